@@ -1030,4 +1030,53 @@ bool BBoxComputer::process(const Scene& scene){
     else return false;
 }
 
+bool BBoxComputer::process(const FlatScene& scene){
+
+    // The flat nodes are traversed without recursion. Shapes, groups and linear transformations
+    // are opened, and the other geometries are bounded in their local frame (with the cache for
+    // shared objects) before being transformed by the precomputed matrix of their ancestors.
+    BoundingBoxPtr _bbox;
+    const std::vector<uint_t>& shapes = scene.getShapeNodes();
+    for (std::vector<uint_t>::const_iterator _i = shapes.begin(); _i != shapes.end(); ++_i) {
+        uint_t _end = scene.getNextNode(*_i);
+        for (uint_t _n = *_i; _n < _end; ) {
+            const FlatScene::Node& node = scene.getNode(_n);
+            switch (node.tag) {
+                case FlatScene::eShape:
+                case FlatScene::eInline:
+                case FlatScene::eGroup:
+                    ++_n;
+                    continue;
+                case FlatScene::eAxisRotated:
+                case FlatScene::eEulerRotated:
+                case FlatScene::eOriented:
+                case FlatScene::eScaled:
+                case FlatScene::eTranslated:
+                    // Children have a matrix only if the transformation is a matrix
+                    if (_n + 1 < _end && scene.hasWorldMatrix(_n + 1)) { ++_n; continue; }
+                    break;
+                case FlatScene::eMaterial:
+                case FlatScene::eMonoSpectral:
+                case FlatScene::eMultiSpectral:
+                case FlatScene::eTexture2D:
+                case FlatScene::eImageTexture:
+                case FlatScene::eTexture2DTransformation:
+                case FlatScene::eFont:
+                    _n = scene.getNextNode(_n);
+                    continue;
+                default:
+                    break;
+            }
+            if (scene.dispatch(_n, *this) && __bbox) {
+                GEOM_BBOXCOMPUTER_TRANSFORM_BBOX(scene.getWorldMatrix(_n));
+                if (_bbox) _bbox->extend(__bbox);
+                else _bbox = BoundingBoxPtr(new BoundingBox(*__bbox));
+            }
+            _n = scene.getNextNode(_n);
+        }
+    }
+    __bbox = _bbox;
+    return (_bbox.get() != NULL);
+}
+
 /* ----------------------------------------------------------------------- */
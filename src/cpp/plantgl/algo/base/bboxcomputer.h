@@ -64,6 +64,7 @@ PGL_BEGIN_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
 class Discretizer;
+class FlatScene;
 #ifdef GEOM_FWDEF
 class Scene;
 typedef RCPtr<Scene> ScenePtr;
@@ -220,6 +221,9 @@ public:
   virtual bool process(const ScenePtr& scene);
   virtual bool process(const Scene& scene);
 
+  /// Compute bounding box of a compiled scene, dispatching on type tags.
+  virtual bool process(const FlatScene& scene);
+
 protected:
 
   /// The cache storing the already computed bounding boxes.
@@ -0,0 +1,106 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file cgaldelaunay.h
+    \brief Construction of CGAL Delaunay triangulations of point sets.
+    Must only be included when PlantGL is built with CGAL.
+*/
+
+#ifndef __cgaldelaunay_h__
+#define __cgaldelaunay_h__
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Triangulation_vertex_base_with_info_3.h>
+#include <CGAL/Delaunay_triangulation_cell_base_3.h>
+#include <CGAL/Delaunay_triangulation_3.h>
+
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <list>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+#include "cgalwrap.h"
+
+typedef CGAL::Exact_predicates_inexact_constructions_kernel             DelaunayKernel;
+typedef CGAL::Triangulation_vertex_base_with_info_3<uint32_t, DelaunayKernel> DelaunayVertexBase;
+typedef CGAL::Delaunay_triangulation_cell_base_3<DelaunayKernel>        DelaunayCellBase;
+
+typedef CGAL::Triangulation_data_structure_3<DelaunayVertexBase, DelaunayCellBase> SequentialDelaunayTds;
+typedef CGAL::Delaunay_triangulation_3<DelaunayKernel, SequentialDelaunayTds> SequentialDelaunay3;
+
+#ifdef CGAL_LINKED_WITH_TBB
+typedef CGAL::Triangulation_data_structure_3<DelaunayVertexBase, DelaunayCellBase, CGAL::Parallel_tag> ParallelDelaunayTds;
+typedef CGAL::Delaunay_triangulation_3<DelaunayKernel, ParallelDelaunayTds> ParallelDelaunay3;
+#endif
+
+/** Calls \e func with the Delaunay triangulation of \e points. The info of each vertex is
+    the index of its point. Points are inserted at once so that CGAL inserts them in spatial order.
+    If \e parallel is true and CGAL is linked with TBB, the insertion is done in parallel.
+    Duplicated points are represented by only one of their indices. */
+template<class Function>
+inline void with_delaunay_triangulation3(const Point3ArrayPtr& points, bool parallel, Function func)
+{
+    typedef DelaunayKernel::Point_3 DPoint;
+    std::vector<std::pair<DPoint, uint32_t> > indexedpoints;
+    indexedpoints.reserve(points->size());
+    uint32_t pointCount = 0;
+    for (Point3Array::const_iterator it = points->begin(); it != points->end(); ++it)
+        indexedpoints.push_back(std::make_pair(toPoint3<DPoint>(*it), pointCount++));
+
+#ifdef CGAL_LINKED_WITH_TBB
+    if (parallel && !indexedpoints.empty()) {
+        CGAL::Bbox_3 bbox = indexedpoints.front().first.bbox();
+        for (std::vector<std::pair<DPoint, uint32_t> >::const_iterator it = indexedpoints.begin();
+             it != indexedpoints.end(); ++it)
+            bbox += it->first.bbox();
+        ParallelDelaunay3::Lock_data_structure locking(bbox, 50);
+        ParallelDelaunay3 triangulation(&locking);
+        triangulation.insert(indexedpoints.begin(), indexedpoints.end());
+        func(triangulation);
+        return;
+    }
+#endif
+    SequentialDelaunay3 triangulation(indexedpoints.begin(), indexedpoints.end());
+    func(triangulation);
+}
+
+#endif
@@ -52,6 +52,12 @@
 #include <plantgl/scenegraph/function/function.h>
 
 #include <plantgl/math/util_math.h>
+#include <plantgl/tool/errormsg.h>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_set>
 
 #ifdef GEOM_DEBUG
 #include <plantgl/tool/timer.h>
@@ -66,7 +72,7 @@ using namespace std;
 template <class T> bool Discretizer::check_cache(T * geom)
 {
   if (!geom->unique()) {
-    Cache<ExplicitModelPtr>::Iterator _it = __cache.find(geom->getObjectId());
+    DiscretizationCache::Iterator _it = __cache.find(cacheKey(geom));
     if (! (_it == __cache.end())) {
        __discretization = ExplicitModelPtr(_it->second);
       if (__discretization) return true;
@@ -80,7 +86,7 @@ template <class T> bool Discretizer::check_cache(T * geom)
 template <class T> bool Discretizer::check_cache_with_tex(T * geom)
 {
   if (!geom->unique()) {
-    Cache<ExplicitModelPtr>::Iterator _it = __cache.find(geom->getObjectId());
+    DiscretizationCache::Iterator _it = __cache.find(cacheKey(geom));
     if ((_it != __cache.end()) && (dynamic_pointer_cast<Mesh>(_it->second))->hasTexCoordList()) {
        __discretization = ExplicitModelPtr(_it->second);
       if (__discretization) return true;
@@ -95,10 +101,115 @@ template <class T>
 void Discretizer::update_cache(T * geom) {
   if (!geom->unique()) {
     if(__discretization && geom->isNamed())__discretization->setName(geom->getName());
-    __cache.insert(geom->getObjectId(),__discretization);
+    __cache.insert(cacheKey(geom),__discretization);
   }
 }
 
+/* ----------------------------------------------------------------------- */
+
+/*
+  Tables shared by all the discretizers. They depend only on the resolution of
+  the primitives: cosines and sines of the slices of a circle, points of unit
+  spheres and index and texture lists. The meshes of the primitives
+  of same resolution share these lists, so that only their points are computed.
+*/
+
+struct CircleTable {
+  std::vector<real_t> cosa;
+  std::vector<real_t> sina;
+};
+
+enum TessellationTable {
+  CONE_INDEX, CONE_TEXCOORD, CONE_TEXINDEX,
+  TUBE_INDEX, TUBE_TEXINDEX, TUBE_QUADINDEX, TUBE_QUADTEXINDEX, FRUSTUM_TEXCOORD,
+  SPHERE_POINTS, SPHERE_INDEX, SPHERE_TEXCOORD, SPHERE_TEXINDEX,
+  DISC_INDEX, DISC_TEXCOORD
+};
+
+// table, slices, stacks, solid
+typedef std::tuple<int,uint_t,uint_t,bool> TessellationKey;
+
+// The tables are only built once for each resolution. Lookups share the lock and only the
+// construction of a missing table takes it exclusively.
+static std::shared_timed_mutex& tessellation_mutex() { static std::shared_timed_mutex MUTEX; return MUTEX; }
+static std::map<uint_t,CircleTable>& circle_tables() { static std::map<uint_t,CircleTable> TABLES; return TABLES; }
+static std::map<TessellationKey,RefCountObjectPtr>& tessellation_tables() { static std::map<TessellationKey,RefCountObjectPtr> TABLES; return TABLES; }
+static std::unordered_set<const RefCountObject *>& tessellation_table_set() { static std::unordered_set<const RefCountObject *> TABLES; return TABLES; }
+
+static void fillCircleTable(CircleTable& table, uint_t slices) {
+  real_t _angleStep = real_t(GEOM_TWO_PI) / slices;
+  table.cosa.resize(slices);
+  table.sina.resize(slices);
+  for (uint_t _i = 0; _i < slices; _i++) {
+    table.cosa[_i] = cos(_i * _angleStep);
+    table.sina[_i] = sin(_i * _angleStep);
+  }
+}
+
+static const CircleTable& getCircleTable(uint_t slices) {
+  {
+    std::shared_lock<std::shared_timed_mutex> guard(tessellation_mutex());
+    std::map<uint_t,CircleTable>::const_iterator it = circle_tables().find(slices);
+    if (it != circle_tables().end()) return it->second;
+  }
+  std::unique_lock<std::shared_timed_mutex> guard(tessellation_mutex());
+  CircleTable& table = circle_tables()[slices];
+  if (table.cosa.empty()) fillCircleTable(table,slices);
+  return table;
+}
+
+template<class T>
+static RCPtr<T> getTessellationTable(TessellationTable id, uint_t slices, uint_t stacks, bool solid,
+                                     RCPtr<T> (* builder)(uint_t slices, uint_t stacks, bool solid)) {
+  TessellationKey key(id,slices,stacks,solid);
+  {
+    std::shared_lock<std::shared_timed_mutex> guard(tessellation_mutex());
+    std::map<TessellationKey,RefCountObjectPtr>::const_iterator it = tessellation_tables().find(key);
+    if (it != tessellation_tables().end()) return dynamic_pointer_cast<T>(it->second);
+  }
+  std::unique_lock<std::shared_timed_mutex> guard(tessellation_mutex());
+  RefCountObjectPtr& table = tessellation_tables()[key];
+  if (!table) {
+    table = RefCountObjectPtr(builder(slices,stacks,solid));
+    tessellation_table_set().insert(table.get());
+  }
+  return dynamic_pointer_cast<T>(table);
+}
+
+void Discretizer::clearTessellationTables() {
+  std::unique_lock<std::shared_timed_mutex> guard(tessellation_mutex());
+  circle_tables().clear();
+  tessellation_tables().clear();
+  tessellation_table_set().clear();
+}
+
+template<class Array>
+static void detachTable(RCPtr<Array>& array) {
+  if (array && tessellation_table_set().find(array.get()) != tessellation_table_set().end())
+    array = RCPtr<Array>(new Array(*array));
+}
+
+template<class MeshType>
+static ExplicitModelPtr detachMeshTables(const ExplicitModelPtr& model, MeshType * mesh) {
+  std::shared_lock<std::shared_timed_mutex> guard(tessellation_mutex());
+  const std::unordered_set<const RefCountObject *>& tables = tessellation_table_set();
+  if (tables.find(mesh->getIndexList().get()) == tables.end() &&
+      tables.find(mesh->getTexCoordList().get()) == tables.end() &&
+      tables.find(mesh->getTexCoordIndexList().get()) == tables.end()) return model;
+  MeshType * result = new MeshType(*mesh);
+  detachTable(result->getIndexList());
+  detachTable(result->getTexCoordList());
+  detachTable(result->getTexCoordIndexList());
+  return ExplicitModelPtr(result);
+}
+
+ExplicitModelPtr Discretizer::detachTessellationTables(const ExplicitModelPtr& model) {
+  if (TriangleSet * t = dynamic_cast<TriangleSet *>(model.get())) return detachMeshTables(model, t);
+  if (QuadSet * q = dynamic_cast<QuadSet *>(model.get())) return detachMeshTables(model, q);
+  if (FaceSet * f = dynamic_cast<FaceSet *>(model.get())) return detachMeshTables(model, f);
+  return model;
+}
+
 #define GEOM_DISCRETIZER_CHECK_CACHE(geom) \
   if (check_cache(geom)) return true;
 
@@ -107,12 +218,54 @@ void Discretizer::update_cache(T * geom) {
 
 #define GEOM_DISCRETIZER_UPDATE_CACHE update_cache
 
+/// Returns an upper bound of the factor applied to lengths by \e transformation.
+static real_t transformationScale(const Transformation3DPtr& transformation) {
+  Matrix4TransformationPtr _matrix = dynamic_pointer_cast<Matrix4Transformation>(transformation);
+  if (_matrix) {
+    // norms of the images of the axes by the linear part of the matrix
+    Matrix4 _m = _matrix->getMatrix();
+    real_t _scale = 0;
+    for (uchar_t _j = 0; _j < 3; ++_j)
+      _scale = max(_scale,norm(Vector3(_m(0,_j),_m(1,_j),_m(2,_j))));
+    return _scale;
+  }
+  Point3ArrayPtr _frame(new Point3Array(4,Vector3::ORIGIN));
+  _frame->setAt(1,Vector3::OX);
+  _frame->setAt(2,Vector3::OY);
+  _frame->setAt(3,Vector3::OZ);
+  _frame = transformation->transform(_frame);
+  real_t _scale = 0;
+  for (uint_t _i = 1; _i < 4; ++_i)
+    _scale = max(_scale,norm(_frame->getAt(_i)-_frame->getAt(0)));
+  return _scale;
+}
+
+/// Returns half the diagonal of the bounding box of control points of extent \e extent.
+static real_t ctrlPointRadius(const Vector4& extent) {
+  return norm(Vector3(extent.x(),extent.y(),extent.z())) / 2;
+}
+
+static real_t ctrlPointRadius(const Vector3& extent) {
+  return norm(Vector2(extent.x(),extent.y())) / 2;
+}
+
 template <class T>
 bool Discretizer::transformed(T * geom) {
   GEOM_DISCRETIZER_CHECK_CACHE(geom);
-  if(geom->getGeometry() &&
-    (geom->getGeometry())->apply(*this) &&
-    __discretization){
+  bool _applied = false;
+  if (geom->getGeometry()) {
+    if (__lodScale > 0) {
+      // the resolution of the transformed geometry depends on its projected size
+      real_t _lodScale = __lodScale;
+      int _lodLevel = __lodLevel;
+      setLodScale(__lodScale * transformationScale(geom->getTransformation()));
+      _applied = geom->getGeometry()->apply(*this);
+      __lodScale = _lodScale;
+      __lodLevel = _lodLevel;
+    }
+    else _applied = geom->getGeometry()->apply(*this);
+  }
+  if(_applied && __discretization){
     __discretization = __discretization->transform(geom->getTransformation());
     GEOM_DISCRETIZER_UPDATE_CACHE(geom);
     return true;
@@ -132,7 +285,10 @@ Discretizer::Discretizer( ) :
     Action(),
     __cache(),
     __discretization(),
-    __computeTexCoord(false){
+    __computeTexCoord(false),
+    __lodScale(0),
+    __lodLevel(0),
+    __lodTolerance(0.5){
 }
 
 Discretizer::~Discretizer( ) {
@@ -143,6 +299,42 @@ void Discretizer::clear( ) {
   __cache.clear();
 }
 
+void Discretizer::setLodScale(real_t pixelsPerUnit) {
+  if (pixelsPerUnit > GEOM_EPSILON) {
+    __lodLevel = int(ceil(2 * log2(pixelsPerUnit)));
+    __lodScale = pow(real_t(2),real_t(__lodLevel)/2);
+  }
+  else {
+    __lodLevel = 0;
+    __lodScale = 0;
+  }
+}
+
+void Discretizer::setLodTolerance(real_t pixels) {
+  if (pixels > GEOM_EPSILON) __lodTolerance = pixels;
+  else pglWarning("Discretizer : the level of detail tolerance must be strictly positive.");
+}
+
+uint_t Discretizer::lodResolution(uint_t resolution, real_t radius, uint_t minimum, real_t angle) const {
+  if (__lodScale <= 0 || resolution <= minimum) return resolution;
+  // the sagitta of a chord of angle a on a circle of radius r is r (1 - cos(a/2))
+  real_t _radius = radius * __lodScale;
+  if (_radius <= __lodTolerance) return minimum;
+  real_t _step = 2 * acos(1 - __lodTolerance / _radius);
+  real_t _nb = ceil(angle / _step);
+  if (_nb >= resolution) return resolution;
+  return max(minimum,uint_t(_nb));
+}
+
+void Discretizer::lodPatchStrides(const Point4MatrixPtr& ctrlPoints, bool urows, uint_t& ustride, uint_t& vstride) const {
+  if (__lodScale <= 0) return;
+  real_t _radius = ctrlPointRadius(ctrlPoints->getExtent());
+  uint_t _uNb = (urows ? ctrlPoints->getRowNb() : ctrlPoints->getColumnNb());
+  uint_t _vNb = (urows ? ctrlPoints->getColumnNb() : ctrlPoints->getRowNb());
+  ustride = lodResolution(ustride,_radius,_uNb);
+  vstride = lodResolution(vstride,_radius,_vNb);
+}
+
 /* ----------------------------------------------------------------------- */
 
 bool Discretizer::process(Shape * Shape){
@@ -252,6 +444,13 @@ bool Discretizer::process( AsymmetricHull * asymmetricHull ) {
   const real_t& _shapeTop = asymmetricHull->getTopShape();
   uint_t _slices = asymmetricHull->getSlices();
   uint_t _stacks = asymmetricHull->getStacks();
+  if (isLodEnabled()) {
+    // slices and stacks are given for a quarter of turn
+    real_t _hullRadius = max(max(fabs(asymmetricHull->getPosXRadius()),fabs(asymmetricHull->getNegXRadius())),
+                             max(fabs(asymmetricHull->getPosYRadius()),fabs(asymmetricHull->getNegYRadius())));
+    _slices = lodResolution(_slices,_hullRadius,1,GEOM_HALF_PI);
+    _stacks = lodResolution(_stacks,max(_hullRadius,norm(_topPoint-_botPoint)/2),1,GEOM_HALF_PI);
+  }
 
   uint_t _totalSlices = _slices * 4;
   uint_t _totalStacks = _stacks * 2;
@@ -439,6 +638,9 @@ bool Discretizer::process( BezierCurve * bezierCurve ) {
 
   real_t _start = 0;
   uint_t _size = bezierCurve->getStride();
+  if (isLodEnabled())
+    _size = lodResolution(_size,ctrlPointRadius(bezierCurve->getCtrlPointList()->getExtent()),
+                          bezierCurve->getCtrlPointList()->size());
   real_t _step = real_t(1.0) / (real_t)_size;
   Point3ArrayPtr _pointList(new Point3Array(_size + 1));
 
@@ -462,49 +664,42 @@ bool Discretizer::process( BezierPatch * bezierPatch ) {
 
   GEOM_DISCRETIZER_CHECK_CACHE_WITH_TEX(bezierPatch);
 
-  const uint_t _uStride = bezierPatch->getUStride();
-  const uint_t _vStride = bezierPatch->getVStride();
+  uint_t _uStride = bezierPatch->getUStride();
+  uint_t _vStride = bezierPatch->getVStride();
+  // control points are stored along v in the rows of the matrix
+  lodPatchStrides(bezierPatch->getCtrlPointMatrix(),false,_uStride,_vStride);
+
+  const real_t _uStride1 = _uStride - real_t(1);
+  const real_t _vStride1 = _vStride - real_t(1);
+
+  RealArrayPtr _uValues(new RealArray(_uStride));
+  for (uint_t _u = 0 ; _u < _uStride - 1 ; _u ++)
+    _uValues->setAt(_u,_u/_uStride1);
+  _uValues->setAt(_uStride - 1,1.0);
 
-  const real_t _uStride1 = bezierPatch->getUStride() - real_t(1);
-  const real_t _vStride1 = bezierPatch->getVStride() - real_t(1);
+  RealArrayPtr _vValues(new RealArray(_vStride));
+  for (uint_t _v = 0 ; _v < _vStride - 1 ; _v ++)
+    _vValues->setAt(_v,_v/_vStride1);
+  _vValues->setAt(_vStride - 1,1.0);
 
-  Point3ArrayPtr _pointList(new Point3Array(_uStride * _vStride));
+  // basis functions are evaluated once per u and v value
+  Point3ArrayPtr _pointList = bezierPatch->evaluateGrid(_uValues,_vValues);
   Index4ArrayPtr _indexList(new Index4Array( (_uStride - 1) * (_vStride - 1)));
 
   uint_t _cur = 0;
-
-  uint_t _pointCount = 0;
   uint_t _indexCount = 0;
 
-  for ( real_t _u = 0 ; _u < _uStride1 ; _u ++){
-    for (real_t _v = 0; _v < _vStride1; _v ++) {
-
-      _pointList->setAt(_pointCount++,
-                        bezierPatch->getPointAt((_u/_uStride1),
-                                                (_v/_vStride1)));
-
+  for (uint_t _u = 0 ; _u < _uStride - 1 ; _u ++){
+    for (uint_t _v = 0; _v < _vStride - 1; _v ++) {
       _indexList->setAt(_indexCount++,Index4(_cur,
                                              _cur + 1,
                                              _cur + _vStride + 1,
                                              _cur + _vStride));
-
       _cur++;
-
     };
-
-    _pointList->setAt(_pointCount++,
-                      bezierPatch->getPointAt((_u/_uStride1),1.0));
-
     _cur++;
-
   };
 
-  for (real_t _v = 0; _v < _vStride1; _v ++)
-    _pointList->setAt(_pointCount++,
-                      bezierPatch->getPointAt(1.0,(_v/_vStride1)));
-
-  _pointList->setAt(_pointCount,bezierPatch->getPointAt(1.0,1.0));
-
   PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
                                      Vector3(0,0,0)));
 
@@ -588,6 +783,40 @@ bool Discretizer::process( Box * box ) {
 /* ----------------------------------------------------------------------- */
 
 
+static Index3ArrayPtr buildConeIndices(uint_t _slices, uint_t, bool _solid) {
+  Index3ArrayPtr _indexList(new Index3Array(_slices * (_solid ? 2 : 1)));
+  Index3Array::iterator _itIndex = _indexList->begin();
+  uint_t _base = _slices + 1;
+  uint_t _top = _base - 1;
+  for (uint_t _cur = 0; _cur < _slices; _cur++) {
+    uint_t _next = (_cur + 1) % _slices;
+    *_itIndex = Index3(_cur,_next,_top); ++_itIndex;
+    if (_solid) { *_itIndex = Index3(_cur,_base,_next); ++_itIndex; }
+  }
+  return _indexList;
+}
+
+static Point2ArrayPtr buildConeTexCoords(uint_t _slices, uint_t, bool) {
+  Point2ArrayPtr _texCoordList(new Point2Array(_slices + 2));
+  real_t _angleStep = real_t(GEOM_TWO_PI) / _slices;
+  for (uint_t _i = 0; _i < _slices; _i++)
+    _texCoordList->setAt(_i,Vector2(0.5+cos(_i * _angleStep)/2,0.5+sin(_i * _angleStep)/2));
+  _texCoordList->setAt(_slices,Vector2(1.0,0.5));
+  _texCoordList->setAt(_slices+1,Vector2(0.5,0.5));
+  return _texCoordList;
+}
+
+static Index3ArrayPtr buildConeTexIndices(uint_t _slices, uint_t, bool _solid) {
+  Index3ArrayPtr _texIndexList(new Index3Array(_slices * (_solid ? 2 : 1)));
+  Index3Array::iterator _itIndex = _texIndexList->begin();
+  uint_t _toptex = _slices + 1;
+  for (uint_t _cur = 0; _cur < _slices; _cur++) {
+    *_itIndex = Index3(_cur,_cur+1,_toptex); ++_itIndex;
+    if (_solid) { *_itIndex = Index3(_cur,_toptex,_cur+1); ++_itIndex; }
+  }
+  return _texIndexList;
+}
+
 bool Discretizer::process( Cone * cone ) {
   GEOM_ASSERT(cone);
 
@@ -596,60 +825,19 @@ bool Discretizer::process( Cone * cone ) {
   real_t _radius = cone->getRadius();
   real_t _height = cone->getHeight();
   bool _solid = cone->getSolid();
-  uint_t _slices = cone->getSlices();
+  uint_t _slices = lodResolution(cone->getSlices(),_radius);
 
   uint_t _offset = (_solid ? 1 : 0);
 
+  // only the points depend on the dimensions of the cone
+  const CircleTable& _circle = getCircleTable(_slices);
   Point3ArrayPtr _pointList(new Point3Array(_slices + 1 + _offset));
-  Index3ArrayPtr _indexList(new Index3Array(_slices * (1 + _offset)));
-  Point2ArrayPtr _texCoordList;
-  Index3ArrayPtr _texIndexList;
-  if(__computeTexCoord){
-    _texCoordList = Point2ArrayPtr(new Point2Array(_slices + 2));
-    _texIndexList = Index3ArrayPtr(new Index3Array(_slices * (1 + _offset)));
-  }
-
-  uint_t _cur = 0;
-  uint_t _next = 1;
-  uint_t _base = _slices + 1;
-  uint_t _top = _base - 1;
-  uint_t _toptex = _base;
-
-  uint_t _pointsCount = 0;
-  uint_t _texCoordCount = 0;
-  uint_t _facesCount = 0;
-  real_t _angleStep = real_t(GEOM_TWO_PI) / _slices;
+  Point3Array::iterator _itPoint = _pointList->begin();
+  for (uint_t _i = 0; _i < _slices; _i++, ++_itPoint)
+    *_itPoint = Vector3(_circle.cosa[_i] * _radius,_circle.sina[_i] * _radius,0);
+  *_itPoint = Vector3(0,0,_height);
 
-  _pointList->setAt(_top,Vector3(0,0,_height));
-  if(__computeTexCoord)
-      _texCoordList->setAt(_toptex,Vector2(0.5,0.5));
-
-  for (uint_t _i = 0; _i < _slices; _i++) {
-    real_t cosa = cos(_i * _angleStep);
-    real_t sina = sin(_i * _angleStep);
-    real_t _x = cosa * _radius;
-    real_t _y = sina * _radius;
-
-    _pointList->setAt(_pointsCount++,Vector3(_x,_y,0));
-    _indexList->setAt(_facesCount,Index3(_cur,_next,_top));
-    if(__computeTexCoord){
-      _texCoordList->setAt(_texCoordCount++,Vector2(0.5+cosa/2,0.5+sina/2));
-      _texIndexList->setAt(_facesCount,Index3(_cur,_cur+1,_toptex));
-    }
-    ++_facesCount;
-
-    if (_solid){
-      _indexList->setAt(_facesCount,Index3(_cur,_base,_next));
-      if(__computeTexCoord)
-            _texIndexList->setAt(_facesCount,Index3(_cur,_toptex,_cur+1));
-      ++_facesCount;
-    }
-
-    _cur = _next;
-    _next = (_next + 1 ) % _slices;
-  }
-  if(__computeTexCoord)
-    _texCoordList->setAt(_texCoordCount,Vector2(1.0,0.5));
+  Index3ArrayPtr _indexList = getTessellationTable(CONE_INDEX,_slices,0,_solid,&buildConeIndices);
 
   PolylinePtr _skeleton(new Polyline(Vector3(Vector3::ORIGIN),
                                      Vector3(0,0,_height)));
@@ -658,8 +846,8 @@ bool Discretizer::process( Cone * cone ) {
                                     true, true, // CCW
                                     _solid,_skeleton);
   if (__computeTexCoord){
-    t->getTexCoordList() = _texCoordList;
-    t->getTexCoordIndexList() = _texIndexList;
+    t->getTexCoordList() = getTessellationTable(CONE_TEXCOORD,_slices,0,false,&buildConeTexCoords);
+    t->getTexCoordIndexList() = getTessellationTable(CONE_TEXINDEX,_slices,0,_solid,&buildConeTexIndices);
   }
   __discretization = ExplicitModelPtr(t);
 
@@ -671,132 +859,144 @@ bool Discretizer::process( Cone * cone ) {
 /* ----------------------------------------------------------------------- */
 
 
-bool Discretizer::process( Cylinder * cylinder ) {
-  GEOM_ASSERT(cylinder);
-
-  GEOM_DISCRETIZER_CHECK_CACHE(cylinder);
-
-  real_t _radius = cylinder->getRadius();
-  real_t _height = cylinder->getHeight();
-  bool _solid = cylinder->getSolid();
-  uint_t _slices = cylinder->getSlices();
-
-  uint_t _offset = (_solid ? 2 : 0);
-
-  Point3ArrayPtr _pointList(new Point3Array((_slices * 2) + _offset));
-  Point2ArrayPtr _texCoordList;
-  if(__computeTexCoord)
-    _texCoordList = Point2ArrayPtr(new Point2Array(((_slices+1) * (2 + (_solid ? 1 : 0))) + (_solid ? 1 : 0)));
-
-  IndexArrayPtr _indexList;
-  Index4ArrayPtr _index4List;
-  if(_solid)
-      _indexList= IndexArrayPtr(new IndexArray(_slices * 3 ));
-  else
-      _index4List= Index4ArrayPtr(new Index4Array(_slices ));
-
-  IndexArrayPtr _texIndexList;
-  Index4ArrayPtr _texIndex4List;
-  if(__computeTexCoord) {
-    if(_solid)
-      _texIndexList= IndexArrayPtr(new IndexArray(_slices * 3 ));
-    else
-      _texIndex4List= Index4ArrayPtr(new Index4Array(_slices ));
-  }
-
-
-  uint_t _cur = 0;
-  uint_t _next = 2;
-
-  uint_t _curtex = 0;
-  uint_t _nexttexstep = 2+ (_solid ? 1 : 0);
-  uint_t _nexttex = _nexttexstep;
-
+/*
+  Topology of cylinders and frustums: points 2i and 2i+1 are the bottom and top points of slice i,
+  followed by the centers of the bottom and top caps when the tube is solid.
+  Texture coordinates of slice i are at (2 + solid) * i.
+*/
+static IndexArrayPtr buildTubeIndices(uint_t _slices, uint_t, bool) {
+  IndexArrayPtr _indexList(new IndexArray(_slices * 3));
+  uint_t _facesCount = 0;
   uint_t _base = 2 * _slices;
   uint_t _top = _base + 1;
-  uint_t _basetex = (2+ (_solid ? 1 : 0)) * (_slices+1);
-
-  uint_t _pointsCount = 0;
-  uint_t _texCoordCount = 0;
-  uint_t _facesCount = 0;
-  uint_t _texFacesCount = 0;
-  real_t _angleStep = GEOM_TWO_PI / _slices;
+  for (uint_t _i = 0; _i < _slices; _i++) {
+    uint_t _cur = 2 * _i;
+    uint_t _next = (_cur + 2) % (2 * _slices);
+    _indexList->setAt(_facesCount++,Index4(_cur,_next,_next+1,_cur+1));
+    _indexList->setAt(_facesCount++,Index3(_cur + 1,_next + 1,_top));
+    _indexList->setAt(_facesCount++,Index3(_cur,_base,_next));
+  }
+  return _indexList;
+}
 
-  if (_solid){
-    _pointList->setAt(_top,Vector3(0,0,_height));
-    if(__computeTexCoord)
-        _texCoordList->setAt(_basetex,Vector2(0.5,0.5));
+static Index4ArrayPtr buildTubeQuadIndices(uint_t _slices, uint_t, bool) {
+  Index4ArrayPtr _index4List(new Index4Array(_slices));
+  Index4Array::iterator _itIndex = _index4List->begin();
+  for (uint_t _i = 0; _i < _slices; _i++, ++_itIndex) {
+    uint_t _cur = 2 * _i;
+    uint_t _next = (_cur + 2) % (2 * _slices);
+    *_itIndex = Index4(_cur,_next ,_next+1,_cur + 1);
   }
+  return _index4List;
+}
 
+static IndexArrayPtr buildTubeTexIndices(uint_t _slices, uint_t, bool) {
+  IndexArrayPtr _texIndexList(new IndexArray(_slices * 3));
+  uint_t _texFacesCount = 0;
+  uint_t _basetex = 3 * (_slices+1);
   for (uint_t _i = 0; _i < _slices; _i++) {
-    real_t cosa = cos(_i * _angleStep);
-    real_t sina = sin(_i * _angleStep);
-    real_t _x = cosa * _radius;
-    real_t _y = sina * _radius;
-
-    _pointList->setAt(_pointsCount++,Vector3(_x,_y,0));
-    _pointList->setAt(_pointsCount++,Vector3(_x,_y,_height));
-
-    if(__computeTexCoord){
-        real_t u = real_t(_i)/_slices;
-        _texCoordList->setAt(_texCoordCount++,Vector2(u,0));
-        _texCoordList->setAt(_texCoordCount++,Vector2(u,_height));
-        if (_solid)
-            _texCoordList->setAt(_texCoordCount++,Vector2(0.5 * cosa + 0.5 , 0.5 * sina + 0.5));
-    }
-
-    if (_solid) {
-        _indexList->setAt(_facesCount++,Index4(_cur,_next,_next+1,_cur+1));
-        _indexList->setAt(_facesCount++,Index3(_cur + 1,_next + 1,_top));
-        _indexList->setAt(_facesCount++,Index3(_cur,_base,_next));
-        if(__computeTexCoord){
-            _texIndexList->setAt(_texFacesCount++,Index4(_curtex,_nexttex ,_nexttex+1,_curtex + 1));
-            _texIndexList->setAt(_texFacesCount++,Index3(_curtex+2,_nexttex+2,_basetex));
-            _texIndexList->setAt(_texFacesCount++,Index3(_curtex+2,_basetex,_nexttex+2));
-        }
-    }
-    else {
-        _index4List->setAt(_facesCount++,Index4(_cur,_next ,_next+1,_cur + 1));
-        if(__computeTexCoord)
-            _texIndex4List->setAt(_texFacesCount++,Index4(_curtex,_nexttex ,_nexttex+1,_curtex + 1));
-    }
-
+    uint_t _curtex = 3 * _i;
+    uint_t _nexttex = _curtex + 3;
+    _texIndexList->setAt(_texFacesCount++,Index4(_curtex,_nexttex ,_nexttex+1,_curtex + 1));
+    _texIndexList->setAt(_texFacesCount++,Index3(_curtex+2,_nexttex+2,_basetex));
+    _texIndexList->setAt(_texFacesCount++,Index3(_curtex+2,_basetex,_nexttex+2));
+  }
+  return _texIndexList;
+}
 
-    _cur = _next;
-    _next = (_next + 2 ) % (2 * _slices);
-    _curtex = _nexttex;
-    _nexttex += _nexttexstep ;
+static Index4ArrayPtr buildTubeQuadTexIndices(uint_t _slices, uint_t, bool) {
+  Index4ArrayPtr _texIndex4List(new Index4Array(_slices));
+  Index4Array::iterator _itIndex = _texIndex4List->begin();
+  for (uint_t _i = 0; _i < _slices; _i++, ++_itIndex) {
+    uint_t _curtex = 2 * _i;
+    uint_t _nexttex = _curtex + 2;
+    *_itIndex = Index4(_curtex,_nexttex ,_nexttex+1,_curtex + 1);
   }
+  return _texIndex4List;
+}
 
-  if(__computeTexCoord){
-        _texCoordList->setAt(_texCoordCount++,Vector2(1,0));
-        _texCoordList->setAt(_texCoordCount++,Vector2(1,_height));
-        if (_solid)
-            _texCoordList->setAt(_texCoordCount++,Vector2(1.0, 0.5));
+static Point2ArrayPtr tubeTexCoords(const CircleTable& _circle, uint_t _slices, bool _solid, real_t _vtop) {
+  Point2ArrayPtr _texCoordList(new Point2Array(((_slices+1) * (2 + (_solid ? 1 : 0))) + (_solid ? 1 : 0)));
+  Point2Array::iterator _itTex = _texCoordList->begin();
+  for (uint_t _i = 0; _i < _slices; _i++) {
+    real_t u = real_t(_i)/_slices;
+    *_itTex = Vector2(u,0); ++_itTex;
+    *_itTex = Vector2(u,_vtop); ++_itTex;
+    if (_solid) { *_itTex = Vector2(0.5 * _circle.cosa[_i] + 0.5 , 0.5 * _circle.sina[_i] + 0.5); ++_itTex; }
+  }
+  *_itTex = Vector2(1,0); ++_itTex;
+  *_itTex = Vector2(1,_vtop); ++_itTex;
+  if (_solid) {
+    *_itTex = Vector2(1.0, 0.5); ++_itTex;
+    *_itTex = Vector2(0.5,0.5);
   }
+  return _texCoordList;
+}
+
+static Point2ArrayPtr buildFrustumTexCoords(uint_t _slices, uint_t, bool _solid) {
+  // called with the tables locked
+  CircleTable _circle;
+  fillCircleTable(_circle,_slices);
+  return tubeTexCoords(_circle, _slices, _solid, 1);
+}
 
+/*
+  Build the mesh of a tube from its points with the shared topology.
+*/
+static ExplicitModelPtr tubeMesh(const Point3ArrayPtr& _pointList, uint_t _slices, bool _solid, real_t _height,
+                                 const Point2ArrayPtr& _texCoordList) {
   PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
                                      Vector3(0,0,_height)));
-
-
   if (_solid){
-      FaceSet * f = new FaceSet(_pointList, _indexList,
+      FaceSet * f = new FaceSet(_pointList, getTessellationTable(TUBE_INDEX,_slices,0,true,&buildTubeIndices),
                                 true, true, // CCW
                                 _solid, _skeleton);
-      f->getTexCoordList() = _texCoordList;
-      f->getTexCoordIndexList() = _texIndexList;
-      __discretization = ExplicitModelPtr(f);
+      if (_texCoordList) {
+        f->getTexCoordList() = _texCoordList;
+        f->getTexCoordIndexList() = getTessellationTable(TUBE_TEXINDEX,_slices,0,true,&buildTubeTexIndices);
+      }
+      return ExplicitModelPtr(f);
   }
   else {
-      QuadSet * q = new QuadSet(_pointList,
-                                _index4List,
+      QuadSet * q = new QuadSet(_pointList, getTessellationTable(TUBE_QUADINDEX,_slices,0,false,&buildTubeQuadIndices),
                                 true, true, // CCW
                                 _solid, _skeleton);
-      q->getTexCoordList() = _texCoordList;
-      q->getTexCoordIndexList() = _texIndex4List;
-      __discretization = ExplicitModelPtr(q);
+      if (_texCoordList) {
+        q->getTexCoordList() = _texCoordList;
+        q->getTexCoordIndexList() = getTessellationTable(TUBE_QUADTEXINDEX,_slices,0,false,&buildTubeQuadTexIndices);
+      }
+      return ExplicitModelPtr(q);
   }
+}
+
+bool Discretizer::process( Cylinder * cylinder ) {
+  GEOM_ASSERT(cylinder);
+
+  GEOM_DISCRETIZER_CHECK_CACHE(cylinder);
 
+  real_t _radius = cylinder->getRadius();
+  real_t _height = cylinder->getHeight();
+  bool _solid = cylinder->getSolid();
+  uint_t _slices = lodResolution(cylinder->getSlices(),_radius);
+
+  uint_t _offset = (_solid ? 2 : 0);
+
+  const CircleTable& _circle = getCircleTable(_slices);
+  Point3ArrayPtr _pointList(new Point3Array((_slices * 2) + _offset));
+  Point3Array::iterator _itPoint = _pointList->begin();
+  for (uint_t _i = 0; _i < _slices; _i++) {
+    real_t _x = _circle.cosa[_i] * _radius;
+    real_t _y = _circle.sina[_i] * _radius;
+    *_itPoint = Vector3(_x,_y,0); ++_itPoint;
+    *_itPoint = Vector3(_x,_y,_height); ++_itPoint;
+  }
+  if (_solid) _pointList->setAt(2 * _slices + 1,Vector3(0,0,_height));
+
+  // texture coordinates depend on the height of the cylinder
+  Point2ArrayPtr _texCoordList;
+  if(__computeTexCoord) _texCoordList = tubeTexCoords(_circle, _slices, _solid, _height);
+
+  __discretization = tubeMesh(_pointList, _slices, _solid, _height, _texCoordList);
 
   GEOM_DISCRETIZER_UPDATE_CACHE(cylinder);
   return true;
@@ -1320,123 +1520,25 @@ bool Discretizer::process( Frustum * frustum ) {
   real_t _height = frustum->getHeight();
   real_t _taper = frustum->getTaper();
   bool _solid = frustum->getSolid();
-  uint_t _slices = frustum->getSlices();
+  uint_t _slices = lodResolution(frustum->getSlices(),_radius * max(real_t(1),_taper));
 
   uint_t _offset = (_solid ? 2 : 0);
 
+  const CircleTable& _circle = getCircleTable(_slices);
   Point3ArrayPtr _pointList(new Point3Array((_slices * 2) + _offset));
-  Point2ArrayPtr _texCoordList;
-  if(__computeTexCoord)
-    _texCoordList = Point2ArrayPtr(new Point2Array(((_slices+1) * (2 + (_solid ? 1 : 0))) + (_solid ? 1 : 0)));
-
-  IndexArrayPtr _indexList;
-  Index4ArrayPtr _index4List;
-  if(_solid)
-      _indexList= IndexArrayPtr(new IndexArray(_slices * 3 ));
-  else
-      _index4List= Index4ArrayPtr(new Index4Array(_slices ));
-
-  IndexArrayPtr _texIndexList;
-  Index4ArrayPtr _texIndex4List;
-  if(__computeTexCoord) {
-    if(_solid)
-      _texIndexList= IndexArrayPtr(new IndexArray(_slices * 3 ));
-    else
-      _texIndex4List= Index4ArrayPtr(new Index4Array(_slices ));
-  }
-
-
-  uint_t _cur = 0;
-  uint_t _next = 2;
-
-  uint_t _curtex = 0;
-  uint_t _nexttexstep = 2+ (_solid ? 1 : 0);
-  uint_t _nexttex = _nexttexstep;
-
-  uint_t _base = 2 * _slices;
-  uint_t _top = _base + 1;
-  uint_t _basetex = (2+ (_solid ? 1 : 0)) * (_slices+1);
-
-  uint_t _pointsCount = 0;
-  uint_t _texCoordCount = 0;
-  uint_t _facesCount = 0;
-  uint_t _texFacesCount = 0;
-
-  real_t _angleStep = GEOM_TWO_PI / _slices;
-
-  if (_solid){
-    _pointList->setAt(_top,Vector3(0,0,_height));
-    if(__computeTexCoord)
-        _texCoordList->setAt(_basetex,Vector2(0.5,0.5));
-  }
-
+  Point3Array::iterator _itPoint = _pointList->begin();
   for (uint_t _i = 0; _i < _slices; _i++) {
-    real_t cosa = cos(_i * _angleStep);
-    real_t sina = sin(_i * _angleStep);
-    real_t _x = cosa * _radius;
-    real_t _y = sina * _radius;
-
-    _pointList->setAt(_pointsCount++,Vector3(_x,_y,0));
-    _pointList->setAt(_pointsCount++,Vector3(_x * _taper,
-                                             _y * _taper,
-                                             _height));
-
-    if(__computeTexCoord){
-        real_t u = real_t(_i)/_slices;
-        _texCoordList->setAt(_texCoordCount++,Vector2(u,0));
-        _texCoordList->setAt(_texCoordCount++,Vector2(u,1));
-        if (_solid)
-            _texCoordList->setAt(_texCoordCount++,Vector2(0.5 * cosa + 0.5 , 0.5 * sina + 0.5));
-    }
-
-    if (_solid) {
-        _indexList->setAt(_facesCount++,Index4(_cur,_next,_next+1,_cur+1));
-        _indexList->setAt(_facesCount++,Index3(_cur + 1,_next + 1,_top));
-        _indexList->setAt(_facesCount++,Index3(_cur,_base,_next));
-        if(__computeTexCoord){
-            _texIndexList->setAt(_texFacesCount++,Index4(_curtex,_nexttex ,_nexttex+1,_curtex + 1));
-            _texIndexList->setAt(_texFacesCount++,Index3(_curtex+2,_nexttex+2,_basetex));
-            _texIndexList->setAt(_texFacesCount++,Index3(_curtex+2,_basetex,_nexttex+2));
-        }
-    }
-    else {
-        _index4List->setAt(_facesCount++,Index4(_cur,_next ,_next+1,_cur + 1));
-        if(__computeTexCoord)
-            _texIndex4List->setAt(_texFacesCount++,Index4(_curtex,_nexttex ,_nexttex+1,_curtex + 1));
-    }
-
-    _cur = _next;
-    _next = (_next + 2 ) % (2 * _slices);
-    _curtex = _nexttex;
-    _nexttex += _nexttexstep ;
+    real_t _x = _circle.cosa[_i] * _radius;
+    real_t _y = _circle.sina[_i] * _radius;
+    *_itPoint = Vector3(_x,_y,0); ++_itPoint;
+    *_itPoint = Vector3(_x * _taper, _y * _taper, _height); ++_itPoint;
   }
+  if (_solid) _pointList->setAt(2 * _slices + 1,Vector3(0,0,_height));
 
-  if(__computeTexCoord){
-        _texCoordList->setAt(_texCoordCount++,Vector2(1,0));
-        _texCoordList->setAt(_texCoordCount++,Vector2(1,1));
-        if (_solid)
-            _texCoordList->setAt(_texCoordCount++,Vector2(1.0, 0.5));
-  }
-
-  PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
-                                     Vector3(0,0,_height)));
+  Point2ArrayPtr _texCoordList;
+  if(__computeTexCoord) _texCoordList = getTessellationTable(FRUSTUM_TEXCOORD,_slices,0,_solid,&buildFrustumTexCoords);
 
-  if (_solid){
-      FaceSet * f = new FaceSet(_pointList, _indexList,
-                                true, true, // CCW
-                                _solid, _skeleton);
-      f->getTexCoordList() = _texCoordList;
-      f->getTexCoordIndexList() = _texIndexList;
-      __discretization = ExplicitModelPtr(f);
-  }
-  else {
-      QuadSet * q = new QuadSet(_pointList, _index4List,
-                                true, true, // CCW
-                                _solid, _skeleton);
-      q->getTexCoordList() = _texCoordList;
-      q->getTexCoordIndexList() = _texIndex4List;
-      __discretization = ExplicitModelPtr(q);
-  }
+  __discretization = tubeMesh(_pointList, _slices, _solid, _height, _texCoordList);
 
   GEOM_DISCRETIZER_UPDATE_CACHE(frustum);
   return true;
@@ -1557,6 +1659,9 @@ bool Discretizer::process( NurbsCurve * nurbsCurve ) {
 
   real_t _start = nurbsCurve->getFirstKnot();
   uint_t _size = nurbsCurve->getStride();
+  if (isLodEnabled())
+    _size = lodResolution(_size,ctrlPointRadius(nurbsCurve->getCtrlPointList()->getExtent()),
+                          nurbsCurve->getCtrlPointList()->size());
   real_t _step =  (nurbsCurve->getLastKnot()-_start) / (real_t) _size;
   Point3ArrayPtr _pointList(new Point3Array(_size + 1));
 
@@ -1581,19 +1686,11 @@ bool Discretizer::process( NurbsPatch * nurbsPatch ) {
 
   uint_t _uStride = nurbsPatch->getUStride();
   uint_t _vStride = nurbsPatch->getVStride();
+  lodPatchStrides(nurbsPatch->getCtrlPointMatrix(),true,_uStride,_vStride);
 
   real_t _uStride1 = _uStride - real_t(1);
   real_t _vStride1 = _vStride - real_t(1);
 
-
-  Point3ArrayPtr _pointList(new Point3Array(_uStride * _vStride));
-  Index4ArrayPtr _indexList(new Index4Array( (_uStride - 1) * (_vStride - 1)));
-
-  uint_t _cur = 0;
-
-  uint_t _pointCount = 0;
-  uint_t _indexCount = 0;
-
   real_t _ufirst=nurbsPatch->getFirstUKnot();
   real_t _ulast=nurbsPatch->getLastUKnot();
   real_t _uinter=_ulast-_ufirst;
@@ -1602,33 +1699,33 @@ bool Discretizer::process( NurbsPatch * nurbsPatch ) {
   real_t _vlast=nurbsPatch->getLastVKnot();
   real_t _vinter=_vlast-_vfirst;
 
-  for ( real_t _u = 0 ; _u < _uStride1 - GEOM_EPSILON ; ++_u) {
-    for (real_t _v = 0; _v < _vStride1 - GEOM_EPSILON ; ++_v) {
-      _pointList->setAt(_pointCount++,
-                        nurbsPatch->getPointAt(_ufirst + (_u * _uinter) / _uStride1,
-                                               _vfirst + (_v * _vinter) / _vStride1));
+  RealArrayPtr _uValues(new RealArray(_uStride));
+  for (uint_t _u = 0 ; _u < _uStride - 1 ; ++_u)
+    _uValues->setAt(_u,_ufirst + (_u * _uinter) / _uStride1);
+  _uValues->setAt(_uStride - 1,_ulast);
+
+  RealArrayPtr _vValues(new RealArray(_vStride));
+  for (uint_t _v = 0 ; _v < _vStride - 1 ; ++_v)
+    _vValues->setAt(_v,_vfirst + (_v * _vinter) / _vStride1);
+  _vValues->setAt(_vStride - 1,_vlast);
+
+  // knot spans and basis functions are evaluated once per u and v value
+  Point3ArrayPtr _pointList = nurbsPatch->evaluateGrid(_uValues,_vValues);
+  Index4ArrayPtr _indexList(new Index4Array( (_uStride - 1) * (_vStride - 1)));
+
+  uint_t _cur = 0;
+  uint_t _indexCount = 0;
+
+  for (uint_t _u = 0 ; _u < _uStride - 1 ; ++_u) {
+    for (uint_t _v = 0; _v < _vStride - 1 ; ++_v) {
       _indexList->setAt(_indexCount++,
                         Index4(_cur,                _cur + 1,
                                _cur + _vStride + 1, _cur + _vStride));
-
       _cur++;
     };
-
-    _pointList->setAt(_pointCount++,
-                      nurbsPatch->getPointAt(_ufirst + (_u * _uinter) / _uStride1,_vlast));
      _cur++;
-
   };
 
-  for (real_t _v = 0; _v < _vStride1 - GEOM_EPSILON; ++_v ){
-    _pointList->setAt(_pointCount++,
-                       nurbsPatch->getPointAt(_ulast,
-                                               (_vfirst +
-                                                (_v * _vinter) / _vStride1)));
-  }
-
-  _pointList->setAt(_pointCount,nurbsPatch->getPointAt(_ulast,_vlast));
-
   PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
                                      Vector3(0,0,0)));
 
@@ -1662,8 +1759,8 @@ bool Discretizer::process( Paraboloid * paraboloid ) {
   const real_t& _height = paraboloid->getHeight();
   const real_t& _shape = paraboloid->getShape();
   bool _solid = paraboloid->getSolid();
-  uchar_t _slices = paraboloid->getSlices();
-  uchar_t _stacks = paraboloid->getStacks();
+  uchar_t _slices = lodResolution(paraboloid->getSlices(),_radius);
+  uchar_t _stacks = lodResolution(paraboloid->getStacks(),max(_radius,_height),2,GEOM_HALF_PI);
 
   uint_t _stacksBySlices = _stacks * _slices;
 
@@ -2016,117 +2113,126 @@ bool Discretizer::process( ScreenProjected * screenprojected) {
 /* ----------------------------------------------------------------------- */
 
 
-bool Discretizer::process( Sphere * sphere ) {
-  GEOM_ASSERT(sphere);
-
-  GEOM_DISCRETIZER_CHECK_CACHE_WITH_TEX(sphere);
-
-  const real_t& _radius = sphere->getRadius();
-  uchar_t _slices = sphere->getSlices();
-  uchar_t _stacks = sphere->getStacks();
-
-  uint_t _ringCount = _stacks - 1;    // number of rings of points
-  uint_t _bot = _slices * _ringCount; // index of the lower point
-  uint_t _top = _bot + 1;             // index of the upper point
-
-  Point3ArrayPtr _pointList = Point3ArrayPtr(new Point3Array(_top + 1));
-  // Point3ArrayPtr _normalList = Point3ArrayPtr(new Point3Array(_top + 1));
-  Index3ArrayPtr _indexList(new Index3Array(_slices * (2 * _ringCount)));
+/*
+  Topology of spheres: the stacks - 1 rings of points of each slice, followed by
+  the bottom and the top points.
+*/
+static Point3ArrayPtr buildUnitSpherePoints(uint_t _slices, uint_t _stacks, bool) {
+  uint_t _ringCount = _stacks - 1;
+  Point3ArrayPtr _pointList(new Point3Array(_slices * _ringCount + 2));
+  Point3Array::iterator _itPoint = _pointList->begin();
 
   real_t _azStep = GEOM_TWO_PI / _slices;
   real_t _elStep = GEOM_PI / _stacks;
 
-  uint_t _cur = 0;
-  uint_t _next = _ringCount;
-
-  uint_t _pointCount = 0;
-  uint_t _indexCount = 0;
-
   for (uint_t _i = 0; _i < _slices; ++_i) {
-
     real_t _az = _i * _azStep;
     real_t _el = - GEOM_HALF_PI + _elStep;
     real_t _cosAz = cos(_az);
     real_t _sinAz = sin(_az);
-    real_t _cosEl = cos(_el);
-    real_t _x = _cosAz * _cosEl ;
-    real_t _y = _sinAz * _cosEl ;
-    real_t _z = sin(_el) ;
-
-    _pointList->setAt(_pointCount++,Vector3(_x,_y,_z)* _radius);
+    for (uint_t _j = 0; _j < _ringCount; ++_j, ++_itPoint) {
+      if (_j > 0) _el += _elStep;
+      real_t _cosEl = cos(_el);
+      *_itPoint = Vector3(_cosAz * _cosEl, _sinAz * _cosEl, sin(_el));
+    }
+  }
+  *_itPoint = Vector3(0,0,-1); ++_itPoint;
+  *_itPoint = Vector3(0,0,1);
+  return _pointList;
+}
 
-    _indexList->setAt(_indexCount++,
-                      Index3(_cur,_bot,_next));
-    _indexList->setAt(_indexCount++,
-                      Index3(_cur + _ringCount - 1,_next + _ringCount - 1,_top));
+static Index3ArrayPtr buildSphereIndices(uint_t _slices, uint_t _stacks, bool) {
+  uint_t _ringCount = _stacks - 1;
+  uint_t _bot = _slices * _ringCount;
+  uint_t _top = _bot + 1;
+  Index3ArrayPtr _indexList(new Index3Array(_slices * (2 * _ringCount)));
+  Index3Array::iterator _itIndex = _indexList->begin();
 
+  uint_t _cur = 0;
+  uint_t _next = _ringCount;
+  for (uint_t _i = 0; _i < _slices; ++_i) {
+    *_itIndex = Index3(_cur,_bot,_next); ++_itIndex;
+    *_itIndex = Index3(_cur + _ringCount - 1,_next + _ringCount - 1,_top); ++_itIndex;
     for (uint_t _j = 1; _j < _ringCount; ++_j) {
-      _el += _elStep;
-      _cosEl = cos(_el);
-      _x = _cosAz * _cosEl ;
-      _y = _sinAz * _cosEl ;
-      _z = sin(_el) ;
+      *_itIndex = Index3(_cur + _j, _cur + _j - 1, _next + _j - 1); ++_itIndex;
+      *_itIndex = Index3(_cur + _j, _next + _j - 1, _next + _j); ++_itIndex;
+    }
+    _cur = _next;
+    _next = (_next + _ringCount ) % (_ringCount * _slices);
+  }
+  return _indexList;
+}
 
-      _pointList->setAt(_pointCount++,Vector3(_x,_y,_z)* _radius);
+static Point2ArrayPtr buildSphereTexCoords(uint_t _slices, uint_t _stacks, bool) {
+  uint_t _slices1 = _slices+1;
+  Point2ArrayPtr _texList(new Point2Array(_slices1 * (_stacks +1)));
+  uint_t _pointCount = 0;
+  for(uint_t _i = 0; _i < _slices1 ; ++_i){
+      real_t _s = (real_t)_i/(real_t)_slices;
+      for (uint_t _j = 1; _j < _stacks; ++_j) {
+          _texList->setAt(_pointCount++, Vector2(_s,(real_t)_j/(real_t)(_stacks+1)));
+      }
+  }
+  for(uint_t _i = 0; _i < _slices1 ; ++_i){
+      _texList->setAt(_pointCount++, Vector2((real_t)_i/(real_t)_slices,0));
+  }
+  for(uint_t _i = 0; _i < _slices1 ; ++_i){
+      _texList->setAt(_pointCount++, Vector2((real_t)_i/(real_t)_slices,1));
+  }
+  return _texList;
+}
 
-      _indexList->setAt(_indexCount++,
-                        Index3(_cur + _j, _cur + _j - 1, _next + _j - 1));
-      _indexList->setAt(_indexCount++,
-                          Index3(_cur + _j, _next + _j - 1, _next + _j));
-    };
+static Index3ArrayPtr buildSphereTexIndices(uint_t _slices, uint_t _stacks, bool) {
+  uint_t _ringCount = _stacks - 1;
+  uint_t _bot = (_slices+1) * _ringCount;
+  uint_t _top = _bot + _slices + 1;
+  Index3ArrayPtr _texIndexList(new Index3Array(_slices * (2 * _ringCount)));
+  Index3Array::iterator _itIndex = _texIndexList->begin();
+  uint_t _cur = 0;
+  uint_t _next = _ringCount;
+  for(uint_t _i = 0; _i < _slices ; ++_i){
+      *_itIndex = Index3(_cur,_bot+_i,_next); ++_itIndex;
+      *_itIndex = Index3(_cur + _ringCount - 1,_next + _ringCount - 1,_top+_i); ++_itIndex;
+      for (uint_t _j = 1; _j < _ringCount; ++_j) {
+          *_itIndex = Index3(_cur + _j, _cur + _j - 1, _next + _j - 1); ++_itIndex;
+          *_itIndex = Index3(_cur + _j, _next + _j - 1, _next + _j); ++_itIndex;
+      }
+      _cur = _next;
+      _next = _next + _ringCount ;
+  }
+  return _texIndexList;
+}
 
-    _cur = _next;
-    _next = (_next + _ringCount ) % (_ringCount * _slices);
-  };
-  _pointList->setAt(_pointCount++,Vector3(0,0,-_radius));
-  _pointList->setAt(_pointCount++,Vector3(0,0,_radius));
+bool Discretizer::process( Sphere * sphere ) {
+  GEOM_ASSERT(sphere);
 
-  GEOM_ASSERT(_pointCount == _pointList->size());
-  GEOM_ASSERT(_indexCount == _indexList->size());
+  GEOM_DISCRETIZER_CHECK_CACHE_WITH_TEX(sphere);
 
+  const real_t& _radius = sphere->getRadius();
+  uchar_t _slices = lodResolution(sphere->getSlices(),_radius);
+  uchar_t _stacks = lodResolution(sphere->getStacks(),_radius,2,GEOM_PI);
+
+  // points of the unit sphere scaled by the radius
+  Point3ArrayPtr _unitSphere = getTessellationTable(SPHERE_POINTS,_slices,_stacks,false,&buildUnitSpherePoints);
+  Point3ArrayPtr _pointList(new Point3Array(_unitSphere->size()));
+  Point3Array::const_iterator _itUnit = _unitSphere->begin();
+  for (Point3Array::iterator _itPoint = _pointList->begin(); _itPoint != _pointList->end(); ++_itPoint, ++_itUnit)
+    *_itPoint = *_itUnit * _radius;
+
+  Index3ArrayPtr _indexList = getTessellationTable(SPHERE_INDEX,_slices,_stacks,false,&buildSphereIndices);
+
+  uint_t _bot = _pointList->size() - 2;
+  uint_t _top = _bot + 1;
   PolylinePtr _skeleton(new Polyline(Vector3(_pointList->getAt(_bot)),
                                      Vector3(_pointList->getAt(_top))));
 
   TriangleSet * t = new TriangleSet(_pointList, _indexList, Point3ArrayPtr(),
                                     Index3ArrayPtr() , Color4ArrayPtr(), Index3ArrayPtr(),
-                                    /*_texList, _texIndexList,*/
                                     Point2ArrayPtr(),Index3ArrayPtr(), true, true,true,true,_skeleton);
 
   if(__computeTexCoord){
-      uchar_t _slices1 = _slices+1;
-      Point2ArrayPtr _texList(new Point2Array(_slices1 * (_stacks +1)));
-      _pointCount = 0;
-      for(uint_t _i = 0; _i < _slices1 ; ++_i){
-          real_t _s = (real_t)_i/(real_t)_slices;
-          for (uint_t _j = 1; _j < _stacks; ++_j) {
-              _texList->setAt(_pointCount++, Vector2(_s,(real_t)_j/(real_t)(_stacks+1)));
-          }
-      }
-      _bot = _pointCount;
-      for(uint_t _i = 0; _i < _slices1 ; ++_i){
-          _texList->setAt(_pointCount++, Vector2((real_t)_i/(real_t)_slices,0));
-      }
-      _top = _pointCount;
-      for(uint_t _i = 0; _i < _slices1 ; ++_i){
-          _texList->setAt(_pointCount++, Vector2((real_t)_i/(real_t)_slices,1));
-      }
-      t->getTexCoordList() = _texList;
-
-      Index3ArrayPtr _texIndexList(new Index3Array(_slices * (2 * _ringCount)));
-      _indexCount = 0;
-      _cur = 0;
-      _next = _ringCount;
-      for(uint_t _i = 0; _i < _slices ; ++_i){
-          _texIndexList->setAt(_indexCount++, Index3(_cur,_bot+_i,_next));
-          _texIndexList->setAt(_indexCount++,  Index3(_cur + _ringCount - 1,_next + _ringCount - 1,_top+_i));
-          for (uint_t _j = 1; _j < _ringCount; ++_j) {
-              _texIndexList->setAt(_indexCount++,Index3(_cur + _j, _cur + _j - 1, _next + _j - 1));
-              _texIndexList->setAt(_indexCount++,Index3(_cur + _j, _next + _j - 1, _next + _j));
-          }
-          _cur = _next;
-          _next = _next + _ringCount ;
-      }
-      t->getTexCoordIndexList() = _texIndexList;
+      t->getTexCoordList() = getTessellationTable(SPHERE_TEXCOORD,_slices,_stacks,false,&buildSphereTexCoords);
+      t->getTexCoordIndexList() = getTessellationTable(SPHERE_TEXINDEX,_slices,_stacks,false,&buildSphereTexIndices);
   }
 
   __discretization = ExplicitModelPtr(t);
@@ -2174,6 +2280,9 @@ bool Discretizer::process( BezierCurve2D * bezierCurve ) {
 
   real_t _start = 0;
   uint_t _size = bezierCurve->getStride();
+  if (isLodEnabled())
+    _size = lodResolution(_size,ctrlPointRadius(bezierCurve->getCtrlPointList()->getExtent()),
+                          bezierCurve->getCtrlPointList()->size());
   real_t _step = 1.0 / (real_t)_size;
   Point3ArrayPtr _pointList(new Point3Array(_size + 1));
 
@@ -2191,53 +2300,47 @@ bool Discretizer::process( BezierCurve2D * bezierCurve ) {
 
 /* ----------------------------------------------------------------------- */
 
+static Index3ArrayPtr buildDiscIndices(uint_t _slices, uint_t, bool) {
+  Index3ArrayPtr _indexList(new Index3Array(_slices));
+  Index3Array::iterator _itIndex = _indexList->begin();
+  uint_t _cen = _slices;
+  for (uint_t _cur = 0; _cur < _slices; _cur++, ++_itIndex)
+    *_itIndex = Index3(_cur,(_cur + 1) % _slices,_cen);
+  return _indexList;
+}
+
+static Point2ArrayPtr buildDiscTexCoords(uint_t _slices, uint_t, bool) {
+  CircleTable _circle;
+  fillCircleTable(_circle,_slices);
+  Point2ArrayPtr _texList(new Point2Array(_slices + 1));
+  Point2Array::iterator _itTex = _texList->begin();
+  for (uint_t _i = 0; _i < _slices; _i++, ++_itTex)
+    *_itTex = Vector2((_circle.cosa[_i]/2) + 0.5,(_circle.sina[_i]/2)+0.5);
+  *_itTex = Vector2(0.5,0.5);
+  return _texList;
+}
+
 bool Discretizer::process( Disc * disc ) {
   GEOM_ASSERT(disc);
 
   GEOM_DISCRETIZER_CHECK_CACHE_WITH_TEX(disc);
 
   real_t _radius = disc->getRadius();
-  uint_t _slices = disc->getSlices();
+  uint_t _slices = lodResolution(disc->getSlices(),_radius);
 
+  const CircleTable& _circle = getCircleTable(_slices);
   Point3ArrayPtr _pointList(new Point3Array(_slices + 1));
-  Point2ArrayPtr _texList;
-  if(__computeTexCoord){
-      _texList = Point2ArrayPtr(new Point2Array(_slices + 1));
-  }
-  Index3ArrayPtr _indexList(new Index3Array(_slices));
-
-  uint_t _cen = _slices;
-  uint_t _cur = 0;
-  uint_t _next = 1;
-
-  uint_t _pointsCount = 0;
-  uint_t _facesCount = 0;
-  real_t _angleStep = GEOM_TWO_PI / _slices;
-
-  for (uint_t _i = 0; _i < _slices; _i++) {
-
-    real_t _c = cos(_i * _angleStep);
-    real_t _s = sin(_i * _angleStep);
-    real_t _x = _c * _radius;
-    real_t _y = _s * _radius;
-
-    if(__computeTexCoord)
-        _texList->setAt(_pointsCount,Vector2((_c/2) + 0.5,(_s/2)+0.5));
-    _pointList->setAt(_pointsCount++,Vector3(_x,_y,0));
-    _indexList->setAt(_facesCount++,Index3(_cur,_next,_cen));
-
-    _cur = _next;
-    _next = (_next + 1) % _slices;
-  }
-  if(__computeTexCoord)
-      _texList->setAt(_pointsCount,Vector2(0.5,0.5));
+  Point3Array::iterator _itPoint = _pointList->begin();
+  for (uint_t _i = 0; _i < _slices; _i++, ++_itPoint)
+    *_itPoint = Vector3(_circle.cosa[_i] * _radius,_circle.sina[_i] * _radius,0);
 
   PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
                                      Vector3(0,0,0)));
 
-  TriangleSet * t = new TriangleSet(_pointList, _indexList, true, true,  false, _skeleton);
+  TriangleSet * t = new TriangleSet(_pointList, getTessellationTable(DISC_INDEX,_slices,0,false,&buildDiscIndices),
+                                    true, true,  false, _skeleton);
   if(__computeTexCoord)
-        t->getTexCoordList() = _texList;
+        t->getTexCoordList() = getTessellationTable(DISC_TEXCOORD,_slices,0,false,&buildDiscTexCoords);
 
   __discretization = ExplicitModelPtr(t);
 
@@ -2256,6 +2359,9 @@ bool Discretizer::process( NurbsCurve2D * nurbsCurve ) {
 
   real_t _start = nurbsCurve->getFirstKnot();
   uint_t _size = nurbsCurve->getStride();
+  if (isLodEnabled())
+    _size = lodResolution(_size,ctrlPointRadius(nurbsCurve->getCtrlPointList()->getExtent()),
+                          nurbsCurve->getCtrlPointList()->size());
   real_t _step =  (nurbsCurve->getLastKnot()-_start) / (real_t) _size;
   Point3ArrayPtr _pointList(new Point3Array(_size + 1));
 
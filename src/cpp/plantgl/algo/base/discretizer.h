@@ -53,6 +53,7 @@
 #include "../algo_config.h"
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/tool/util_cache.h>
+#include <plantgl/math/util_math.h>
 #include <plantgl/scenegraph/core/action.h>
 #include <plantgl/scenegraph/geometry/explicitmodel.h>
 
@@ -66,6 +67,9 @@ PGL_BEGIN_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
 
+class Point4Matrix;
+typedef RCPtr<Point4Matrix> Point4MatrixPtr;
+
 #ifdef GEOM_FWDEF
 class Point2Array;
 typedef RCPtr<Point2Array> Point2ArrayPtr;
@@ -226,20 +230,79 @@ public:
 
   Point2ArrayPtr gridTexCoord(Point3ArrayPtr pts, int gw, int gh) const;
 
+  /** Removes the tables shared by all the discretizers to tessellate primitives
+      (circles, unit spheres and index lists for each resolution). They are rebuilt when needed.
+      It must not be called while a discretization is computed in another thread. */
+  static void clearTessellationTables();
+
+  /** Returns \e model or, when it shares index or texture lists with the tessellation tables,
+      a copy of it with its own lists that can be modified without changing the other discretizations. */
+  static ExplicitModelPtr detachTessellationTables(const ExplicitModelPtr& model);
+
+  /// @name Level of detail
+  //@{
+  /** Sets the length in pixels of a unit of the scene once projected on the screen.
+      If strictly positive, the resolution (slices, stacks and strides) of the primitives
+      is reduced so that their tessellation does not deviate from them by more than
+      the tolerance in pixels. The scale is rounded up to a power of sqrt(2) so that the
+      discretizations of a level can be cached. A scale of 0 (default) disables it. */
+  void setLodScale(real_t pixelsPerUnit);
+
+  /// Returns the length in pixels of a unit of the scene used for the level of detail.
+  inline real_t getLodScale( ) const { return __lodScale; }
+
+  /// Returns whether the level of detail is enabled.
+  inline bool isLodEnabled( ) const { return __lodScale > 0; }
+
+  /// Sets the maximal distance in pixels between a primitive and its tessellation (0.5 by default).
+  void setLodTolerance(real_t pixels);
+
+  /// Returns the maximal distance in pixels between a primitive and its tessellation.
+  inline real_t getLodTolerance( ) const { return __lodTolerance; }
+
+  /** Returns the number of segments, between \e minimum and \e resolution, needed to tessellate
+      an arc of circle of radius \e radius and of angle \e angle with the current level of detail.
+      Returns \e resolution if the level of detail is disabled. */
+  uint_t lodResolution(uint_t resolution, real_t radius,
+                       uint_t minimum = 3, real_t angle = GEOM_TWO_PI) const;
+  //@}
+
 protected:
   template <class T> bool check_cache(T * geom);
   template <class T> bool check_cache_with_tex(T * geom);
   template <class T> void update_cache(T * geom);
   template <class T> bool transformed(T * geom);
 
+  /** Reduces \e ustride and \e vstride according to the level of detail for a patch of control points
+      \e ctrlPoints, stored along u in the rows of the matrix if \e urows is true. */
+  void lodPatchStrides(const Point4MatrixPtr& ctrlPoints, bool urows, uint_t& ustride, uint_t& vstride) const;
+
+  /// Returns the key of \e geom in the cache, which depends on the level of detail.
+  inline uint64_t cacheKey(const SceneObject * geom) const {
+    if (__lodScale > 0) return uint64_t(geom->getObjectId()) ^ (uint64_t(__lodLevel + 1024) << 48);
+    return geom->getObjectId();
+  }
+
+  /// The cache of discretized geometries, with keys of 64 bits to store the level of detail.
+  typedef Cache<ExplicitModelPtr, uint64_t> DiscretizationCache;
+
   /// The cache storing the already discretized geometries.
-  Cache<ExplicitModelPtr> __cache;
+  DiscretizationCache __cache;
 
   /// The last computed discretized geometry.
   ExplicitModelPtr __discretization;
 
   bool __computeTexCoord;
 
+  /// The length in pixels of a unit of the scene (0 if the level of detail is disabled).
+  real_t __lodScale;
+
+  /// The level of the scale (2 levels per power of 2).
+  int __lodLevel;
+
+  /// The maximal distance in pixels between a primitive and its tessellation.
+  real_t __lodTolerance;
+
 };
 
 
@@ -42,14 +42,192 @@
 #include "merge.h"
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/scenegraph/container/colorarray.h>
+#include <plantgl/tool/util_parallel.h>
+#include <cmath>
 
 PGL_USING_NAMESPACE
 
+static const uint_t NO_VERTEX = uint_t(-1);
+
+/////////////////////////////////////////////////////////////////////////////
+MeshWelder::MeshWelder( real_t tolerance, real_t attributeTolerance ) :
+    __tolerance(tolerance),
+    __attributeTolerance(attributeTolerance)
+/////////////////////////////////////////////////////////////////////////////
+{
+}
+
+void MeshWelder::setTolerance( real_t tolerance )
+{
+  __tolerance = tolerance;
+  clear();
+}
+
+void MeshWelder::setVertexArrays( const Point3ArrayPtr& points,
+                                  const Point3ArrayPtr& normals,
+                                  const Point2ArrayPtr& texCoords,
+                                  const Color4ArrayPtr& colors )
+{
+  __points = points;
+  __normals = normals;
+  __texCoords = texCoords;
+  __colors = colors;
+  clear();
+}
+
+void MeshWelder::clear( )
+{
+  __cells.clear();
+  __next.clear();
+}
+
+bool MeshWelder::similar( uint_t i, uint_t j ) const
+{
+  if (normSquared(__points->getAt(i) - __points->getAt(j)) > __tolerance * __tolerance) return false;
+  if (__normals && norm(__normals->getAt(i) - __normals->getAt(j)) > __attributeTolerance) return false;
+  if (__texCoords && norm(__texCoords->getAt(i) - __texCoords->getAt(j)) > __attributeTolerance) return false;
+  if (__colors && __colors->getAt(i) != __colors->getAt(j)) return false;
+  return true;
+}
+
+void MeshWelder::add( uint_t i )
+{
+  GEOM_ASSERT(__tolerance > 0);
+  const Vector3& _p = __points->getAt(i);
+  size_t _key = cellKey(int64_t(std::floor(_p.x() / __tolerance)),
+                        int64_t(std::floor(_p.y() / __tolerance)),
+                        int64_t(std::floor(_p.z() / __tolerance)));
+  if (__next.size() <= i) __next.resize(i + 1, NO_VERTEX);
+  pgl_hash_map<size_t,uint_t>::iterator _cell = __cells.find(_key);
+  if (_cell == __cells.end()) __cells[_key] = i;
+  else {
+    __next[i] = _cell->second;
+    _cell->second = i;
+  }
+}
+
+uint_t MeshWelder::insert( uint_t i )
+{
+  const Vector3& _p = __points->getAt(i);
+  int64_t _cx = int64_t(std::floor(_p.x() / __tolerance));
+  int64_t _cy = int64_t(std::floor(_p.y() / __tolerance));
+  int64_t _cz = int64_t(std::floor(_p.z() / __tolerance));
+  // similar vertices are in the neighbouring cells. Cells of different
+  // coordinates may share a key: the vertices are compared anyway.
+  uint_t _found = NO_VERTEX;
+  for (int64_t _dx = -1; _dx <= 1; ++_dx)
+    for (int64_t _dy = -1; _dy <= 1; ++_dy)
+      for (int64_t _dz = -1; _dz <= 1; ++_dz) {
+        pgl_hash_map<size_t,uint_t>::const_iterator _cell = __cells.find(cellKey(_cx+_dx,_cy+_dy,_cz+_dz));
+        if (_cell == __cells.end()) continue;
+        for (uint_t _j = _cell->second; _j != NO_VERTEX; _j = __next[_j])
+          // the first registered vertex is kept to make the result independent of the hashing
+          if (_j < _found && similar(i,_j)) _found = _j;
+      }
+  if (_found != NO_VERTEX) return _found;
+  add(i);
+  return i;
+}
+
+template<class T>
+static void pop_back(RCPtr<T>& array)
+{ if (array) array->erase(array->end() - 1); }
+
+template<class IndexArrayPtrType>
+static IndexArrayPtrType remapIndices( const IndexArrayPtrType& indices, const std::vector<uint_t>& remap )
+{
+  IndexArrayPtrType _result(new typename IndexArrayPtrType::element_type(*indices));
+  for (typename IndexArrayPtrType::element_type::iterator _it = _result->begin(); _it != _result->end(); ++_it)
+    for (typename IndexArrayPtrType::element_type::element_type::iterator _it2 = _it->begin(); _it2 != _it->end(); ++_it2)
+      *_it2 = remap[*_it2];
+  return _result;
+}
+
+template<class MeshType>
+static ExplicitModelPtr weldMesh( const MeshType& mesh, MeshWelder& welder, std::vector<uint_t>& remap )
+{
+  // attributes are welded with the points if they are given per vertex
+  bool _normals = mesh.hasNormalList() && mesh.getNormalPerVertex() && !mesh.getNormalIndexList();
+  bool _texCoords = mesh.hasTexCoordList() && !mesh.getTexCoordIndexList();
+  bool _colors = mesh.hasColorList() && mesh.getColorPerVertex() && !mesh.getColorIndexList();
+
+  const Point3ArrayPtr& _srcPoints = mesh.getPointList();
+  uint_t _nbPoints = _srcPoints->size();
+  Point3ArrayPtr _points(new Point3Array());
+  _points->reserve(_nbPoints);
+  Point3ArrayPtr _normalList(_normals ? new Point3Array() : NULL);
+  Point2ArrayPtr _texCoordList(_texCoords ? new Point2Array() : NULL);
+  Color4ArrayPtr _colorList(_colors ? new Color4Array() : NULL);
+  welder.setVertexArrays(_points, _normalList, _texCoordList, _colorList);
+
+  remap.resize(_nbPoints);
+  for (uint_t _i = 0; _i < _nbPoints; ++_i) {
+    uint_t _last = _points->size();
+    _points->push_back(_srcPoints->getAt(_i));
+    if (_normals) _normalList->push_back(mesh.getNormalList()->getAt(_i));
+    if (_texCoords) _texCoordList->push_back(mesh.getTexCoordList()->getAt(_i));
+    if (_colors) _colorList->push_back(mesh.getColorList()->getAt(_i));
+    uint_t _j = welder.insert(_last);
+    if (_j != _last) {
+      pop_back(_points); pop_back(_normalList); pop_back(_texCoordList); pop_back(_colorList);
+    }
+    remap[_i] = _j;
+  }
+
+  MeshType * _result = new MeshType(mesh);
+  _result->getPointList() = _points;
+  _result->getIndexList() = remapIndices(mesh.getIndexList(), remap);
+  if (_normals) _result->getNormalList() = _normalList;
+  if (_texCoords) _result->getTexCoordList() = _texCoordList;
+  if (_colors) _result->getColorList() = _colorList;
+  return ExplicitModelPtr(_result);
+}
+
+ExplicitModelPtr MeshWelder::weld( const ExplicitModelPtr& mesh, std::vector<uint_t> * remap ) const
+{
+  std::vector<uint_t> _remap;
+  MeshWelder _welder(__tolerance, __attributeTolerance);
+  ExplicitModelPtr _result = mesh;
+  if (mesh && __tolerance > 0) {
+    switch (Merge::getType(mesh)) {
+      case Merge::TRIANGLE_SET:
+        _result = weldMesh(*dynamic_pointer_cast<TriangleSet>(mesh), _welder, _remap); break;
+      case Merge::QUAD_SET:
+        _result = weldMesh(*dynamic_pointer_cast<QuadSet>(mesh), _welder, _remap); break;
+      case Merge::FACE_SET:
+        _result = weldMesh(*dynamic_pointer_cast<FaceSet>(mesh), _welder, _remap); break;
+      default:
+        break;
+    }
+  }
+  if (remap) {
+    if (_result == mesh) {
+      // unchanged model
+      _remap.resize(mesh ? mesh->getPointListSize() : 0);
+      for (uint_t _i = 0; _i < _remap.size(); ++_i) _remap[_i] = _i;
+    }
+    remap->swap(_remap);
+  }
+  return _result;
+}
+
+std::vector<ExplicitModelPtr> MeshWelder::weld( const std::vector<ExplicitModelPtr>& meshes ) const
+{
+  std::vector<ExplicitModelPtr> _result(meshes.size());
+  pgl_parallel_for(0, meshes.size(), [this, &meshes, &_result](size_t i){
+    _result[i] = weld(meshes[i]);
+  });
+  return _result;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 Merge::Merge( Discretizer& discretizer,
               ExplicitModelPtr& model ) :
     __model(model),
     __discretizer(discretizer),
+    __welder(),
+    __weldTolerance(0),
     __isoModel(false)
 /////////////////////////////////////////////////////////////////////////////
 {
@@ -79,32 +257,93 @@ bool Merge::init()
   if( __type == OTHER )
     return false;
 
-  if (!__model->unique()){
-      // duplication of index List fields to avoid
-      // modification of others objects
-      if( __type == TRIANGLE_SET )
-      {
-          TriangleSetPtr m = dynamic_pointer_cast<TriangleSet>(__model);
+  // duplication of index List fields to avoid
+  // modification of others objects. Index lists
+  // of discretized primitives are shared between meshes.
+  if( __type == TRIANGLE_SET )
+  {
+      TriangleSetPtr m = dynamic_pointer_cast<TriangleSet>(__model);
+      if (!__model->unique() || !m->getIndexList()->unique()){
           Index3ArrayPtr index(new Index3Array(*(m->getIndexList())));
           m->getIndexList()= index;
       }
-      else
-          if( __type == QUAD_SET )
-          {
-              QuadSetPtr m = dynamic_pointer_cast<QuadSet>(__model);
+  }
+  else
+      if( __type == QUAD_SET )
+      {
+          QuadSetPtr m = dynamic_pointer_cast<QuadSet>(__model);
+          if (!__model->unique() || !m->getIndexList()->unique()){
               Index4ArrayPtr index(new Index4Array(*(m->getIndexList())));
               m->getIndexList()= index;
           }
-          else
+      }
+      else
+          if( __type == FACE_SET )
           {
               FaceSetPtr m = dynamic_pointer_cast<FaceSet>(__model);
-              IndexArrayPtr index(new IndexArray(*(m->getIndexList())));
-              m->getIndexList()= index;
+              if (!__model->unique() || !m->getIndexList()->unique()){
+                  IndexArrayPtr index(new IndexArray(*(m->getIndexList())));
+                  m->getIndexList()= index;
+              }
           }
-  }
+
+  // the vertices of the model are registered in the welder when needed
+  __welder.setVertexArrays(Point3ArrayPtr());
   return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+void Merge::setWeldTolerance( real_t tolerance )
+/////////////////////////////////////////////////////////////////////////////
+{
+  __weldTolerance = tolerance;
+  __welder.setTolerance(tolerance);
+  __welder.setVertexArrays(Point3ArrayPtr());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void Merge::appendVertices( Mesh& geom, std::vector<uint_t>& remap )
+/////////////////////////////////////////////////////////////////////////////
+{
+  MeshPtr model = dynamic_pointer_cast<Mesh>(__model);
+  Point3ArrayPtr& points= model->getPointList();
+  Point3ArrayPtr pts= geom.getPointList();
+  uint_t size = points->size();
+
+  checkNormals(geom);
+  Point3ArrayPtr& normals= model->getNormalList();
+  Point3ArrayPtr n= geom.getNormalList();
+  bool vnormals = n && model->getNormalPerVertex();
+
+  remap.resize(pts->size());
+  if ( __weldTolerance <= 0 ) {
+    points->insert( points->end(),pts->begin(),pts->end());
+    if(n)normals->insert( normals->end(),n->begin(),n->end());
+    for ( uint_t i = 0; i < pts->size(); ++i ) remap[i] = size + i;
+    return;
+  }
+
+  if ( !vnormals && n ) normals->insert( normals->end(),n->begin(),n->end());
+
+  // vertices are welded with their normals if they are given per vertex
+  Point3ArrayPtr weldnormals = vnormals ? normals : Point3ArrayPtr();
+  if ( __welder.getPoints() != points || __welder.getNormals() != weldnormals ) {
+    __welder.setVertexArrays(points, weldnormals);
+    for ( uint_t i = 0; i < size; ++i ) __welder.add(i);
+  }
+  for ( uint_t i = 0; i < pts->size(); ++i ) {
+    uint_t last = points->size();
+    points->push_back(pts->getAt(i));
+    if (vnormals) normals->push_back(n->getAt(i));
+    uint_t j = __welder.insert(last);
+    if (j != last) {
+      points->erase(points->end() - 1);
+      if (vnormals) normals->erase(normals->end() - 1);
+    }
+    remap[i] = j;
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 Merge::MODEL_TYPE Merge::getType( const ExplicitModelPtr& model )
 /////////////////////////////////////////////////////////////////////////////
@@ -286,20 +525,11 @@ if( __type != QUAD_SET ){
     else return false;
 }
 
-  Point3ArrayPtr& points= __model->getPointList();
-  Point3ArrayPtr pts= geom.getPointList();
-  uint_t size = points->size();
-
-  points->insert( points->end(),pts->begin(),pts->end());
-
   QuadSetPtr model = dynamic_pointer_cast<QuadSet>(__model);
   GEOM_ASSERT(model);
 
-  checkNormals(geom);
-  Point3ArrayPtr& normals= model->getNormalList();
-  Point3ArrayPtr n= geom.getNormalList();
-
-  if(n)normals->insert( normals->end(),n->begin(),n->end());
+  std::vector<uint_t> remap;
+  appendVertices(geom, remap);
 
   Index4ArrayPtr& index= model->getIndexList();
   Index4ArrayPtr index1= geom.getIndexList();
@@ -312,18 +542,18 @@ if( __type != QUAD_SET ){
     {
     for( _it= index1->begin(); _it != index1->end(); _it++ )
       {
-      index->push_back( Index4( _it->getAt(0)+size,
-                               _it->getAt(1)+size,
-                               _it->getAt(2)+size,
-                               _it->getAt(3)+size ) );
+      index->push_back( Index4( remap[_it->getAt(0)],
+                               remap[_it->getAt(1)],
+                               remap[_it->getAt(2)],
+                               remap[_it->getAt(3)] ) );
       }
     }
   else
     for( _it= index1->begin(); _it != index1->end(); _it++ )
-      index->push_back( Index4( _it->getAt(3)+size,
-                               _it->getAt(2)+size,
-                               _it->getAt(1)+size,
-                               _it->getAt(0)+size ) );
+      index->push_back( Index4( remap[_it->getAt(3)],
+                               remap[_it->getAt(2)],
+                               remap[_it->getAt(1)],
+                               remap[_it->getAt(0)] ) );
 
   return true;
 }
@@ -343,20 +573,11 @@ GEOM_TRACE("apply TriangleSet");
     else return false;
   }
 
-  Point3ArrayPtr& points= __model->getPointList();
-  Point3ArrayPtr pts= geom.getPointList();
-  uint_t size = points->size();
-
-  points->insert( points->end(),pts->begin(),pts->end());
-
   TriangleSetPtr model = dynamic_pointer_cast<TriangleSet>(__model);
   GEOM_ASSERT(model);
 
-  checkNormals(geom);
-  Point3ArrayPtr& normals= model->getNormalList();
-  Point3ArrayPtr n= geom.getNormalList();
-
-  if(n)normals->insert( normals->end(),n->begin(),n->end());
+  std::vector<uint_t> remap;
+  appendVertices(geom, remap);
 
   Index3ArrayPtr& index= model->getIndexList();
   Index3ArrayPtr index1= geom.getIndexList();
@@ -367,14 +588,14 @@ GEOM_TRACE("apply TriangleSet");
   Index3Array::const_iterator _it;
   if( ccw == ccw1 )
     for( _it= index1->begin(); _it != index1->end(); _it++ )
-      index->push_back( Index3( _it->getAt(0)+size,
-                               _it->getAt(1)+size,
-                               _it->getAt(2)+size ) );
+      index->push_back( Index3( remap[_it->getAt(0)],
+                               remap[_it->getAt(1)],
+                               remap[_it->getAt(2)] ) );
   else
     for( _it= index1->begin(); _it != index1->end(); _it++ )
-      index->push_back( Index3( _it->getAt(3)+size,
-                               _it->getAt(2)+size,
-                               _it->getAt(1)+size ) );
+      index->push_back( Index3( remap[_it->getAt(2)],
+                               remap[_it->getAt(1)],
+                               remap[_it->getAt(0)] ) );
   return true;
 }
 
@@ -393,19 +614,11 @@ bool Merge::apply( FaceSet& geom )
     else return false;
   }
 
-  Point3ArrayPtr& points= __model->getPointList();
-  Point3ArrayPtr pts= geom.getPointList();
-  uint_t size = points->size();
-
-  points->insert( points->end(),pts->begin(),pts->end());
-
   FaceSetPtr model = dynamic_pointer_cast<FaceSet>(__model);
   GEOM_ASSERT(model);
 
-  checkNormals(geom);
-  Point3ArrayPtr& normals= model->getNormalList();
-  Point3ArrayPtr n= geom.getNormalList();
-  if(n)normals->insert( normals->end(),n->begin(),n->end());
+  std::vector<uint_t> remap;
+  appendVertices(geom, remap);
 
   IndexArrayPtr& index= model->getIndexList();
   IndexArrayPtr index1= geom.getIndexList();
@@ -424,7 +637,7 @@ bool Merge::apply( FaceSet& geom )
     for( _it2=_it->begin();
          _it2 != _it->end();
          _it2++, ( ccw == ccw1 ) ? idi++ : idi--)
-       _new.setAt(idi,*_it2+size);
+       _new.setAt(idi,remap[*_it2]);
     index->push_back(_new);
     }
 
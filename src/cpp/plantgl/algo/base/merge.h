@@ -52,6 +52,8 @@
 #include <plantgl/scenegraph/geometry/quadset.h>
 #include <plantgl/scenegraph/geometry/polyline.h>
 #include <plantgl/scenegraph/geometry/pointset.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <vector>
 
 
 /* ----------------------------------------------------------------------- */
@@ -60,6 +62,86 @@ PGL_BEGIN_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
 
+/**
+   \class MeshWelder
+   \brief Welds the vertices of meshes closer than a tolerance.
+          Vertices are hashed on a grid of cells of the size of the tolerance,
+          so that each vertex is only compared to the vertices of the 27 neighbouring cells.
+          Normals, texture coordinates and colors given per vertex must also be closer
+          than the attribute tolerance for the vertices to be welded.
+*/
+
+class ALGO_API MeshWelder
+{
+public:
+
+    /// Constructor.
+    MeshWelder( real_t tolerance = GEOM_EPSILON, real_t attributeTolerance = GEOM_TOLERANCE );
+
+    /// Destructor.
+    virtual ~MeshWelder( ) {}
+
+    inline real_t getTolerance( ) const { return __tolerance; }
+    void setTolerance( real_t tolerance );
+
+    inline real_t getAttributeTolerance( ) const { return __attributeTolerance; }
+    inline void setAttributeTolerance( real_t tolerance ) { __attributeTolerance = tolerance; }
+
+    /** Sets the arrays of the vertices to weld and removes the registered vertices.
+        Attributes arrays can be null. */
+    void setVertexArrays( const Point3ArrayPtr& points,
+                          const Point3ArrayPtr& normals = Point3ArrayPtr(),
+                          const Point2ArrayPtr& texCoords = Point2ArrayPtr(),
+                          const Color4ArrayPtr& colors = Color4ArrayPtr() );
+
+    inline const Point3ArrayPtr& getPoints( ) const { return __points; }
+    inline const Point3ArrayPtr& getNormals( ) const { return __normals; }
+
+    /// Removes the registered vertices.
+    void clear( );
+
+    /// Registers the vertex \e i of the arrays without looking for a similar vertex.
+    void add( uint_t i );
+
+    /** Returns the index of a registered vertex similar to the vertex \e i of the arrays.
+        If there is none, \e i is registered and returned. */
+    uint_t insert( uint_t i );
+
+    /** Returns a copy of \e mesh in which similar vertices are merged.
+        If given, \e remap is filled with the new index of each vertex of \e mesh.
+        Models which are not TriangleSet, QuadSet or FaceSet are returned unchanged. */
+    ExplicitModelPtr weld( const ExplicitModelPtr& mesh, std::vector<uint_t> * remap = NULL ) const;
+
+    /// Welds in parallel each model of \e meshes.
+    std::vector<ExplicitModelPtr> weld( const std::vector<ExplicitModelPtr>& meshes ) const;
+
+protected:
+
+    /// Returns whether the vertices \e i and \e j are similar.
+    bool similar( uint_t i, uint_t j ) const;
+
+    /// Returns the key of the cell (x,y,z) in the hash map.
+    static inline size_t cellKey( int64_t x, int64_t y, int64_t z )
+    { return (size_t(x) * 73856093u) ^ (size_t(y) * 19349663u) ^ (size_t(z) * 83492791u); }
+
+    real_t __tolerance;
+
+    real_t __attributeTolerance;
+
+    Point3ArrayPtr __points;
+    Point3ArrayPtr __normals;
+    Point2ArrayPtr __texCoords;
+    Color4ArrayPtr __colors;
+
+    /// The first registered vertex of each cell.
+    pgl_hash_map<size_t,uint_t> __cells;
+
+    /// The next registered vertex of the cell of each vertex.
+    std::vector<uint_t> __next;
+};
+
+/* ----------------------------------------------------------------------- */
+
 /**
    \class Merge
    \brief A class of algorithm which merge two Explicit Model.
@@ -153,6 +235,13 @@ public:
 
     virtual void checkNormals(Mesh& geom);
 
+    /** Sets the distance below which the vertices of the merged meshes are welded
+        to the vertices of the model. A tolerance of 0 (default) disables welding. */
+    void setWeldTolerance( real_t tolerance );
+
+    /// Returns the distance below which the vertices are welded.
+    inline real_t getWeldTolerance( ) const { return __weldTolerance; }
+
 protected:
 
     /// The model to merge.
@@ -164,6 +253,16 @@ protected:
     /// The discretizer used to store the discretize parametric while
     Discretizer& __discretizer;
 
+    /** Appends the vertices of \e geom to the model, welding them if enabled.
+        \e remap is filled with the index in the model of each vertex of \e geom. */
+    void appendVertices( Mesh& geom, std::vector<uint_t>& remap );
+
+    /// Welds the vertices of the merged meshes.
+    MeshWelder __welder;
+
+    /// The distance below which vertices are welded.
+    real_t __weldTolerance;
+
 private:
 
     bool init();
@@ -1652,6 +1652,34 @@ PGL(pointset_covariance)(const Point3ArrayPtr points, const Index &group) {
   return result;
 }
 
+Matrix3
+PGL(pointset_centered_covariance)(const Point3ArrayPtr points, const Index &group) {
+  Matrix3 result(0, 0, 0, 0, 0, 0, 0, 0, 0);
+  size_t nbpoints = (group.empty() ? points->size() : group.size());
+  if (nbpoints == 0) return result;
+  Vector3 center;
+  if (group.empty()) center = points->getCenter();
+  else {
+    for (Index::const_iterator it = group.begin(); it != group.end(); ++it)
+      center += points->getAt(*it);
+    center /= nbpoints;
+  }
+  for (size_t i = 0; i < nbpoints; ++i) {
+    Vector3 v = points->getAt(group.empty() ? i : group[i]) - center;
+    result(0, 0) += v.x() * v.x();
+    result(0, 1) += v.x() * v.y();
+    result(0, 2) += v.x() * v.z();
+    result(1, 1) += v.y() * v.y();
+    result(1, 2) += v.y() * v.z();
+    result(2, 2) += v.z() * v.z();
+  }
+  result(1, 0) = result(0, 1);
+  result(2, 0) = result(0, 2);
+  result(2, 1) = result(1, 2);
+  result /= nbpoints;
+  return result;
+}
+
 
 real_t
 PGL(density_from_k_neighborhood)(uint32_t pid,
@@ -3559,15 +3587,8 @@ PGL(pointset_angulardirections)(const Point3ArrayPtr points, const Vector3 &orig
 }
 
 Point3ArrayPtr PGL(pointsets_orientations)(const Point3ArrayPtr points, const IndexArrayPtr groups) {
-  size_t nbPoints = points->size();
-  Point3ArrayPtr result(new Point3Array(nbPoints));
-
-  ProgressStatus st(nbPoints, "orientations computed for %.2f%% of points.");
-  IndexArray::const_iterator itNbrhd = groups->begin();
-  for (Point3Array::iterator itRes = result->begin(); itRes != result->end(); ++itRes, ++itNbrhd, ++st)
-    *itRes = pointset_orientation(points, *itNbrhd);
-
-  return result;
+  // the line fitting the points is along the eigen vector of the largest eigen value.
+  return pointsets_principal_axes(points, groups, 2, "orientations computed for %.2f%% of points.");
 }
 
 std::pair<uint32_t, real_t>
@@ -140,11 +140,18 @@ PGL_BEGIN_NAMESPACE
 // typedef std::vector<std::vector<uint32_t> > AdjacencyMap;
 
 /// K-Neighborhood computation
+/** Delaunay connections of the points. If \e parallel is true and CGAL is linked with TBB,
+    the triangulation is built in parallel. */
   ALGO_API IndexArrayPtr
-  delaunay_point_connection(const Point3ArrayPtr points);
+  delaunay_point_connection(const Point3ArrayPtr points, bool parallel = false);
+
+/** Delaunay connections of the points in a flat layout (offsets, neighbors):
+    the neighbors of point i are neighbors[offsets[i]] to neighbors[offsets[i+1]-1]. */
+  ALGO_API std::pair<Index, Index>
+  delaunay_point_connection_flat(const Point3ArrayPtr points, bool parallel = true);
 
   ALGO_API Index3ArrayPtr
-  delaunay_triangulation(const Point3ArrayPtr points);
+  delaunay_triangulation(const Point3ArrayPtr points, bool parallel = false);
 
   ALGO_API IndexArrayPtr
   k_closest_points_from_delaunay(const Point3ArrayPtr points, size_t k);
@@ -276,6 +283,9 @@ PGL_BEGIN_NAMESPACE
 
   ALGO_API Matrix3 pointset_covariance(const Point3ArrayPtr points, const Index &group = Index());
 
+  /// Covariance of the points of \e group (all points if empty) around their centroid.
+  ALGO_API Matrix3 pointset_centered_covariance(const Point3ArrayPtr points, const Index &group = Index());
+
 
   ALGO_API Index
   get_sorted_element_order(const RealArrayPtr distances);
@@ -317,18 +327,29 @@ PGL_BEGIN_NAMESPACE
   ALGO_API std::pair<Vector3, Vector3>
   pointset_plane(const Point3ArrayPtr points, const Index &group);
 
+  /// Direction of the line fitting the points of \e group (all points if empty).
   ALGO_API Vector3
   pointset_orientation(const Point3ArrayPtr points, const Index &group);
 
+  /// pointset_orientation of each group, computed in parallel with pointsets_principal_axes.
   ALGO_API Point3ArrayPtr
   pointsets_orientations(const Point3ArrayPtr points, const IndexArrayPtr groups);
 
+  /// Normal of the plane fitting the points of \e group (all points if empty).
   ALGO_API Vector3
   pointset_normal(const Point3ArrayPtr points, const Index &group);
 
+  /// pointset_normal of each group, computed in parallel with pointsets_principal_axes.
   ALGO_API Point3ArrayPtr
   pointsets_normals(const Point3ArrayPtr points, const IndexArrayPtr groups);
 
+  /** Eigen vector of rank \e axis (0 for the smallest eigen value) of the centered covariance of each group.
+      Empty groups stand for all the points, as for pointset_centered_covariance.
+      Covariances and their eigen decompositions are computed in parallel. */
+  ALGO_API Point3ArrayPtr
+  pointsets_principal_axes(const Point3ArrayPtr points, const IndexArrayPtr groups, uint32_t axis,
+                           const std::string& progressmessage = "principal axes computed for %.2f%% of groups.");
+
 
   ALGO_API Point3ArrayPtr
   pointsets_orient_normals(const Point3ArrayPtr normals, const Point3ArrayPtr points, const IndexArrayPtr riemanian);
@@ -42,18 +42,16 @@
 
 #include "pointmanipulation.h"
 #include <plantgl/scenegraph/container/indexarray_iterator.h>
+#include <plantgl/algo/fitting/eigenvector.h>
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/util_progress.h>
 
 PGL_USING_NAMESPACE
 
 
 #ifdef PGL_WITH_CGAL
 
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Triangulation_vertex_base_with_info_3.h>
-#include <CGAL/Delaunay_triangulation_3.h>
-// #include <CGAL/Triangulation_3.h>
-
-#include "cgalwrap.h"
+#include "cgaldelaunay.h"
 
 # ifdef PGL_WITH_EIGEN
 #   define CGAL_AND_SVD_SOLVER_ENABLED
@@ -79,38 +77,49 @@ PGL_USING_NAMESPACE
 
 #endif
 
-IndexArrayPtr
-PGL::delaunay_point_connection(const Point3ArrayPtr points) {
 #ifdef PGL_WITH_CGAL
 
-  typedef CGAL::Exact_predicates_inexact_constructions_kernel TK;
-  typedef CGAL::Triangulation_vertex_base_with_info_3<uint32_t, TK> TVb;
-  typedef CGAL::Triangulation_data_structure_3<TVb> Tds;
-
-  typedef CGAL::Delaunay_triangulation_3<TK, Tds> Triangulation;
-  // typedef CGAL::Triangulation_3<K,Tds>      Triangulation;
-
-
-  typedef Triangulation::Cell_handle TCell_handle;
-  typedef Triangulation::Vertex_handle TVertex_handle;
-  typedef Triangulation::Locate_type TLocate_type;
-  typedef Triangulation::Point TPoint;
-  typedef Triangulation::Segment TSegment;
-
-  Triangulation triangulation;
-  uint32_t pointCount = 0;
-  for (Point3Array::const_iterator it = points->begin(); it != points->end(); ++it)
-    triangulation.insert(toPoint3<TPoint>(*it))->info() = pointCount++;
-
+/** Fills \e offsets and \e neighbors with the connections of the vertices of \e triangulation.
+    Edges are visited twice so that the neighbors are written directly at their final place. */
+template<class Triangulation>
+static void delaunay_flat_connections(const Triangulation& triangulation, size_t nbpoints,
+                                      Index& offsets, Index& neighbors)
+{
+  offsets = Index(nbpoints + 1, 0);
+  for (typename Triangulation::Finite_edges_iterator it = triangulation.finite_edges_begin();
+       it != triangulation.finite_edges_end(); ++it) {
+    ++offsets[it->first->vertex(it->second)->info() + 1];
+    ++offsets[it->first->vertex(it->third)->info() + 1];
+  }
+  for (size_t i = 0; i < nbpoints; ++i) offsets[i + 1] += offsets[i];
 
-  IndexArrayPtr result(new IndexArray(points->size(), Index()));
-  for (Triangulation::Finite_edges_iterator it = triangulation.finite_edges_begin();
+  neighbors = Index(offsets[nbpoints]);
+  Index next(offsets.begin(), offsets.end() - 1);
+  for (typename Triangulation::Finite_edges_iterator it = triangulation.finite_edges_begin();
        it != triangulation.finite_edges_end(); ++it) {
     uint32_t source = it->first->vertex(it->second)->info();
     uint32_t target = it->first->vertex(it->third)->info();
-    result->getAt(source).push_back(target);
-    result->getAt(target).push_back(source);
+    neighbors[next[source]++] = target;
+    neighbors[next[target]++] = source;
   }
+}
+
+#endif
+
+IndexArrayPtr
+PGL::delaunay_point_connection(const Point3ArrayPtr points, bool parallel) {
+#ifdef PGL_WITH_CGAL
+  IndexArrayPtr result(new IndexArray(points->size(), Index()));
+  with_delaunay_triangulation3(points, parallel, [&result](const auto& triangulation) {
+    typedef typename std::decay<decltype(triangulation)>::type Triangulation;
+    for (typename Triangulation::Finite_edges_iterator it = triangulation.finite_edges_begin();
+         it != triangulation.finite_edges_end(); ++it) {
+      uint32_t source = it->first->vertex(it->second)->info();
+      uint32_t target = it->first->vertex(it->third)->info();
+      result->getAt(source).push_back(target);
+      result->getAt(target).push_back(source);
+    }
+  });
 #else
 #ifdef _MSC_VER
 #pragma message("function 'delaunay_point_connection' disabled. CGAL needed.")
@@ -123,48 +132,48 @@ PGL::delaunay_point_connection(const Point3ArrayPtr points) {
   return result;
 }
 
-Index3ArrayPtr
-PGL::delaunay_triangulation(const Point3ArrayPtr points) {
+std::pair<Index, Index>
+PGL::delaunay_point_connection_flat(const Point3ArrayPtr points, bool parallel) {
+  std::pair<Index, Index> result;
 #ifdef PGL_WITH_CGAL
+  with_delaunay_triangulation3(points, parallel, [&result, &points](const auto& triangulation) {
+    delaunay_flat_connections(triangulation, points->size(), result.first, result.second);
+  });
+#else
+#ifdef _MSC_VER
+#pragma message("function 'delaunay_point_connection_flat' disabled. CGAL needed.")
+#else
+#warning "function 'delaunay_point_connection_flat' disabled. CGAL needed"
+#endif
+#endif
+  return result;
+}
 
-  typedef CGAL::Exact_predicates_inexact_constructions_kernel TK;
-  typedef CGAL::Triangulation_vertex_base_with_info_3<uint32_t, TK> TVb;
-  typedef CGAL::Triangulation_data_structure_3<TVb> Tds;
-
-  typedef CGAL::Delaunay_triangulation_3<TK, Tds> Triangulation;
-  // typedef CGAL::Triangulation_3<K,Tds>      Triangulation;
-
-
-  typedef Triangulation::Cell_handle TCell_handle;
-  typedef Triangulation::Vertex_handle TVertex_handle;
-  typedef Triangulation::Locate_type TLocate_type;
-  typedef Triangulation::Point TPoint;
-  typedef Triangulation::Segment TSegment;
-
-  Triangulation triangulation;
-  uint32_t pointCount = 0;
-  for (Point3Array::const_iterator it = points->begin(); it != points->end(); ++it)
-    triangulation.insert(toPoint3<TPoint>(*it))->info() = pointCount++;
-
-
+Index3ArrayPtr
+PGL::delaunay_triangulation(const Point3ArrayPtr points, bool parallel) {
+#ifdef PGL_WITH_CGAL
   Index3ArrayPtr result(new Index3Array());
-  for (Triangulation::Finite_facets_iterator it = triangulation.finite_facets_begin();
-       it != triangulation.finite_facets_end(); ++it) {
-    Index3 ind;
-    int j = 0;
-    for (int i = 0; i < 4; ++i) {
-      if (i != it->second) {
-        ind[j] = it->first->vertex(i)->info();
-        ++j;
+  with_delaunay_triangulation3(points, parallel, [&result](const auto& triangulation) {
+    typedef typename std::decay<decltype(triangulation)>::type Triangulation;
+    result->reserve(triangulation.number_of_finite_facets());
+    for (typename Triangulation::Finite_facets_iterator it = triangulation.finite_facets_begin();
+         it != triangulation.finite_facets_end(); ++it) {
+      Index3 ind;
+      int j = 0;
+      for (int i = 0; i < 4; ++i) {
+        if (i != it->second) {
+          ind[j] = it->first->vertex(i)->info();
+          ++j;
+        }
       }
+      result->push_back(ind);
     }
-    result->push_back(ind);
-  }
+  });
 #else
 #ifdef _MSC_VER
-#pragma message("function 'delaunay_point_connection' disabled. CGAL needed.")
+#pragma message("function 'delaunay_triangulation' disabled. CGAL needed.")
 #else
-#warning "function 'delaunay_point_connection' disabled. CGAL needed"
+#warning "function 'delaunay_triangulation' disabled. CGAL needed"
 #endif
 
   Index3ArrayPtr result;
@@ -172,7 +181,6 @@ PGL::delaunay_triangulation(const Point3ArrayPtr points) {
   return result;
 }
 
-
 #ifdef PGL_WITH_CGAL
 
 #include <CGAL/linear_least_squares_fitting_3.h>
@@ -227,13 +235,10 @@ Vector3 PGL::pointset_orientation(const Point3ArrayPtr points, const Index &grou
 
   return toVector3(line.to_vector());
 #else
-#ifdef _MSC_VER
-#pragma message("function 'pointset_orientation' disabled. CGAL needed.")
-#else
-#warning "function 'pointset_orientation' disabled. CGAL needed"
-#endif
-
-  return Vector3(0,0,0);
+  Vector3 values;
+  Matrix3 vectors;
+  symmetricEigenDecomposition(pointset_centered_covariance(points, group), values, vectors);
+  return vectors.getColumn(2);
 #endif
 }
 
@@ -337,35 +342,60 @@ Vector3 PGL::pointset_normal(const Point3ArrayPtr points, const Index &group) {
   typedef CK::Plane_3 CPlane;
 
   std::list<CPoint> pointdata;
-  // for (Point3Array::const_iterator it = points->begin(); it != points->end() ; ++it)
-  for (Index::const_iterator it = group.begin(); it != group.end(); ++it)
-    pointdata.push_back(toPoint3<CPoint>(points->getAt(*it)));
+  if (!group.empty())
+    pointdata = toPoint3List<CPoint>(points, group);
+  else
+    pointdata = toPoint3List<CPoint>(points);
 
   CPlane plane;
   linear_least_squares_fitting_3(pointdata.begin(), pointdata.end(), plane, CGAL::Dimension_tag<0>());
 
   return dir2Vector3(plane.orthogonal_direction());
 #else
-#ifdef _MSC_VER
-#pragma message("function 'pointset_normal' disabled. CGAL needed.")
-#else
-#warning "function 'pointset_normal' disabled. CGAL needed"
-#endif
-
-  return Vector3(0,0,0);
+  Vector3 values;
+  Matrix3 vectors;
+  symmetricEigenDecomposition(pointset_centered_covariance(points, group), values, vectors);
+  return vectors.getColumn(0);
 #endif
 }
 
 Point3ArrayPtr
 PGL::pointsets_normals(const Point3ArrayPtr points, const IndexArrayPtr groups) {
-  Point3ArrayPtr result(new Point3Array(points->size()));
-  uint32_t i = 0;
-  for (IndexArray::const_iterator it = groups->begin(); it != groups->end(); ++it, ++i) {
-    result->setAt(i, pointset_normal(points, *it));
+  // the normal of the plane fitting the points is the eigen vector of the smallest eigen value.
+  return pointsets_principal_axes(points, groups, 0, "normals computed for %.2f%% of points.");
+}
+
+// groups are processed by chunks so that progress can be reported between the parallel passes.
+#define PRINCIPAL_AXES_CHUNK 4096
+
+Point3ArrayPtr
+PGL::pointsets_principal_axes(const Point3ArrayPtr points, const IndexArrayPtr groups, uint32_t axis,
+                              const std::string& progressmessage) {
+  size_t nbgroups = groups->size();
+  Point3ArrayPtr result(new Point3Array(nbgroups));
+  ProgressStatus st(nbgroups, progressmessage);
+
+  std::vector<Matrix3> covariances;
+  std::vector<Vector3> values;
+  std::vector<Matrix3> vectors;
+  for (size_t begin = 0; begin < nbgroups; begin += PRINCIPAL_AXES_CHUNK) {
+    size_t end = std::min<size_t>(begin + PRINCIPAL_AXES_CHUNK, nbgroups);
+    covariances.resize(end - begin);
+    pgl_parallel_for(begin, end, [&](size_t i) {
+      covariances[i - begin] = pointset_centered_covariance(points, groups->getAt(i));
+    }, 0, 256);
+
+    symmetricEigenDecomposition(covariances, values, vectors);
+
+    for (size_t i = begin; i < end; ++i)
+      result->setAt(i, vectors[i - begin].getColumn(axis));
+    st.increment(end - begin);
   }
   return result;
 }
 
+#undef PRINCIPAL_AXES_CHUNK
+
 
 real_t mean_over(const Point3ArrayPtr points, const Index &section, int i) {
   real_t v = 0;
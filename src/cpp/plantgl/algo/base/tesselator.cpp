@@ -71,7 +71,7 @@ using namespace std;
 
 #define GEOM_TESSELATOR_CHECK_CACHE(geom) \
 if(!geom->unique()){ \
-  Cache<ExplicitModelPtr>::Iterator _it = __cache.find(geom->getObjectId()); \
+  DiscretizationCache::Iterator _it = __cache.find(cacheKey(geom)); \
   if (! (_it == __cache.end())) { \
     __discretization = _it->second; \
     return true; \
@@ -81,7 +81,7 @@ if(!geom->unique()){ \
 #define GEOM_TESSELATOR_UPDATE_CACHE(geom) \
 if(!geom->unique()){ \
   if(geom->isNamed())__discretization->setName(geom->getName()); \
-  __cache.insert(geom->getObjectId(),__discretization); \
+  __cache.insert(cacheKey(geom),__discretization); \
 }
 
 
@@ -186,11 +186,12 @@ bool Tesselator::process( BezierPatch * bezierPatch ) {
 
   GEOM_TESSELATOR_CHECK_CACHE(bezierPatch);
 
-  const uint_t _uStride = bezierPatch->getUStride();
-  const uint_t _vStride = bezierPatch->getVStride();
+  uint_t _uStride = bezierPatch->getUStride();
+  uint_t _vStride = bezierPatch->getVStride();
+  lodPatchStrides(bezierPatch->getCtrlPointMatrix(),false,_uStride,_vStride);
 
-  const real_t _uStride1 = bezierPatch->getUStride() - 1;
-  const real_t _vStride1 = bezierPatch->getVStride() - 1;
+  const real_t _uStride1 = _uStride - real_t(1);
+  const real_t _vStride1 = _vStride - real_t(1);
 
   Point3ArrayPtr _pointList(new Point3Array(_uStride * _vStride));
   Index3ArrayPtr _indexList(new Index3Array(2 * (_uStride - 1) * (_vStride - 1)));
@@ -256,7 +257,7 @@ bool Tesselator::process( Cylinder * cylinder ) {
   real_t _radius = cylinder->getRadius();
   real_t _height = cylinder->getHeight();
   bool _solid = cylinder->getSolid();
-  uint_t _slices = cylinder->getSlices();
+  uint_t _slices = lodResolution(cylinder->getSlices(),_radius);
 
   uint_t _offset = (_solid ? 2 : 0);
 
@@ -448,7 +449,7 @@ bool Tesselator::process( Frustum * frustum ) {
   real_t _height = frustum->getHeight();
   real_t _taper = frustum->getTaper();
   bool _solid = frustum->getSolid();
-  uint_t _slices = frustum->getSlices();
+  uint_t _slices = lodResolution(frustum->getSlices(),_radius * max(real_t(1),_taper));
 
   uint_t _offset = (_solid ? 2 : 0);
 
@@ -616,11 +617,12 @@ bool Tesselator::process( NurbsPatch * nurbsPatch ) {
 
   GEOM_TESSELATOR_CHECK_CACHE(nurbsPatch);
 
-  const uint_t _uStride = nurbsPatch->getUStride();
-  const uint_t _vStride = nurbsPatch->getVStride();
+  uint_t _uStride = nurbsPatch->getUStride();
+  uint_t _vStride = nurbsPatch->getVStride();
+  lodPatchStrides(nurbsPatch->getCtrlPointMatrix(),true,_uStride,_vStride);
 
-  const real_t _uStride1 = nurbsPatch->getUStride() - 1;
-  const real_t _vStride1 = nurbsPatch->getVStride() - 1;
+  const real_t _uStride1 = _uStride - real_t(1);
+  const real_t _vStride1 = _vStride - real_t(1);
 
 
   Point3ArrayPtr _pointList(new Point3Array(_uStride * _vStride));
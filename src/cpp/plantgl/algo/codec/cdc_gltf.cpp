@@ -0,0 +1,610 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------- */
+
+#include "cdc_gltf.h"
+#include <plantgl/algo/base/tesselator.h>
+#include <plantgl/scenegraph/appearance/material.h>
+#include <plantgl/scenegraph/appearance/texture.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/geometry/group.h>
+#include <plantgl/scenegraph/transformation/mattransformed.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/dirnames.h>
+#include <plantgl/tool/errormsg.h>
+#include <plantgl/tool/util_string.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cmath>
+
+PGL_USING_NAMESPACE
+
+using namespace std;
+
+/* ----------------------------------------------------------------------- */
+
+#define GLTF_ARRAY_BUFFER 34962
+#define GLTF_ELEMENT_ARRAY_BUFFER 34963
+
+#define GLTF_BYTE 5120
+#define GLTF_UNSIGNED_BYTE 5121
+#define GLTF_UNSIGNED_SHORT 5123
+#define GLTF_UNSIGNED_INT 5125
+#define GLTF_FLOAT 5126
+
+#define GLTF_LINEAR 9729
+#define GLTF_LINEAR_MIPMAP_LINEAR 9987
+#define GLTF_REPEAT 10497
+#define GLTF_CLAMP_TO_EDGE 33071
+
+/* ----------------------------------------------------------------------- */
+
+namespace {
+
+/// Number written with enough digits to read back the same float.
+string gltfNumber(double value)
+{
+    ostringstream stream;
+    stream.precision(9);
+    stream << value;
+    return stream.str();
+}
+
+string gltfString(const string& value)
+{
+    string result = "\"";
+    for (string::const_iterator it = value.begin(); it != value.end(); ++it) {
+        if (*it == '"' || *it == '\\') { result += '\\'; result += *it; }
+        else if ((unsigned char)*it < 0x20) result += ' ';
+        else result += *it;
+    }
+    return result + "\"";
+}
+
+/// glTF colors are linear while PlantGL colors are sRGB.
+real_t linearComponent(uchar_t c)
+{
+    real_t v = c / 255.;
+    return v <= 0.04045 ? v / 12.92 : pow((v + 0.055) / 1.055, 2.4);
+}
+
+string linearColor(const Color3& c)
+{
+    return gltfNumber(linearComponent(c.getRed())) + "," + gltfNumber(linearComponent(c.getGreen())) + "," + gltfNumber(linearComponent(c.getBlue()));
+}
+
+string gltfMatrix(const Matrix4& m)
+{
+    string result = "[";
+    for (uchar_t j = 0; j < 4; ++j)
+        for (uchar_t i = 0; i < 4; ++i)
+            result += (i + j > 0 ? "," : "") + gltfNumber(m(i, j));
+    return result + "]";
+}
+
+/// Join \e items in a json array named \e name. Empty arrays are not written since glTF forbids them.
+string gltfArray(const string& name, const vector<string>& items)
+{
+    if (items.empty()) return "";
+    string result = ",\"" + name + "\":[";
+    for (vector<string>::const_iterator it = items.begin(); it != items.end(); ++it)
+        result += (it != items.begin() ? "," : "") + *it;
+    return result + "]";
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Build the json description and the binary buffer of a glb file.
+class GltfWriter {
+public:
+    GltfWriter(bool quantization) :
+        __quantization(quantization), __hasQuantizedMesh(false) {}
+
+    void addShape(const ShapePtr& shape);
+
+    bool write(const string& fname) const;
+
+protected:
+    /// A mesh written in the buffer and the matrix giving its coordinates from the stored ones.
+    struct MeshEntry {
+        int mesh;
+        Matrix4 dequantization;
+    };
+
+    void addGeometry(const GeometryPtr& geometry, const Matrix4& matrix, const ShapePtr& shape,
+                     uint_t material, const Texture2DTransformationPtr& texTransformation);
+
+    /// Write the triangles of \e triangles in the buffer. Return -1 if it is empty.
+    int addMesh(const TriangleSetPtr& triangles, uint_t material, const Texture2DTransformationPtr& texTransformation,
+                Matrix4& dequantization);
+
+    uint_t addMaterial(const AppearancePtr& appearance);
+
+    int addTexture(const Texture2DPtr& texture);
+
+    uint_t addBufferView(const void * data, size_t size, size_t stride = 0, int target = 0);
+
+    uint_t addAccessor(uint_t bufferView, int componentType, size_t count, const string& type,
+                       bool normalized = false, const string& bounds = "");
+
+    template<class T>
+    uint_t addAttribute(const vector<T>& data, size_t stride, int componentType, size_t count, const string& type,
+                        bool normalized = false, const string& bounds = "")
+    { return addAccessor(addBufferView(&data[0], data.size() * sizeof(T), stride, GLTF_ARRAY_BUFFER), componentType, count, type, normalized, bounds); }
+
+    bool __quantization;
+    bool __hasQuantizedMesh;
+
+    vector<char> __buffer;
+    vector<string> __bufferViews;
+    vector<string> __accessors;
+    vector<string> __meshes;
+    vector<string> __materials;
+    vector<string> __textures;
+    vector<string> __images;
+    vector<string> __samplers;
+    vector<string> __nodes;
+
+    /// Index of the materials from their description and from the id of the appearances.
+    map<string, uint_t> __materialIds;
+    pgl_hash_map<size_t, uint_t> __appearanceMaterials;
+
+    /// Index of the textures from their description and of the images from their file name.
+    map<string, int> __textureIds;
+    map<string, int> __samplerIds;
+    map<string, int> __imageIds;
+
+    /// Meshes already written identified by the id of their geometry, their material and texture transformation.
+    map<pair<size_t, pair<uint_t, size_t> >, MeshEntry> __meshIds;
+
+    Tesselator __tesselator;
+};
+
+/* ----------------------------------------------------------------------- */
+
+void GltfWriter::addShape(const ShapePtr& shape)
+{
+    if (is_null_ptr(shape->getGeometry())) return;
+    uint_t material = addMaterial(shape->getAppearance());
+    Texture2DTransformationPtr texTransformation;
+    Texture2DPtr texture = dynamic_pointer_cast<Texture2D>(shape->getAppearance());
+    if (is_valid_ptr(texture)) texTransformation = texture->getTransformation();
+    addGeometry(shape->getGeometry(), Matrix4::IDENTITY, shape, material, texTransformation);
+}
+
+void GltfWriter::addGeometry(const GeometryPtr& geometry, const Matrix4& matrix, const ShapePtr& shape,
+                             uint_t material, const Texture2DTransformationPtr& texTransformation)
+{
+    // Flatten the affine transformations in the matrix of the node, so that the geometry can be instanced.
+    MatrixTransformedPtr transformed = dynamic_pointer_cast<MatrixTransformed>(geometry);
+    if (is_valid_ptr(transformed)) {
+        Matrix4TransformationPtr transformation = dynamic_pointer_cast<Matrix4Transformation>(transformed->getTransformation());
+        if (is_valid_ptr(transformation)) {
+            addGeometry(transformed->getGeometry(), matrix * transformation->getMatrix(), shape, material, texTransformation);
+            return;
+        }
+    }
+    GroupPtr group = dynamic_pointer_cast<Group>(geometry);
+    if (is_valid_ptr(group)) {
+        for (uint_t i = 0; i < group->getGeometryListSize(); ++i)
+            addGeometry(group->getGeometryListAt(i), matrix, shape, material, texTransformation);
+        return;
+    }
+
+    pair<size_t, pair<uint_t, size_t> > key(geometry->getObjectId(),
+        pair<uint_t, size_t>(material, is_valid_ptr(texTransformation) ? texTransformation->getObjectId() : 0));
+    map<pair<size_t, pair<uint_t, size_t> >, MeshEntry>::const_iterator it = __meshIds.find(key);
+    if (it == __meshIds.end()) {
+        MeshEntry entry;
+        entry.mesh = -1;
+        if (geometry->apply(__tesselator)) {
+            TriangleSetPtr triangles = __tesselator.getTriangulation();
+            if (is_valid_ptr(triangles)) entry.mesh = addMesh(triangles, material, texTransformation, entry.dequantization);
+        }
+        it = __meshIds.insert(make_pair(key, entry)).first;
+    }
+    if (it->second.mesh < 0) return;
+
+    string node = "{";
+    if (shape->isNamed()) node += "\"name\":" + gltfString(shape->getName()) + ",";
+    node += "\"mesh\":" + number(it->second.mesh);
+    Matrix4 nodeMatrix = matrix * it->second.dequantization;
+    if (nodeMatrix != Matrix4::IDENTITY) node += ",\"matrix\":" + gltfMatrix(nodeMatrix);
+    node += ",\"extras\":{\"id\":" + number(shape->getId()) + "}}";
+    __nodes.push_back(node);
+}
+
+int GltfWriter::addMesh(const TriangleSetPtr& triangles, uint_t material, const Texture2DTransformationPtr& texTransformation,
+                        Matrix4& dequantization)
+{
+    dequantization = Matrix4::IDENTITY;
+    uint_t nbfaces = triangles->getIndexListSize();
+    if (nbfaces == 0) return -1;
+
+    bool hasTexCoords = triangles->hasTexCoordList();
+    bool hasColors = triangles->hasColorList();
+
+    // Normals per vertex are computed if missing. The geometry of the scene is not modified.
+    Point3ArrayPtr vertexNormals;
+    if (!triangles->hasNormalList()) vertexNormals = triangles->computeNormalPerVertex();
+
+    // glTF uses a single index for all the attributes. Vertices are duplicated per face when attributes have their own indices.
+    bool pointIndexed = (!triangles->hasNormalList() || (triangles->getNormalPerVertex() && is_null_ptr(triangles->getNormalIndexList()))) &&
+                        (!hasTexCoords || is_null_ptr(triangles->getTexCoordIndexList())) &&
+                        (!hasColors || (triangles->getColorPerVertex() && is_null_ptr(triangles->getColorIndexList())));
+
+    vector<Vector3> points, normals;
+    vector<Vector2> texCoords;
+    vector<Color4> colors;
+    vector<uint32_t> indices;
+    indices.reserve(3 * nbfaces);
+    bool ccw = triangles->getCCW();
+    if (pointIndexed) {
+        const Point3ArrayPtr& pointList = triangles->getPointList();
+        points.assign(pointList->begin(), pointList->end());
+        const Point3ArrayPtr& normalList = (is_valid_ptr(vertexNormals) ? vertexNormals : triangles->getNormalList());
+        normals.assign(normalList->begin(), normalList->end());
+        if (hasTexCoords) texCoords.assign(triangles->getTexCoordList()->begin(), triangles->getTexCoordList()->end());
+        if (hasColors) colors.assign(triangles->getColorList()->begin(), triangles->getColorList()->end());
+        for (uint_t i = 0; i < nbfaces; ++i) {
+            const Index3& face = triangles->getIndexListAt(i);
+            indices.push_back(face[0]);
+            indices.push_back(face[ccw ? 1 : 2]);
+            indices.push_back(face[ccw ? 2 : 1]);
+        }
+    }
+    else {
+        for (uint_t i = 0; i < nbfaces; ++i) {
+            for (uint_t j = 0; j < 3; ++j) {
+                uint_t c = (ccw || j == 0 ? j : 3 - j);
+                indices.push_back(points.size());
+                points.push_back(triangles->getFacePointAt(i, c));
+                if (is_valid_ptr(vertexNormals)) normals.push_back(vertexNormals->getAt(triangles->getFacePointIndexAt(i, c)));
+                else normals.push_back(triangles->getFaceNormalAt(i, c));
+                if (hasTexCoords) texCoords.push_back(triangles->getFaceTexCoordAt(i, c));
+                if (hasColors) colors.push_back(triangles->getFaceColorAt(i, c));
+            }
+        }
+    }
+    size_t nbvertices = points.size();
+
+    string attributes;
+
+    // Positions
+    Vector3 pmin = points[0], pmax = points[0];
+    for (vector<Vector3>::const_iterator it = points.begin(); it != points.end(); ++it) {
+        pmin = Min(pmin, *it);
+        pmax = Max(pmax, *it);
+    }
+    if (__quantization) {
+        // Unsigned short positions in the bounding box, with the same scale on all the axes to keep normals valid.
+        real_t extent = max(max(pmax.x() - pmin.x(), pmax.y() - pmin.y()), pmax.z() - pmin.z());
+        if (extent <= 0) extent = 1;
+        real_t scale = 65535 / extent;
+        vector<uint16_t> data(4 * nbvertices, 0);
+        uint16_t qmin[3] = { 65535, 65535, 65535 }, qmax[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < nbvertices; ++i)
+            for (int k = 0; k < 3; ++k) {
+                uint16_t q = uint16_t(min<real_t>(65535, floor((points[i][k] - pmin[k]) * scale + 0.5)));
+                data[4 * i + k] = q;
+                qmin[k] = min(qmin[k], q);
+                qmax[k] = max(qmax[k], q);
+            }
+        string bounds = "\"min\":[" + number(qmin[0]) + "," + number(qmin[1]) + "," + number(qmin[2]) + "],\"max\":[" +
+                        number(qmax[0]) + "," + number(qmax[1]) + "," + number(qmax[2]) + "]";
+        attributes += "\"POSITION\":" + number(addAttribute(data, 8, GLTF_UNSIGNED_SHORT, nbvertices, "VEC3", false, bounds));
+        dequantization = Matrix4::translation(pmin) * Matrix4(Matrix3::scaling(1 / scale));
+        __hasQuantizedMesh = true;
+    }
+    else {
+        vector<float> data(3 * nbvertices);
+        for (size_t i = 0; i < nbvertices; ++i)
+            for (int k = 0; k < 3; ++k) data[3 * i + k] = float(points[i][k]);
+        string bounds = "\"min\":[" + gltfNumber(float(pmin.x())) + "," + gltfNumber(float(pmin.y())) + "," + gltfNumber(float(pmin.z())) + "],\"max\":[" +
+                        gltfNumber(float(pmax.x())) + "," + gltfNumber(float(pmax.y())) + "," + gltfNumber(float(pmax.z())) + "]";
+        attributes += "\"POSITION\":" + number(addAttribute(data, 0, GLTF_FLOAT, nbvertices, "VEC3", false, bounds));
+    }
+
+    // Normals
+    for (vector<Vector3>::iterator it = normals.begin(); it != normals.end(); ++it) {
+        if (normSquared(*it) > GEOM_EPSILON) it->normalize();
+        else *it = Vector3::OZ;
+    }
+    if (__quantization) {
+        vector<int8_t> data(4 * nbvertices, 0);
+        for (size_t i = 0; i < nbvertices; ++i)
+            for (int k = 0; k < 3; ++k) data[4 * i + k] = int8_t(floor(normals[i][k] * 127 + 0.5));
+        attributes += ",\"NORMAL\":" + number(addAttribute(data, 4, GLTF_BYTE, nbvertices, "VEC3", true));
+    }
+    else {
+        vector<float> data(3 * nbvertices);
+        for (size_t i = 0; i < nbvertices; ++i)
+            for (int k = 0; k < 3; ++k) data[3 * i + k] = float(normals[i][k]);
+        attributes += ",\"NORMAL\":" + number(addAttribute(data, 0, GLTF_FLOAT, nbvertices, "VEC3"));
+    }
+
+    // Texture coordinates. The origin of the images is their top left corner in glTF.
+    if (hasTexCoords) {
+        bool inUnitSquare = true;
+        for (vector<Vector2>::iterator it = texCoords.begin(); it != texCoords.end(); ++it) {
+            if (is_valid_ptr(texTransformation)) *it = texTransformation->transform(*it);
+            it->y() = 1 - it->y();
+            if (it->x() < 0 || it->x() > 1 || it->y() < 0 || it->y() > 1) inUnitSquare = false;
+        }
+        if (__quantization && inUnitSquare) {
+            vector<uint16_t> data(2 * nbvertices);
+            for (size_t i = 0; i < nbvertices; ++i)
+                for (int k = 0; k < 2; ++k) data[2 * i + k] = uint16_t(floor(texCoords[i][k] * 65535 + 0.5));
+            attributes += ",\"TEXCOORD_0\":" + number(addAttribute(data, 0, GLTF_UNSIGNED_SHORT, nbvertices, "VEC2", true));
+        }
+        else {
+            vector<float> data(2 * nbvertices);
+            for (size_t i = 0; i < nbvertices; ++i)
+                for (int k = 0; k < 2; ++k) data[2 * i + k] = float(texCoords[i][k]);
+            attributes += ",\"TEXCOORD_0\":" + number(addAttribute(data, 0, GLTF_FLOAT, nbvertices, "VEC2"));
+        }
+    }
+
+    // Colors. Alpha of PlantGL colors is a transparency.
+    if (hasColors) {
+        vector<uchar_t> data(4 * nbvertices);
+        for (size_t i = 0; i < nbvertices; ++i) {
+            const Color4& c = colors[i];
+            data[4 * i] = uchar_t(floor(linearComponent(c.getRed()) * 255 + 0.5));
+            data[4 * i + 1] = uchar_t(floor(linearComponent(c.getGreen()) * 255 + 0.5));
+            data[4 * i + 2] = uchar_t(floor(linearComponent(c.getBlue()) * 255 + 0.5));
+            data[4 * i + 3] = 255 - c.getAlpha();
+        }
+        attributes += ",\"COLOR_0\":" + number(addAttribute(data, 0, GLTF_UNSIGNED_BYTE, nbvertices, "VEC4", true));
+    }
+
+    // Indices, with the smallest component type whose primitive restart value (255 or 65535) is not a vertex index.
+    uint_t indexAccessor;
+    if (nbvertices < 256) {
+        vector<uchar_t> data(indices.begin(), indices.end());
+        indexAccessor = addAccessor(addBufferView(&data[0], data.size() * sizeof(uchar_t), 0, GLTF_ELEMENT_ARRAY_BUFFER),
+                                    GLTF_UNSIGNED_BYTE, data.size(), "SCALAR");
+    }
+    else if (nbvertices < 65536) {
+        vector<uint16_t> data(indices.begin(), indices.end());
+        indexAccessor = addAccessor(addBufferView(&data[0], data.size() * sizeof(uint16_t), 0, GLTF_ELEMENT_ARRAY_BUFFER),
+                                    GLTF_UNSIGNED_SHORT, data.size(), "SCALAR");
+    }
+    else {
+        indexAccessor = addAccessor(addBufferView(&indices[0], indices.size() * sizeof(uint32_t), 0, GLTF_ELEMENT_ARRAY_BUFFER),
+                                    GLTF_UNSIGNED_INT, indices.size(), "SCALAR");
+    }
+
+    __meshes.push_back("{\"primitives\":[{\"attributes\":{" + attributes + "},\"indices\":" + number(indexAccessor) +
+                       ",\"material\":" + number(material) + ",\"mode\":4}]}");
+    return __meshes.size() - 1;
+}
+
+uint_t GltfWriter::addMaterial(const AppearancePtr& appearance)
+{
+    size_t appearanceId = (is_valid_ptr(appearance) ? appearance->getObjectId() : 0);
+    pgl_hash_map<size_t, uint_t>::const_iterator ita = __appearanceMaterials.find(appearanceId);
+    if (ita != __appearanceMaterials.end()) return ita->second;
+
+    string description;
+    Texture2DPtr texture = dynamic_pointer_cast<Texture2D>(appearance);
+    int textureId = (is_valid_ptr(texture) ? addTexture(texture) : -1);
+    if (textureId >= 0) {
+        description = "\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":" + number(textureId) + "},"
+                      "\"metallicFactor\":0,\"roughnessFactor\":1},\"alphaMode\":\"MASK\"";
+    }
+    else {
+        MaterialPtr material = dynamic_pointer_cast<Material>(appearance);
+        if (is_null_ptr(material)) {
+            if (is_valid_ptr(texture)) material = MaterialPtr(new Material(Color3(texture->getBaseColor())));
+            else material = dynamic_pointer_cast<Material>(Material::DEFAULT_MATERIAL);
+        }
+        real_t transparency = material->getTransparency();
+        description = "\"pbrMetallicRoughness\":{\"baseColorFactor\":[" + linearColor(material->getDiffuseColor()) + "," + gltfNumber(1 - transparency) + "],"
+                      "\"metallicFactor\":0,\"roughnessFactor\":" + gltfNumber(1 - material->getShininess()) + "}";
+        if (material->getEmission() != Color3::BLACK) description += ",\"emissiveFactor\":[" + linearColor(material->getEmission()) + "]";
+        if (transparency > 0) description += ",\"alphaMode\":\"BLEND\"";
+    }
+    // Leaves are seen from both sides.
+    description += ",\"doubleSided\":true";
+
+    uint_t result;
+    map<string, uint_t>::const_iterator itm = __materialIds.find(description);
+    if (itm != __materialIds.end()) result = itm->second;
+    else {
+        result = __materials.size();
+        __materials.push_back("{" + description + "}");
+        __materialIds[description] = result;
+    }
+    __appearanceMaterials[appearanceId] = result;
+    return result;
+}
+
+int GltfWriter::addTexture(const Texture2DPtr& texture)
+{
+    ImageTexturePtr imgdef = texture->getImage();
+    if (is_null_ptr(imgdef)) return -1;
+    const string& filename = imgdef->getFilename();
+
+    int image;
+    map<string, int>::const_iterator iti = __imageIds.find(filename);
+    if (iti != __imageIds.end()) image = iti->second;
+    else {
+        // Images are embedded as they are. glTF only supports png and jpeg images.
+        string suffix = toLower(get_suffix(filename));
+        string mimeType = (suffix == "png" ? "image/png" : (suffix == "jpg" || suffix == "jpeg" ? "image/jpeg" : ""));
+        ifstream stream(filename.c_str(), ios::binary);
+        vector<char> data;
+        if (stream) data.assign(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+        if (mimeType.empty() || data.empty()) {
+            pglWarning("glTF export : Cannot embed image '%s'. Only png and jpeg files are supported.", filename.c_str());
+            image = -1;
+        }
+        else {
+            image = __images.size();
+            __images.push_back("{\"bufferView\":" + number(addBufferView(&data[0], data.size())) + ",\"mimeType\":\"" + mimeType + "\"}");
+        }
+        __imageIds[filename] = image;
+    }
+    if (image < 0) return -1;
+
+    string sampler = "{\"magFilter\":" + number(GLTF_LINEAR) + ",\"minFilter\":" + number(imgdef->getMipmaping() ? GLTF_LINEAR_MIPMAP_LINEAR : GLTF_LINEAR) +
+                     ",\"wrapS\":" + number(imgdef->getRepeatS() ? GLTF_REPEAT : GLTF_CLAMP_TO_EDGE) +
+                     ",\"wrapT\":" + number(imgdef->getRepeatT() ? GLTF_REPEAT : GLTF_CLAMP_TO_EDGE) + "}";
+    map<string, int>::const_iterator its = __samplerIds.find(sampler);
+    if (its == __samplerIds.end()) {
+        its = __samplerIds.insert(make_pair(sampler, int(__samplers.size()))).first;
+        __samplers.push_back(sampler);
+    }
+
+    string description = "{\"sampler\":" + number(its->second) + ",\"source\":" + number(image) + "}";
+    map<string, int>::const_iterator itt = __textureIds.find(description);
+    if (itt == __textureIds.end()) {
+        itt = __textureIds.insert(make_pair(description, int(__textures.size()))).first;
+        __textures.push_back(description);
+    }
+    return itt->second;
+}
+
+uint_t GltfWriter::addBufferView(const void * data, size_t size, size_t stride, int target)
+{
+    // Data of the buffer views are aligned on 4 bytes.
+    while (__buffer.size() % 4 != 0) __buffer.push_back(0);
+    size_t offset = __buffer.size();
+    __buffer.insert(__buffer.end(), (const char *)data, (const char *)data + size);
+    string view = "{\"buffer\":0,\"byteOffset\":" + number(offset) + ",\"byteLength\":" + number(size);
+    if (stride > 0) view += ",\"byteStride\":" + number(stride);
+    if (target > 0) view += ",\"target\":" + number(target);
+    __bufferViews.push_back(view + "}");
+    return __bufferViews.size() - 1;
+}
+
+uint_t GltfWriter::addAccessor(uint_t bufferView, int componentType, size_t count, const string& type,
+                               bool normalized, const string& bounds)
+{
+    string accessor = "{\"bufferView\":" + number(bufferView) + ",\"componentType\":" + number(componentType) +
+                      ",\"count\":" + number(count) + ",\"type\":\"" + type + "\"";
+    if (normalized) accessor += ",\"normalized\":true";
+    if (!bounds.empty()) accessor += "," + bounds;
+    __accessors.push_back(accessor + "}");
+    return __accessors.size() - 1;
+}
+
+bool GltfWriter::write(const string& fname) const
+{
+    // A root node turns the z up axis of PlantGL into the y up axis of glTF.
+    string root = "{\"name\":\"root\",\"matrix\":[1,0,0,0,0,0,-1,0,0,1,0,0,0,0,0,1]";
+    if (!__nodes.empty()) {
+        root += ",\"children\":[";
+        for (size_t i = 1; i <= __nodes.size(); ++i) root += (i > 1 ? "," : "") + number(i);
+        root += "]";
+    }
+    root += "}";
+    vector<string> nodes(1, root);
+    nodes.insert(nodes.end(), __nodes.begin(), __nodes.end());
+
+    string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"PlantGL\"}";
+    if (__hasQuantizedMesh)
+        json += ",\"extensionsUsed\":[\"KHR_mesh_quantization\"],\"extensionsRequired\":[\"KHR_mesh_quantization\"]";
+    json += ",\"scene\":0,\"scenes\":[{\"nodes\":[0]}]";
+    json += gltfArray("nodes", nodes);
+    json += gltfArray("meshes", __meshes);
+    json += gltfArray("materials", __materials);
+    json += gltfArray("textures", __textures);
+    json += gltfArray("images", __images);
+    json += gltfArray("samplers", __samplers);
+    json += gltfArray("accessors", __accessors);
+    json += gltfArray("bufferViews", __bufferViews);
+    if (!__buffer.empty()) json += ",\"buffers\":[{\"byteLength\":" + number(__buffer.size()) + "}]";
+    json += "}";
+    while (json.size() % 4 != 0) json += ' ';
+
+    size_t binSize = __buffer.size();
+    while (binSize % 4 != 0) ++binSize;
+
+    ofstream stream(fname.c_str(), ios::binary);
+    if (!stream) return false;
+
+    // glb chunks are little endian.
+    uint32_t header[3] = { 0x46546C67, 2, uint32_t(12 + 8 + json.size() + (binSize > 0 ? 8 + binSize : 0)) };
+    stream.write((const char *)header, sizeof(header));
+    uint32_t jsonChunk[2] = { uint32_t(json.size()), 0x4E4F534A };
+    stream.write((const char *)jsonChunk, sizeof(jsonChunk));
+    stream.write(json.c_str(), json.size());
+    if (binSize > 0) {
+        uint32_t binChunk[2] = { uint32_t(binSize), 0x004E4942 };
+        stream.write((const char *)binChunk, sizeof(binChunk));
+        stream.write(&__buffer[0], __buffer.size());
+        for (size_t i = __buffer.size(); i < binSize; ++i) stream.put(0);
+    }
+    return bool(stream);
+}
+
+}
+
+/* ----------------------------------------------------------------------- */
+
+GltfCodec::GltfCodec(bool quantization) :
+    SceneCodec(quantization ? "GLTF_QUANTIZED" : "GLTF", Write ),
+    __quantization(quantization)
+    {}
+
+SceneFormatList GltfCodec::formats() const
+{
+    SceneFormat _format;
+    _format.name = getName();
+    _format.suffixes.push_back("glb");
+    _format.comment = (__quantization ? "The binary glTF 2.0 format with quantized meshes." : "The binary glTF 2.0 format.");
+    SceneFormatList _formats;
+    _formats.push_back(_format);
+    return _formats;
+}
+
+bool GltfCodec::write(const std::string& fname,const ScenePtr& scene)
+{
+    GltfWriter writer(__quantization);
+    for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it) {
+        ShapePtr shape = dynamic_pointer_cast<Shape>(*it);
+        if (is_valid_ptr(shape)) writer.addShape(shape);
+    }
+    return writer.write(fname);
+}
@@ -0,0 +1,91 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file cdc_gltf.h
+    \brief Definition of the binary glTF 2.0 codec.
+*/
+
+#ifndef __cdc_gltf_h__
+#define __cdc_gltf_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/scenegraph/scene/factory.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class GltfCodec
+   \brief Writes scenes in the binary glTF 2.0 format (.glb) for web viewers.
+
+   The shapes are tessellated and each leaf geometry under the transformations of a shape
+   becomes a node of the glTF scene whose matrix is the composition of the transformations.
+   Geometries shared by several shapes are written once and instanced by the nodes.
+   Identical materials are written once. Textures are embedded in the file.
+   With quantization, positions, normals and texture coordinates are stored as integers
+   with the KHR_mesh_quantization extension.
+   The scene is rotated so that the z axis of PlantGL is the y axis (up) of glTF.
+*/
+
+class CODEC_API GltfCodec : public SceneCodec {
+public :
+
+    GltfCodec(bool quantization = false);
+
+    virtual SceneFormatList formats() const;
+
+    virtual bool write(const std::string& fname,const ScenePtr& scene);
+
+    bool isQuantized() const { return __quantization; }
+
+protected:
+    bool __quantization;
+};
+
+
+PGL_END_NAMESPACE
+
+#endif
@@ -0,0 +1,821 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/* ----------------------------------------------------------------------- */
+
+#include "cdc_obj.h"
+#include <plantgl/scenegraph/appearance/material.h>
+#include <plantgl/scenegraph/appearance/texture.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/geometry/quadset.h>
+#include <plantgl/scenegraph/geometry/faceset.h>
+#include <plantgl/scenegraph/geometry/polyline.h>
+#include <plantgl/scenegraph/geometry/pointset.h>
+#include <plantgl/scenegraph/geometry/group.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/dirnames.h>
+#include <plantgl/tool/errormsg.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <plantgl/tool/util_parallel.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <mutex>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+PGL_USING_NAMESPACE
+
+using namespace std;
+
+/* ----------------------------------------------------------------------- */
+
+namespace {
+
+/// Chunks smaller than this are not worth a task of their own.
+const size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
+/// Marks a missing texture coordinate or normal index.
+const int32_t OBJ_NOINDEX = INT32_MIN;
+
+enum ObjElementType { eFace = 0, eLine, ePoint };
+enum ObjAttribute { eVertex = 0, eTexCoord, eNormal };
+
+/// The content of a file, mapped in memory when the system allows it.
+class ObjFileContent {
+public:
+    ObjFileContent(const string& fname);
+    ~ObjFileContent();
+
+    bool isValid() const { return __valid; }
+    const char * begin() const { return __data; }
+    const char * end() const { return __data + __size; }
+    size_t size() const { return __size; }
+
+protected:
+    bool __valid;
+    const char * __data;
+    size_t __size;
+#ifdef _WIN32
+    vector<char> __buffer;
+#else
+    void * __map;
+#endif
+};
+
+#ifdef _WIN32
+
+ObjFileContent::ObjFileContent(const string& fname) :
+    __valid(false), __data(NULL), __size(0)
+{
+    ifstream stream(fname.c_str(), ios::in | ios::binary);
+    if (!stream) return;
+    __buffer.assign(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+    __data = __buffer.empty() ? NULL : &__buffer[0];
+    __size = __buffer.size();
+    __valid = true;
+}
+
+ObjFileContent::~ObjFileContent() {}
+
+#else
+
+ObjFileContent::ObjFileContent(const string& fname) :
+    __valid(false), __data(NULL), __size(0), __map(NULL)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat status;
+    if (fstat(fd, &status) == 0) {
+        __size = size_t(status.st_size);
+        if (__size == 0) __valid = true;
+        else {
+            __map = mmap(NULL, __size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (__map != MAP_FAILED) {
+                __data = (const char *)__map;
+                __valid = true;
+#ifdef MADV_SEQUENTIAL
+                madvise(__map, __size, MADV_SEQUENTIAL);
+#endif
+            }
+            else { __map = NULL; __size = 0; }
+        }
+    }
+    close(fd);
+}
+
+ObjFileContent::~ObjFileContent()
+{
+    if (__map) munmap(__map, __size);
+}
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline void skipBlanks(const char *& it, const char * end)
+{ while (it != end && isBlank(*it)) ++it; }
+
+/// Returns the first word of [\e it, \e end).
+string firstWord(const char * it, const char * end)
+{
+    skipBlanks(it, end);
+    const char * start = it;
+    while (it != end && !isBlank(*it)) ++it;
+    return string(start, it);
+}
+
+/// Returns [\e it, \e end) without leading and trailing blanks.
+string trimmed(const char * it, const char * end)
+{
+    skipBlanks(it, end);
+    while (end != it && isBlank(end[-1])) --end;
+    return string(it, end);
+}
+
+/// Parses a real at \e it, after blanks. The OBJ files are written in the C locale.
+bool parseReal(const char *& it, const char * end, real_t& value)
+{
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    skipBlanks(it, end);
+    const char * start = it;
+    bool negative = false;
+    if (it != end && (*it == '-' || *it == '+')) { negative = (*it == '-'); ++it; }
+    double mantissa = 0;
+    int exponent = 0;
+    bool digits = false;
+    for (; it != end && isDigit(*it); ++it, digits = true) mantissa = mantissa * 10 + (*it - '0');
+    if (it != end && *it == '.') {
+        for (++it; it != end && isDigit(*it); ++it, digits = true) {
+            mantissa = mantissa * 10 + (*it - '0');
+            --exponent;
+        }
+    }
+    if (!digits) { it = start; return false; }
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        const char * e = it + 1;
+        bool negativeExponent = false;
+        if (e != end && (*e == '-' || *e == '+')) { negativeExponent = (*e == '-'); ++e; }
+        if (e != end && isDigit(*e)) {
+            int value = 0;
+            for (; e != end && isDigit(*e); ++e) if (value < 10000) value = value * 10 + (*e - '0');
+            exponent += (negativeExponent ? -value : value);
+            it = e;
+        }
+    }
+    if (it != end && !isBlank(*it)) { it = start; return false; }
+    double result = mantissa;
+    if (exponent != 0) {
+        double power = (abs(exponent) <= 22 ? powers[abs(exponent)] : pow(10., abs(exponent)));
+        result = (exponent > 0 ? result * power : result / power);
+    }
+    value = real_t(negative ? -result : result);
+    return true;
+}
+
+/// Parses an integer at \e it, which is followed by a blank or a '/'.
+bool parseInteger(const char *& it, const char * end, int64_t& value)
+{
+    const char * start = it;
+    bool negative = false;
+    if (it != end && (*it == '-' || *it == '+')) { negative = (*it == '-'); ++it; }
+    if (it == end || !isDigit(*it)) { it = start; return false; }
+    int64_t result = 0;
+    for (; it != end && isDigit(*it); ++it) if (result < INT32_MAX) result = result * 10 + (*it - '0');
+    value = (negative ? -result : result);
+    return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Faces, lines or point sets. The corners of element i are in [offsets[i], offsets[i+1]).
+struct ObjElements {
+    ObjElements() : offsets(1, 0) {}
+
+    size_t size() const { return offsets.size() - 1; }
+
+    vector<uint32_t> offsets;
+
+    /// The 0-based vertex, texture coordinate and normal indices of the corners.
+    vector<int32_t> indices[3];
+
+    /** The corners whose index of each attribute is relative to the end of the chunk.
+        It is stored relatively to the first element of the chunk until the chunks are merged. */
+    vector<uint32_t> relatives[3];
+};
+
+/// A statement changing the group or the material of the following elements.
+struct ObjStatement {
+    enum Type { eGroup, eMaterial, eMaterialLib };
+    Type type;
+    string name;
+    /// The number of elements of each type of the chunk before the statement.
+    size_t counts[3];
+};
+
+/// The data of a part of the file, parsed independently of the other parts.
+class ObjChunk {
+public:
+    ObjChunk(const char * begin = NULL, const char * end = NULL) :
+        begin(begin), end(end), nbLines(0), nbErrors(0), firstErrorLine(0) {}
+
+    void parse();
+
+    const char * begin;
+    const char * end;
+
+    vector<Vector3> points;
+    /// The colors of the points, empty if no point of the chunk has a color.
+    vector<Color4> colors;
+    vector<Vector2> texCoords;
+    vector<Vector3> normals;
+
+    ObjElements elements[3];
+    vector<ObjStatement> statements;
+
+    size_t nbLines;
+    size_t nbErrors;
+    size_t firstErrorLine;
+    set<string> unknownKeywords;
+
+protected:
+    bool parseLine(const char * it, const char * end);
+    bool parseElement(const char * it, const char * end, ObjElementType type);
+    bool parseIndex(const char *& it, const char * end, ObjAttribute attribute, size_t nbValues, ObjElements& elements);
+    void addStatement(ObjStatement::Type type, const string& name);
+};
+
+void ObjChunk::parse()
+{
+    nbLines = 0;
+    for (const char * it = begin; it < end; ++nbLines) {
+        const char * eol = (const char *)memchr(it, '\n', end - it);
+        if (eol == NULL) eol = end;
+        if (!parseLine(it, eol)) {
+            if (nbErrors == 0) firstErrorLine = nbLines;
+            ++nbErrors;
+        }
+        it = eol + 1;
+    }
+    if (!colors.empty()) colors.resize(points.size(), Color4(255, 255, 255, 0));
+}
+
+bool ObjChunk::parseLine(const char * it, const char * end)
+{
+    skipBlanks(it, end);
+    if (it == end || *it == '#') return true;
+    const char * keyword = it;
+    while (it != end && !isBlank(*it)) ++it;
+    size_t length = it - keyword;
+    real_t values[7];
+    char code = (length == 1 ? keyword[0] : 0);
+    if (length == 2 && keyword[0] == 'v') code = (keyword[1] == 't' ? 'T' : keyword[1] == 'n' ? 'N' : 0);
+    switch (code) {
+        case 'v': {
+            size_t nb = 0;
+            while (nb < 7 && parseReal(it, end, values[nb])) ++nb;
+            if (nb < 3) return false;
+            points.push_back(Vector3(values[0], values[1], values[2]));
+            if (nb >= 6) {
+                if (colors.empty()) colors.resize(points.size() - 1, Color4(255, 255, 255, 0));
+                colors.push_back(Color4(uchar_t(values[3] * 255 + 0.5), uchar_t(values[4] * 255 + 0.5), uchar_t(values[5] * 255 + 0.5), 0));
+            }
+            else if (!colors.empty()) colors.push_back(Color4(255, 255, 255, 0));
+            return true;
+        }
+        case 'T': {
+            size_t nb = 0;
+            while (nb < 3 && parseReal(it, end, values[nb])) ++nb;
+            if (nb < 1) return false;
+            texCoords.push_back(Vector2(values[0], nb > 1 ? values[1] : 0));
+            return true;
+        }
+        case 'N': {
+            size_t nb = 0;
+            while (nb < 3 && parseReal(it, end, values[nb])) ++nb;
+            if (nb < 3) return false;
+            // PlantGL meshes expect normalized normals, which OBJ files do not ensure.
+            Vector3 normal(values[0], values[1], values[2]);
+            normal.normalize();
+            normals.push_back(normal);
+            return true;
+        }
+        case 'f': return parseElement(it, end, eFace);
+        case 'l': return parseElement(it, end, eLine);
+        case 'p': return parseElement(it, end, ePoint);
+        case 'g':
+        case 'o': {
+            string name = firstWord(it, end);
+            if (!name.empty()) addStatement(ObjStatement::eGroup, name);
+            return true;
+        }
+        case 's': return true;
+        default: break;
+    }
+    string word(keyword, length);
+    if (word == "usemtl") addStatement(ObjStatement::eMaterial, firstWord(it, end));
+    else if (word == "mtllib") addStatement(ObjStatement::eMaterialLib, trimmed(it, end));
+    else unknownKeywords.insert(word);
+    return true;
+}
+
+bool ObjChunk::parseElement(const char * it, const char * end, ObjElementType type)
+{
+    static const size_t minSizes[3] = { 3, 2, 1 };
+    static const size_t nbAttributes[3] = { 3, 2, 1 };
+    ObjElements& elements = this->elements[type];
+    size_t first = elements.indices[eVertex].size();
+    size_t nbRelatives[3];
+    for (int a = 0; a < 3; ++a) nbRelatives[a] = elements.relatives[a].size();
+    const size_t nbValues[3] = { points.size(), texCoords.size(), normals.size() };
+    bool ok = true;
+    for (skipBlanks(it, end); it != end && ok; skipBlanks(it, end)) {
+        ok = parseIndex(it, end, eVertex, nbValues[eVertex], elements);
+        for (size_t a = 1; a < 3; ++a) {
+            if (ok && it != end && *it == '/') {
+                ++it;
+                if (a == eTexCoord && it != end && *it == '/') elements.indices[a].push_back(OBJ_NOINDEX);
+                else ok = (a < nbAttributes[type]) && parseIndex(it, end, ObjAttribute(a), nbValues[a], elements);
+            }
+            else elements.indices[a].push_back(OBJ_NOINDEX);
+        }
+        if (ok && it != end && !isBlank(*it)) ok = false;
+    }
+    if (ok && elements.indices[eVertex].size() - first >= minSizes[type]) {
+        elements.offsets.push_back(uint32_t(elements.indices[eVertex].size()));
+        return true;
+    }
+    for (int a = 0; a < 3; ++a) {
+        elements.indices[a].resize(first);
+        elements.relatives[a].resize(nbRelatives[a]);
+    }
+    return false;
+}
+
+bool ObjChunk::parseIndex(const char *& it, const char * end, ObjAttribute attribute, size_t nbValues, ObjElements& elements)
+{
+    int64_t value;
+    if (!parseInteger(it, end, value) || value == 0) return false;
+    vector<int32_t>& indices = elements.indices[attribute];
+    if (value < 0) {
+        elements.relatives[attribute].push_back(uint32_t(indices.size()));
+        value += nbValues;
+    }
+    else value -= 1;
+    indices.push_back(int32_t(value));
+    return true;
+}
+
+void ObjChunk::addStatement(ObjStatement::Type type, const string& name)
+{
+    ObjStatement statement;
+    statement.type = type;
+    statement.name = name;
+    for (int t = 0; t < 3; ++t) statement.counts[t] = elements[t].size();
+    statements.push_back(statement);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Reads the materials of the MTL file \e fname in \e materials.
+void readMaterialLibrary(const string& fname, map<string, AppearancePtr>& materials)
+{
+    ifstream stream(fname.c_str());
+    if (!stream) {
+        pglWarning("Cannot open material library '%s'.", fname.c_str());
+        return;
+    }
+    string dirname = get_dirname(fname);
+    string name, texture;
+    real_t Ka[3], Kd[3], Ks[3], Ke[3], Ns = 0, Tr = 0;
+    bool defined = false;
+    for (string line; ; ) {
+        bool eof = !getline(stream, line);
+        istringstream fields(line);
+        string key;
+        fields >> key;
+        if (eof || key == "newmtl") {
+            if (defined) {
+                if (materials.find(name) != materials.end())
+                    pglWarning("Material '%s' of '%s' defined several times.", name.c_str(), fname.c_str());
+                AppearancePtr appearance;
+                if (texture.empty()) {
+                    real_t ambient = Ka[0] + Ka[1] + Ka[2];
+                    real_t diffuse = Kd[0] + Kd[1] + Kd[2];
+                    // A null ambient is common in MTL files: the diffuse color is then used as ambient.
+                    const real_t * color = (ambient > GEOM_EPSILON ? Ka : Kd);
+                    appearance = AppearancePtr(new Material(name,
+                        Color3(uchar_t(color[0] * 255), uchar_t(color[1] * 255), uchar_t(color[2] * 255)),
+                        (ambient > GEOM_EPSILON ? diffuse / ambient : 1),
+                        Color3(uchar_t(Ks[0] * 255), uchar_t(Ks[1] * 255), uchar_t(Ks[2] * 255)),
+                        Color3(uchar_t(Ke[0] * 255), uchar_t(Ke[1] * 255), uchar_t(Ke[2] * 255)),
+                        std::min<real_t>(std::max<real_t>(Ns / 1000, 0), 1), Tr));
+                }
+                else {
+                    appearance = AppearancePtr(new Texture2D(name,
+                        ImageTexturePtr(new ImageTexture(cat_dir_file(dirname, texture))),
+                        Texture2D::DEFAULT_TRANSFORMATION,
+                        Color4(uchar_t(Ka[0] * 255), uchar_t(Ka[1] * 255), uchar_t(Ka[2] * 255), uchar_t(Tr * 255))));
+                }
+                materials[name] = appearance;
+            }
+            if (eof) break;
+            fields >> name;
+            texture.clear();
+            for (int i = 0; i < 3; ++i) { Ka[i] = 0.1; Kd[i] = 0.3; Ks[i] = 0; Ke[i] = 0; }
+            Ns = Material::DEFAULT_SHININESS * 1000;
+            Tr = 0;
+            defined = true;
+        }
+        else if (!defined) continue;
+        else if (key == "Ka") fields >> Ka[0] >> Ka[1] >> Ka[2];
+        else if (key == "Kd") fields >> Kd[0] >> Kd[1] >> Kd[2];
+        else if (key == "Ks") fields >> Ks[0] >> Ks[1] >> Ks[2];
+        else if (key == "Ke") fields >> Ke[0] >> Ke[1] >> Ke[2];
+        else if (key == "Ns") fields >> Ns;
+        else if (key == "Tr") fields >> Tr;
+        else if (key == "d") { real_t d = 1; fields >> d; Tr = 1 - d; }
+        else if (key == "map_Kd") {
+            // Options of the map come before the file name which is the last field.
+            string field;
+            while (fields >> field) texture = field;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// A range of elements of a chunk.
+struct ObjRange {
+    size_t chunk, begin, end;
+};
+
+/// The elements of a group with a material, from which a shape is built.
+struct ObjPart {
+    string group;
+    string material;
+    vector<ObjRange> ranges[3];
+};
+
+/// The data of all the chunks once merged, from which the shapes are built.
+class ObjBuilder {
+public:
+    ObjBuilder(const vector<ObjChunk>& chunks, size_t nbPoints, size_t nbTexCoords, size_t nbNormals) :
+        __chunks(chunks), nbInvalidElements(0)
+    {
+        __nbValues[eVertex] = nbPoints;
+        __nbValues[eTexCoord] = nbTexCoords;
+        __nbValues[eNormal] = nbNormals;
+    }
+
+    GeometryPtr build(const ObjPart& part);
+
+    Point3ArrayPtr points;
+    Color4ArrayPtr colors;
+    Point2ArrayPtr texCoords;
+    Point3ArrayPtr normals;
+
+    size_t nbInvalidElements;
+
+protected:
+    bool isValid(const ObjElements& elements, size_t i, ObjAttribute attribute) const;
+
+    template<class MeshType, class IndexArrayType>
+    GeometryPtr buildMesh(const ObjPart& part, size_t nbFaces, bool withTexCoords, bool withNormals);
+
+    const vector<ObjChunk>& __chunks;
+    size_t __nbValues[3];
+    std::mutex __mutex;
+};
+
+bool ObjBuilder::isValid(const ObjElements& elements, size_t i, ObjAttribute attribute) const
+{
+    const vector<int32_t>& indices = elements.indices[attribute];
+    for (uint32_t c = elements.offsets[i]; c < elements.offsets[i + 1]; ++c)
+        if (indices[c] < 0 || size_t(indices[c]) >= __nbValues[attribute]) return false;
+    return true;
+}
+
+template<class IndexType>
+inline void makeIndex(IndexType& index, const vector<uint32_t>& corners)
+{ for (size_t i = 0; i < corners.size(); ++i) index[i] = corners[i]; }
+
+template<>
+inline void makeIndex<Index>(Index& index, const vector<uint32_t>& corners)
+{ index = Index(corners.begin(), corners.end()); }
+
+/// Appends to \e array the value \e source[i] the first time \e i is met and returns its index in \e array.
+template<class ArrayPtr>
+inline uint32_t compactIndex(pgl_hash_map<uint32_t, uint32_t>& remap, uint32_t i,
+                             const ArrayPtr& source, ArrayPtr& array)
+{
+    pair<pgl_hash_map<uint32_t, uint32_t>::iterator, bool> it = remap.insert(make_pair(i, uint32_t(array->size())));
+    if (it.second) array->push_back(source->getAt(i));
+    return it.first->second;
+}
+
+template<class MeshType, class IndexArrayType>
+GeometryPtr ObjBuilder::buildMesh(const ObjPart& part, size_t nbFaces, bool withTexCoords, bool withNormals)
+{
+    typedef typename IndexArrayType::element_type IndexType;
+    typedef RCPtr<IndexArrayType> MeshIndexArrayPtr;
+    Point3ArrayPtr meshPoints(new Point3Array());
+    Color4ArrayPtr meshColors(colors ? new Color4Array() : NULL);
+    Point2ArrayPtr meshTexCoords(withTexCoords ? new Point2Array() : NULL);
+    Point3ArrayPtr meshNormals(withNormals ? new Point3Array() : NULL);
+    MeshIndexArrayPtr indices(new IndexArrayType()), texCoordIndices, normalIndices;
+    indices->reserve(nbFaces);
+    if (withTexCoords) { texCoordIndices = MeshIndexArrayPtr(new IndexArrayType()); texCoordIndices->reserve(nbFaces); }
+    if (withNormals) { normalIndices = MeshIndexArrayPtr(new IndexArrayType()); normalIndices->reserve(nbFaces); }
+    pgl_hash_map<uint32_t, uint32_t> remaps[3];
+    vector<uint32_t> corners;
+    IndexType index;
+    for (vector<ObjRange>::const_iterator range = part.ranges[eFace].begin(); range != part.ranges[eFace].end(); ++range) {
+        const ObjElements& faces = __chunks[range->chunk].elements[eFace];
+        for (size_t f = range->begin; f < range->end; ++f) {
+            if (!isValid(faces, f, eVertex)) continue;
+            const uint32_t first = faces.offsets[f], last = faces.offsets[f + 1];
+            corners.clear();
+            for (uint32_t c = first; c < last; ++c) {
+                uint32_t i = faces.indices[eVertex][c];
+                pair<pgl_hash_map<uint32_t, uint32_t>::iterator, bool> it = remaps[eVertex].insert(make_pair(i, uint32_t(meshPoints->size())));
+                if (it.second) {
+                    meshPoints->push_back(points->getAt(i));
+                    if (meshColors) meshColors->push_back(colors->getAt(i));
+                }
+                corners.push_back(it.first->second);
+            }
+            makeIndex(index, corners);
+            indices->push_back(index);
+            if (withTexCoords) {
+                corners.clear();
+                for (uint32_t c = first; c < last; ++c)
+                    corners.push_back(compactIndex(remaps[eTexCoord], faces.indices[eTexCoord][c], texCoords, meshTexCoords));
+                makeIndex(index, corners);
+                texCoordIndices->push_back(index);
+            }
+            if (withNormals) {
+                corners.clear();
+                for (uint32_t c = first; c < last; ++c)
+                    corners.push_back(compactIndex(remaps[eNormal], faces.indices[eNormal][c], normals, meshNormals));
+                makeIndex(index, corners);
+                normalIndices->push_back(index);
+            }
+        }
+    }
+    return GeometryPtr(new MeshType(meshPoints, indices, meshNormals, normalIndices,
+                                    meshColors, MeshIndexArrayPtr(), meshTexCoords, texCoordIndices,
+                                    true, true));
+}
+
+GeometryPtr ObjBuilder::build(const ObjPart& part)
+{
+    // The type of mesh and its attributes depend on all the faces of the part.
+    size_t nbFaces = 0, nbInvalid = 0;
+    bool triangles = true, quads = true, withTexCoords = true, withNormals = true;
+    for (vector<ObjRange>::const_iterator range = part.ranges[eFace].begin(); range != part.ranges[eFace].end(); ++range) {
+        const ObjElements& faces = __chunks[range->chunk].elements[eFace];
+        for (size_t f = range->begin; f < range->end; ++f) {
+            if (!isValid(faces, f, eVertex)) { ++nbInvalid; continue; }
+            ++nbFaces;
+            uint32_t size = faces.offsets[f + 1] - faces.offsets[f];
+            triangles &= (size == 3);
+            quads &= (size == 4);
+            withTexCoords = withTexCoords && isValid(faces, f, eTexCoord);
+            withNormals = withNormals && isValid(faces, f, eNormal);
+        }
+    }
+    GeometryArrayPtr geometries(new GeometryArray());
+    if (nbFaces > 0) {
+        if (triangles) geometries->push_back(buildMesh<TriangleSet, Index3Array>(part, nbFaces, withTexCoords, withNormals));
+        else if (quads) geometries->push_back(buildMesh<QuadSet, Index4Array>(part, nbFaces, withTexCoords, withNormals));
+        else geometries->push_back(buildMesh<FaceSet, IndexArray>(part, nbFaces, withTexCoords, withNormals));
+    }
+    for (int type = eLine; type <= ePoint; ++type) {
+        GeometryArrayPtr elements(new GeometryArray());
+        for (vector<ObjRange>::const_iterator range = part.ranges[type].begin(); range != part.ranges[type].end(); ++range) {
+            const ObjElements& chunkElements = __chunks[range->chunk].elements[type];
+            for (size_t e = range->begin; e < range->end; ++e) {
+                if (!isValid(chunkElements, e, eVertex)) { ++nbInvalid; continue; }
+                Point3ArrayPtr elementPoints(new Point3Array());
+                Color4ArrayPtr elementColors(colors ? new Color4Array() : NULL);
+                for (uint32_t c = chunkElements.offsets[e]; c < chunkElements.offsets[e + 1]; ++c) {
+                    uint32_t i = chunkElements.indices[eVertex][c];
+                    elementPoints->push_back(points->getAt(i));
+                    if (elementColors) elementColors->push_back(colors->getAt(i));
+                }
+                if (type == eLine) elements->push_back(GeometryPtr(new Polyline(elementPoints, elementColors)));
+                else elements->push_back(GeometryPtr(new PointSet(elementPoints, elementColors)));
+            }
+        }
+        if (!elements->empty()) geometries->push_back(GeometryPtr(new Group(elements)));
+    }
+    if (nbInvalid > 0) {
+        std::lock_guard<std::mutex> lock(__mutex);
+        nbInvalidElements += nbInvalid;
+    }
+    if (geometries->empty()) return GeometryPtr();
+    if (geometries->size() == 1) return geometries->getAt(0);
+    return GeometryPtr(new Group(geometries));
+}
+
+}
+
+/* ----------------------------------------------------------------------- */
+
+ObjCodec::ObjCodec() :
+    SceneCodec("OBJ", Read )
+    {}
+
+SceneFormatList ObjCodec::formats() const
+{
+    SceneFormat _format;
+    _format.name = "Obj Codec";
+    _format.suffixes.push_back("obj");
+    _format.comment = "The Wavefront Obj file format.";
+    SceneFormatList _formats;
+    _formats.push_back(_format);
+    return _formats;
+}
+
+ScenePtr ObjCodec::read(const std::string& fname)
+{
+    ObjFileContent content(fname);
+    if (!content.isValid()) {
+        pglErrorEx(PGLERRORMSG(C_FILE_OPEN_ERR_s), fname.c_str());
+        return ScenePtr();
+    }
+
+    // Split the file at line boundaries in chunks parsed in parallel.
+    size_t nbChunks = std::max<size_t>(1, std::min(content.size() / OBJ_MIN_CHUNK_SIZE, 4 * pgl_thread_count()));
+    vector<ObjChunk> chunks;
+    const char * begin = content.begin();
+    for (size_t c = 1; c <= nbChunks; ++c) {
+        const char * end = content.begin() + content.size() * c / nbChunks;
+        if (end < begin) end = begin;
+        const char * eol = (const char *)memchr(end, '\n', content.end() - end);
+        end = (c == nbChunks || eol == NULL ? content.end() : eol + 1);
+        if (end > begin || chunks.empty()) chunks.push_back(ObjChunk(begin, end));
+        begin = end;
+    }
+    pgl_parallel_for(0, chunks.size(), [&chunks](size_t c) { chunks[c].parse(); });
+
+    // Offsets of the values of each chunk in the merged arrays.
+    size_t nbChunkValues[3];
+    vector<size_t> offsets[3];
+    size_t nbValues[3] = { 0, 0, 0 };
+    bool withColors = false;
+    for (vector<ObjChunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk) {
+        nbChunkValues[eVertex] = chunk->points.size();
+        nbChunkValues[eTexCoord] = chunk->texCoords.size();
+        nbChunkValues[eNormal] = chunk->normals.size();
+        for (int a = 0; a < 3; ++a) {
+            offsets[a].push_back(nbValues[a]);
+            nbValues[a] += nbChunkValues[a];
+        }
+        withColors |= !chunk->colors.empty();
+    }
+
+    ObjBuilder builder(chunks, nbValues[eVertex], nbValues[eTexCoord], nbValues[eNormal]);
+    builder.points = Point3ArrayPtr(new Point3Array(uint_t(nbValues[eVertex])));
+    builder.texCoords = Point2ArrayPtr(new Point2Array(uint_t(nbValues[eTexCoord])));
+    builder.normals = Point3ArrayPtr(new Point3Array(uint_t(nbValues[eNormal])));
+    if (withColors) builder.colors = Color4ArrayPtr(new Color4Array(uint_t(nbValues[eVertex]), Color4(255, 255, 255, 0)));
+
+    // Merge the values and make the indices of the chunks absolute.
+    pgl_parallel_for(0, chunks.size(), [&](size_t c) {
+        ObjChunk& chunk = chunks[c];
+        std::copy(chunk.points.begin(), chunk.points.end(), builder.points->begin() + offsets[eVertex][c]);
+        if (!chunk.colors.empty()) std::copy(chunk.colors.begin(), chunk.colors.end(), builder.colors->begin() + offsets[eVertex][c]);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), builder.texCoords->begin() + offsets[eTexCoord][c]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), builder.normals->begin() + offsets[eNormal][c]);
+        for (int type = 0; type < 3; ++type) {
+            ObjElements& elements = chunk.elements[type];
+            for (int a = 0; a < 3; ++a) {
+                int32_t offset = int32_t(offsets[a][c]);
+                for (vector<uint32_t>::const_iterator it = elements.relatives[a].begin(); it != elements.relatives[a].end(); ++it)
+                    elements.indices[a][*it] += offset;
+            }
+        }
+    });
+
+    // Split the elements in parts according to the groups and materials, and read the materials.
+    vector<ObjPart> parts;
+    map<pair<string, string>, size_t> partIds;
+    map<string, AppearancePtr> materials;
+    string group, material;
+    size_t nbErrors = 0, lineOffset = 0;
+    set<string> unknownKeywords;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const ObjChunk& chunk = chunks[c];
+        size_t counts[3] = { 0, 0, 0 };
+        for (size_t s = 0; s <= chunk.statements.size(); ++s) {
+            const size_t * nextCounts = (s < chunk.statements.size() ? chunk.statements[s].counts : NULL);
+            for (int type = 0; type < 3; ++type) {
+                size_t next = (nextCounts ? nextCounts[type] : chunk.elements[type].size());
+                if (next > counts[type]) {
+                    pair<map<pair<string, string>, size_t>::iterator, bool> it =
+                        partIds.insert(make_pair(make_pair(group, material), parts.size()));
+                    if (it.second) {
+                        parts.push_back(ObjPart());
+                        parts.back().group = group;
+                        parts.back().material = material;
+                    }
+                    ObjRange range = { c, counts[type], next };
+                    parts[it.first->second].ranges[type].push_back(range);
+                }
+                counts[type] = next;
+            }
+            if (nextCounts == NULL) break;
+            const ObjStatement& statement = chunk.statements[s];
+            switch (statement.type) {
+                case ObjStatement::eGroup: group = statement.name; break;
+                case ObjStatement::eMaterial: material = statement.name; break;
+                case ObjStatement::eMaterialLib: readMaterialLibrary(cat_dir_file(get_dirname(fname), statement.name), materials); break;
+            }
+        }
+        if (chunk.nbErrors > 0) {
+            if (nbErrors == 0) pglWarning("Invalid line %lu in '%s'.", (unsigned long)(lineOffset + chunk.firstErrorLine + 1), fname.c_str());
+            nbErrors += chunk.nbErrors;
+        }
+        lineOffset += chunk.nbLines;
+        unknownKeywords.insert(chunk.unknownKeywords.begin(), chunk.unknownKeywords.end());
+    }
+    if (nbErrors > 1) pglWarning("%lu invalid lines ignored in '%s'.", (unsigned long)nbErrors, fname.c_str());
+    for (set<string>::const_iterator it = unknownKeywords.begin(); it != unknownKeywords.end(); ++it)
+        pglWarning("Unsupported statement '%s' ignored in '%s'.", it->c_str(), fname.c_str());
+
+    // Undefined materials are replaced by a default material with their name.
+    for (vector<ObjPart>::const_iterator part = parts.begin(); part != parts.end(); ++part) {
+        if (!part->material.empty() && materials.find(part->material) == materials.end()) {
+            pglWarning("Material '%s' used in '%s' is not defined.", part->material.c_str(), fname.c_str());
+            materials[part->material] = AppearancePtr(new Material(part->material));
+        }
+    }
+
+    vector<GeometryPtr> geometries(parts.size());
+    pgl_parallel_for(0, parts.size(), [&](size_t p) { geometries[p] = builder.build(parts[p]); });
+    if (builder.nbInvalidElements > 0)
+        pglWarning("%lu elements with invalid indices ignored in '%s'.", (unsigned long)builder.nbInvalidElements, fname.c_str());
+
+    ScenePtr scene(new Scene());
+    for (size_t p = 0; p < parts.size(); ++p) {
+        if (!geometries[p]) continue;
+        AppearancePtr appearance = (parts[p].material.empty() ? AppearancePtr(Material::DEFAULT_MATERIAL) : materials[parts[p].material]);
+        scene->add(ShapePtr(new Shape(parts[p].group, geometries[p], appearance)));
+    }
+    return scene;
+}
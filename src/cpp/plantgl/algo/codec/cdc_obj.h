@@ -0,0 +1,86 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file cdc_obj.h
+    \brief Definition of the Wavefront OBJ codec.
+*/
+
+#ifndef __cdc_obj_h__
+#define __cdc_obj_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/scenegraph/scene/factory.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ObjCodec
+   \brief Reads scenes in the Wavefront OBJ format with their MTL material libraries.
+
+   The file is mapped in memory and split at line boundaries into chunks parsed in parallel.
+   Relative (negative) indices are resolved once the number of vertices of the previous
+   chunks is known. A shape is created for each couple of group (or object) and material.
+   Its mesh only contains the vertices it uses and is a TriangleSet, a QuadSet or a FaceSet
+   according to the size of its faces. Lines and point sets are added as Polyline and PointSet.
+   The codec is registered as "OBJ". OBJ files are written by the python codec "OBJ_WRITER".
+*/
+
+class CODEC_API ObjCodec : public SceneCodec {
+public :
+
+    ObjCodec();
+
+    virtual SceneFormatList formats() const;
+
+    virtual ScenePtr read(const std::string& fname);
+
+};
+
+
+PGL_END_NAMESPACE
+
+#endif
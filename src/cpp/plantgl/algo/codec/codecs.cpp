@@ -48,6 +48,8 @@
 #include "cdc_pov.h"
 #include "cdc_vrml.h"
 #include "cdc_ply.h"
+#include "cdc_gltf.h"
+#include "cdc_obj.h"
 #include <plantgl/scenegraph/scene/factory.h>
 
 /* ----------------------------------------------------------------------- */
@@ -72,6 +74,9 @@ void installCodecs(){
         SceneFactory::get().registerCodec(SceneCodecPtr(new PovCodec()));
         SceneFactory::get().registerCodec(SceneCodecPtr(new VrmlCodec()));
         SceneFactory::get().registerCodec(SceneCodecPtr(new PlyCodec()));
+        SceneFactory::get().registerCodec(SceneCodecPtr(new GltfCodec(true)));
+        SceneFactory::get().registerCodec(SceneCodecPtr(new GltfCodec()));
+        SceneFactory::get().registerCodec(SceneCodecPtr(new ObjCodec()));
     }
 }
 
@@ -45,6 +45,7 @@
 
 #include "plyprinter.h"
 #include <plantgl/algo/base/discretizer.h>
+#include <plantgl/algo/base/merge.h>
 
 #include <plantgl/pgl_scene.h>
 #include <plantgl/pgl_appearance.h>
@@ -61,50 +62,52 @@ using namespace std;
 /* ----------------------------------------------------------------------- */
 
 #define GEOM_PLY_MESH(obj,gindex,len) \
+  auto _mesh = weldedMesh(obj); \
   if( __pass == 1 ){ \
-    __vertex += obj->getPointList()->size(); \
-    __face += obj->getIndexList()->size(); \
+    __vertex += _mesh->getPointList()->size(); \
+    __face += _mesh->getIndexList()->size(); \
   } \
   else if( __pass == 2 ){ \
-    for(Point3Array::const_iterator _it = obj->getPointList()->begin(); \
-        _it != obj->getPointList()->end(); _it++){ \
+    for(Point3Array::const_iterator _it = _mesh->getPointList()->begin(); \
+        _it != _mesh->getPointList()->end(); _it++){ \
          stream << _it->x() << ' ' <<_it->y()  << ' ' << _it->z()  << ' ' << __red   << ' ' << __green   << ' ' << __blue << endl; \
     } \
   } \
   else if( __pass == 3 ){ \
-    for(gindex##Array::const_iterator _it = obj->getIndexList()->begin(); \
-        _it != obj->getIndexList()->end(); _it++){ \
+    for(gindex##Array::const_iterator _it = _mesh->getIndexList()->begin(); \
+        _it != _mesh->getIndexList()->end(); _it++){ \
        stream << len; \
        for(gindex::const_iterator _it2 = _it->begin(); \
           _it2 != _it->end(); _it2++) \
           stream << ' ' << ((*_it2)+__index); \
        stream << endl; \
     } \
-    __index += obj->getPointList()->size(); \
+    __index += _mesh->getPointList()->size(); \
   } \
   return true; \
 
 
 #define GEOM_PLYB_MESH(obj,gindex,len) \
+  auto _mesh = weldedMesh(obj); \
   if( __pass == 1 ){ \
-    __vertex += obj->getPointList()->size(); \
-    __face += obj->getIndexList()->size(); \
+    __vertex += _mesh->getPointList()->size(); \
+    __face += _mesh->getIndexList()->size(); \
   } \
   else if( __pass == 2 ){ \
-    for(Point3Array::const_iterator _it = obj->getPointList()->begin(); \
-        _it != obj->getPointList()->end(); _it++){ \
+    for(Point3Array::const_iterator _it = _mesh->getPointList()->begin(); \
+        _it != _mesh->getPointList()->end(); _it++){ \
       stream << (float)_it->x() << (float)_it->y()  << (float)_it->z() << (uchar_t)__red  << (uchar_t)__green  << (uchar_t)__blue; \
     } \
   } \
   else if( __pass == 3 ){ \
-    for(gindex##Array::const_iterator _it = obj->getIndexList()->begin(); \
-        _it != obj->getIndexList()->end(); _it++){ \
+    for(gindex##Array::const_iterator _it = _mesh->getIndexList()->begin(); \
+        _it != _mesh->getIndexList()->end(); _it++){ \
        stream << (uchar_t)len; \
        for(gindex::const_iterator _it2 = _it->begin(); \
           _it2 != _it->end(); _it2++) \
          stream << (int)((*_it2)+__index); \
     } \
-    __index += obj->getPointList()->size(); \
+    __index += _mesh->getPointList()->size(); \
   } \
   return true; \
 
@@ -120,7 +123,9 @@ PlyPrinter::PlyPrinter( ostream& stream , Discretizer& discretizer) :
   __red(160),
   __green(160),
   __blue(160),
-  __index(0)
+  __index(0),
+  __weldTolerance(0),
+  __weldedIndex(0)
 {
 }
 
@@ -670,18 +675,50 @@ PlyPrinter::process( Font * font )
 
 /* ----------------------------------------------------------------------- */
 
+void
+PlyPrinter::beginPass(int pass)
+{
+  __pass = pass;
+  __weldedIndex = 0;
+  if (pass <= 1) {
+    __weldedMeshes.clear();
+    __weldCache.clear();
+  }
+}
+
+ExplicitModelPtr
+PlyPrinter::weldedModel(ExplicitModel * mesh)
+{
+  if (__pass != 1) {
+    if (__weldedIndex < __weldedMeshes.size()) return __weldedMeshes[__weldedIndex++];
+    return ExplicitModelPtr(mesh);
+  }
+  ExplicitModelPtr _welded;
+  Cache<std::pair<ExplicitModelPtr,ExplicitModelPtr> >::Iterator _it = __weldCache.find(mesh->getObjectId());
+  if (_it != __weldCache.end()) _welded = _it->second.second;
+  else {
+    // the original mesh is kept so that its id is not given to another mesh during the pass
+    ExplicitModelPtr _mesh(mesh);
+    _welded = MeshWelder(__weldTolerance).weld(_mesh);
+    if (!_welded) _welded = _mesh;
+    __weldCache.insert(mesh->getObjectId(), std::make_pair(_mesh, _welded));
+  }
+  __weldedMeshes.push_back(_welded);
+  return _welded;
+}
 
 bool
 PlyPrinter::process(ScenePtr scene, const char * comment)
 {
   GEOM_ASSERT(scene);
-  __pass = 1;
+  beginPass(1);
   scene->apply(*this);
   header(comment);
-  __pass = 2;
+  beginPass(2);
   scene->apply(*this);
-  __pass = 3;
+  beginPass(3);
   scene->apply(*this);
+  beginPass(0);
   return true;
 }
 
@@ -892,13 +929,14 @@ bool
 PlyBinaryPrinter::process(ScenePtr scene, const char * comment)
 {
   GEOM_ASSERT(scene);
-  __pass = 1;
+  beginPass(1);
   scene->apply(*this);
   header(comment);
-  __pass = 2;
+  beginPass(2);
   scene->apply(*this);
-  __pass = 3;
+  beginPass(3);
   scene->apply(*this);
+  beginPass(0);
   return true;
 }
 
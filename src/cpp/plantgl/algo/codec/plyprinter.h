@@ -51,6 +51,9 @@
 
 #include "printer.h"
 #include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_cache.h>
+#include <plantgl/scenegraph/geometry/explicitmodel.h>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -374,6 +377,13 @@ public :
       - \e scene must be non null and valid. */
   virtual bool process(ScenePtr scene, const char * comment);
 
+  /** Sets the distance below which the vertices of each mesh are welded before being written.
+      A tolerance of 0 (default) writes the vertices unchanged. */
+  inline void setWeldTolerance(real_t tolerance) { __weldTolerance = tolerance; }
+
+  /// Returns the distance below which the vertices of each mesh are welded.
+  inline real_t getWeldTolerance() const { return __weldTolerance; }
+
   /// Print the scene \e scene in the file \e filename in ply format.
   static bool print(ScenePtr scene,std::string filename,const char * comment = NULL, ply_format format = ply_ascii );
 
@@ -407,6 +417,32 @@ protected :
   /// index of point.
   uint_t __index;
 
+  /// distance below which the vertices of a mesh are welded.
+  real_t __weldTolerance;
+
+  /// Welded meshes of the first pass, in the order of the traversal.
+  std::vector<ExplicitModelPtr> __weldedMeshes;
+
+  /// Position in __weldedMeshes of the next mesh of the current pass.
+  size_t __weldedIndex;
+
+  /// Original and welded meshes of the first pass, by id of the original mesh.
+  Cache<std::pair<ExplicitModelPtr,ExplicitModelPtr> > __weldCache;
+
+  /** Returns \e mesh with its vertices welded. Each mesh is welded once in the first pass,
+      and the next passes reuse the welded meshes in the order of the traversal. */
+  template<class T>
+  RCPtr<T> weldedMesh(T * mesh) {
+    if (__weldTolerance <= 0) return RCPtr<T>(mesh);
+    RCPtr<T> _welded = dynamic_pointer_cast<T>(weldedModel(mesh));
+    return _welded ? _welded : RCPtr<T>(mesh);
+  }
+
+  ExplicitModelPtr weldedModel(ExplicitModel * mesh);
+
+  /// Forgets the welded meshes and starts the pass \e pass.
+  void beginPass(int pass);
+
 
 };
 
@@ -58,11 +58,13 @@
 #include <plantgl/math/util_math.h>
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/tool/util_hashmap.h>
+#include <plantgl/tool/util_parallel.h>
 
 #include <stdio.h>
 #include <fstream>
 
 #include <stack>
+#include <algorithm>
 
 PGL_USING_NAMESPACE
 using namespace std;
@@ -75,37 +77,53 @@ STDEXT_USING_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
 
-Point3ArrayPtr
-PGL(discretizeWithCurvature)(NurbsCurvePtr C,int NumberOfPoint){
+/// Local curvatures of a curve sampled every 0.001 of its parameter range.
+struct CurvatureProfile {
+  /// The sampled parameters.
+  std::vector<real_t> params;
+  /// The curvature at each parameter (0 where it is not defined).
+  std::vector<real_t> curvatures;
+  /// The sum of the curvatures.
+  real_t total;
+
+  CurvatureProfile() : total(0) {}
+
+  void compute(const NurbsCurvePtr& C){
+    params.clear(); curvatures.clear(); total = 0.0;
+    for(real_t i=C->getFirstKnot();i<C->getLastKnot();i+=0.001f){
+      real_t courbureL=0.0;
+      real_t courbureLden =0.0;
+
+      Vector4 C1_u = C->getDerivativeAt(i,1);
+      Vector4 C2_u = C->getDerivativeAt(i,2);
+
+      courbureL=sqrt(sq((C1_u.y()*C2_u.z()-C1_u.z()*C2_u.y()))
+        +sq((C1_u.z()*C2_u.x()-C1_u.x()*C2_u.z()))
+        +sq((C1_u.x()*C2_u.y()-C1_u.y()*C2_u.x())));
+
+      courbureLden= pow((sqrt(C1_u.x() * C1_u.x()
+        + C1_u.y() * C1_u.y()
+        + C1_u.z()* C1_u.z() )),3);
+      if(courbureLden!=0.0){
+        courbureL=courbureL/courbureLden;
+        total+=courbureL;
+      }
+      else courbureL = 0.0;
+      params.push_back(i);
+      curvatures.push_back(courbureL);
+    }
+  }
+};
+
+/// Points of \e C equally spaced in curvature, using the curvature \e profile of C.
+static Point3ArrayPtr
+discretizeWithCurvature(const NurbsCurvePtr& C, const CurvatureProfile& profile, int NumberOfPoint){
   if(!C)return Point3ArrayPtr();
   Point3ArrayPtr theVector(new Point3Array(NumberOfPoint));
   theVector->setAt(0,C->getPointAt(C->getFirstKnot()));
   theVector->setAt(NumberOfPoint-1,C->getPointAt(C->getLastKnot()));
   if(NumberOfPoint > 2){
-    Vector3 Zero(0,0,0);
-    real_t courbureG=0.0;
-    {
-      for(real_t i=C->getFirstKnot();i<C->getLastKnot();i+=0.001f){
-        real_t courbureL=0.0;
-        real_t courbureLden =0.0;
-
-        Vector4 C1_u = C->getDerivativeAt(i,1);
-        Vector4 C2_u = C->getDerivativeAt(i,2);
-
-
-        courbureL=sqrt(sq((C1_u.y()*C2_u.z()-C1_u.z()*C2_u.y()))
-          +sq((C1_u.z()*C2_u.x()-C1_u.x()*C2_u.z()))
-          +sq((C1_u.x()*C2_u.y()-C1_u.y()*C2_u.x())));
-
-        courbureLden= pow((sqrt(C1_u.x() * C1_u.x()
-          + C1_u.y() * C1_u.y()
-          + C1_u.z()* C1_u.z() )),3);
-        if(courbureLden!=0.0){
-          courbureL=courbureL/courbureLden;
-          courbureG+=courbureL;
-        }
-      }
-    }
+    real_t courbureG=profile.total;
 
 #ifdef GEOM_DEBUG
     printf("Global Curvature : %f\n",(courbureG*0.001));
@@ -115,32 +133,10 @@ PGL(discretizeWithCurvature)(NurbsCurvePtr C,int NumberOfPoint){
       real_t courbureStep=courbureG/(NumberOfPoint-1);
       real_t courbureA = courbureStep;
       int index=1;
-      for(real_t i=C->getFirstKnot();
-      i<C->getLastKnot() && index<(NumberOfPoint-1);i+=0.001f){
-        real_t courbureL = 0.0;
-        real_t courbureLden =0.0;
-        Vector4 C1_u = C->getDerivativeAt(i,1);
-        Vector4 C2_u = C->getDerivativeAt(i,2);
-
-        courbureL=sqrt(sq((C1_u.y()*C2_u.z()-C1_u.z()*C2_u.y()))
-          +sq((C1_u.z()*C2_u.x()-C1_u.x()*C2_u.z()))
-          +sq((C1_u.x()*C2_u.y()-C1_u.y()*C2_u.x())));
-        courbureLden= pow((sqrt(C1_u.x() * C1_u.x()
-          + C1_u.y() * C1_u.y()
-          + C1_u.z()* C1_u.z() )),3);
-        if(courbureLden!=0.0){
-          courbureL=courbureL/courbureLden;
-          courbureSomme+=courbureL;
-        }
+      for(size_t j = 0; j < profile.params.size() && index<(NumberOfPoint-1); ++j){
+        courbureSomme+=profile.curvatures[j];
         if(courbureSomme >= courbureA){
-          theVector->setAt(index,C->getPointAt(i));
-#ifdef GEOM_DEBUG
-          if(theVector->getAt(index)==Zero)
-            printf("Point Calcul error ! (%s:%s)\n",get_filename(__FILE__).c_str(),__LINE__);
-          printf("Find the %d (of %d) interior point  at u=%f: %f - %f -> <%f,%f,%f>\n",
-            index,(NumberOfPoint),i,courbureSomme*0.001,courbureA*0.001,
-            theVector->getAt(index).x(),theVector->getAt(index).y(),theVector->getAt(index).z());
-#endif
+          theVector->setAt(index,C->getPointAt(profile.params[j]));
           index++;
           courbureA+=courbureStep;
         }
@@ -155,6 +151,14 @@ PGL(discretizeWithCurvature)(NurbsCurvePtr C,int NumberOfPoint){
   return theVector;
 }
 
+Point3ArrayPtr
+PGL(discretizeWithCurvature)(NurbsCurvePtr C,int NumberOfPoint){
+  if(!C)return Point3ArrayPtr();
+  CurvatureProfile profile;
+  if(NumberOfPoint > 2) profile.compute(C);
+  return discretizeWithCurvature(C,profile,NumberOfPoint);
+}
+
 Point3ArrayPtr
 PGL(compressPolyline)(Point3ArrayPtr C,int NumberOfPoint){
   if(!C)return Point3ArrayPtr();
@@ -279,35 +283,60 @@ PGL(fitt)(const Point3ArrayPtr&  MyVector,
 */
 /* ----------------------------------------------------------------------- */
 
-NurbsCurvePtr
-PGL(fitt)(const Point3ArrayPtr&  MyVector,
-                   int deg,
-                   int CPbegin,
-                   int nbPtCtrlMax,
-                   real_t ErreurBound,
-                   int &  Nbloop,
-                   real_t & SommeEk){
-
-  //######################################
-  //#      Approximation des points      #
-  //######################################
-
+/*
+  Iterative approximation of the points by curves with an increasing number of
+  control points. Each iteration is recorded, so that the result for any maximum
+  number of control points is obtained from a single run, resumed if needed.
+*/
+struct FitTrajectory {
+  /// Result of an iteration.
+  struct Step {
+    NurbsCurvePtr curve;
+    real_t error;
+    /// The number of control points of the next iteration.
+    int nextCtrlPoints;
+    /// Whether the iterations stop whatever the maximum number of control points.
+    bool last;
+  };
+
+  Point3ArrayPtr MyVector;
+  int deg;
+  real_t ErreurBound;
   NurbsCurvePtr C;
   NurbsCurvePtr C2;
   NurbsCurvePtr Cold;
-  real_t EkOld=0;
-  real_t polygonLength=0.0;
-  int k=MyVector->size();
+  real_t polygonLength;
+  real_t oldLength;
   RealArrayPtr ub;
-  ub = Fit::chordLengthParam(MyVector,polygonLength) ;
-  real_t oldLength=polygonLength;
-  real_t localLength=0.0;
-  int NoErr=1;
-  int ok=1;
-  int backup=0;
+  int CPbegin;
+  int NoErr;
+  int ok;
+  int backup;
+  std::vector<Step> steps;
+
+  FitTrajectory() : deg(0), ErreurBound(0), polygonLength(0), oldLength(0), CPbegin(0), NoErr(1), ok(1), backup(0) {}
+
+  FitTrajectory(const Point3ArrayPtr& _points, int _deg, int _CPbegin, real_t _ErreurBound) :
+    MyVector(_points), deg(_deg), ErreurBound(_ErreurBound),
+    polygonLength(0), oldLength(0), CPbegin(_CPbegin), NoErr(1), ok(1), backup(0) {
+    ub = Fit::chordLengthParam(MyVector,polygonLength) ;
+    oldLength=polygonLength;
+  }
 
-  do{
-    EkOld=0;SommeEk=0;
+  bool isValid() const { return MyVector.get() != NULL; }
+
+  /// Whether another iteration can be done.
+  bool isComplete() const { return !steps.empty() && steps.back().last; }
+
+  /// Performs one iteration and records its result.
+  void iterate(){
+    //######################################
+    //#      Approximation des points      #
+    //######################################
+    int k=MyVector->size();
+    real_t localLength=0.0;
+    real_t SommeEk=0;
+    bool stop = false;
     C = dynamic_pointer_cast<NurbsCurve>(Fit::leastSquares(MyVector,deg,CPbegin,ub));
     if(!C){
         NoErr=0;
@@ -318,8 +347,6 @@ PGL(fitt)(const Point3ArrayPtr&  MyVector,
     }
     else C2 = C;
     if(C){
-      EkOld=SommeEk;
-      SommeEk=0;
       for(int i=0;i<MyVector->size();i++){
         real_t u_i ;
         Vector3 r_i = C->projectTo(MyVector->getAt(i),ub->getAt(i),u_i) ;
@@ -327,34 +354,87 @@ PGL(fitt)(const Point3ArrayPtr&  MyVector,
         ub->setAt(i,u_i);
       }
       if(CPbegin>deg+1){
-        double delta;
-        if((delta=fabs(C->getLength()-polygonLength))>oldLength*3/2)break;
+        if(fabs(C->getLength()-polygonLength)>oldLength*3/2) stop = true;
       }
     }
-    if(NoErr < 1)break;
-    if(C)localLength=C->getLength();
-    else localLength=FLT_MAX;
-    if(fabs(localLength-polygonLength)>oldLength) ok=0;
-    if(C)oldLength=fabs(localLength-polygonLength);
-    if(NoErr){
+    if(!stop){
+      if(NoErr < 1) stop = true;
+      else {
+        if(C)localLength=C->getLength();
+        else localLength=FLT_MAX;
+        if(fabs(localLength-polygonLength)>oldLength) ok=0;
+        if(C)oldLength=fabs(localLength-polygonLength);
+        if(NoErr){
 #ifdef GEOM_DEBUG
-      printf("< %2d >Fitting error : %f -*- Length Delta : %f\n",CPbegin,SommeEk,(localLength-polygonLength));
+          printf("< %2d >Fitting error : %f -*- Length Delta : %f\n",CPbegin,SommeEk,(localLength-polygonLength));
 #endif
-      if(SommeEk>(ErreurBound*k)&&ok){
-        backup=1;
-        Cold = C;
-        CPbegin++;
+          if(SommeEk>(ErreurBound*k)&&ok){
+            backup=1;
+            Cold = C;
+            CPbegin++;
+          }
+          else if(backup){
+            C = Cold;
+            backup=0;
+          }
+        }
+        stop = !((SommeEk>(ErreurBound*k)||NoErr<=0)&&ok);
       }
-      else if(backup){
-        C = Cold;
-        backup=0;
+    }
+    Step step = { C, SommeEk, CPbegin, stop };
+    steps.push_back(step);
+  }
+
+  /// Returns the curve obtained with at most \e nbPtCtrlMax control points.
+  NurbsCurvePtr result(int nbPtCtrlMax, real_t& SommeEk){
+    for(size_t i = 0; ; ++i){
+      if(i == steps.size()) iterate();
+      const Step& step = steps[i];
+      if(step.last || step.nextCtrlPoints > nbPtCtrlMax){
+        SommeEk = step.error;
+        return step.curve;
       }
     }
-  }while(((SommeEk>(ErreurBound*k)||NoErr<=0)&&ok)&&CPbegin<=nbPtCtrlMax);
-  if(!C){
-    return NurbsCurvePtr();
   }
-  return C;
+};
+
+NurbsCurvePtr
+PGL(fitt)(const Point3ArrayPtr&  MyVector,
+                   int deg,
+                   int CPbegin,
+                   int nbPtCtrlMax,
+                   real_t ErreurBound,
+                   int &  Nbloop,
+                   real_t & SommeEk){
+  FitTrajectory trajectory(MyVector,deg,CPbegin,ErreurBound);
+  return trajectory.result(nbPtCtrlMax,SommeEk);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Fitting results of a branch, kept to be reused along the compression.
+struct BranchFit {
+  FitTrajectory trajectory;
+  CurvatureProfile profile;
+  /// The curve described by \e profile.
+  NurbsCurvePtr profiled;
+};
+
+/// Returns the trajectory of \e fit, initialized with the given fitting parameters if needed.
+static FitTrajectory& branchTrajectory(BranchFit& fit, const Point3ArrayPtr& points,
+                                       int deg, int CPbegin, real_t ErreurBound){
+  if(!fit.trajectory.isValid() || fit.trajectory.deg != deg)
+    fit.trajectory = FitTrajectory(points,deg,CPbegin,ErreurBound);
+  return fit.trajectory;
+}
+
+/// Returns the curvature profile of \e C, computed once per branch.
+static const CurvatureProfile& curvatureProfile(BranchFit& fit, const NurbsCurvePtr& C){
+  if(fit.profiled != C){
+    fit.profile.compute(C);
+    fit.profiled = C;
+  }
+  return fit.profile;
 }
 
 /* ----------------------------------------------------------------------- */
@@ -363,7 +443,7 @@ Curve2DPtr BranchCompressor::DEFAULT_CROSS_SECTION;
 
 /* ----------------------------------------------------------------------- */
 
-BranchCompressor::BranchCompressor():__verbose(false),__roots(-1){
+BranchCompressor::BranchCompressor():__verbose(false),__roots(-1),__multithreaded(true){
   if(!DEFAULT_CROSS_SECTION){
     int slices = 6;
     Point2ArrayPtr pts(new Point2Array(slices+1));
@@ -397,69 +477,49 @@ BranchCompressor::setData(const std::vector<BranchInput>& i,
       cerr << "Length = " << _it2->first << ", Nb = " << _it2->second << endl;*/
 }
 
+/** Sorts \e i so that \e before(a,b) holds for no pair a after b.
+    Inputs equivalent for \e before are given in reverse order of \e i. */
+template<class Compare>
+static std::vector<BranchInput> sortBranches(const std::vector<BranchInput>& i, Compare before){
+  vector<BranchInput> res(i.rbegin(),i.rend());
+  std::stable_sort(res.begin(),res.end(),before);
+  return res;
+}
+
 std::vector<BranchInput>
 BranchCompressor::sortByIncSize(const std::vector<BranchInput>&i){
 //  cerr << "sortByIncreasingSize" << endl;
-  vector<BranchInput>::const_iterator _it1 = i.begin();
-  vector<BranchInput> res;
-  vector<BranchInput>::iterator _i1 = res.begin();
-
-  for(;_it1!=i.end();_it1++){
-    if(res.empty()){
-      res.push_back(*_it1);
-    }
-    else {
-      _i1 = res.begin();
-      while(_i1 != res.end() &&
-            _i1->points->size() > _it1->points->size()){
-        _i1++;
-      }
-      res.insert(_i1,*_it1);
-    }
-  }
-  return res;
+  return sortBranches(i,[](const BranchInput& a, const BranchInput& b){
+    return a.points->size() > b.points->size();
+  });
 }
 
 std::vector<BranchInput>
 BranchCompressor::sortByDecSize(const std::vector<BranchInput>&i)
 {
 //  cerr << "sortByDecreasingSize" << endl;
-  vector<BranchInput>::const_iterator _it1 = i.begin();
-  vector<BranchInput> res;
-  vector<BranchInput>::iterator _i1 = res.begin();
-
-  for(;_it1!=i.end();_it1++){
-    if(res.empty()){
-      res.push_back(*_it1);
-    }
-    else {
-      _i1 = res.begin();
-      while(_i1 != res.end() &&
-            _i1->points->size() < _it1->points->size()){
-        _i1++;
-      }
-      res.insert(_i1,*_it1);
-    }
-  }
-  return res;
+  return sortBranches(i,[](const BranchInput& a, const BranchInput& b){
+    return a.points->size() < b.points->size();
+  });
 }
 
 typedef pgl_hash_map<int,pair<int,int> > GraphMap;
 
-std::vector<BranchInput>
-BranchCompressor::sortByIncOrder(const std::vector<BranchInput>&i)
+/// Computes the order of each branch of \e i in \e graph.
+static void branchOrders(const std::vector<BranchInput>&i, GraphMap& graph, int& roots)
 {
-//  cerr << "sortByIncreasingOrder" << endl;
-  GraphMap graph;
-  for(std::vector<BranchInput>::const_iterator _it = i.begin(); _it != i.end(); _it++)
+  for(std::vector<BranchInput>::const_iterator _it = i.begin(); _it != i.end(); _it++){
     graph[_it->id] = pair<int,int>(_it->father,(_it->father <=0?0:-1));
-  stack<GraphMap::iterator> st;
+    if(_it->father <=0)roots= _it->id;
+  }
+  std::stack<GraphMap::iterator> st;
   for(GraphMap::iterator _it2 = graph.begin(); _it2 != graph.end(); _it2++){
     if(_it2->second.second == -1 ){
       int f = _it2->second.first;
       GraphMap::iterator _it3 = graph.find(f);
       while( _it3 != graph.end() && _it3->second.second == -1 ){
-        st.push(_it3);_it3 = graph.find(_it3->second.first);
+        st.push(_it3);
+        _it3 = graph.find(_it3->second.first);
       }
       int order = 0;
       if(_it3 != graph.end())order = _it3->second.second +1;
@@ -471,25 +531,19 @@ BranchCompressor::sortByIncOrder(const std::vector<BranchInput>&i)
       _it2->second.second = order;
     }
   }
-  vector<BranchInput>::const_iterator _it1 = i.begin();
-  vector<BranchInput> res;
-  vector<BranchInput>::iterator _i1 = res.begin();
+}
 
-  for(;_it1!=i.end();_it1++){
-    if(res.empty()){
-      res.push_back(*_it1);
-    }
-    else {
-      _i1 = res.begin();
-      while(_i1 != res.end() &&
-             (graph[_i1->id].second < graph[_it1->id].second ||
-             (graph[_i1->id].second == graph[_it1->id].second && _i1->points->size() > _it1->points->size()))){
-        _i1++;
-      }
-      res.insert(_i1,*_it1);
-    }
-  }
-  return res;
+std::vector<BranchInput>
+BranchCompressor::sortByIncOrder(const std::vector<BranchInput>&i)
+{
+//  cerr << "sortByIncreasingOrder" << endl;
+  GraphMap graph;
+  int roots = __roots;
+  branchOrders(i,graph,roots);
+  return sortBranches(i,[&graph](const BranchInput& a, const BranchInput& b){
+    int oa = graph.find(a.id)->second.second, ob = graph.find(b.id)->second.second;
+    return oa < ob || (oa == ob && a.points->size() > b.points->size());
+  });
 }
 
 std::vector<BranchInput>
@@ -497,48 +551,11 @@ BranchCompressor::sortByDecOrder(const std::vector<BranchInput>&i)
 {
 //  cerr << "sortByDecreasingOrder" << endl;
   GraphMap graph;
-  for(std::vector<BranchInput>::const_iterator _it = i.begin(); _it != i.end(); _it++){
-    graph[_it->id] = pair<int,int>(_it->father,(_it->father <=0?0:-1));
-    if(_it->father <=0)__roots= _it->id;
-  }
-  std::stack<GraphMap::iterator> st;
-  for(GraphMap::iterator _it2 = graph.begin(); _it2 != graph.end(); _it2++){
-    if(_it2->second.second == -1 ){
-      int f = _it2->second.first;
-      GraphMap::iterator _it3 = graph.find(f);
-      while( _it3 != graph.end() && _it3->second.second == -1 ){
-        st.push(_it3);
-        _it3 = graph.find(_it3->second.first);
-      }
-      int order = 0;
-      if(_it3 != graph.end())order = _it3->second.second +1;
-      while(!st.empty()){
-        _it3 = st.top();
-        _it3->second.second = order; order++;
-        st.pop();
-      }
-      _it2->second.second = order;
-    }
-  }
-  vector<BranchInput>::const_iterator _it1 = i.begin();
-  vector<BranchInput> res;
-  vector<BranchInput>::iterator _i1 = res.begin();
-
-  for(;_it1!=i.end();_it1++){
-    if(res.empty()){
-      res.push_back(*_it1);
-    }
-    else {
-      _i1 = res.begin();
-      while(_i1 != res.end() &&
-            (graph[_i1->id].second > graph[_it1->id].second ||
-             (graph[_i1->id].second == graph[_it1->id].second &&_i1->points->size() < _it1->points->size()))){
-        _i1++;
-      }
-      res.insert(_i1,*_it1);
-    }
-  }
-  return res;
+  branchOrders(i,graph,__roots);
+  return sortBranches(i,[&graph](const BranchInput& a, const BranchInput& b){
+    int oa = graph.find(a.id)->second.second, ob = graph.find(b.id)->second.second;
+    return oa > ob || (oa == ob && a.points->size() < b.points->size());
+  });
 }
 
 void BranchCompressor::clear()
@@ -728,6 +745,43 @@ BranchCompressor::compress(real_t taux,
     PR("Memory Ressource : %d - Data to use : %d\n",DataRemind,DataIn2);
     if(!__verbose)cout << "Generating 3D representation :\n"<<flush;
 
+    /** Ajustement anticipe des branches en parallele.
+        Les courbes sont calculees avec le budget initial et reprises
+        si besoin lors de la compression sequentielle. */
+    vector<BranchFit> fits(GeometryVector.size());
+    if(__multithreaded && option != 2 && DataIn2 > 0){
+      fittimer.start();
+      const real_t ratio = (real_t)DataRemind/(real_t)DataIn2;
+      size_t nbthreads = pgl_thread_count();
+      pgl_parallel_for(0,nbthreads,[&](size_t t){
+        // Branches are interleaved between threads to balance their sizes.
+        for(size_t b = t; b < GeometryVector.size(); b += nbthreads){
+          const Point3ArrayPtr& points = GeometryVector[b].points;
+          int k = points->size();
+          if(k < 3) continue;
+          int jj = k, deg;
+          if(jj < degre+1 )deg = jj - 1;
+          else {deg = degre;jj=degre+1;}
+          int nbPtCtrlMax = deg+1;
+          if(option==0){
+            real_t calcul = ( 3.0 * (real_t)k * ratio -(real_t)deg -1.0) / 5.0;
+            nbPtCtrlMax = (int)(calcul - ((real_t)sizeof(int))/(5.0*(real_t)sizeof(real_t)));
+          }
+          if(nbPtCtrlMax<deg+1 && ratio > 0 &&
+             k > (4.0 *(real_t)(deg + 1) +((real_t)sizeof(int)/(real_t)sizeof(real_t)))/(3.0*ratio))
+            nbPtCtrlMax = deg+1;
+          real_t SommeEk=0;
+          if(nbPtCtrlMax>=deg+1)
+            branchTrajectory(fits[b],points,deg,jj,ErreurBound).result(nbPtCtrlMax,SommeEk);
+          else if((real_t)k*ratio >= 4.0){
+            NurbsCurvePtr C = branchTrajectory(fits[b],points,deg,jj,ErreurBound).result(deg+1,SommeEk);
+            if(C)curvatureProfile(fits[b],C);
+          }
+        }
+      },nbthreads);
+      fittime += fittimer.stop();
+    }
+
 
     /** Compression de la geometrie de chaque branche */
 
@@ -782,7 +836,7 @@ BranchCompressor::compress(real_t taux,
 
           real_t SommeEk=0;
           fittimer.start();
-          C = fitt(MyVector,deg, jj, nbPtCtrlMax, ErreurBound, Nbloop,SommeEk );
+          C = branchTrajectory(fits[currentBranch],MyVector,deg,jj,ErreurBound).result(nbPtCtrlMax,SommeEk);
           fittime += fittimer.stop();
           SumError+=SommeEk;
           int localDataOut=sizeof(int);
@@ -835,9 +889,9 @@ BranchCompressor::compress(real_t taux,
 
             real_t SommeEk=0;
             fittimer.start();
-            C = fitt(MyVector, deg, deg+1, deg+1, ErreurBound, Nbloop, SommeEk);
+            C = branchTrajectory(fits[currentBranch],MyVector,deg,deg+1,ErreurBound).result(deg+1,SommeEk);
             // Methode utilisant la courbure generale
-            if(C)pts = discretizeWithCurvature(C,maxPoint);
+            if(C)pts = discretizeWithCurvature(C,curvatureProfile(fits[currentBranch],C),maxPoint);
             fittime += fittimer.stop();
           }
           if(!pts) {
@@ -992,28 +1046,42 @@ BranchCompressor::interConnection(ScenePtr& scene){
   for(std::vector<BranchInput>::const_iterator _iter = __inputs.begin();
   _iter != __inputs.end(); _iter++)
     graph[_iter->id] = _iter->father;
+  // Scene objects indexed as Scene::findSceneObjectId and Scene::findShapeId
+  // would find them, to avoid a search of the scene per connection.
+  pgl_hash_map<size_t,Shape3DPtr> objects;
+  pgl_hash_map<uint_t,ShapePtr> shapes;
+  for(Scene::iterator _it = scene->begin(); _it != scene->end(); _it++){
+    if(!*_it) continue;
+    objects.insert(pgl_hash_map<size_t,Shape3DPtr>::value_type((*_it)->SceneObject::getObjectId(),*_it));
+    ShapePtr sh = dynamic_pointer_cast<Shape>(*_it);
+    if(sh) shapes.insert(pgl_hash_map<uint_t,ShapePtr>::value_type(sh->getId(),sh));
+  }
   int id = 0;
   int father = 0;
   Vector3 origin;
   for(Scene::iterator _it = scene->begin(); _it != scene->end(); _it++){
     id = (*_it)->getObjectId();
     father = graph[id];
-    while(father > 0 && !(scene->findSceneObjectId(father)))
+    while(father > 0 && objects.find((uint_t)father) == objects.end())
           father = graph[father];
     if(father > 0){
-      ShapePtr sh = dynamic_pointer_cast<Shape>(scene->findSceneObjectId(id));
+      pgl_hash_map<size_t,Shape3DPtr>::const_iterator _obj = objects.find((uint_t)id);
+      ShapePtr sh;
+      if(_obj != objects.end()) sh = dynamic_pointer_cast<Shape>(_obj->second);
+      pgl_hash_map<uint_t,ShapePtr>::const_iterator _father = shapes.find(father);
+      ShapePtr fsh = (_father == shapes.end() ? ShapePtr() : _father->second);
       if(sh){
         ExtrusionPtr ex = dynamic_pointer_cast<Extrusion>(sh->getGeometry());
         if(ex){
           if(ex->getAxis()->isExplicit()){
             PolylinePtr pol = dynamic_pointer_cast<Polyline>(ex->getAxis());
             if(pol)pol->getPointList()->setAt(0,
-              connectionTo(pol->getPointList()->getAt(0),scene,father));
+              connectionTo(pol->getPointList()->getAt(0),fsh));
           }
           else {
             BezierCurvePtr bez = dynamic_pointer_cast<BezierCurve>(ex->getAxis());
             if(bez)bez->getCtrlPointList()->setAt(0,
-              connectionTo(bez->getCtrlPointList()->getAt(0),scene,father));
+              connectionTo(bez->getCtrlPointList()->getAt(0),fsh));
           }
         }
         else {
@@ -1040,7 +1108,7 @@ BranchCompressor::interConnection(ScenePtr& scene){
           if(cone){
             real_t height = cone->getHeight();
             Vector3 pt = o+h*height;
-            Vector3 newo = connectionTo(o,scene,father);
+            Vector3 newo = connectionTo(o,fsh);
             if(norm(newo - o) > GEOM_EPSILON){
               Vector3 h = pt-newo;
               real_t length = h.normalize();
@@ -1069,19 +1137,13 @@ BranchCompressor::interConnection(ScenePtr& scene){
 
 Vector4
 BranchCompressor::connectionTo(const Vector4& p,
-                               const ScenePtr& scene,
-                               int fid){
-  return Vector4(connectionTo(p.project(),scene,fid),1);
+                               const ShapePtr& sh){
+  return Vector4(connectionTo(p.project(),sh),1);
 }
 
 Vector3
 BranchCompressor::connectionTo(const Vector3& p,
-                               const ScenePtr& scene,
-                               int fid){
-  if(fid <= 0 || !scene){
-    return p;
-  }
-  ShapePtr sh = dynamic_pointer_cast<Shape>(scene->findShapeId(fid));
+                               const ShapePtr& sh){
   if(!sh) {
     return p;
   }
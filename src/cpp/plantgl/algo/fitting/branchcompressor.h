@@ -74,6 +74,11 @@ public :
     ~BranchCompressor(){};
 
     void setVerbose(bool b) { __verbose = b; }
+
+    /// Whether the branches are fitted in parallel before being compressed.
+    bool isMultiThreaded() const { return __multithreaded; }
+    void setMultiThreaded(bool value) { __multithreaded = value; }
+
     void setData(const std::vector<BranchInput>&, int sorttype = 0);
     void clear();
 
@@ -98,15 +103,15 @@ public :
 
 private :
   int __roots;
+  bool __multithreaded;
 
   void interConnection(ScenePtr& scene);
 
+  /// Returns the point of the branch geometry of \e father closest to \e p.
   Vector3 connectionTo(const Vector3& p,
-                       const ScenePtr& scene,
-                       int fid);
+                       const ShapePtr& father);
   Vector4 connectionTo(const Vector4& p,
-                       const ScenePtr& scene,
-                       int fid);
+                       const ShapePtr& father);
 
   void addScene(ScenePtr scene, int c_branch,LineicModelPtr axis) const;
   void addScene(ScenePtr scene, int c_branch,GeometryPtr geom) const;
@@ -0,0 +1,544 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+#include "convexhull.h"
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <algorithm>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Twice the signed area of the triangle (o,a,b), positive if counter-clockwise.
+static inline real_t orientation2D(const Vector2& o, const Vector2& a, const Vector2& b)
+{ return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x()); }
+
+/// Lexicographic order on x then y.
+static inline bool lessXY(const Vector2& a, const Vector2& b)
+{ return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y()); }
+
+ConvexHull2D::ConvexHull2D( real_t tolerance ) :
+    __tolerance(tolerance),
+    __epsilon(0)
+{
+}
+
+ConvexHull2D::ConvexHull2D( const Point2ArrayPtr& points, const Index& group, real_t tolerance ) :
+    __tolerance(tolerance),
+    __epsilon(0)
+{
+    insert(points, group);
+}
+
+void ConvexHull2D::insert( const Vector2& point )
+{
+    __pending.push_back(point);
+}
+
+void ConvexHull2D::insert( const Point2ArrayPtr& points, const Index& group )
+{
+    if (!points) return;
+    if (group.empty()) __pending.insert(__pending.end(), points->begin(), points->end());
+    else {
+        __pending.reserve(__pending.size() + group.size());
+        for (Index::const_iterator it = group.begin(); it != group.end(); ++it)
+            __pending.push_back(points->getAt(*it));
+    }
+}
+
+void ConvexHull2D::clear( )
+{
+    __epsilon = 0;
+    __vertices.clear();
+    __pending.clear();
+}
+
+void ConvexHull2D::update( )
+{
+    if (__pending.empty()) return;
+    std::vector<Vector2> points;
+    points.reserve(__vertices.size() + __pending.size());
+    points.insert(points.end(), __vertices.begin(), __vertices.end());
+    points.insert(points.end(), __pending.begin(), __pending.end());
+    __pending.clear();
+
+    std::sort(points.begin(), points.end(), lessXY);
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    size_t nbpoints = points.size();
+
+    // Points are sorted along x: the extent along y is computed.
+    real_t ymin = points[0].y(), ymax = points[0].y();
+    for (std::vector<Vector2>::const_iterator it = points.begin() + 1; it != points.end(); ++it) {
+        if (it->y() < ymin) ymin = it->y();
+        else if (it->y() > ymax) ymax = it->y();
+    }
+    __epsilon = __tolerance * std::max(points.back().x() - points.front().x(), ymax - ymin);
+
+    if (nbpoints < 3) {
+        __vertices.swap(points);
+        return;
+    }
+
+    // Andrew's monotone chain: lower then upper hull, collinear points removed.
+    __vertices.resize(2 * nbpoints);
+    size_t k = 0;
+    for (size_t i = 0; i < nbpoints; ++i) {
+        while (k >= 2 && orientation2D(__vertices[k-2], __vertices[k-1], points[i]) <= 0) --k;
+        __vertices[k++] = points[i];
+    }
+    for (size_t i = nbpoints - 1, lower = k + 1; i > 0; --i) {
+        while (k >= lower && orientation2D(__vertices[k-2], __vertices[k-1], points[i-1]) <= 0) --k;
+        __vertices[k++] = points[i-1];
+    }
+    __vertices.resize(k - 1);
+
+    // Start from the lowest vertex, as Fit::convexPolyline.
+    std::vector<Vector2>::iterator lowest = __vertices.begin();
+    for (std::vector<Vector2>::iterator it = __vertices.begin() + 1; it != __vertices.end(); ++it)
+        if (it->y() < lowest->y() || (it->y() == lowest->y() && it->x() < lowest->x())) lowest = it;
+    std::rotate(__vertices.begin(), lowest, __vertices.end());
+}
+
+const std::vector<Vector2>& ConvexHull2D::getVertices( )
+{
+    update();
+    return __vertices;
+}
+
+bool ConvexHull2D::contains( const Vector2& point )
+{
+    update();
+    size_t nbvertices = __vertices.size();
+    if (nbvertices == 0) return false;
+    if (nbvertices == 1) return normSquared(point - __vertices[0]) <= __epsilon * __epsilon;
+    if (nbvertices == 2) {
+        // A segment: distance to the segment.
+        const Vector2& a = __vertices[0];
+        Vector2 ab = __vertices[1] - a;
+        real_t t = std::max<real_t>(0, std::min<real_t>(1, dot(point - a, ab) / normSquared(ab)));
+        return normSquared(point - a - ab * t) <= __epsilon * __epsilon;
+    }
+    for (size_t i = 0; i < nbvertices; ++i) {
+        const Vector2& a = __vertices[i];
+        const Vector2& b = __vertices[(i + 1) % nbvertices];
+        if (orientation2D(a, b, point) < -__epsilon * norm(b - a)) return false;
+    }
+    return true;
+}
+
+Point2ArrayPtr ConvexHull2D::getPointList( )
+{
+    update();
+    return Point2ArrayPtr(new Point2Array(__vertices.begin(), __vertices.end()));
+}
+
+Polyline2DPtr ConvexHull2D::getPolyline( )
+{
+    update();
+    if (__vertices.size() < 2) return Polyline2DPtr();
+    return Polyline2DPtr(new Polyline2D(getPointList()));
+}
+
+/* ----------------------------------------------------------------------- */
+
+ConvexHull3D::ConvexHull3D( real_t tolerance ) :
+    __tolerance(tolerance),
+    __epsilon(0),
+    __pendingRank(0),
+    __visit(0)
+{
+}
+
+ConvexHull3D::ConvexHull3D( const Point3ArrayPtr& points, const Index& group, real_t tolerance ) :
+    __tolerance(tolerance),
+    __epsilon(0),
+    __pendingRank(0),
+    __visit(0)
+{
+    insert(points, group);
+}
+
+void ConvexHull3D::clear( )
+{
+    __epsilon = 0;
+    __points.clear();
+    __faces.clear();
+    __freeFaces.clear();
+    __pending.clear();
+    __pendingRank = 0;
+}
+
+uint_t ConvexHull3D::addPoint( const Vector3& point )
+{
+    if (__points.empty()) __lower = __upper = point;
+    else {
+        __lower = Min(__lower, point);
+        __upper = Max(__upper, point);
+    }
+    __points.push_back(point);
+    Vector3 extent = __upper - __lower;
+    __epsilon = __tolerance * std::max(std::max(extent.x(), extent.y()), extent.z());
+    return uint_t(__points.size() - 1);
+}
+
+uint_t ConvexHull3D::addFace( uint_t a, uint_t b, uint_t c )
+{
+    uint_t id;
+    if (__freeFaces.empty()) {
+        id = uint_t(__faces.size());
+        __faces.push_back(Face());
+    }
+    else {
+        id = __freeFaces.back();
+        __freeFaces.pop_back();
+    }
+    Face& face = __faces[id];
+    face.vertices[0] = a; face.vertices[1] = b; face.vertices[2] = c;
+    face.neighbors[0] = face.neighbors[1] = face.neighbors[2] = UINT32_MAX;
+    const Vector3& pa = __points[a];
+    const Vector3& pb = __points[b];
+    const Vector3& pc = __points[c];
+    real_t ux = pb.x() - pa.x(), uy = pb.y() - pa.y(), uz = pb.z() - pa.z();
+    real_t vx = pc.x() - pa.x(), vy = pc.y() - pa.y(), vz = pc.z() - pa.z();
+    real_t nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+    real_t length = sqrt(nx * nx + ny * ny + nz * nz);
+    if (length > 0) { nx /= length; ny /= length; nz /= length; }
+    face.normal = Vector3(nx, ny, nz);
+    face.offset = nx * pa.x() + ny * pa.y() + nz * pa.z();
+    face.outside.clear();
+    face.visit = 0;
+    face.removed = false;
+    return id;
+}
+
+bool ConvexHull3D::assign( uint_t p, const std::vector<uint_t>& faces )
+{
+    const Vector3& point = __points[p];
+    for (std::vector<uint_t>::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+        Face& face = __faces[*it];
+        if (!face.removed && distance(face, point) > __epsilon) {
+            face.outside.push_back(p);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConvexHull3D::init( )
+{
+    if (__pending.size() < 4) return false;
+
+    // Two most distant points among the extreme points along the axes.
+    uint_t extremes[6];
+    for (int i = 0; i < 6; ++i) extremes[i] = __pending[0];
+    for (std::vector<uint_t>::const_iterator it = __pending.begin(); it != __pending.end(); ++it) {
+        const Vector3& p = __points[*it];
+        for (int j = 0; j < 3; ++j) {
+            if (p[j] < __points[extremes[2*j]][j]) extremes[2*j] = *it;
+            if (p[j] > __points[extremes[2*j+1]][j]) extremes[2*j+1] = *it;
+        }
+    }
+    uint_t a = extremes[0], b = extremes[1];
+    real_t maxdist = -1;
+    for (int i = 0; i < 6; ++i)
+        for (int j = i + 1; j < 6; ++j) {
+            real_t d = normSquared(__points[extremes[i]] - __points[extremes[j]]);
+            if (d > maxdist) { maxdist = d; a = extremes[i]; b = extremes[j]; }
+        }
+    __pendingRank = 1;
+    __pendingSpan[0] = a;
+    if (sqrt(maxdist) <= __epsilon) return false;
+
+    // Farthest point from the line (a,b).
+    Vector3 direction = __points[b] - __points[a];
+    direction.normalize();
+    uint_t c = a;
+    maxdist = 0;
+    for (std::vector<uint_t>::const_iterator it = __pending.begin(); it != __pending.end(); ++it) {
+        real_t d = norm(cross(__points[*it] - __points[a], direction));
+        if (d > maxdist) { maxdist = d; c = *it; }
+    }
+    __pendingRank = 2;
+    __pendingSpan[1] = b;
+    if (maxdist <= __epsilon) return false;
+
+    // Farthest point from the plane (a,b,c).
+    uint_t base = addFace(a, b, c);
+    uint_t d = a;
+    maxdist = 0;
+    for (std::vector<uint_t>::const_iterator it = __pending.begin(); it != __pending.end(); ++it) {
+        real_t dist = fabs(distance(__faces[base], __points[*it]));
+        if (dist > maxdist) { maxdist = dist; d = *it; }
+    }
+    if (maxdist <= __epsilon) {
+        __pendingRank = 3;
+        __pendingSpan[2] = c;
+        __faces.clear();
+        return false;
+    }
+    if (distance(__faces[base], __points[d]) > 0) {
+        std::swap(b, c);
+        __faces.clear();
+        base = addFace(a, b, c);
+    }
+
+    // The tetrahedron, d being below (a,b,c).
+    std::vector<uint_t> faces(4);
+    faces[0] = base;
+    faces[1] = addFace(a, d, b);
+    faces[2] = addFace(b, d, c);
+    faces[3] = addFace(c, d, a);
+    pgl_hash_map<uint64_t, std::pair<uint_t, int> > edges;
+    for (int i = 0; i < 4; ++i)
+        for (int k = 0; k < 3; ++k) {
+            const Face& face = __faces[faces[i]];
+            edges[uint64_t(face.vertices[k]) << 32 | face.vertices[(k + 1) % 3]] = std::make_pair(faces[i], k);
+        }
+    for (int i = 0; i < 4; ++i)
+        for (int k = 0; k < 3; ++k) {
+            Face& face = __faces[faces[i]];
+            face.neighbors[k] = edges[uint64_t(face.vertices[(k + 1) % 3]) << 32 | face.vertices[k]].first;
+        }
+
+    for (std::vector<uint_t>::const_iterator it = __pending.begin(); it != __pending.end(); ++it)
+        assign(*it, faces);
+    __pending.clear();
+    __pendingRank = 0;
+    expand(faces);
+    return true;
+}
+
+bool ConvexHull3D::extendsPending( const Vector3& point ) const
+{
+    if (__pendingRank == 0) return true;
+    const Vector3& a = __points[__pendingSpan[0]];
+    if (__pendingRank == 1) return norm(point - a) > __epsilon;
+    Vector3 direction = __points[__pendingSpan[1]] - a;
+    if (__pendingRank == 2) return norm(cross(point - a, direction)) > __epsilon * norm(direction);
+    Vector3 normal = cross(direction, __points[__pendingSpan[2]] - a);
+    return fabs(dot(point - a, normal)) > __epsilon * norm(normal);
+}
+
+void ConvexHull3D::expand( const std::vector<uint_t>& faces )
+{
+    std::vector<uint_t> stack(faces.begin(), faces.end());
+    std::vector<uint_t> visible, candidates, newfaces;
+    // Horizon edges (a,b) with the face beyond them.
+    struct HorizonEdge { uint_t a, b, beyond; };
+    std::vector<HorizonEdge> horizon;
+    pgl_hash_map<uint_t, uint_t> startingAt;
+
+    while (!stack.empty()) {
+        uint_t current = stack.back();
+        stack.pop_back();
+        if (__faces[current].removed || __faces[current].outside.empty()) continue;
+
+        // The farthest outside point.
+        const std::vector<uint_t>& outside = __faces[current].outside;
+        uint_t apex = outside[0];
+        real_t maxdist = distance(__faces[current], __points[apex]);
+        for (std::vector<uint_t>::const_iterator it = outside.begin() + 1; it != outside.end(); ++it) {
+            real_t d = distance(__faces[current], __points[*it]);
+            if (d > maxdist) { maxdist = d; apex = *it; }
+        }
+        const Vector3& p = __points[apex];
+
+        // The faces visible from the apex are connected: they are found from the current one.
+        // They are tested without tolerance so that the cone remains convex.
+        ++__visit;
+        visible.clear();
+        horizon.clear();
+        visible.push_back(current);
+        __faces[current].visit = __visit;
+        for (size_t i = 0; i < visible.size(); ++i) {
+            uint_t f = visible[i];
+            for (int k = 0; k < 3; ++k) {
+                uint_t n = __faces[f].neighbors[k];
+                Face& neighbor = __faces[n];
+                if (neighbor.visit == __visit) continue;
+                if (distance(neighbor, p) > 0) {
+                    neighbor.visit = __visit;
+                    visible.push_back(n);
+                }
+                else {
+                    HorizonEdge edge = { __faces[f].vertices[k], __faces[f].vertices[(k + 1) % 3], n };
+                    horizon.push_back(edge);
+                }
+            }
+        }
+
+        candidates.clear();
+        for (std::vector<uint_t>::const_iterator it = visible.begin(); it != visible.end(); ++it) {
+            Face& face = __faces[*it];
+            for (std::vector<uint_t>::const_iterator itp = face.outside.begin(); itp != face.outside.end(); ++itp)
+                if (*itp != apex) candidates.push_back(*itp);
+            face.outside.clear();
+            face.removed = true;
+            __freeFaces.push_back(*it);
+        }
+
+        // The cone from the horizon to the apex.
+        newfaces.clear();
+        startingAt.clear();
+        for (std::vector<HorizonEdge>::const_iterator it = horizon.begin(); it != horizon.end(); ++it) {
+            uint_t f = addFace(it->a, it->b, apex);
+            Face& beyond = __faces[it->beyond];
+            // The edge is found by its vertices since the visible faces may already be reused.
+            for (int k = 0; k < 3; ++k)
+                if (beyond.vertices[k] == it->b && beyond.vertices[(k + 1) % 3] == it->a) { beyond.neighbors[k] = f; break; }
+            __faces[f].neighbors[0] = it->beyond;
+            startingAt[it->a] = f;
+            newfaces.push_back(f);
+        }
+        for (std::vector<uint_t>::const_iterator it = newfaces.begin(); it != newfaces.end(); ++it) {
+            pgl_hash_map<uint_t, uint_t>::const_iterator next = startingAt.find(__faces[*it].vertices[1]);
+            if (next == startingAt.end()) continue;
+            __faces[*it].neighbors[1] = next->second;
+            __faces[next->second].neighbors[2] = *it;
+        }
+
+        for (std::vector<uint_t>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+            assign(*it, newfaces);
+        for (std::vector<uint_t>::const_iterator it = newfaces.begin(); it != newfaces.end(); ++it)
+            if (!__faces[*it].outside.empty()) stack.push_back(*it);
+    }
+}
+
+bool ConvexHull3D::insert( const Vector3& point )
+{
+    uint_t p = addPoint(point);
+    if (!isValid()) {
+        // init is only tried again if the point can give a volume to the pending points.
+        __pending.push_back(p);
+        if (extendsPending(point)) init();
+        return true;
+    }
+    for (uint_t f = 0; f < __faces.size(); ++f) {
+        Face& face = __faces[f];
+        if (!face.removed && distance(face, point) > __epsilon) {
+            face.outside.push_back(p);
+            expand(std::vector<uint_t>(1, f));
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConvexHull3D::insert( const Point3ArrayPtr& points, const Index& group )
+{
+    if (!points) return;
+    size_t nbpoints = group.empty() ? points->size() : group.size();
+    __points.reserve(__points.size() + nbpoints);
+    bool valid = isValid();
+    std::vector<uint_t> faces;
+    if (valid) {
+        for (uint_t f = 0; f < __faces.size(); ++f)
+            if (!__faces[f].removed) faces.push_back(f);
+    }
+    for (size_t i = 0; i < nbpoints; ++i) {
+        uint_t p = addPoint(points->getAt(group.empty() ? i : group[i]));
+        if (valid) assign(p, faces);
+        else __pending.push_back(p);
+    }
+    if (valid) expand(faces);
+    else init();
+}
+
+bool ConvexHull3D::contains( const Vector3& point ) const
+{
+    if (!isValid()) return false;
+    for (std::vector<Face>::const_iterator it = __faces.begin(); it != __faces.end(); ++it)
+        if (!it->removed && distance(*it, point) > __epsilon) return false;
+    return true;
+}
+
+TriangleSetPtr ConvexHull3D::getMesh( ) const
+{
+    if (!isValid()) return TriangleSetPtr();
+    Point3ArrayPtr points(new Point3Array());
+    Index3ArrayPtr indices(new Index3Array());
+    indices->reserve(getFaceNb());
+    pgl_hash_map<uint_t, uint_t> pointids;
+    for (std::vector<Face>::const_iterator it = __faces.begin(); it != __faces.end(); ++it) {
+        if (it->removed) continue;
+        Index3 triangle;
+        for (int k = 0; k < 3; ++k) {
+            std::pair<pgl_hash_map<uint_t, uint_t>::iterator, bool> id =
+                pointids.insert(std::make_pair(it->vertices[k], uint_t(points->size())));
+            if (id.second) points->push_back(__points[it->vertices[k]]);
+            triangle[k] = id.first->second;
+        }
+        indices->push_back(triangle);
+    }
+    return TriangleSetPtr(new TriangleSet(points, indices, true, true, true));
+}
+
+/* ----------------------------------------------------------------------- */
+
+GeometryArrayPtr
+PGL(pointsets_convex_hulls)(const Point3ArrayPtr& points, const IndexArrayPtr& groups)
+{
+    GeometryArrayPtr result(new GeometryArray(groups->size()));
+    pgl_parallel_for(0, groups->size(), [&](size_t i) {
+        const Index& group = groups->getAt(i);
+        if (group.empty()) return;
+        ConvexHull3D hull(points, group);
+        result->setAt(i, GeometryPtr(hull.getMesh()));
+    });
+    return result;
+}
+
+Curve2DArrayPtr
+PGL(pointsets_convex_polylines)(const Point2ArrayPtr& points, const IndexArrayPtr& groups)
+{
+    Curve2DArrayPtr result(new Curve2DArray(groups->size()));
+    pgl_parallel_for(0, groups->size(), [&](size_t i) {
+        const Index& group = groups->getAt(i);
+        if (group.empty()) return;
+        ConvexHull2D hull(points, group);
+        result->setAt(i, Curve2DPtr(hull.getPolyline()));
+    });
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
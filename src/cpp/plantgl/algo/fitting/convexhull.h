@@ -0,0 +1,264 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file convexhull.h
+    \brief Incremental convex hulls of 2D and 3D point sets.
+*/
+
+#ifndef __convexhull_h__
+#define __convexhull_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/scenegraph/container/geometryarray2.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/geometry/polyline.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ConvexHull2D
+   \brief Convex hull of a growing set of 2D points.
+          Inserted points are kept aside and merged with the vertices of the
+          hull when it is requested, using a monotone chain over these points only.
+          Points closer to the hull than the tolerance, relative to the extent of the
+          hull, are considered inside. Unlike Fit::convexPolyline, it does not depend on Qhull and is thread safe.
+*/
+
+class ALGO_API ConvexHull2D
+{
+public:
+
+    /// Constructor.
+    ConvexHull2D( real_t tolerance = GEOM_EPSILON );
+
+    /// Constructs the hull of the points of \e group in \e points (all of them if \e group is empty).
+    ConvexHull2D( const Point2ArrayPtr& points, const Index& group = Index(), real_t tolerance = GEOM_EPSILON );
+
+    /// Destructor.
+    virtual ~ConvexHull2D( ) {}
+
+    /// Inserts the point \e point.
+    void insert( const Vector2& point );
+
+    /// Inserts the points of \e group in \e points (all of them if \e group is empty).
+    void insert( const Point2ArrayPtr& points, const Index& group = Index() );
+
+    /// Removes all the points.
+    void clear( );
+
+    /// Returns the vertices of the hull in counter-clockwise order, starting from the lowest one.
+    const std::vector<Vector2>& getVertices( );
+
+    /// Returns whether \e point is inside the hull or on its boundary.
+    bool contains( const Vector2& point );
+
+    /// Returns the vertices of the hull as an array.
+    Point2ArrayPtr getPointList( );
+
+    /// Returns the contour of the hull, or a null pointer if it has less than 2 vertices.
+    Polyline2DPtr getPolyline( );
+
+protected:
+
+    /// Merges the inserted points with the vertices of the hull.
+    void update( );
+
+    real_t __tolerance;
+
+    /// The tolerance scaled by the extent of the hull.
+    real_t __epsilon;
+
+    /// The vertices of the hull.
+    std::vector<Vector2> __vertices;
+
+    /// The points inserted since the last update.
+    std::vector<Vector2> __pending;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ConvexHull3D
+   \brief Convex hull of a growing set of 3D points.
+          The hull is built by the quickhull algorithm: each face keeps the points
+          outside of it and is replaced, with the faces visible from its farthest
+          point, by the cone of the horizon to this point. Points inserted later are
+          assigned to a face they are outside of and processed the same way, so that
+          growing sets do not require to rebuild the hull. Points closer to the faces than
+          the tolerance, relative to the extent of the bounding box of the points, are
+          considered inside.
+          Unlike Fit::convexHull, it does not depend on Qhull and is thread safe.
+*/
+
+class ALGO_API ConvexHull3D
+{
+public:
+
+    /// Constructor.
+    ConvexHull3D( real_t tolerance = GEOM_EPSILON );
+
+    /// Constructs the hull of the points of \e group in \e points (all of them if \e group is empty).
+    ConvexHull3D( const Point3ArrayPtr& points, const Index& group = Index(), real_t tolerance = GEOM_EPSILON );
+
+    /// Destructor.
+    virtual ~ConvexHull3D( ) {}
+
+    /** Inserts the point \e point. Returns false if the point is inside the hull.
+        Points are kept aside until the hull has a volume. */
+    bool insert( const Vector3& point );
+
+    /// Inserts the points of \e group in \e points (all of them if \e group is empty).
+    void insert( const Point3ArrayPtr& points, const Index& group = Index() );
+
+    /// Removes all the points.
+    void clear( );
+
+    /// Returns whether the hull has a volume.
+    inline bool isValid( ) const { return __faces.size() > __freeFaces.size(); }
+
+    /// Returns the number of triangles of the hull.
+    inline uint_t getFaceNb( ) const { return uint_t(__faces.size() - __freeFaces.size()); }
+
+    /// Returns whether \e point is inside the hull or on its boundary.
+    bool contains( const Vector3& point ) const;
+
+    /** Returns the triangles of the hull, with outward normals,
+        or a null pointer if the hull has no volume. */
+    TriangleSetPtr getMesh( ) const;
+
+protected:
+
+    /// A triangle of the hull.
+    struct Face {
+        /// The vertices, counter-clockwise seen from outside.
+        uint_t vertices[3];
+        /// The face sharing the edge (vertices[i],vertices[i+1]).
+        uint_t neighbors[3];
+        /// The unit outward normal.
+        Vector3 normal;
+        /// The distance of the plane of the face to the origin along the normal.
+        real_t offset;
+        /// The points outside of the face which are not assigned to another face.
+        std::vector<uint_t> outside;
+        /// Visit mark used to find the faces visible from a point.
+        uint_t visit;
+        bool removed;
+    };
+
+    /// Returns the signed distance of the point \e p to the plane of \e face.
+    static inline real_t distance( const Face& face, const Vector3& p )
+    { return face.normal.x() * p.x() + face.normal.y() * p.y() + face.normal.z() * p.z() - face.offset; }
+
+    /// Stores \e point and returns its index.
+    uint_t addPoint( const Vector3& point );
+
+    /// Creates the face (a,b,c) and returns its index.
+    uint_t addFace( uint_t a, uint_t b, uint_t c );
+
+    /// Assigns the point \e p to the first face of \e faces it is outside of. Returns false if there is none.
+    bool assign( uint_t p, const std::vector<uint_t>& faces );
+
+    /// Builds the initial tetrahedron from the pending points. Returns false if they have no volume.
+    bool init( );
+
+    /** Returns whether \e point is out of the point, line or plane spanned by the
+        pending points when init last failed, so that init may succeed with it. */
+    bool extendsPending( const Vector3& point ) const;
+
+    /// Adds to the hull the points outside of the faces.
+    void expand( const std::vector<uint_t>& faces );
+
+    real_t __tolerance;
+
+    /// The tolerance scaled by the extent of the points.
+    real_t __epsilon;
+
+    /// The bounding box of the points.
+    Vector3 __lower, __upper;
+
+    std::vector<Vector3> __points;
+
+    std::vector<Face> __faces;
+
+    /// Indices of the removed faces, reused by new faces.
+    std::vector<uint_t> __freeFaces;
+
+    /// Points inserted while the hull has no volume.
+    std::vector<uint_t> __pending;
+
+    /// Number of pending points spanning all the others when init last failed (0 if unknown).
+    int __pendingRank;
+
+    /// These points.
+    uint_t __pendingSpan[3];
+
+    uint_t __visit;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/** Convex hulls of the groups of \e points, computed in parallel.
+    The hulls are TriangleSet, or null for groups without volume. */
+ALGO_API GeometryArrayPtr
+pointsets_convex_hulls(const Point3ArrayPtr& points, const IndexArrayPtr& groups);
+
+/** Convex contours of the groups of 2D \e points, computed in parallel.
+    The contours are Polyline2D, or null for groups of less than 2 distinct points. */
+ALGO_API Curve2DArrayPtr
+pointsets_convex_polylines(const Point2ArrayPtr& points, const IndexArrayPtr& groups);
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __convexhull_h__
+#endif
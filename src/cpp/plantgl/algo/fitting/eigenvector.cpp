@@ -47,6 +47,7 @@
 
 #include "eigenvector.h"
 #include <plantgl/math/util_math.h>
+#include <plantgl/tool/util_parallel.h>
 
 PGL_USING_NAMESPACE
 
@@ -1296,49 +1297,31 @@ vecteurs propres distincts :
 */
 void PGL(Laxi_Vecpro) (double mat3x3[3][3],double vect[3][3],short *marqueur)
    {
-   double   pc[4], val[3];
-
-   /* initialisation */
-   val[0] = val[1] = val[2] = VInfini ;
-   vect[0][0] = vect[0][1] = vect[0][2] = VInfini ;
-   vect[1][0] = vect[1][1] = vect[1][2] = VInfini ;
-   vect[2][0] = vect[2][1] = vect[2][2] = VInfini ;
-
-   marqueur[0] = 0;
-   marqueur[1] = 0;
-   marqueur[2] = 0;
-   /* traitement */
-   Laxi_Polynom (mat3x3,pc) ;
-   Laxi_VecteursPropres (mat3x3,pc,val,vect) ;
+   Vector3 val;
+   Matrix3 vecpro;
+   short j;
 
-   if ( vect[1][0] != VInfini )
-      if (( vect[0][0] != VInfini ) &&
-          ( fabs(vect[1][0]-vect[0][0]) < VZero ) && ( fabs(vect[1][1]-vect[0][1]) < VZero ) && ( fabs(vect[1][2]-vect[0][2]) < VZero ))
-         {
-         vect[1][0] = vect[1][1] = vect[1][2] = VInfini ;
-         }
+   /* la matrice est symetrique : decomposition sous forme close */
+   symmetricEigenDecomposition (Matrix3(mat3x3[0][0],mat3x3[0][1],mat3x3[0][2],
+                                        mat3x3[1][0],mat3x3[1][1],mat3x3[1][2],
+                                        mat3x3[2][0],mat3x3[2][1],mat3x3[2][2]),val,vecpro);
 
-   if ( vect[2][0] != VInfini )
+   for (j = 0; j < 3; j++)
       {
-      if (( vect[0][0] != VInfini ) &&
-          ( fabs(vect[2][0]-vect[0][0]) < VZero ) && ( fabs(vect[2][1]-vect[0][1]) < VZero ) && ( fabs(vect[2][2]-vect[0][2]) < VZero ))
+      if ( val[j] != 0. )
          {
-         vect[2][0] = vect[2][1] = vect[2][2] = VInfini ;
+         vect[j][0] = vecpro(0,j);
+         vect[j][1] = vecpro(1,j);
+         vect[j][2] = vecpro(2,j);
+         Laxi_VectNorm (val[j], vect[j]);
+         marqueur[j] = 1;
          }
-      if (( vect[1][0] != VInfini ) &&
-          ( fabs(vect[2][0]-vect[1][0]) < VZero ) && ( fabs(vect[2][1]-vect[1][1]) < VZero ) && ( fabs(vect[2][2]-vect[1][2]) < VZero ))
+      else
          {
-         vect[2][0] = vect[2][1] = vect[2][2] = VInfini ;
+         vect[j][0] = vect[j][1] = vect[j][2] = VInfini ;
+         marqueur[j] = 0;
          }
       }
-
-   if (vect[0][0] < VInfini)
-      marqueur[0] = 1;
-   if (vect[1][0] < VInfini)
-      marqueur[1] = 1;
-   if (vect[2][0] < VInfini)
-      marqueur[2] = 1;
-
    }
 
 
@@ -1569,3 +1552,222 @@ void PGL(Laxi_ComputeInertia) (Point3ArrayPtr pts,float vpvec[3][3],float vpint[
    }
 
 
+
+/* ----------------------------------------------------------------------- */
+
+/*
+Decomposition des matrices symetriques 3x3 sous forme close
+(voir D. Eberly, A Robust Eigensolver for 3x3 Symmetric Matrices).
+Les matrices sont traitees par blocs stockes par composante, afin que
+le calcul des valeurs propres soit vectorisable par le compilateur.
+*/
+
+#define EIGEN_BLOCK_SIZE 64
+
+static inline real_t dot3(const real_t * a, const real_t * b)
+{ return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+static inline void cross3(const real_t * a, const real_t * b, real_t * r)
+{
+    r[0] = a[1] * b[2] - a[2] * b[1];
+    r[1] = a[2] * b[0] - a[0] * b[2];
+    r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/// r = a.v for the symmetric matrix a given by its upper triangle (a00, a01, a02, a11, a12, a22).
+static inline void product3(const real_t * a, const real_t * v, real_t * r)
+{
+    r[0] = a[0] * v[0] + a[1] * v[1] + a[2] * v[2];
+    r[1] = a[1] * v[0] + a[3] * v[1] + a[4] * v[2];
+    r[2] = a[2] * v[0] + a[4] * v[1] + a[5] * v[2];
+}
+
+/// Unit vector of the largest cross product of the rows of the singular matrix (a - value.I).
+static void eigenVectorOfSingle(const real_t * a, real_t value, real_t * evec)
+{
+    real_t row0[3] = { a[0] - value, a[1], a[2] };
+    real_t row1[3] = { a[1], a[3] - value, a[4] };
+    real_t row2[3] = { a[2], a[4], a[5] - value };
+    real_t r0xr1[3], r0xr2[3], r1xr2[3];
+    cross3(row0, row1, r0xr1);
+    cross3(row0, row2, r0xr2);
+    cross3(row1, row2, r1xr2);
+    real_t d0 = dot3(r0xr1, r0xr1);
+    real_t d1 = dot3(r0xr2, r0xr2);
+    real_t d2 = dot3(r1xr2, r1xr2);
+    const real_t * best = r0xr1;
+    real_t dmax = d0;
+    if (d1 > dmax) { best = r0xr2; dmax = d1; }
+    if (d2 > dmax) { best = r1xr2; dmax = d2; }
+    real_t invLength = 1 / sqrt(dmax);
+    evec[0] = best[0] * invLength; evec[1] = best[1] * invLength; evec[2] = best[2] * invLength;
+}
+
+/// Unit eigen vector of \e value orthogonal to the eigen vector \e evec. Stable if \e value is a double eigen value.
+static void eigenVectorOrthogonalTo(const real_t * a, const real_t * evec, real_t value, real_t * result)
+{
+    // orthonormal basis (u,v) of the plane orthogonal to evec
+    real_t u[3], v[3];
+    if (fabs(evec[0]) > fabs(evec[1])) {
+        real_t invLength = 1 / sqrt(evec[0] * evec[0] + evec[2] * evec[2]);
+        u[0] = -evec[2] * invLength; u[1] = 0; u[2] = evec[0] * invLength;
+    }
+    else {
+        real_t invLength = 1 / sqrt(evec[1] * evec[1] + evec[2] * evec[2]);
+        u[0] = 0; u[1] = evec[2] * invLength; u[2] = -evec[1] * invLength;
+    }
+    cross3(evec, u, v);
+
+    // restriction of (a - value.I) to the plane
+    real_t au[3], av[3];
+    product3(a, u, au);
+    product3(a, v, av);
+    real_t m00 = dot3(u, au) - value;
+    real_t m01 = dot3(u, av);
+    real_t m11 = dot3(v, av) - value;
+    real_t absM00 = fabs(m00), absM01 = fabs(m01), absM11 = fabs(m11);
+
+    // the whole plane is an eigen space if the restriction is null
+    real_t cu = 1, cv = 0;
+    if (absM00 >= absM11) {
+        if (std::max(absM00, absM01) > 0) {
+            if (absM00 >= absM01) { m01 /= m00; m00 = 1 / sqrt(1 + m01 * m01); m01 *= m00; }
+            else { m00 /= m01; m01 = 1 / sqrt(1 + m00 * m00); m00 *= m01; }
+            cu = m01; cv = -m00;
+        }
+    }
+    else {
+        if (std::max(absM11, absM01) > 0) {
+            if (absM11 >= absM01) { m01 /= m11; m11 = 1 / sqrt(1 + m01 * m01); m01 *= m11; }
+            else { m11 /= m01; m01 = 1 / sqrt(1 + m11 * m11); m11 *= m01; }
+            cu = m11; cv = -m01;
+        }
+    }
+    result[0] = cu * u[0] + cv * v[0];
+    result[1] = cu * u[1] + cv * v[1];
+    result[2] = cu * u[2] + cv * v[2];
+}
+
+/// Decomposition of the \e nb (at most EIGEN_BLOCK_SIZE) matrices starting at \e matrices.
+static void symmetricEigenBlock(const Matrix3 * matrices, size_t nb, Vector3 * values, Matrix3 * vectors)
+{
+    real_t a00[EIGEN_BLOCK_SIZE], a01[EIGEN_BLOCK_SIZE], a02[EIGEN_BLOCK_SIZE];
+    real_t a11[EIGEN_BLOCK_SIZE], a12[EIGEN_BLOCK_SIZE], a22[EIGEN_BLOCK_SIZE];
+    real_t scale[EIGEN_BLOCK_SIZE], halfDet[EIGEN_BLOCK_SIZE];
+    real_t e0[EIGEN_BLOCK_SIZE], e1[EIGEN_BLOCK_SIZE], e2[EIGEN_BLOCK_SIZE];
+    size_t i;
+
+    // gathering of the upper triangles, scaled to avoid overflow
+    for (i = 0; i < nb; ++i) {
+        const real_t * m = matrices[i].getData();
+        a00[i] = m[0]; a01[i] = m[1]; a02[i] = m[2];
+        a11[i] = m[4]; a12[i] = m[5]; a22[i] = m[8];
+    }
+    for (i = 0; i < nb; ++i) {
+        real_t maxabs = std::max(std::max(std::max(fabs(a00[i]), fabs(a01[i])), std::max(fabs(a02[i]), fabs(a11[i]))),
+                                 std::max(fabs(a12[i]), fabs(a22[i])));
+        scale[i] = maxabs;
+        real_t inv = (maxabs > 0 ? 1 / maxabs : 0);
+        a00[i] *= inv; a01[i] *= inv; a02[i] *= inv;
+        a11[i] *= inv; a12[i] *= inv; a22[i] *= inv;
+    }
+
+    // eigen values as roots of the characteristic polynomial of (a - q.I)/p
+    for (i = 0; i < nb; ++i) {
+        real_t q = (a00[i] + a11[i] + a22[i]) / 3;
+        real_t b00 = a00[i] - q, b11 = a11[i] - q, b22 = a22[i] - q;
+        real_t offdiag = a01[i] * a01[i] + a02[i] * a02[i] + a12[i] * a12[i];
+        real_t p2 = (b00 * b00 + b11 * b11 + b22 * b22 + 2 * offdiag) / 6;
+        real_t p = sqrt(p2);
+        real_t invp = (p2 > 0 ? 1 / p : 0);
+        real_t c00 = b00 * invp, c11 = b11 * invp, c22 = b22 * invp;
+        real_t c01 = a01[i] * invp, c02 = a02[i] * invp, c12 = a12[i] * invp;
+        real_t det = c00 * (c11 * c22 - c12 * c12) - c01 * (c01 * c22 - c12 * c02) + c02 * (c01 * c12 - c11 * c02);
+        real_t hd = std::min<real_t>(std::max<real_t>(det / 2, -1), 1);
+        real_t angle = acos(hd) / 3;
+        real_t beta2 = 2 * cos(angle);
+        real_t beta0 = 2 * cos(angle + 2 * GEOM_PI / 3);
+        // clamped to keep the values sorted despite rounding errors
+        real_t beta1 = std::min(std::max(-(beta0 + beta2), beta0), beta2);
+        halfDet[i] = hd;
+        e0[i] = q + p * beta0;
+        e1[i] = q + p * beta1;
+        e2[i] = q + p * beta2;
+    }
+
+    // the acos loses half of the precision when two eigen values are close.
+    // a Newton step on det(a - e.I) refines the most distant eigen value.
+    for (i = 0; i < nb; ++i) {
+        real_t e = (halfDet[i] >= 0 ? e2[i] : e0[i]);
+        real_t b00 = a00[i] - e, b11 = a11[i] - e, b22 = a22[i] - e;
+        real_t m0 = b11 * b22 - a12[i] * a12[i];
+        real_t m1 = b00 * b22 - a02[i] * a02[i];
+        real_t m2 = b00 * b11 - a01[i] * a01[i];
+        real_t f = b00 * m0 - a01[i] * (a01[i] * b22 - a12[i] * a02[i]) + a02[i] * (a01[i] * a12[i] - b11 * a02[i]);
+        real_t df = m0 + m1 + m2;
+        real_t step = (df != 0 ? f / df : 0);
+        e += (fabs(step) < 1e-6 ? step : 0);
+        if (halfDet[i] >= 0) e2[i] = e; else e0[i] = e;
+    }
+
+    // eigen vectors, starting from the eigen value the most distant from the others
+    for (i = 0; i < nb; ++i) {
+        if (e2[i] == e0[i]) {
+            // triple eigen value
+            values[i] = Vector3(e0[i], e0[i], e0[i]) * scale[i];
+            vectors[i] = Matrix3::IDENTITY;
+            continue;
+        }
+        real_t a[6] = { a00[i], a01[i], a02[i], a11[i], a12[i], a22[i] };
+        real_t v[3][3];
+        if (halfDet[i] >= 0) {
+            eigenVectorOfSingle(a, e2[i], v[2]);
+            eigenVectorOrthogonalTo(a, v[2], e1[i], v[1]);
+            cross3(v[1], v[2], v[0]);
+        }
+        else {
+            eigenVectorOfSingle(a, e0[i], v[0]);
+            eigenVectorOrthogonalTo(a, v[0], e1[i], v[1]);
+            cross3(v[0], v[1], v[2]);
+        }
+        // eigen values are given by the Rayleigh quotients of the eigen vectors,
+        // which are more precise than the roots when eigen values are close.
+        real_t r[3], av[3];
+        for (int j = 0; j < 3; ++j) { product3(a, v[j], av); r[j] = dot3(v[j], av); }
+        // rounding errors may swap close eigen values. Swapped vectors are negated to keep a direct frame.
+        for (int j = 0; j < 3; ++j) {
+            int k = (j == 2 ? 0 : j);
+            if (r[k] > r[k + 1]) {
+                std::swap(r[k], r[k + 1]);
+                for (int c = 0; c < 3; ++c) { std::swap(v[k][c], v[k + 1][c]); v[k][c] = -v[k][c]; }
+            }
+        }
+        real_t * value = values[i].data();
+        real_t * vector = vectors[i].getData();
+        for (int j = 0; j < 3; ++j) {
+            value[j] = r[j] * scale[i];
+            vector[j] = v[j][0]; vector[3 + j] = v[j][1]; vector[6 + j] = v[j][2];
+        }
+    }
+}
+
+void PGL(symmetricEigenDecomposition) (const Matrix3& matrix, Vector3& values, Matrix3& vectors)
+{
+    symmetricEigenBlock(&matrix, 1, &values, &vectors);
+}
+
+void PGL(symmetricEigenDecomposition) (const std::vector<Matrix3>& matrices,
+                                       std::vector<Vector3>& values,
+                                       std::vector<Matrix3>& vectors,
+                                       size_t nbthreads)
+{
+    size_t nb = matrices.size();
+    values.resize(nb);
+    vectors.resize(nb);
+    if (nb == 0) return;
+    size_t nbblocks = (nb + EIGEN_BLOCK_SIZE - 1) / EIGEN_BLOCK_SIZE;
+    pgl_parallel_for(0, nbblocks, [&](size_t b) {
+        size_t first = b * EIGEN_BLOCK_SIZE;
+        symmetricEigenBlock(&matrices[first], std::min<size_t>(EIGEN_BLOCK_SIZE, nb - first), &values[first], &vectors[first]);
+    }, nbthreads, 16);
+}
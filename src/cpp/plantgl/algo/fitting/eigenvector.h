@@ -52,7 +52,9 @@
 
 #include "../algo_config.h"
 #include <plantgl/math/util_vector.h>
+#include <plantgl/math/util_matrix.h>
 #include <plantgl/scenegraph/container/pointarray.h>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -153,11 +155,11 @@ extern void ALGO_API Laxi_ValproVecpro (double mat3x3[3][3],double val[3],double
 
 
 /*! vecteurs propres distincts : \n
-    mat3x3  : matrice de l'operateur lineaire ( donnee ) \n
-    val : valeurs propres associees a l'operateur lineaire ( cherchees ) \n
-                  si pas de solution, val = Infini \n
-    vect    : vecteurs propres distincts associes aux valeurs propres ( cherchees ) \n
-                  si pas de solution, vect = (Infini,Infini,Infini) \n
+    mat3x3  : matrice symetrique de l'operateur lineaire ( donnee ) \n
+    vect    : vecteurs propres associes aux valeurs propres croissantes ( cherchees ), \n
+                  de norme 2*sqrt(valeur propre) \n
+                  si valeur propre nulle, vect = (Infini,Infini,Infini) \n
+    Utilise symmetricEigenDecomposition. \n
 */
 extern void ALGO_API Laxi_Vecpro (double mat3x3[3][3],double vect[3][3],short *marqueur);
 
@@ -180,6 +182,25 @@ extern void ALGO_API Laxi_ComputeInertia (Point3ArrayPtr pts,float vpvec[3][3],f
 
 
 
+/* ----------------------------------------------------------------------- */
+
+/*! Eigen decomposition of the symmetric 3x3 matrix \e matrix.
+    Eigen values are given in increasing order in \e values. Column i of \e vectors
+    is the unit eigen vector of values[i] and the columns form a direct frame.
+    The decomposition is computed in closed form and remains stable for repeated
+    or null eigen values. Only the upper triangle of \e matrix is read.
+*/
+extern void ALGO_API symmetricEigenDecomposition (const Matrix3& matrix, Vector3& values, Matrix3& vectors);
+
+/*! Eigen decomposition of each symmetric 3x3 matrix of \e matrices.
+    \e values and \e vectors are resized to the number of matrices.
+    Matrices are processed by blocks in parallel with \e nbthreads threads (0 for all available).
+*/
+extern void ALGO_API symmetricEigenDecomposition (const std::vector<Matrix3>& matrices,
+                                                  std::vector<Vector3>& values,
+                                                  std::vector<Matrix3>& vectors,
+                                                  size_t nbthreads = 0);
+
 /* ----------------------------------------------------------------------- */
 
 PGL_END_NAMESPACE
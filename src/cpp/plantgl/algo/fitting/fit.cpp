@@ -64,6 +64,7 @@
 #include <plantgl/math/util_matrixmath.h>
 #include "miniball.h"
 #include "eigenvector.h"
+#include "convexhull.h"
 
 // #define PGL_WITHOUT_QHULL
 
@@ -113,11 +114,9 @@ Fit::Fit(const Point3ArrayPtr& _pointstofit ):
 GeometryPtr Fit::use(const string& classname){
     if(! __pointstofit )return GeometryPtr();
     string cl = toUpper(classname);
-#ifdef PGL_WITH_QHULL
     if(cl =="CONVEXHULL")
     return convexHull();
     else
-#endif
     if(cl =="EXTRUDEDHULL")
     return extrudedHull();
     else if(cl =="ASYMMETRICHULL")
@@ -161,9 +160,7 @@ GeometryPtr Fit::use(const string& classname){
 
 vector<string> Fit::getVolumeClassNames(){
     vector<string> classname;
-#ifdef PGL_WITH_QHULL
     classname.push_back(string("CONVEXHULL"));
-#endif
     classname.push_back(string("ASYMMETRICHULL"));
     classname.push_back(string("EXTRUDEDHULL"));
     classname.push_back(string("SPHERE"));
@@ -1595,7 +1592,28 @@ GeometryPtr Fit::extrudedHull(){
 GeometryPtr
 Fit::convexHull(){
 #ifndef PGL_WITH_QHULL
-    return GeometryPtr();
+  // Without qhull, the native quickhull implementation is used.
+  if(! __pointstofit )return GeometryPtr();
+  uint_t numpoints = __pointstofit->size();
+  if(numpoints > 3){
+      TriangleSetPtr hull = ConvexHull3D(__pointstofit).getMesh();
+      if(hull){
+          pair<Point3Array::const_iterator,Point3Array::const_iterator> _skel = hull->getPointList()->getZMinAndMax();
+          hull->getSkeleton() = PolylinePtr(new Polyline(*(_skel.first),*(_skel.second)));
+          return GeometryPtr(hull);
+      }
+      return GeometryPtr();
+  }
+  else if(numpoints==3){
+      Index3ArrayPtr topo(new Index3Array());
+      topo->push_back(Index3(0,1,2));
+      return GeometryPtr(new TriangleSet(__pointstofit,topo, true,true, true,
+                                         PolylinePtr(new Polyline(__pointstofit->getAt(0),__pointstofit->getAt(1)))));
+  }
+  else if(numpoints==2){
+      return GeometryPtr(new Polyline(__pointstofit));
+  }
+  else return GeometryPtr();
 #else
 
 #ifdef QHULL_LIB_CHECK
@@ -1741,7 +1759,9 @@ Fit::convexHull(){
 
 Point2ArrayPtr Fit::convexPolyline(const Point2ArrayPtr& _points){
 #ifndef PGL_WITH_QHULL
-    return Point2ArrayPtr();
+    // Without qhull, the native monotone chain implementation is used.
+    if(!_points || _points->size() < 3) return Point2ArrayPtr();
+    return ConvexHull2D(_points).getPointList();
 #else
 
     /* dimension of points */
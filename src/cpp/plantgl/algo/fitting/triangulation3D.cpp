@@ -45,51 +45,28 @@
 PGL_USING_NAMESPACE
 
 #ifdef PGL_WITH_CGAL
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Triangulation_vertex_base_with_info_3.h>
-#include <CGAL/Delaunay_triangulation_3.h>
-// #include <CGAL/Triangulation_3.h>
-
-typedef CGAL::Exact_predicates_inexact_constructions_kernel         K;
-typedef CGAL::Triangulation_vertex_base_with_info_3<uint32_t, K>    Vb;
-typedef CGAL::Triangulation_data_structure_3<Vb>                    Tds;
-
-typedef CGAL::Delaunay_triangulation_3<K, Tds>                      Triangulation;
-// typedef CGAL::Triangulation_3<K,Tds>      Triangulation;
-
-
-typedef Triangulation::Cell_handle    Cell_handle;
-typedef Triangulation::Vertex_handle  Vertex_handle;
-typedef Triangulation::Locate_type    Locate_type;
-typedef Triangulation::Point          Point;
-typedef Triangulation::Segment        Segment;
-
-
-
-inline Point toPoint(const Vector3& v) { return Point(v.x(),v.y(),v.z()); }
-inline Vector3 toVector3(const Point& v) { return Vector3(v.x(),v.y(),v.z()); }
-
+#include <plantgl/algo/base/cgaldelaunay.h>
 #endif
 
 Index3ArrayPtr
-PGL(delaunay_triangulation3D)(const Point3ArrayPtr points)
+PGL(delaunay_triangulation3D)(const Point3ArrayPtr points, bool parallel)
 {
 #ifdef PGL_WITH_CGAL
-    Triangulation triangulation;
-    uint32_t pointCount = 0;
-    for (Point3Array::const_iterator it = points->begin(); it != points->end(); ++it)
-        triangulation.insert(toPoint(*it))->info() = pointCount++;
-
-    Index3ArrayPtr result(new Index3Array(points->size()));
-    for(Triangulation::Finite_facets_iterator it = triangulation.finite_facets_begin();
-        it != triangulation.finite_facets_end(); ++it){
-            const Cell_handle cell = it->first;
-            const int& index = it->second;
-            const int index1 = cell->vertex(triangulation.vertex_triple_index(index, 0))->info();
-            const int index2 = cell->vertex(triangulation.vertex_triple_index(index, 1))->info();
-            const int index3 = cell->vertex(triangulation.vertex_triple_index(index, 2))->info();
-            result->push_back(Index3(index1,index2,index3));
-    }
+    Index3ArrayPtr result(new Index3Array());
+    with_delaunay_triangulation3(points, parallel, [&result](const auto& triangulation) {
+        typedef typename std::decay<decltype(triangulation)>::type Triangulation;
+        typedef typename Triangulation::Cell_handle Cell_handle;
+        result->reserve(triangulation.number_of_finite_facets());
+        for(typename Triangulation::Finite_facets_iterator it = triangulation.finite_facets_begin();
+            it != triangulation.finite_facets_end(); ++it){
+                const Cell_handle cell = it->first;
+                const int& index = it->second;
+                const int index1 = cell->vertex(triangulation.vertex_triple_index(index, 0))->info();
+                const int index2 = cell->vertex(triangulation.vertex_triple_index(index, 1))->info();
+                const int index3 = cell->vertex(triangulation.vertex_triple_index(index, 2))->info();
+                result->push_back(Index3(index1,index2,index3));
+        }
+    });
 #else
     #ifdef _MSC_VER
     #pragma message("function 'delaunay_triangulation3D' disabled. CGAL needed.")
@@ -56,8 +56,10 @@ PGL_BEGIN_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
 
+/** Facets of the Delaunay tetrahedralization of \e points. If \e parallel is true
+    and CGAL is linked with TBB, the triangulation is built in parallel. */
 ALGO_API Index3ArrayPtr
-delaunay_triangulation3D(const Point3ArrayPtr points);
+delaunay_triangulation3D(const Point3ArrayPtr points, bool parallel = false);
 
 
 
@@ -0,0 +1,357 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "voxelizer.h"
+#include "../base/tesselator.h"
+#include "../base/bboxcomputer.h"
+#include <plantgl/scenegraph/geometry/boundingbox.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/util_parallel.h>
+#include <algorithm>
+#include <mutex>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Splits \e polygon by the plane of coordinate \e plane along \e axis into the parts \e below and \e above it.
+static void splitPolygon(const std::vector<Vector3>& polygon, int axis, real_t plane,
+                         std::vector<Vector3>& below, std::vector<Vector3>& above)
+{
+    below.clear();
+    above.clear();
+    size_t nbpoints = polygon.size();
+    for (size_t i = 0; i < nbpoints; ++i) {
+        const Vector3& p = polygon[i];
+        const Vector3& q = polygon[(i + 1) % nbpoints];
+        real_t dp = p[axis] - plane;
+        real_t dq = q[axis] - plane;
+        if (dp <= 0) below.push_back(p);
+        if (dp >= 0) above.push_back(p);
+        if ((dp < 0 && dq > 0) || (dp > 0 && dq < 0)) {
+            Vector3 x = p + (q - p) * (dp / (dp - dq));
+            x[axis] = plane;
+            below.push_back(x);
+            above.push_back(x);
+        }
+    }
+}
+
+/// Twice the area of the planar \e polygon of unit normal \e normal.
+static inline real_t doubleArea(const std::vector<Vector3>& polygon, const Vector3& normal)
+{
+    Vector3 sum;
+    const Vector3& origin = polygon[0];
+    for (size_t i = 1; i + 1 < polygon.size(); ++i)
+        sum += cross(polygon[i] - origin, polygon[i + 1] - origin);
+    return fabs(dot(normal, sum));
+}
+
+/* ----------------------------------------------------------------------- */
+
+SceneVoxelizer::SceneVoxelizer( const Vector3& voxelsize,
+                                const Vector3& minpoint,
+                                const Vector3& maxpoint,
+                                uint_t nbInclinationClasses ) :
+    RealGrid3(voxelsize, minpoint, maxpoint),
+    __multithreaded(true)
+{
+    allocate(nbInclinationClasses);
+}
+
+SceneVoxelizer::SceneVoxelizer( const ScenePtr& scene,
+                                const Vector3& voxelsize,
+                                uint_t nbInclinationClasses ) :
+    RealGrid3(voxelsize),
+    __multithreaded(true)
+{
+    Discretizer d;
+    BBoxComputer bbc(d);
+    if (scene) bbc.process(scene);
+    BoundingBoxPtr bbox = bbc.getBoundingBox();
+    if (bbox) RealGrid3::initialize(bbox->getLowerLeftCorner(), bbox->getUpperRightCorner(), voxelsize);
+    else RealGrid3::initialize(Vector3::ORIGIN, Vector3::ORIGIN, voxelsize);
+    allocate(nbInclinationClasses);
+}
+
+SceneVoxelizer::~SceneVoxelizer( )
+{
+}
+
+void SceneVoxelizer::allocate( uint_t nbInclinationClasses )
+{
+    __nbInclinationClasses = std::max<uint_t>(1, nbInclinationClasses);
+    __inclinations.assign(size() * __nbInclinationClasses, 0);
+}
+
+void SceneVoxelizer::reset( )
+{
+    std::fill(__values.begin(), __values.end(), real_t(0));
+    std::fill(__inclinations.begin(), __inclinations.end(), real_t(0));
+    __shapeIds.clear();
+}
+
+/* ----------------------------------------------------------------------- */
+
+template<class Function>
+void SceneVoxelizer::clip( const std::vector<Vector3>& polygon, Clipper& clipper, Function& func,
+                           int axis, CellId cell ) const
+{
+    const real_t origin = __origin[axis];
+    const real_t voxelsize = __voxelsize[axis];
+    const long dimension = long(dimensions()[axis]);
+
+    real_t minvalue = polygon[0][axis], maxvalue = minvalue;
+    for (std::vector<Vector3>::const_iterator it = polygon.begin() + 1; it != polygon.end(); ++it) {
+        if ((*it)[axis] < minvalue) minvalue = (*it)[axis];
+        else if ((*it)[axis] > maxvalue) maxvalue = (*it)[axis];
+    }
+    real_t minindex = floor((minvalue - origin) / voxelsize);
+    real_t maxindex = floor((maxvalue - origin) / voxelsize);
+    if (maxindex < 0 || minindex >= dimension) return;
+
+    std::vector<Vector3>& rest = clipper.rest[axis];
+    std::vector<Vector3>& below = clipper.below[axis];
+    std::vector<Vector3>& above = clipper.above[axis];
+    rest = polygon;
+    long first = long(std::max<real_t>(minindex, 0));
+    long last = long(std::min<real_t>(maxindex, dimension - 1));
+    if (minindex < first) {
+        // Removes the part before the grid
+        splitPolygon(rest, axis, origin + first * voxelsize, below, above);
+        rest.swap(above);
+    }
+    for (long k = first; k <= last; ++k) {
+        real_t plane = origin + (k + 1) * voxelsize;
+        bool split = maxvalue > plane;
+        if (split) splitPolygon(rest, axis, plane, below, above);
+        const std::vector<Vector3>& piece = (split ? below : rest);
+        if (piece.size() >= 3) {
+            CellId cid = cell * dimension + k;
+            if (axis == 2) func(cid, piece);
+            else clip(piece, clipper, func, axis + 1, cid);
+        }
+        if (!split) break;
+        rest.swap(above);
+    }
+}
+
+void SceneVoxelizer::accumulate( Accumulator& acc, Clipper& clipper,
+                                 const Vector3& a, const Vector3& b, const Vector3& c ) const
+{
+    Vector3 normal = cross(b - a, c - a);
+    if (!(normal.normalize() > 0)) return;
+    real_t inclination = acos(std::min<real_t>(fabs(normal.z()), 1));
+    uint_t inclinationclass = std::min<uint_t>(__nbInclinationClasses - 1,
+                                               uint_t(inclination * __nbInclinationClasses / GEOM_HALF_PI));
+    clipper.polygon.resize(3);
+    clipper.polygon[0] = a;
+    clipper.polygon[1] = b;
+    clipper.polygon[2] = c;
+    const uint_t nbclasses = __nbInclinationClasses;
+    auto addPiece = [&acc, &normal, inclinationclass, nbclasses](CellId cid, const std::vector<Vector3>& piece) {
+        real_t area = doubleArea(piece, normal) / 2;
+        if (area <= 0) return;
+        if (acc.areas) {
+            acc.areas[cid] += area;
+            acc.inclinations[cid * nbclasses + inclinationclass] += area;
+        }
+        else {
+            Piece p = { cid, inclinationclass, area };
+            acc.pieces.push_back(p);
+        }
+        acc.cells.push_back(cid);
+    };
+    clip(clipper.polygon, clipper, addPiece);
+}
+
+void SceneVoxelizer::closeShape( Accumulator& acc, uint_t shapeid )
+{
+    std::sort(acc.cells.begin(), acc.cells.end());
+    std::vector<CellId>::const_iterator end = std::unique(acc.cells.begin(), acc.cells.end());
+    for (std::vector<CellId>::const_iterator it = acc.cells.begin(); it != end; ++it)
+        acc.shapes.push_back(std::make_pair(*it, shapeid));
+    acc.cells.clear();
+}
+
+void SceneVoxelizer::addShapeIds( const std::vector<std::pair<CellId, uint_t> >& shapes )
+{
+    for (std::vector<std::pair<CellId, uint_t> >::const_iterator it = shapes.begin(); it != shapes.end(); ++it) {
+        std::vector<uint_t>& ids = __shapeIds[it->first];
+        std::vector<uint_t>::iterator pos = std::lower_bound(ids.begin(), ids.end(), it->second);
+        if (pos == ids.end() || *pos != it->second) ids.insert(pos, it->second);
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+
+void SceneVoxelizer::flush( Accumulator& acc )
+{
+    const uint_t nbclasses = __nbInclinationClasses;
+    for (std::vector<Piece>::const_iterator it = acc.pieces.begin(); it != acc.pieces.end(); ++it) {
+        __values[it->cell] += it->area;
+        __inclinations[it->cell * nbclasses + it->inclinationclass] += it->area;
+    }
+    acc.pieces.clear();
+}
+
+void SceneVoxelizer::addTriangle( const Vector3& a, const Vector3& b, const Vector3& c, uint_t shapeid )
+{
+    Accumulator acc;
+    acc.areas = __values.data();
+    acc.inclinations = __inclinations.data();
+    Clipper clipper;
+    accumulate(acc, clipper, a, b, c);
+    closeShape(acc, shapeid);
+    addShapeIds(acc.shapes);
+}
+
+void SceneVoxelizer::process( const ScenePtr& scene )
+{
+    if (!scene) return;
+    std::vector<ShapePtr> shapes;
+    for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it) {
+        ShapePtr shape = dynamic_pointer_cast<Shape>(*it);
+        if (shape && shape->getGeometry()) shapes.push_back(shape);
+    }
+    if (shapes.empty()) return;
+
+    size_t nbthreads = __multithreaded ? std::min(pgl_thread_count(), shapes.size()) : 1;
+    // A single thread accumulates directly in the grid. Otherwise each thread keeps at most
+    // MaxPendingPieces pieces of triangles and adds them to the grid under a lock, so that no
+    // thread needs a copy of the grid.
+    const size_t MaxPendingPieces = 1 << 16;
+    std::vector<Accumulator> accumulators(nbthreads);
+    if (nbthreads == 1) {
+        accumulators[0].areas = __values.data();
+        accumulators[0].inclinations = __inclinations.data();
+    }
+    else {
+        for (std::vector<Accumulator>::iterator it = accumulators.begin(); it != accumulators.end(); ++it)
+            it->areas = it->inclinations = NULL;
+    }
+    std::mutex gridmutex;
+
+    pgl_parallel_for(0, nbthreads, [&](size_t t) {
+        Accumulator& acc = accumulators[t];
+        Tesselator tesselator;
+        Clipper clipper;
+        // Shapes are interleaved between threads to balance their sizes.
+        for (size_t i = t; i < shapes.size(); i += nbthreads) {
+            if (!shapes[i]->apply(tesselator)) continue;
+            TriangleSetPtr mesh = tesselator.getTriangulation();
+            if (!mesh) continue;
+            const Point3ArrayPtr& points = mesh->getPointList();
+            const Index3ArrayPtr& indices = mesh->getIndexList();
+            for (Index3Array::const_iterator it = indices->begin(); it != indices->end(); ++it) {
+                accumulate(acc, clipper, points->getAt(it->getAt(0)), points->getAt(it->getAt(1)), points->getAt(it->getAt(2)));
+                if (acc.pieces.size() >= MaxPendingPieces) {
+                    std::lock_guard<std::mutex> lock(gridmutex);
+                    flush(acc);
+                }
+            }
+            closeShape(acc, shapes[i]->getId());
+        }
+        if (!acc.pieces.empty()) {
+            std::lock_guard<std::mutex> lock(gridmutex);
+            flush(acc);
+        }
+    }, nbthreads);
+
+    for (std::vector<Accumulator>::const_iterator it = accumulators.begin(); it != accumulators.end(); ++it)
+        addShapeIds(it->shapes);
+}
+
+/* ----------------------------------------------------------------------- */
+
+real_t SceneVoxelizer::getTotalArea( ) const
+{
+    real_t total = 0;
+    for (const_iterator it = begin(); it != end(); ++it) total += *it;
+    return total;
+}
+
+RealArrayPtr SceneVoxelizer::getAreaDensities( ) const
+{
+    real_t volume = __voxelsize.x() * __voxelsize.y() * __voxelsize.z();
+    RealArrayPtr result(new RealArray(__values.size()));
+    RealArray::iterator itres = result->begin();
+    for (const_iterator it = begin(); it != end(); ++it, ++itres) *itres = *it / volume;
+    return result;
+}
+
+RealArray2Ptr SceneVoxelizer::getInclinationDistributions( ) const
+{
+    RealArray2Ptr result(new RealArray2(__values.size(), __nbInclinationClasses));
+    std::copy(__inclinations.begin(), __inclinations.end(), result->begin());
+    return result;
+}
+
+std::vector<SceneVoxelizer::CellId> SceneVoxelizer::getOccupiedVoxels( ) const
+{
+    std::vector<CellId> result;
+    for (CellId cid = 0; cid < __values.size(); ++cid)
+        if (__values[cid] > 0) result.push_back(cid);
+    return result;
+}
+
+std::vector<uint_t> SceneVoxelizer::getShapeIds( const CellId& cid ) const
+{
+    pgl_hash_map<CellId, std::vector<uint_t> >::const_iterator it = __shapeIds.find(cid);
+    if (it == __shapeIds.end()) return std::vector<uint_t>();
+    return it->second;
+}
+
+std::vector<std::pair<SceneVoxelizer::CellId, Point3ArrayPtr> >
+SceneVoxelizer::clipPolygon( const Point3ArrayPtr& polygon ) const
+{
+    std::vector<std::pair<CellId, Point3ArrayPtr> > result;
+    if (!polygon || polygon->size() < 3) return result;
+    Clipper clipper;
+    clipper.polygon.assign(polygon->begin(), polygon->end());
+    auto addPiece = [&result](CellId cid, const std::vector<Vector3>& piece) {
+        result.push_back(std::make_pair(cid, Point3ArrayPtr(new Point3Array(piece.begin(), piece.end()))));
+    };
+    clip(clipper.polygon, clipper, addPiece);
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,215 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use,
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info".
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability.
+ *
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or
+ *   data to be ensured and,  more generally, to use and operate it in the
+ *   same conditions as regards security.
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file voxelizer.h
+    \brief Computation of the area of the triangles of a scene in the voxels of a regular grid.
+*/
+
+#ifndef __voxelizer_h__
+#define __voxelizer_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <vector>
+#include <plantgl/math/util_math.h>
+#include <plantgl/math/util_vector.h>
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/tool/util_spatialarray.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <plantgl/tool/util_array2.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Empty policy of the arrays of numbers: null values are empty.
+template<class T>
+class NullValuePolicy {
+public:
+    static inline bool is_empty(const T& value) { return value == 0; }
+};
+
+/// Regular 3D grid of real values, in which voxels with a null value are empty.
+typedef SpatialArrayN<real_t, Vector3, 3, VectorContainer<real_t, NullValuePolicy<real_t> > > RealGrid3;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class SceneVoxelizer
+   \brief Area of the surfaces of a scene in the voxels of a regular grid.
+          The shapes are tessellated and each triangle is clipped exactly against the
+          planes of the voxels. The value of a voxel is the area of the pieces of triangles
+          it contains. The distribution of this area in classes of inclination of the
+          normals and the ids of the shapes are also recorded for each voxel.
+          The shapes can be processed in parallel. Each thread keeps the clipped pieces of
+          its triangles and adds them to the shared grid under a mutex when too many are
+          pending and when its shapes are done, so no thread copies the grid.
+*/
+
+class ALGO_API SceneVoxelizer : public RealGrid3
+{
+public:
+
+    /// Constructs a grid of voxels of size \e voxelsize covering [\e minpoint, \e maxpoint].
+    SceneVoxelizer( const Vector3& voxelsize,
+                    const Vector3& minpoint,
+                    const Vector3& maxpoint,
+                    uint_t nbInclinationClasses = 9 );
+
+    /// Constructs a grid of voxels of size \e voxelsize covering the bounding box of \e scene.
+    SceneVoxelizer( const ScenePtr& scene,
+                    const Vector3& voxelsize,
+                    uint_t nbInclinationClasses = 9 );
+
+    /// Destructor.
+    virtual ~SceneVoxelizer( );
+
+    inline void setMultiThreaded( bool enabled ) { __multithreaded = enabled; }
+    inline bool isMultiThreaded( ) const { return __multithreaded; }
+
+    /// Returns the number of classes of inclination of the normals, dividing [0, pi/2].
+    inline uint_t getNbInclinationClasses( ) const { return __nbInclinationClasses; }
+
+    /// Removes the area accumulated in the voxels.
+    void reset( );
+
+    /// Adds the area of the shapes of \e scene to the voxels.
+    void process( const ScenePtr& scene );
+
+    /// Adds the area of the triangle (\e a, \e b, \e c) of the shape \e shapeid to the voxels.
+    void addTriangle( const Vector3& a, const Vector3& b, const Vector3& c, uint_t shapeid );
+
+    /// Returns the area in all the voxels.
+    real_t getTotalArea( ) const;
+
+    /// Returns the area per unit of volume of each voxel.
+    RealArrayPtr getAreaDensities( ) const;
+
+    /** Returns for each voxel (row) the area of the triangles in each class of inclination (column).
+        The inclination of a triangle is the angle of its normal with the vertical axis. */
+    RealArray2Ptr getInclinationDistributions( ) const;
+
+    /// Returns the area of the voxel \e cid in each class of inclination.
+    inline const real_t * getInclinationDistribution( const CellId& cid ) const
+    { return &__inclinations[cid * __nbInclinationClasses]; }
+
+    /// Returns the ids of the voxels with a non null area.
+    std::vector<CellId> getOccupiedVoxels( ) const;
+
+    /// Returns the sorted ids of the shapes with a non null area in the voxel \e cid.
+    std::vector<uint_t> getShapeIds( const CellId& cid ) const;
+
+    /// Returns the pieces of the planar polygon \e polygon in each voxel of the grid.
+    std::vector<std::pair<CellId, Point3ArrayPtr> > clipPolygon( const Point3ArrayPtr& polygon ) const;
+
+protected:
+
+    /// A piece of triangle in a voxel, waiting to be added to the grid.
+    struct Piece {
+        CellId cell;
+        uint_t inclinationclass;
+        real_t area;
+    };
+
+    /// The values accumulated by a thread.
+    struct Accumulator {
+        /// The grid values to add the pieces to, or null to keep them in \e pieces.
+        real_t * areas;
+        real_t * inclinations;
+        /// The pieces not yet added to the grid.
+        std::vector<Piece> pieces;
+        /// The voxels of the current shape.
+        std::vector<CellId> cells;
+        /// The (voxel, shape id) pairs of the processed shapes.
+        std::vector<std::pair<CellId, uint_t> > shapes;
+    };
+
+    /// Scratch polygons used to clip a polygon, the pieces being stored per axis.
+    struct Clipper {
+        std::vector<Vector3> polygon;
+        std::vector<Vector3> rest[3], below[3], above[3];
+    };
+
+    /// Allocates the inclination classes of the voxels.
+    void allocate( uint_t nbInclinationClasses );
+
+    /// Calls \e func(cellid, polygon) for each non degenerated piece of \e polygon in a voxel.
+    template<class Function>
+    void clip( const std::vector<Vector3>& polygon, Clipper& clipper, Function& func,
+               int axis = 0, CellId cell = 0 ) const;
+
+    /// Adds the area of the triangle (\e a, \e b, \e c) to the voxels of \e acc.
+    void accumulate( Accumulator& acc, Clipper& clipper,
+                     const Vector3& a, const Vector3& b, const Vector3& c ) const;
+
+    /// Adds the pending pieces of \e acc to the grid.
+    void flush( Accumulator& acc );
+
+    /// Records the voxels of \e acc as voxels of the shape \e shapeid.
+    static void closeShape( Accumulator& acc, uint_t shapeid );
+
+    /// Adds the (voxel, shape id) pairs to the shape ids of the voxels.
+    void addShapeIds( const std::vector<std::pair<CellId, uint_t> >& shapes );
+
+    uint_t __nbInclinationClasses;
+
+    /// The area of each voxel in each class of inclination.
+    std::vector<real_t> __inclinations;
+
+    /// The ids of the shapes of the non empty voxels.
+    pgl_hash_map<CellId, std::vector<uint_t> > __shapeIds;
+
+    bool __multithreaded;
+};
+
+/// SceneVoxelizer Pointer
+typedef RCPtr<SceneVoxelizer> SceneVoxelizerPtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
@@ -0,0 +1,353 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include "gcmeshbuilder.h"
+#include "../base/discretizer.h"
+#include <plantgl/scenegraph/geometry/polyline.h>
+#include <plantgl/scenegraph/geometry/quadset.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/math/util_math.h>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+GCRingConsumer::~GCRingConsumer() { }
+
+/* ----------------------------------------------------------------------- */
+
+GCMeshBuilder::GCMeshBuilder(const Curve2DPtr& crossSection, bool ccw, bool triangulated):
+    RefCountObject(),
+    __closed(false),
+    __ccw(ccw),
+    __triangulated(triangulated),
+    __ringReuse(true),
+    __storeMesh(true),
+    __nbPushed(0),
+    __nbPoints(0),
+    __lastRadius(0),
+    __lastV(0),
+    __hasLastRing(false),
+    __hasHeldRing(false),
+    __points(new Point3Array()),
+    __ringBuffer(new Point3Array())
+{
+    setCrossSection(crossSection, ccw);
+}
+
+GCMeshBuilder::~GCMeshBuilder() { }
+
+bool GCMeshBuilder::setCrossSection(const Curve2DPtr& crossSection, bool ccw)
+{
+    if (!__ringV.empty() || __hasHeldRing) return false;
+    __section.clear();
+    __sectionU.clear();
+    __closed = false;
+    __ccw = ccw;
+    if (!crossSection) return false;
+
+    Discretizer d;
+    if (!crossSection->apply(d) || !d.getDiscretization()) return false;
+    Point3ArrayPtr pts = d.getDiscretization()->getPointList();
+    if (!pts || pts->size() < 2) return false;
+
+    Point3Array::const_iterator last = pts->end();
+    if (norm(pts->getAt(0) - pts->getAt(pts->size()-1)) < GEOM_EPSILON) {
+        --last;
+        __closed = true;
+    }
+
+    // Section coordinates and normalized arc length for texture coordinates
+    real_t length = 0;
+    for (Point3Array::const_iterator it = pts->begin(); it != last; ++it) {
+        if (it != pts->begin()) length += norm(*it - *(it-1));
+        __section.push_back(Vector2(it->x(), it->y()));
+        __sectionU.push_back(length);
+    }
+    if (__closed) length += norm(pts->getAt(0) - *(last-1));
+    if (length > GEOM_EPSILON)
+        for (std::vector<real_t>::iterator itU = __sectionU.begin(); itU != __sectionU.end(); ++itU)
+            *itU /= length;
+    return true;
+}
+
+GCMeshBuilderPtr GCMeshBuilder::branch() const
+{
+    GCMeshBuilderPtr result(new GCMeshBuilder(*this));
+    result->__points = Point3ArrayPtr(new Point3Array());
+    result->__ringBuffer = Point3ArrayPtr(new Point3Array());
+    result->__ringV.clear();
+    result->__hasLastRing = false;
+    result->__hasHeldRing = false;
+    result->__nbPushed = 0;
+    result->__nbPoints = 0;
+    if (__nbPoints > 0) result->pushPoint(__lastPosition, __lastLeft, __lastRadius);
+    return result;
+}
+
+void GCMeshBuilder::clear()
+{
+    __points = Point3ArrayPtr(new Point3Array());
+    __ringV.clear();
+    __hasLastRing = false;
+    __hasHeldRing = false;
+    __nbPushed = 0;
+    __nbPoints = 0;
+    __lastV = 0;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void GCMeshBuilder::pushPoint(const Vector3& position, const Vector3& left, real_t radius)
+{
+    ++__nbPushed;
+    if (__nbPoints > 0 && norm(position - __lastPosition) < GEOM_EPSILON) {
+        __lastRadius = radius;
+        return;
+    }
+    if (__nbPoints > 0) {
+        // The tangent of the last point is now known. Same as Polyline::getTangentAt.
+        real_t seglength = norm(position - __lastPosition);
+        Vector3 tangent = position - __lastPosition;
+        if (__nbPoints > 1) {
+            Vector3 a = __lastPosition - __prevPosition;
+            Vector3 b = tangent;
+            a.normalize(); b.normalize();
+            if (normSquared(a+b) > GEOM_EPSILON) tangent = a + b;
+        }
+        emitRing(__lastPosition, tangent, __lastLeft, __lastRadius, __lastV);
+        __prevPosition = __lastPosition;
+        __lastV += seglength;
+    }
+    __lastPosition = position;
+    __lastLeft = left;
+    __lastRadius = radius;
+    ++__nbPoints;
+}
+
+void GCMeshBuilder::setLastRadius(real_t radius)
+{
+    __lastRadius = radius;
+}
+
+Vector3 GCMeshBuilder::lastTangent() const
+{
+    return __lastPosition - __prevPosition;
+}
+
+/* ----------------------------------------------------------------------- */
+
+GCMeshBuilder::Ring
+GCMeshBuilder::computeRing(const Vector3& center, const Vector3& tangent, const Vector3& left,
+                           real_t radius, real_t v) const
+{
+    Ring ring;
+    ring.center = center;
+    ring.radius = radius;
+    ring.v = v;
+    ring.tangent = tangent;
+    ring.tangent.normalize();
+    // Double-Cross Method (Bloomenthal) as in Discretizer::process(Extrusion *)
+    if (!__hasLastRing) ring.normal = left - ring.tangent * dot(left, ring.tangent);
+    else ring.normal = cross(__lastRing.binormal, ring.tangent);
+    if (normSquared(ring.normal) < GEOM_EPSILON * GEOM_EPSILON)
+        ring.normal = ring.tangent.anOrthogonalVector();
+    ring.normal.normalize();
+    ring.binormal = cross(ring.tangent, ring.normal);
+    ring.binormal.normalize();
+    return ring;
+}
+
+bool GCMeshBuilder::isAligned(const Ring& r0, const Ring& r1, const Ring& r2) const
+{
+    if (dot(r0.tangent, r1.tangent) < 1 - GEOM_EPSILON) return false;
+    if (dot(r1.tangent, r2.tangent) < 1 - GEOM_EPSILON) return false;
+    if (dot(r0.normal, r2.normal) < 1 - GEOM_EPSILON) return false;
+    real_t dv = r2.v - r0.v;
+    if (dv < GEOM_EPSILON) return false;
+    real_t s = (r1.v - r0.v) / dv;
+    real_t tol = GEOM_EPSILON * std::max(dv, real_t(1));
+    if (norm(r1.center - (r0.center + (r2.center - r0.center) * s)) > tol) return false;
+    if (norm(cross(r2.center - r0.center, r0.tangent)) > tol) return false;
+    real_t rtol = GEOM_EPSILON * std::max(std::max(fabs(r0.radius), fabs(r2.radius)), real_t(1));
+    return fabs(r1.radius - (r0.radius + (r2.radius - r0.radius) * s)) < rtol;
+}
+
+void GCMeshBuilder::emitRing(const Vector3& center, const Vector3& tangent, const Vector3& left,
+                             real_t radius, real_t v)
+{
+    Ring ring = computeRing(center, tangent, left, radius, v);
+    __lastRing = ring;
+    __hasLastRing = true;
+    if (__hasHeldRing) {
+        // The held ring is useless if it is on the straight line between its neighbors.
+        if (!(__ringReuse && !__ringV.empty() && isAligned(__flushedRing, __heldRing, ring)))
+            flushRing(__heldRing);
+    }
+    __heldRing = ring;
+    __hasHeldRing = true;
+}
+
+void GCMeshBuilder::appendRing(Point3Array& points, const Ring& ring) const
+{
+    for (std::vector<Vector2>::const_iterator it = __section.begin(); it != __section.end(); ++it)
+        points.push_back(ring.center + (ring.normal * it->x() + ring.binormal * it->y()) * ring.radius);
+}
+
+void GCMeshBuilder::flushRing(const Ring& ring)
+{
+    Point3ArrayPtr target = __storeMesh ? __points : __ringBuffer;
+    uint_t start = __storeMesh ? target->size() : 0;
+    if (!__storeMesh) __ringBuffer->clear();
+    appendRing(*target, ring);
+    uint_t ringid = __ringV.size();
+    __ringV.push_back(ring.v);
+    __flushedRing = ring;
+    for (GCRingConsumerList::const_iterator it = __consumers.begin(); it != __consumers.end(); ++it)
+        (*it)->ringEvent(ringid, ring.center, ring.normal, ring.binormal, ring.radius, ring.v,
+                         target->begin() + start, target->end());
+}
+
+/* ----------------------------------------------------------------------- */
+
+ExplicitModelPtr GCMeshBuilder::finish(bool texCoord, const PolylinePtr& skeleton)
+{
+    if (__nbPoints > 1) {
+        emitRing(__lastPosition, lastTangent(), __lastLeft, __lastRadius, __lastV);
+    }
+    if (__hasHeldRing) {
+        flushRing(__heldRing);
+        __hasHeldRing = false;
+    }
+    uint_t nbrings = __ringV.size();
+    for (GCRingConsumerList::const_iterator it = __consumers.begin(); it != __consumers.end(); ++it)
+        (*it)->endEvent(nbrings);
+    ExplicitModelPtr result;
+    if (__storeMesh) result = buildMesh(__points, nbrings, __ringV, texCoord, skeleton);
+    clear();
+    return result;
+}
+
+ExplicitModelPtr GCMeshBuilder::currentMesh(bool texCoord, const PolylinePtr& skeleton) const
+{
+    if (!__storeMesh) return ExplicitModelPtr();
+    Point3ArrayPtr points(new Point3Array(*__points));
+    std::vector<real_t> ringv(__ringV);
+    if (__hasHeldRing) {
+        appendRing(*points, __heldRing);
+        ringv.push_back(__heldRing.v);
+    }
+    if (__nbPoints > 1) {
+        Ring ring = computeRing(__lastPosition, lastTangent(), __lastLeft, __lastRadius, __lastV);
+        appendRing(*points, ring);
+        ringv.push_back(ring.v);
+    }
+    return buildMesh(points, ringv.size(), ringv, texCoord, skeleton);
+}
+
+ExplicitModelPtr GCMeshBuilder::buildMesh(const Point3ArrayPtr& points, uint_t nbrings,
+                                          const std::vector<real_t>& ringv,
+                                          bool texCoord, const PolylinePtr& skeleton) const
+{
+    uint_t n = __section.size();
+    if (nbrings < 2 || n < 2) return ExplicitModelPtr();
+
+    // Same topology as the one of Discretizer::process(Extrusion *)
+    uint_t nbquads = (nbrings - 1) * (__closed ? n : n - 1);
+    uint_t tn = __closed ? n + 1 : n;
+    Index4ArrayPtr quads(new Index4Array(nbquads));
+    Index4ArrayPtr texquads;
+    if (texCoord && __closed) texquads = Index4ArrayPtr(new Index4Array(nbquads));
+
+    uint_t k = 0;
+    for (uint_t r = 0; r < nbrings - 1; ++r) {
+        uint_t j = r * n;
+        uint_t tj = r * tn;
+        for (uint_t i = 0; i < n - 1; ++i, ++k) {
+            quads->setAt(k, Index4(j + i, j + i + 1, j + i + n + 1, j + i + n));
+            if (texquads) texquads->setAt(k, Index4(tj + i, tj + i + 1, tj + i + tn + 1, tj + i + tn));
+        }
+        if (__closed) {
+            quads->setAt(k, Index4(j + n - 1, j, j + n, j + 2 * n - 1));
+            if (texquads) texquads->setAt(k, Index4(tj + n - 1, tj + n, tj + n + tn, tj + n - 1 + tn));
+            ++k;
+        }
+    }
+
+    Point2ArrayPtr texlist;
+    if (texCoord) {
+        texlist = Point2ArrayPtr(new Point2Array(nbrings * tn));
+        Point2Array::iterator itT = texlist->begin();
+        for (std::vector<real_t>::const_iterator itV = ringv.begin(); itV != ringv.end(); ++itV) {
+            for (std::vector<real_t>::const_iterator itU = __sectionU.begin(); itU != __sectionU.end(); ++itU, ++itT)
+                *itT = Vector2(*itU, *itV);
+            if (__closed) { *itT = Vector2(1.0, *itV); ++itT; }
+        }
+    }
+
+    if (__triangulated) {
+        Index3ArrayPtr triangles(new Index3Array(2 * nbquads));
+        Index3ArrayPtr textriangles;
+        if (texquads) textriangles = Index3ArrayPtr(new Index3Array(2 * nbquads));
+        for (uint_t q = 0; q < nbquads; ++q) {
+            const Index4& quad = quads->getAt(q);
+            triangles->setAt(2 * q, Index3(quad[0], quad[1], quad[2]));
+            triangles->setAt(2 * q + 1, Index3(quad[0], quad[2], quad[3]));
+            if (textriangles) {
+                const Index4& tquad = texquads->getAt(q);
+                textriangles->setAt(2 * q, Index3(tquad[0], tquad[1], tquad[2]));
+                textriangles->setAt(2 * q + 1, Index3(tquad[0], tquad[2], tquad[3]));
+            }
+        }
+        TriangleSet * t = new TriangleSet(points, triangles, true, __ccw, false, skeleton);
+        t->getTexCoordList() = texlist;
+        t->getTexCoordIndexList() = textriangles;
+        return ExplicitModelPtr(t);
+    }
+    else {
+        QuadSet * q = new QuadSet(points, quads, true, __ccw, false, skeleton);
+        q->getTexCoordList() = texlist;
+        q->getTexCoordIndexList() = texquads;
+        return ExplicitModelPtr(q);
+    }
+}
+
+/* ----------------------------------------------------------------------- */
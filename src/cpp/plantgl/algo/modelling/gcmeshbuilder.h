@@ -0,0 +1,223 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#ifndef __PGL_GC_MESH_BUILDER_H__
+#define __PGL_GC_MESH_BUILDER_H__
+
+#include "../algo_config.h"
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/math/util_vector.h>
+#include <plantgl/scenegraph/geometry/curve.h>
+#include <plantgl/scenegraph/geometry/explicitmodel.h>
+#include <plantgl/scenegraph/geometry/polyline.h>
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <vector>
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Receive the rings of a generalized cylinder as soon as they are built.
+class ALGO_API GCRingConsumer : public RefCountObject {
+public:
+    GCRingConsumer() { }
+
+    virtual ~GCRingConsumer();
+
+    /** Called for each new ring. [\e begin, \e end) are the points of the ring,
+        \e normal and \e binormal the section frame and \e v the arc length of the ring along the axis. */
+    virtual void ringEvent(uint_t ringid, const Vector3& center,
+                           const Vector3& normal, const Vector3& binormal,
+                           real_t radius, real_t v,
+                           Point3Array::const_iterator begin,
+                           Point3Array::const_iterator end) { }
+
+    /// Called when the generalized cylinder is finished.
+    virtual void endEvent(uint_t nbrings) { }
+
+};
+
+typedef RCPtr<GCRingConsumer> GCRingConsumerPtr;
+typedef std::vector<GCRingConsumerPtr> GCRingConsumerList;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class GCMeshBuilder
+   \brief Build incrementally the tube mesh of a generalized cylinder.
+
+   Axis points are pushed one by one while the turtle walks. A ring is emitted
+   as soon as its tangent is known (i.e. when the next point arrives) using
+   a precomputed table of the section coordinates. The reference frame is
+   propagated with the double-cross method used by the Discretizer for Extrusion.
+   Rings of straight portions with a linear radius variation are not repeated.
+*/
+
+class ALGO_API GCMeshBuilder : public RefCountObject {
+public:
+
+    /// Constructs a builder for the cross section \e crossSection.
+    GCMeshBuilder(const Curve2DPtr& crossSection,
+                  bool ccw = true,
+                  bool triangulated = false);
+
+    virtual ~GCMeshBuilder();
+
+    /// Set the cross section. Only possible before the first ring is emitted.
+    bool setCrossSection(const Curve2DPtr& crossSection, bool ccw = true);
+
+    /// Create a builder with the same options that start with the last point of \e self.
+    RCPtr<GCMeshBuilder> branch() const;
+
+    /// Push a new point of the axis with its left direction and radius.
+    void pushPoint(const Vector3& position, const Vector3& left, real_t radius);
+
+    /// Change the radius of the last pushed point.
+    void setLastRadius(real_t radius);
+
+    /// Finish the mesh and return it. \e self is cleared.
+    ExplicitModelPtr finish(bool texCoord = false, const PolylinePtr& skeleton = PolylinePtr());
+
+    /// Return the mesh built so far without modifying \e self.
+    ExplicitModelPtr currentMesh(bool texCoord = false, const PolylinePtr& skeleton = PolylinePtr()) const;
+
+    /// Remove all points and rings.
+    void clear();
+
+    /// Number of point pushed since the last clear.
+    inline uint_t getPointCount() const { return __nbPushed; }
+
+    /// Number of rings emitted.
+    inline uint_t getRingCount() const { return __ringV.size(); }
+
+    inline uint_t getSectionSize() const { return __section.size(); }
+
+    inline bool isSectionClosed() const { return __closed; }
+
+    /// Straight rings with linear radius are not repeated if \e b is true.
+    inline void setRingReuse(bool b) { __ringReuse = b; }
+    inline bool getRingReuse() const { return __ringReuse; }
+
+    inline void setTriangulated(bool b) { __triangulated = b; }
+    inline bool isTriangulated() const { return __triangulated; }
+
+    /// Keep the mesh in memory. If false, rings are only streamed to the consumers.
+    inline void setMeshStored(bool b) { __storeMesh = b; }
+    inline bool isMeshStored() const { return __storeMesh; }
+
+    inline void registerConsumer(const GCRingConsumerPtr& consumer)
+    { __consumers.push_back(consumer); }
+
+    inline const GCRingConsumerList& getConsumers() const
+    { return __consumers; }
+
+protected:
+    struct Ring {
+        Vector3 center;
+        Vector3 tangent;
+        Vector3 normal;
+        Vector3 binormal;
+        real_t radius;
+        real_t v;
+    };
+
+    Ring computeRing(const Vector3& center, const Vector3& tangent, const Vector3& left,
+                     real_t radius, real_t v) const;
+
+    void emitRing(const Vector3& center, const Vector3& tangent, const Vector3& left,
+                  real_t radius, real_t v);
+
+    void flushRing(const Ring& ring);
+
+    void appendRing(Point3Array& points, const Ring& ring) const;
+
+    bool isAligned(const Ring& r0, const Ring& r1, const Ring& r2) const;
+
+    Vector3 lastTangent() const;
+
+    ExplicitModelPtr buildMesh(const Point3ArrayPtr& points, uint_t nbrings,
+                               const std::vector<real_t>& ringv,
+                               bool texCoord, const PolylinePtr& skeleton) const;
+
+    // Precomputed section coordinates (cos/sin for a circular section)
+    std::vector<Vector2> __section;
+    std::vector<real_t> __sectionU;
+    bool __closed;
+    bool __ccw;
+
+    bool __triangulated;
+    bool __ringReuse;
+    bool __storeMesh;
+
+    // Current window of the axis
+    uint_t __nbPushed;
+    uint_t __nbPoints;
+    Vector3 __prevPosition;
+    Vector3 __lastPosition;
+    Vector3 __lastLeft;
+    real_t __lastRadius;
+    real_t __lastV;
+
+    // Last computed ring, used to propagate the frame
+    Ring __lastRing;
+    bool __hasLastRing;
+
+    // Ring waiting to know if it can be skipped, and last flushed ring
+    Ring __heldRing;
+    bool __hasHeldRing;
+    Ring __flushedRing;
+
+    Point3ArrayPtr __ringBuffer;
+
+    Point3ArrayPtr __points;
+    std::vector<real_t> __ringV;
+
+    GCRingConsumerList __consumers;
+};
+
+typedef RCPtr<GCMeshBuilder> GCMeshBuilderPtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
@@ -167,6 +167,14 @@ protected:
                                       bool crossSectionCCW,
                                       bool currentcolor = false);
 
+    /// build the generalized cylinder directly as a mesh, reusing the incremental builder if possible
+    void _meshedGeneralizedCylinder(const Point3ArrayPtr& points,
+                                    const std::vector<Vector3>& left,
+                                    const std::vector<real_t>& radius,
+                                    const Curve2DPtr& crossSection,
+                                    bool crossSectionCCW,
+                                    bool currentcolor = false);
+
     virtual void _sphere(real_t radius);
 
     /// draw a circle in yz plane of radius = radius (default : current width)
@@ -189,6 +197,8 @@ protected:
     std::vector<AppearancePtr> __appList;
 
     ScenePtr __scene;
+
+    bool __inPartialView;
 };
 
 /* ----------------------------------------------------------------------- */
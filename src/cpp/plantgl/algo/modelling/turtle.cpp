@@ -277,6 +277,7 @@ TurtleParam::reset(){
   radiusList.clear();
   initial.reset();
   guide = TurtlePathPtr();
+  gcMesh = GCMeshBuilderPtr();
 }
 
 TurtleParam * TurtleParam::copy(){
@@ -330,12 +331,14 @@ void TurtleParam::keepLastPoint(){
     leftList = vector<Vector3>(1,*(leftList.end()-1));
   if(!radiusList.empty())
     radiusList = vector<real_t>(1,*(radiusList.end()-1));
+  if(gcMesh) gcMesh = gcMesh->branch();
 }
 
 void TurtleParam::removePoints(){
   pointList->clear();
   leftList.clear();
   radiusList.clear();
+  if(gcMesh) gcMesh->clear();
 }
 
 void TurtleParam::polygon(bool t){
@@ -358,6 +361,7 @@ void TurtleParam::generalizedCylinder(bool t){
   }
   else {
     initial.reset();
+    gcMesh = GCMeshBuilderPtr();
   }
 
 }
@@ -367,11 +371,13 @@ void TurtleParam::pushPosition(){
   if(__generalizedCylinder) {
     leftList.push_back(left);
     radiusList.push_back(width);
+    if(gcMesh) gcMesh->pushPoint(position,left,width);
   }
 }
 
 void TurtleParam::pushRadius(){
     *(radiusList.end()-1) = width;
+    if(gcMesh) gcMesh->setLastRadius(width);
 }
 
 /*----------------------------------------------------------*/
@@ -386,7 +392,8 @@ Turtle::Turtle(TurtleParam * params):
   id(Shape::NOID),
   parentId(Shape::NOID),
   warn_on_error(true),
-  path_info_cache_enabled(true)
+  path_info_cache_enabled(true),
+  gc_meshing_enabled(false)
 {
     if (!__params->crossSection) setDefaultCrossSection();
     assert (__params->crossSection && "Failed to initialize cross section");
@@ -399,6 +406,11 @@ void Turtle::registerPushPopHandler(PushPopHandlerPtr handler)
     __pushpophandlerlist.push_back(handler);
 }
 
+void Turtle::registerGCRingConsumer(GCRingConsumerPtr consumer)
+{
+    __gcringconsumerlist.push_back(consumer);
+}
+
 string
 Turtle::str() const {
     stringstream ss;
@@ -896,6 +908,11 @@ void Turtle::oLineTo(const Vector3& v, real_t topradius )
       __params->generalizedCylinder(true);
       __params->customId = popId();
       __params->customParentId = parentId;
+      if (gc_meshing_enabled) {
+          __params->gcMesh = GCMeshBuilderPtr(new GCMeshBuilder(__params->crossSection, __params->crossSectionCCW));
+          for (GCRingConsumerList::const_iterator it = __gcringconsumerlist.begin(); it != __gcringconsumerlist.end(); ++it)
+              __params->gcMesh->registerConsumer(*it);
+      }
       __params->pushPosition();
   }
 
@@ -932,6 +949,7 @@ void Turtle::_setCrossSection(const Curve2DPtr& curve, bool ccw, bool defaultSec
         __params->initial.crossSection = curve;
         __params->initial.crossSectionCCW = ccw;
         __params->initial.defaultSection = defaultSection;
+        if (__params->gcMesh) __params->gcMesh->setCrossSection(curve, ccw);
     }
 }
 
@@ -1317,7 +1335,8 @@ void Turtle::_sweep(real_t length, real_t topradius)
 
 PglTurtle::PglTurtle(TurtleParam * param):
   Turtle(param),
-  __scene(new Scene()){
+  __scene(new Scene()),
+  __inPartialView(false){
    defaultValue();
 }
 
@@ -1876,6 +1895,10 @@ PglTurtle::_generalizedCylinder(const Point3ArrayPtr& points,
                                 bool crossSectionCCW,
                                 bool currentcolor){
   if (points->size() == 2 && norm(points->getAt(0) - points->getAt(1)) < GEOM_EPSILON) return;
+  if (gc_meshing_enabled) {
+      _meshedGeneralizedCylinder(points, leftList, radiusList, crossSection, crossSectionCCW, currentcolor);
+      return;
+  }
   LineicModelPtr axis = LineicModelPtr(new Polyline(Point3ArrayPtr(
                           new Point3Array(*points))));
   Point2ArrayPtr radius(new Point2Array(radiusList.size()));
@@ -1897,6 +1920,39 @@ PglTurtle::_generalizedCylinder(const Point3ArrayPtr& points,
   _addToScene(GeometryPtr(extrusion),!currentcolor);
 }
 
+void
+PglTurtle::_meshedGeneralizedCylinder(const Point3ArrayPtr& points,
+                                      const vector<Vector3>& leftList,
+                                      const vector<real_t>& radiusList,
+                                      const Curve2DPtr& crossSection,
+                                      bool crossSectionCCW,
+                                      bool currentcolor){
+  GCMeshBuilderPtr builder = __params->gcMesh;
+  // The builder of the parameters has followed the points only for the current generalized cylinder.
+  bool incremental = builder && !currentcolor && builder->getPointCount() == points->size();
+  if (!incremental) {
+      Curve2DPtr mcrossSection = crossSection;
+      if (!mcrossSection) {
+          mcrossSection = Curve2DPtr(Polyline2D::Circle(1,__params->sectionResolution));
+          crossSectionCCW = true;
+      }
+      builder = GCMeshBuilderPtr(new GCMeshBuilder(mcrossSection, crossSectionCCW));
+      Point3Array::const_iterator itP = points->begin();
+      std::vector<Vector3>::const_iterator itL = leftList.begin();
+      std::vector<real_t>::const_iterator itR = radiusList.begin();
+      for (; itP != points->end() && itL != leftList.end() && itR != radiusList.end(); ++itP, ++itL, ++itR)
+          builder->pushPoint(*itP, *itL, *itR);
+  }
+  AppearancePtr app = currentcolor ? getCurrentMaterial() : getCurrentInitialMaterial();
+  bool texCoord = is_valid_ptr(dynamic_pointer_cast<Texture2D>(app));
+  PolylinePtr skeleton(new Polyline(Point3ArrayPtr(new Point3Array(*points))));
+  ExplicitModelPtr mesh;
+  // partialView requires the builder to continue after the mesh is produced.
+  if (incremental && __inPartialView) mesh = builder->currentMesh(texCoord, skeleton);
+  else mesh = builder->finish(texCoord, skeleton);
+  if (mesh) _addToScene(GeometryPtr(mesh),!currentcolor);
+}
+
 void
 PglTurtle::_label(const string& text, int size ){
   FontPtr font;
@@ -1978,11 +2034,13 @@ ScenePtr PglTurtle::partialView(){
     ScenePtr currentscene = new Scene(*__scene);
     if(__params->isGeneralizedCylinderOn()){
       if(__params->pointList->size() > 1){
+        __inPartialView = true;
         _generalizedCylinder(__params->pointList,
                            __params->leftList,
                            __params->radiusList,
                            __params->initial.crossSection,
                            __params->initial.crossSectionCCW);
+        __inPartialView = false;
       }
     }
     frame();
@@ -75,6 +75,9 @@ public:
 
     void registerPushPopHandler(PushPopHandlerPtr handler);
 
+    /// Register a consumer of the rings of generalized cylinders. Require gc meshing to be enabled.
+    void registerGCRingConsumer(GCRingConsumerPtr consumer);
+
     Turtle(TurtleParam * params = NULL);
     virtual ~Turtle();
 
@@ -491,6 +494,12 @@ public:
     inline void enablePathInfoCache(bool b) { path_info_cache_enabled = b; }
     inline bool pathInfoCacheEnabled() const { return path_info_cache_enabled; }
 
+    /// Build generalized cylinders incrementally as meshes instead of Extrusion.
+    bool gc_meshing_enabled;
+
+    inline void enableGCMeshing(bool b) { gc_meshing_enabled = b; }
+    inline bool gcMeshingEnabled() const { return gc_meshing_enabled; }
+
     void leftReflection();
     void upReflection();
     void headingReflection();
@@ -556,6 +565,8 @@ protected:
 
     PushPopHandlerList __pushpophandlerlist;
 
+    GCRingConsumerList __gcringconsumerlist;
+
 };
 
 /* ----------------------------------------------------------------------- */
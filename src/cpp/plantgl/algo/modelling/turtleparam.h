@@ -42,6 +42,7 @@
 #define __PGL_TURTLE_PARAM_H__
 
 #include "../algo_config.h"
+#include "gcmeshbuilder.h"
 #include <plantgl/math/util_vector.h>
 #include <plantgl/math/util_matrix.h>
 #include <plantgl/scenegraph/appearance/color.h>
@@ -241,6 +242,9 @@ public:
   std::vector<Vector3> leftList;
   std::vector<real_t> radiusList;
 
+  /// Incremental mesh of the current generalized cylinder, if enabled.
+  GCMeshBuilderPtr gcMesh;
+
   uint_t customId;
   uint_t customParentId;
   uint_t lastId;
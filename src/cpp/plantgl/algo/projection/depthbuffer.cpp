@@ -0,0 +1,130 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+             
+
+
+#include "depthbuffer.h"
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+DepthBuffer::DepthBuffer(uint16_t width, uint16_t height, ePrecision precision):
+    RefCountObject(),
+    __width(width),
+    __height(height),
+    __precision(precision),
+    __realDepthArray(),
+    __realDepths(NULL),
+    __near(0),
+    __scale(1)
+{
+    size_t size = size_t(width) * height;
+    if (precision == eRealDepth) {
+        __realDepthArray = RealArray2Ptr(new RealArray2(uint_t(width), uint_t(height), REAL_MAX));
+        __realDepths = &*__realDepthArray->begin();
+    }
+    else if (precision == eFloatDepth) __floatDepths.resize(size);
+    else __fixedDepths.resize(3 * size);
+    clear();
+}
+
+DepthBuffer::~DepthBuffer() {}
+
+size_t DepthBuffer::getDepthSize() const
+{
+    if (__precision == eRealDepth) return sizeof(real_t);
+    if (__precision == eFloatDepth) return sizeof(float);
+    return 3;
+}
+
+const void * DepthBuffer::data() const
+{
+    if (__precision == eRealDepth) return __realDepths;
+    if (__precision == eFloatDepth) return __floatDepths.data();
+    return __fixedDepths.data();
+}
+
+void DepthBuffer::setRange(real_t near, real_t far)
+{
+    real_t scale = (far > near ? (FIXED_EMPTY - 1) / (far - near) : 1);
+    if (near == __near && scale == __scale) return;
+    if (__precision == eFixed24Depth) {
+        real_t oldnear = __near, oldscale = __scale;
+        __near = near; __scale = scale;
+        size_t size = size_t(__width) * __height;
+        for (size_t i = 0; i < size; ++i) {
+            uint32_t code = getFixedAt(i);
+            if (code != FIXED_EMPTY) setFixedAt(i, encode(oldnear + code / oldscale));
+        }
+    }
+    else { __near = near; __scale = scale; }
+}
+
+void DepthBuffer::clear()
+{
+    if (__precision == eRealDepth) std::fill(__realDepthArray->begin(), __realDepthArray->end(), REAL_MAX);
+    else if (__precision == eFloatDepth) std::fill(__floatDepths.begin(), __floatDepths.end(), std::numeric_limits<float>::max());
+    else std::fill(__fixedDepths.begin(), __fixedDepths.end(), uchar_t(0xFF));
+}
+
+RealArray2Ptr DepthBuffer::getRealDepths() const
+{
+    if (__precision == eRealDepth) return __realDepthArray;
+    RealArray2Ptr result(new RealArray2(uint_t(__width), uint_t(__height)));
+    for (uint_t x = 0; x < __width; ++x)
+        for (uint_t y = 0; y < __height; ++y)
+            result->setAt(x, y, getAt(x, y));
+    return result;
+}
+
+DepthBufferPtr DepthBuffer::deepcopy() const
+{
+    DepthBuffer * copy = new DepthBuffer(*this);
+    if (__precision == eRealDepth) {
+        copy->__realDepthArray = RealArray2Ptr(new RealArray2(*__realDepthArray));
+        copy->__realDepths = &*copy->__realDepthArray->begin();
+    }
+    return DepthBufferPtr(copy);
+}
+
+/* ----------------------------------------------------------------------- */
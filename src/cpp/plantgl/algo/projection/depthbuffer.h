@@ -0,0 +1,188 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file depthbuffer.h
+    \brief Depth buffer of ZBufferEngine with configurable precision.
+*/
+
+
+
+#ifndef __DepthBuffer_h__
+#define __DepthBuffer_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/tool/util_array2.h>
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/math/util_math.h>
+#include <limits>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/** 
+    \class DepthBuffer
+    \brief The depth of each pixel of an image, stored with real_t, float or 24 bits fixed point values.
+
+    Depths are indexed by (x, y) and stored with x major order, as RealArray2(width, height).
+    Fixed point depths are packed in 3 bytes and encode linearly the range [near, far] of the camera,
+    given by setRange. The farthest value marks empty pixels and is returned as REAL_MAX.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class DepthBuffer;
+typedef RCPtr<DepthBuffer> DepthBufferPtr;
+
+class ALGO_API DepthBuffer : public RefCountObject {
+public:
+
+    enum ePrecision {
+        eRealDepth,
+        eFloatDepth,
+        eFixed24Depth
+    };
+
+    DepthBuffer(uint16_t width, uint16_t height, ePrecision precision = eRealDepth);
+    virtual ~DepthBuffer();
+
+    inline ePrecision getPrecision() const { return __precision; }
+    inline uint16_t width() const { return __width; }
+    inline uint16_t height() const { return __height; }
+
+    /// Size in bytes of the depth of a pixel.
+    size_t getDepthSize() const;
+
+    /// Pointer to the stored depths.
+    const void * data() const;
+
+    /** Set the range of depths encoded by fixed point depths.
+        Stored depths are encoded again if the range changes. */
+    void setRange(real_t near, real_t far);
+
+    /// Set all the pixels to empty.
+    void clear();
+
+    inline real_t getAt(uint_t x, uint_t y) const {
+        size_t i = size_t(x) * __height + y;
+        if (__precision == eRealDepth) return __realDepths[i];
+        if (__precision == eFloatDepth) {
+            float z = __floatDepths[i];
+            return z == std::numeric_limits<float>::max() ? REAL_MAX : z;
+        }
+        return decode(getFixedAt(i));
+    }
+
+    inline void setAt(uint_t x, uint_t y, real_t z) {
+        size_t i = size_t(x) * __height + y;
+        if (__precision == eRealDepth) __realDepths[i] = z;
+        else if (__precision == eFloatDepth) __floatDepths[i] = float(z);
+        else setFixedAt(i, encode(z));
+    }
+
+    /// Whether \e z is closer than the depth of the pixel (x, y), compared with the precision of the buffer.
+    inline bool isCloser(uint_t x, uint_t y, real_t z) const {
+        size_t i = size_t(x) * __height + y;
+        if (__precision == eRealDepth) {
+            real_t cz = __realDepths[i];
+            return z < cz && (cz - z) > GEOM_EPSILON;
+        }
+        if (__precision == eFloatDepth) {
+            float fz = float(z), cz = __floatDepths[i];
+            return fz < cz && (cz - fz) > GEOM_EPSILON;
+        }
+        return encode(z) < getFixedAt(i);
+    }
+
+    /// The depths as real values. The array is shared by eRealDepth buffers and converted otherwise.
+    RealArray2Ptr getRealDepths() const;
+
+    DepthBufferPtr deepcopy() const;
+
+    static const uint32_t FIXED_EMPTY = 0xFFFFFF;
+
+protected:
+
+    inline uint32_t getFixedAt(size_t i) const {
+        const uchar_t * d = &__fixedDepths[3 * i];
+        return uint32_t(d[0]) | (uint32_t(d[1]) << 8) | (uint32_t(d[2]) << 16);
+    }
+
+    inline void setFixedAt(size_t i, uint32_t code) {
+        uchar_t * d = &__fixedDepths[3 * i];
+        d[0] = uchar_t(code); d[1] = uchar_t(code >> 8); d[2] = uchar_t(code >> 16);
+    }
+
+    inline uint32_t encode(real_t z) const {
+        if (z <= __near) return 0;
+        real_t code = (z - __near) * __scale + 0.5;
+        return code >= FIXED_EMPTY - 1 ? FIXED_EMPTY - 1 : uint32_t(code);
+    }
+
+    inline real_t decode(uint32_t code) const {
+        return code == FIXED_EMPTY ? REAL_MAX : __near + code / __scale;
+    }
+
+    uint16_t __width;
+    uint16_t __height;
+    ePrecision __precision;
+
+    RealArray2Ptr __realDepthArray;
+    /// Pointer to the data of __realDepthArray.
+    real_t * __realDepths;
+    std::vector<float> __floatDepths;
+    std::vector<uchar_t> __fixedDepths;
+
+    real_t __near;
+    /// Number of fixed point steps per unit of depth.
+    real_t __scale;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
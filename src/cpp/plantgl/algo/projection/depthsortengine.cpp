@@ -48,13 +48,26 @@
 #include <plantgl/scenegraph/geometry/triangleset.h>
 #include <plantgl/scenegraph/container/indexarray.h>
 #include <plantgl/algo/base/planeclipping.h>
+#include "zbufferengine.h"
+#include <algorithm>
 
 /* ----------------------------------------------------------------------- */
 
 PGL_USING_NAMESPACE
 
+// Maximum number of cells of the spatial hash covered by a polygon.
+// Bigger polygons are stored in a separate list.
+#define MAX_CELLS_PER_POLYGON 256
+
+// Number of polygons used to estimate the size of the cells.
+#define AUTO_CELLSIZE_SAMPLE 64
+
 DepthSortEngine::DepthSortEngine() :
-    ProjectionEngine()
+    ProjectionEngine(),
+    __nextorder(0),
+    __cellsize(0),
+    __autocellsize(true),
+    __multithreaded(false)
 {
 }
 
@@ -66,8 +79,6 @@ DepthSortEngine::~DepthSortEngine()
 
 void DepthSortEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid )
 {
-	#ifdef PGL_WITH_CGAL
-
     /*
     const Point3ArrayPtr points(triangles->getPointList());
     const Index3ArrayPtr indices(triangles->getIndexList());
@@ -89,8 +100,6 @@ void DepthSortEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearanc
         processTriangle(v0, v1, v2, id);
 
     }  
-
-	#endif
 }
 
 void DepthSortEngine::iprocess(PolylinePtr polyline, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid )
@@ -105,6 +114,256 @@ void DepthSortEngine::iprocess(PointSetPtr pointset, MaterialPtr material, uint3
 
 
 
+/* ----------------------------------------------------------------------- */
+
+inline uint64_t cellKey(int32_t ix, int32_t iy) 
+{ return (uint64_t(uint32_t(ix)) << 32) | uint64_t(uint32_t(iy)); }
+
+inline int32_t cellIndex(real_t v, real_t cellsize)
+{
+    real_t i = floor(v / cellsize);
+    if (i < -1e9) return -1000000000;
+    if (i > 1e9) return 1000000000;
+    return int32_t(i);
+}
+
+// Cell size is twice the mean extent of the polygons.
+inline real_t estimateCellSize(DepthSortEngine::PolygonInfoList::const_iterator begin, DepthSortEngine::PolygonInfoList::const_iterator end)
+{
+    real_t extent = 0;
+    size_t nbpolygons = 0;
+    for ( ; begin != end; ++begin, ++nbpolygons)
+        extent += std::max(begin->pmax.x() - begin->pmin.x(), begin->pmax.y() - begin->pmin.y());
+    if (nbpolygons > 0) extent /= nbpolygons;
+    return (extent > GEOM_EPSILON ? 2 * extent : 1);
+}
+
+void DepthSortEngine::setCellSize(real_t value)
+{
+    __cellsize = value;
+    __autocellsize = (value <= 0);
+    _rehash();
+}
+
+bool DepthSortEngine::_cellRange(const PolygonInfo& polygon, int32_t& ixmin, int32_t& ixmax, int32_t& iymin, int32_t& iymax) const
+{
+    ixmin = cellIndex(polygon.pmin.x(), __cellsize);
+    ixmax = cellIndex(polygon.pmax.x(), __cellsize);
+    iymin = cellIndex(polygon.pmin.y(), __cellsize);
+    iymax = cellIndex(polygon.pmax.y(), __cellsize);
+    return (uint64_t(ixmax - ixmin + 1) * uint64_t(iymax - iymin + 1) <= MAX_CELLS_PER_POLYGON);
+}
+
+void DepthSortEngine::_hashPolygon(PolygonInfoSet::iterator it)
+{
+    if (__cellsize <= 0) __cellsize = estimateCellSize(it, std::next(it));
+    int32_t ixmin, ixmax, iymin, iymax;
+    if (!_cellRange(*it, ixmin, ixmax, iymin, iymax)) {
+        __largepolygons.push_back(it);
+        return;
+    }
+    for (int32_t ix = ixmin; ix <= ixmax; ++ix)
+        for (int32_t iy = iymin; iy <= iymax; ++iy)
+            __cells[cellKey(ix, iy)].push_back(it);
+}
+
+inline void removeFrom(DepthSortEngine::PolygonInfoIteratorVector& polygons, DepthSortEngine::PolygonInfoSet::iterator it)
+{
+    for (DepthSortEngine::PolygonInfoIteratorVector::iterator itP = polygons.begin(); itP != polygons.end(); ++itP)
+        if (*itP == it) {
+            *itP = polygons.back();
+            polygons.pop_back();
+            return;
+        }
+}
+
+void DepthSortEngine::_unhashPolygon(PolygonInfoSet::iterator it)
+{
+    int32_t ixmin, ixmax, iymin, iymax;
+    if (!_cellRange(*it, ixmin, ixmax, iymin, iymax)) {
+        removeFrom(__largepolygons, it);
+        return;
+    }
+    for (int32_t ix = ixmin; ix <= ixmax; ++ix)
+        for (int32_t iy = iymin; iy <= iymax; ++iy) {
+            pgl_hash_map<uint64_t, PolygonInfoIteratorVector>::iterator itcell = __cells.find(cellKey(ix, iy));
+            if (itcell == __cells.end()) continue;
+            removeFrom(itcell->second, it);
+            if (itcell->second.empty()) __cells.erase(itcell);
+        }
+}
+
+void DepthSortEngine::_rehash()
+{
+    __cells.clear();
+    __largepolygons.clear();
+    if (__polygonlist.empty()) return;
+    if (__cellsize <= 0) __cellsize = estimateCellSize(__polygonlist.begin(), __polygonlist.end());
+    for (PolygonInfoSet::iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it)
+        _hashPolygon(it);
+}
+
+void DepthSortEngine::endProcess()
+{
+    flush();
+}
+
+/* ----------------------------------------------------------------------- */
+
+// Clip the polygon with the half plane coord[axis] <= bound (or >= bound).
+void clip_polygon(std::vector<Vector3>& polygon, uchar_t axis, real_t bound, bool below)
+{
+    std::vector<Vector3> result;
+    size_t nbpoints = polygon.size();
+    for (size_t i = 0; i < nbpoints; ++i) {
+        const Vector3& current = polygon[i];
+        const Vector3& next = polygon[(i+1) % nbpoints];
+        bool currentin = (below ? current[axis] <= bound : current[axis] >= bound);
+        bool nextin = (below ? next[axis] <= bound : next[axis] >= bound);
+        if (currentin) result.push_back(current);
+        if (currentin != nextin) {
+            Vector3 p = current + (next - current) * ((bound - current[axis]) / (next[axis] - current[axis]));
+            p[axis] = bound;
+            result.push_back(p);
+        }
+    }
+    polygon.swap(result);
+}
+
+// Cut the ccw triangle \e polygon with the rectangle [xmin,xmax]x[ymin,ymax] and triangulate the result.
+std::vector<Point3ArrayPtr> clip_triangle(const Point3ArrayPtr& triangle, real_t xmin, real_t xmax, real_t ymin, real_t ymax)
+{
+    std::vector<Vector3> polygon(triangle->begin(), triangle->end());
+    clip_polygon(polygon, 0, xmin, false);
+    if (polygon.size() >= 3) clip_polygon(polygon, 0, xmax, true);
+    if (polygon.size() >= 3) clip_polygon(polygon, 1, ymin, false);
+    if (polygon.size() >= 3) clip_polygon(polygon, 1, ymax, true);
+    std::vector<Point3ArrayPtr> result;
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        const Vector3& p0 = polygon[0]; const Vector3& p1 = polygon[i]; const Vector3& p2 = polygon[i+1];
+        if (cross(Vector2(p1.x()-p0.x(),p1.y()-p0.y()), Vector2(p2.x()-p0.x(),p2.y()-p0.y())) <= 0) continue;
+        Point3ArrayPtr points(new Point3Array());
+        points->push_back(p0); points->push_back(p1); points->push_back(p2);
+        result.push_back(points);
+    }
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+DepthSortEngine::PolygonInfo DepthSortEngine::_toPolygonInfo(const Point3ArrayPtr& points, uint32_t id) const
+{
+    DepthSortEngine::PolygonInfo pinfo;
+    pinfo.points = points;
+    std::pair<Vector3,Vector3> bounds = points->getBounds();
+    pinfo.pmin = bounds.first;
+    pinfo.pmax = bounds.second;
+    pinfo.id = id;
+    pinfo.order = 0;
+    return pinfo;
+}
+
+
+DepthSortEngine::PolygonInfoList DepthSortEngine::_toPolygonInfo(const std::vector<Point3ArrayPtr>& polygons, uint32_t id) const
+{
+    PolygonInfoList result;   
+    for (std::vector<Point3ArrayPtr>::const_iterator it = polygons.begin(); it != polygons.end() ; ++it) {
+        result.push_back( _toPolygonInfo(*it, id));
+    }
+    return result;
+}
+
+void DepthSortEngine::removePolygon(PolygonInfoSet::iterator it)
+{
+    _unhashPolygon(it);
+    __polygonlist.erase(it);
+}
+
+DepthSortEngine::PolygonInfoSet::iterator DepthSortEngine::appendPolygon(const PolygonInfo& polygon)
+{
+    PolygonInfoSet::iterator it = __polygonlist.insert(__polygonlist.end(), polygon);
+    it->order = __nextorder++;
+    if (__autocellsize && __nextorder == AUTO_CELLSIZE_SAMPLE) {
+        // first estimation of the cell size is refined with more polygons.
+        __cellsize = estimateCellSize(__polygonlist.begin(), __polygonlist.end());
+        _rehash();
+    }
+    else _hashPolygon(it);
+    return it;
+}
+
+DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::appendPolygons(DepthSortEngine::PolygonInfoList::iterator begin, DepthSortEngine::PolygonInfoList::iterator end)
+{
+    DepthSortEngine::PolygonInfoIteratorList result;
+    for(DepthSortEngine::PolygonInfoList::iterator it = begin; it != end; ++it)
+        result.push_back(appendPolygon(*it));
+    return result;
+}
+
+inline bool overlap2d(const DepthSortEngine::PolygonInfo& p1, const DepthSortEngine::PolygonInfo& p2)
+{
+    if ((p1.pmin.x() > p2.pmax.x())||(p1.pmax.x() < p2.pmin.x())) { return false; }
+    if ((p1.pmin.y() > p2.pmax.y())||(p1.pmax.y() < p2.pmin.y())) { return false; }
+    return true;
+}
+
+inline bool lowerOrder(const DepthSortEngine::PolygonInfoSet::iterator& it1, const DepthSortEngine::PolygonInfoSet::iterator& it2)
+{ return it1->order < it2->order; }
+
+inline bool sameOrder(const DepthSortEngine::PolygonInfoSet::iterator& it1, const DepthSortEngine::PolygonInfoSet::iterator& it2)
+{ return it1->order == it2->order; }
+
+DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::getIntersectingPolygons(const PolygonInfo& polygon)
+{
+    DepthSortEngine::PolygonInfoIteratorList result;
+    int32_t ixmin, ixmax, iymin, iymax;
+    if (__cellsize <= 0 || !_cellRange(polygon, ixmin, ixmax, iymin, iymax)) {
+        for (DepthSortEngine::PolygonInfoSet::iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it) {
+            if (overlap2d(polygon, *it)) result.push_back(it);
+        }
+        return result;
+    }
+
+    // Candidates are gathered from the cells and sorted in the order of the polygon list.
+    PolygonInfoIteratorVector candidates(__largepolygons);
+    for (int32_t ix = ixmin; ix <= ixmax; ++ix)
+        for (int32_t iy = iymin; iy <= iymax; ++iy) {
+            pgl_hash_map<uint64_t, PolygonInfoIteratorVector>::const_iterator itcell = __cells.find(cellKey(ix, iy));
+            if (itcell != __cells.end()) candidates.insert(candidates.end(), itcell->second.begin(), itcell->second.end());
+        }
+    std::sort(candidates.begin(), candidates.end(), lowerOrder);
+    candidates.erase(std::unique(candidates.begin(), candidates.end(), sameOrder), candidates.end());
+    for (PolygonInfoIteratorVector::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        if (overlap2d(polygon, **it)) result.push_back(*it);
+    }
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+// Point of the plane of the triangle \e polygon projected on \e vertex.
+Vector3 liftVertex(const Vector2& vertex, const Point3ArrayPtr& polygon)
+{
+    real_t area = edgeFunction(polygon->getAt(0), polygon->getAt(1), polygon->getAt(2));
+    real_t w0 = edgeFunction(polygon->getAt(1), polygon->getAt(2), vertex);
+    real_t w1 = edgeFunction(polygon->getAt(2), polygon->getAt(0), vertex);
+    real_t w2 = edgeFunction(polygon->getAt(0), polygon->getAt(1), vertex);
+
+    if (fabs(area) <= GEOM_EPSILON) {
+        real_t sumw = w0 + w1 + w2;
+        w0 /= sumw;
+        w1 /= sumw;
+        w2 /= sumw;
+    }
+    else {
+        w0 /= area;
+        w1 /= area;
+        w2 /= area;                
+    }
+
+    return polygon->getAt(0)*w0 + polygon->getAt(1)*w1 + polygon->getAt(2)*w2;
+}
+
 #ifdef PGL_WITH_CGAL
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/Boolean_set_operations_2.h>
@@ -263,30 +522,8 @@ std::list<Polygon_2> triangulate(const Pwh_list_2& polygons)
 Point3ArrayPtr project(const Polygon_2& proj, Point3ArrayPtr polygon)
 {
     Point3ArrayPtr result(new Point3Array());
-
-    real_t area = edgeFunction(polygon->getAt(0), polygon->getAt(1), polygon->getAt(2));
-
     for (Polygon_2::Vertex_iterator it = proj.vertices_begin() ; it != proj.vertices_end(); ++it)
-    {
-            Vector2 vertex = toVector2(*it);
-            real_t w0 = edgeFunction(polygon->getAt(1), polygon->getAt(2), vertex);
-            real_t w1 = edgeFunction(polygon->getAt(2), polygon->getAt(0), vertex);
-            real_t w2 = edgeFunction(polygon->getAt(0), polygon->getAt(1), vertex);
-
-            if (fabs(area) <= GEOM_EPSILON) {
-                real_t sumw = w0 + w1 + w2;
-                w0 /= sumw;
-                w1 /= sumw;
-                w2 /= sumw;
-            }
-            else {
-                w0 /= area;
-                w1 /= area;
-                w2 /= area;                
-            }
-
-            result->push_back(polygon->getAt(0)*w0 + polygon->getAt(1)*w1 + polygon->getAt(2)*w2);
-    }
+            result->push_back(liftVertex(toVector2(*it), polygon));
     return result;
 }
 
@@ -318,9 +555,6 @@ bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2,
     Polygon_2 p2 = toPolygon(polygon2);
     assert( p1.is_counterclockwise_oriented ());
     assert( p2.is_counterclockwise_oriented ());
-    print_polygon(p1);
-    print_polygon(p2);
-    printf("intersect: %s\n",CGAL::do_intersect(p1, p2)?"True":"False");
     Pwh_list_2 result;
     CGAL::intersection(p1, p2, std::back_inserter(result));
 
@@ -330,25 +564,21 @@ bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2,
     // CGAL::cpp11::result_of<Kernel::Intersect_2(Triangle_2, Triangle_2)>::type
     // result = intersection(p1, p2);
 
-    printf("intersect:%lu\n",result.size());
     if (result.size() == 0) return false;
 
     std::list<Polygon_2> polys = triangulate(result);
-    printf("nb pol:%lu\n",polys.size());
 
     intersection1 = project(polys, polygon1);
     intersection2 = project(polys, polygon2);
 
     Pwh_list_2 result2;
     CGAL::difference(p1, p2, std::back_inserter(result2));
-    printf("diff1:%lu\n",result2.size());
 
     std::list<Polygon_2> polys2 = triangulate(result2);
     rest1 = project(polys2, polygon1);
 
     Pwh_list_2 result3;
     CGAL::difference(p2, p1, std::back_inserter(result3));
-    printf("diff2:%lu\n",result3.size());
 
     std::list<Polygon_2> polys3 = triangulate(result3);
     rest2 = project(polys3, polygon2);
@@ -357,69 +587,107 @@ bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2,
 
 }
 
-DepthSortEngine::PolygonInfo DepthSortEngine::_toPolygonInfo(const Point3ArrayPtr& points, uint32_t id) const
-{
-    // printf("polygon info : %u %u\n", id , points->size());
-    DepthSortEngine::PolygonInfo pinfo;
-    pinfo.points = points;
-    std::pair<Vector3,Vector3> bounds = points->getBounds();
-    pinfo.pmin = bounds.first;
-    pinfo.pmax = bounds.second;
-    pinfo.id = id;
-    return pinfo;
-}
+#else
 
+// Without CGAL, triangles are intersected with floating point arithmetic.
+// Intersection of 2 triangles is convex. Difference is split into convex pieces.
+typedef std::vector<Vector2> Polygon2;
 
-DepthSortEngine::PolygonInfoList DepthSortEngine::_toPolygonInfo(const std::vector<Point3ArrayPtr>& polygons, uint32_t id) const
+Polygon2 toPolygon(Point3ArrayPtr polygon) {
+    Polygon2 pol;
+    for (Point3Array::const_iterator it = polygon->begin(); it != polygon->end(); ++it)
+        pol.push_back(Vector2(it->x(), it->y()));
+    return pol;
+}
+
+// Clip the convex polygon with the half plane on the left of the line (a,b) (or on its right).
+void clip_polygon(Polygon2& polygon, const Vector2& a, const Vector2& b, bool left)
 {
-    PolygonInfoList result;   
-    for (std::vector<Point3ArrayPtr>::const_iterator it = polygons.begin(); it != polygons.end() ; ++it) {
-        result.push_back( _toPolygonInfo(*it, id));
+    Polygon2 result;
+    size_t nbpoints = polygon.size();
+    for (size_t i = 0; i < nbpoints; ++i) {
+        const Vector2& current = polygon[i];
+        const Vector2& next = polygon[(i+1) % nbpoints];
+        real_t dcurrent = cross(b - a, current - a);
+        real_t dnext = cross(b - a, next - a);
+        bool currentin = (left ? dcurrent >= 0 : dcurrent <= 0);
+        bool nextin = (left ? dnext >= 0 : dnext <= 0);
+        if (currentin) result.push_back(current);
+        if (currentin != nextin) result.push_back(current + (next - current) * (dcurrent / (dcurrent - dnext)));
     }
-    return result;
+    polygon.swap(result);
 }
 
-std::pair<real_t, real_t> polygonzbounds(const DepthSortEngine::PolygonInfoList& polygons) {
-    DepthSortEngine::PolygonInfoList::const_iterator it = polygons.begin();
-    real_t zmin = it->pmin.z();
-    real_t zmax = it->pmax.z();
-    for (++it; it != polygons.end() ; ++it) { 
-        if (zmin > it->pmin.z()) zmin = it->pmin.z();
-        if (zmax < it->pmax.z()) zmin = it->pmax.z();
+// Triangulate the convex polygon as a fan. Degenerated triangles are skipped.
+void triangulate(const Polygon2& polygon, std::list<Polygon2>& result)
+{
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        Polygon2 p;
+        p.push_back(polygon[0]); p.push_back(polygon[i]); p.push_back(polygon[i+1]);
+        if (cross(p[1] - p[0], p[2] - p[0]) / 2 > GEOM_EPSILON)
+            result.push_back(p);
     }
-    return std::pair<real_t,real_t>(zmin, zmax);
 }
 
-void DepthSortEngine::removePolygon(PolygonInfoSet::iterator it)
+// Part of the triangle p1 outside of the ccw triangle p2: for each edge of p2,
+// the part outside of this edge and inside of the previous ones.
+std::list<Polygon2> difference(const Polygon2& p1, const Polygon2& p2)
 {
-    __polygonlist.erase(it);
+    std::list<Polygon2> result;
+    for (size_t i = 0; i < 3; ++i) {
+        Polygon2 piece(p1);
+        for (size_t j = 0; j < i && piece.size() >= 3; ++j)
+            clip_polygon(piece, p2[j], p2[j+1], true);
+        if (piece.size() >= 3) clip_polygon(piece, p2[i], p2[(i+1)%3], false);
+        triangulate(piece, result);
+    }
+    return result;
 }
 
-DepthSortEngine::PolygonInfoSet::iterator DepthSortEngine::appendPolygon(const PolygonInfo& polygon)
+std::vector<Point3ArrayPtr> project(const std::list<Polygon2>& projs, Point3ArrayPtr polygon)
 {
-
-
-    return __polygonlist.insert(__polygonlist.end(), polygon);
+    std::vector<Point3ArrayPtr> result;
+    for(std::list<Polygon2>::const_iterator it = projs.begin(); it != projs.end(); ++it) {
+        Point3ArrayPtr points(new Point3Array());
+        for (Polygon2::const_iterator itP = it->begin(); itP != it->end(); ++itP)
+            points->push_back(liftVertex(*itP, polygon));
+        result.push_back(points);
+    }
+    return result;
 }
 
-DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::appendPolygons(DepthSortEngine::PolygonInfoList::iterator begin, DepthSortEngine::PolygonInfoList::iterator end)
+bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2, 
+               std::vector<Point3ArrayPtr>& intersection1, std::vector<Point3ArrayPtr>& intersection2, 
+               std::vector<Point3ArrayPtr>& rest1,  std::vector<Point3ArrayPtr>& rest2)
 {
-    DepthSortEngine::PolygonInfoIteratorList result;
-    for(DepthSortEngine::PolygonInfoList::iterator it = begin; it != end; ++it)
-        result.push_back(appendPolygon(*it));
-    return result;
+    Polygon2 p1 = toPolygon(polygon1);
+    Polygon2 p2 = toPolygon(polygon2);
+    Polygon2 inter(p1);
+    for (size_t i = 0; i < 3 && inter.size() >= 3; ++i)
+        clip_polygon(inter, p2[i], p2[(i+1)%3], true);
+
+    std::list<Polygon2> polys;
+    triangulate(inter, polys);
+    if (polys.empty()) return false;
+
+    intersection1 = project(polys, polygon1);
+    intersection2 = project(polys, polygon2);
+    rest1 = project(difference(p1, p2), polygon1);
+    rest2 = project(difference(p2, p1), polygon2);
+    return true;
 }
 
+#endif
 
-DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::getIntersectingPolygons(const PolygonInfo& polygon)
-{
-    DepthSortEngine::PolygonInfoIteratorList result;
-    for (DepthSortEngine::PolygonInfoSet::iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it) {
-        if ((polygon.pmin.x() > it->pmax.x())||(polygon.pmax.x() < it->pmin.x())) { continue; }
-        if ((polygon.pmin.y() > it->pmax.y())||(polygon.pmax.y() < it->pmin.y())) { continue; }
-        result.push_back(it);
+std::pair<real_t, real_t> polygonzbounds(const DepthSortEngine::PolygonInfoList& polygons) {
+    DepthSortEngine::PolygonInfoList::const_iterator it = polygons.begin();
+    real_t zmin = it->pmin.z();
+    real_t zmax = it->pmax.z();
+    for (++it; it != polygons.end() ; ++it) { 
+        if (zmin > it->pmin.z()) zmin = it->pmin.z();
+        if (zmax < it->pmax.z()) zmin = it->pmax.z();
     }
-    return result;
+    return std::pair<real_t,real_t>(zmin, zmax);
 }
 
 void swap(Vector3& v1, Vector3& v2){
@@ -430,9 +698,7 @@ void swap(Vector3& v1, Vector3& v2){
 
 void DepthSortEngine::processTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, uint32_t id)
 {
-    setlocale(LC_ALL, "en_GB");
 
-    printf("[(%f,%f,%f),(%f,%f,%f),(%f,%f,%f)]\n",v0.x(),v0.y(),v0.z(),v1.x(),v1.y(),v1.z(),v2.x(),v2.y(),v2.z());
 
     Vector3 v0Cam = __camera->worldToCamera(v0);
     Vector3 v1Cam = __camera->worldToCamera(v1);
@@ -467,10 +733,7 @@ void DepthSortEngine::processTriangle(const Vector3& v0, const Vector3& v1, cons
 
 
     real_t direction = cross(Vector2(v1Cam.x()-v0Cam.x(),v1Cam.y()-v0Cam.y()), Vector2(v2Cam.x()-v0Cam.x(),v2Cam.y()-v0Cam.y()));
-    real_t direction2 = cross(Vector3(v1Cam.x()-v0Cam.x(),v1Cam.y()-v0Cam.y(),0), Vector3(v2Cam.x()-v0Cam.x(),v2Cam.y()-v0Cam.y(),0)).z();
 
-    printf("[(%f,%f),(%f,%f),(%f,%f)]:%s\n",v0Cam.x(),v0Cam.y(),v1Cam.x(),v1Cam.y(),v2Cam.x(),v2Cam.y(),(direction>0?"ccw":"cw"));
-    printf("%f - %f\n", direction, direction2);
 
 
     Point3ArrayPtr points(new Point3Array());
@@ -478,7 +741,6 @@ void DepthSortEngine::processTriangle(const Vector3& v0, const Vector3& v1, cons
         return;
     }
     else if (direction < 0) {
-        printf("reverse cw\n");
         points->push_back(v0Cam); points->push_back(v2Cam); points->push_back(v1Cam); 
     }
     else { // CCW
@@ -486,8 +748,172 @@ void DepthSortEngine::processTriangle(const Vector3& v0, const Vector3& v1, cons
     }
 
     PolygonInfo p = _toPolygonInfo(points, id);
-    PolygonInfoIteratorList intersections = getIntersectingPolygons(p);
-    _processTriangle(p, intersections, intersections.begin());
+    if (__multithreaded) __pendinglist.push_back(p);
+    else _insertTriangle(p);
+}
+
+void DepthSortEngine::_insertTriangle(const PolygonInfo& polygon)
+{
+    PolygonInfoIteratorList intersections = getIntersectingPolygons(polygon);
+    _processTriangle(polygon, intersections, intersections.begin());
+}
+
+std::vector<uint64_t> DepthSortEngine::insertPolygons(const PolygonInfoList& settled, const PolygonInfoList& pending)
+{
+    for (PolygonInfoList::const_iterator it = settled.begin(); it != settled.end(); ++it)
+        appendPolygon(*it);
+    std::vector<uint64_t> firstorders;
+    firstorders.reserve(pending.size());
+    for (PolygonInfoList::const_iterator it = pending.begin(); it != pending.end(); ++it) {
+        firstorders.push_back(__nextorder);
+        _insertTriangle(*it);
+    }
+    return firstorders;
+}
+
+inline size_t findRoot(std::vector<size_t>& parents, size_t i)
+{
+    while (parents[i] != i) { parents[i] = parents[parents[i]]; i = parents[i]; }
+    return i;
+}
+
+// Rank of a polygon of a group in the serial processing: polygons already sorted first
+// in their order, then the polygons appended for each pending triangle.
+struct SerialRank {
+    bool pending;
+    uint64_t source;
+    uint64_t order;
+    DepthSortEngine::PolygonInfoSet::const_iterator polygon;
+    bool operator<(const SerialRank& other) const {
+        if (pending != other.pending) return other.pending;
+        if (source != other.source) return source < other.source;
+        return order < other.order;
+    }
+};
+
+void DepthSortEngine::flush()
+{
+    if (__pendinglist.empty()) return;
+    if (__autocellsize) {
+        __cellsize = estimateCellSize(__pendinglist.begin(), __pendinglist.end());
+        _rehash();
+    }
+
+    size_t nbthreads = ThreadManager::get().nb_threads();
+    if (nbthreads <= 1) {
+        for (PolygonInfoList::const_iterator it = __pendinglist.begin(); it != __pendinglist.end(); ++it)
+            _insertTriangle(*it);
+        __pendinglist.clear();
+        return;
+    }
+
+    // Polygons are gathered in groups whose bounding boxes overlap, directly or through other polygons.
+    // Pieces of a polygon stay in its bounding box, so that groups never interact: each one is sorted
+    // as in the serial processing, and the results are merged back in the serial order.
+    std::vector<PolygonInfoList::const_iterator> polygons;
+    polygons.reserve(__polygonlist.size() + __pendinglist.size());
+    for (PolygonInfoList::const_iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it)
+        polygons.push_back(it);
+    size_t nbsettled = polygons.size();
+    for (PolygonInfoList::const_iterator it = __pendinglist.begin(); it != __pendinglist.end(); ++it)
+        polygons.push_back(it);
+
+    Vector3 pmin = polygons.front()->pmin, pmax = polygons.front()->pmax;
+    for (std::vector<PolygonInfoList::const_iterator>::const_iterator it = polygons.begin(); it != polygons.end(); ++it) {
+        pmin = Min(pmin, (*it)->pmin); pmax = Max(pmax, (*it)->pmax);
+    }
+    // Margin for the rounding of the coordinates of the pieces.
+    real_t margin = GEOM_EPSILON * std::max<real_t>(1, std::max(pmax.x() - pmin.x(), pmax.y() - pmin.y()));
+
+    std::vector<size_t> parents(polygons.size());
+    for (size_t i = 0; i < parents.size(); ++i) parents[i] = i;
+    std::vector<size_t> xorder(parents);
+    std::sort(xorder.begin(), xorder.end(), [&polygons](size_t i, size_t j) { return polygons[i]->pmin.x() < polygons[j]->pmin.x(); });
+
+    std::vector<size_t> active;
+    for (std::vector<size_t>::const_iterator it = xorder.begin(); it != xorder.end(); ++it) {
+        const PolygonInfo& polygon = *polygons[*it];
+        size_t nbactive = 0;
+        for (std::vector<size_t>::const_iterator itA = active.begin(); itA != active.end(); ++itA) {
+            const PolygonInfo& other = *polygons[*itA];
+            if (other.pmax.x() + margin < polygon.pmin.x()) continue;
+            active[nbactive++] = *itA;
+            if (polygon.pmin.y() > other.pmax.y() + margin || polygon.pmax.y() + margin < other.pmin.y()) continue;
+            size_t r1 = findRoot(parents, *it), r2 = findRoot(parents, *itA);
+            if (r1 != r2) parents[std::max(r1, r2)] = std::min(r1, r2);
+        }
+        active.resize(nbactive);
+        active.push_back(*it);
+    }
+
+    // Groups are distributed to the threads, the biggest first.
+    std::vector<size_t> groupsizes(polygons.size(), 0);
+    for (size_t i = 0; i < polygons.size(); ++i) ++groupsizes[findRoot(parents, i)];
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < polygons.size(); ++i) if (groupsizes[i] > 0) roots.push_back(i);
+    if (roots.size() <= 1) {
+        for (PolygonInfoList::const_iterator it = __pendinglist.begin(); it != __pendinglist.end(); ++it)
+            _insertTriangle(*it);
+        __pendinglist.clear();
+        return;
+    }
+    std::sort(roots.begin(), roots.end(), [&groupsizes](size_t i, size_t j) { return groupsizes[i] > groupsizes[j]; });
+    size_t nbtasks = std::min(nbthreads, roots.size());
+    std::vector<size_t> tasks(polygons.size()), taskloads(nbtasks, 0);
+    for (std::vector<size_t>::const_iterator it = roots.begin(); it != roots.end(); ++it) {
+        size_t task = std::min_element(taskloads.begin(), taskloads.end()) - taskloads.begin();
+        taskloads[task] += groupsizes[*it];
+        tasks[*it] = task;
+    }
+
+    std::vector<PolygonInfoList> settled(nbtasks), pending(nbtasks);
+    std::vector<std::vector<uint64_t> > sources(nbtasks);
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        size_t task = tasks[findRoot(parents, i)];
+        if (i < nbsettled) settled[task].push_back(*polygons[i]);
+        else {
+            pending[task].push_back(*polygons[i]);
+            sources[task].push_back(i - nbsettled);
+        }
+    }
+    __pendinglist.clear();
+
+    std::vector<DepthSortEngine *> engines(nbtasks);
+    std::vector<std::vector<uint64_t> > firstorders(nbtasks);
+    for (size_t t = 0; t < nbtasks; ++t) {
+        engines[t] = new DepthSortEngine();
+        engines[t]->setCellSize(__cellsize);
+    }
+    // Only the tasks of the groups are waited for, not the other tasks of the pool.
+    ThreadManager::get().run_tasks(nbtasks, [&engines, &settled, &pending, &firstorders](size_t t) { firstorders[t] = engines[t]->insertPolygons(settled[t], pending[t]); });
+
+    std::vector<SerialRank> ranks;
+    for (size_t t = 0; t < nbtasks; ++t) {
+        std::vector<uint64_t> settledorders;
+        for (PolygonInfoList::const_iterator it = settled[t].begin(); it != settled[t].end(); ++it)
+            settledorders.push_back(it->order);
+        const PolygonInfoList& result = engines[t]->__polygonlist;
+        for (PolygonInfoList::const_iterator it = result.begin(); it != result.end(); ++it) {
+            SerialRank rank;
+            rank.polygon = it;
+            rank.order = it->order;
+            rank.pending = (it->order >= settledorders.size());
+            if (rank.pending) {
+                size_t source = std::upper_bound(firstorders[t].begin(), firstorders[t].end(), it->order) - firstorders[t].begin() - 1;
+                rank.source = sources[t][source];
+            }
+            else rank.source = settledorders[it->order];
+            ranks.push_back(rank);
+        }
+    }
+    std::sort(ranks.begin(), ranks.end());
+
+    __polygonlist.clear();
+    __cells.clear();
+    __largepolygons.clear();
+    for (std::vector<SerialRank>::const_iterator it = ranks.begin(); it != ranks.end(); ++it)
+        appendPolygon(*it->polygon);
+    for (size_t t = 0; t < nbtasks; ++t) delete engines[t];
 }
 
 typename DepthSortEngine::PolygonInfoIteratorList::iterator 
@@ -496,7 +922,6 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                                    DepthSortEngine::PolygonInfoIteratorList::iterator begin)
 {
     bool processed = false;
-    printf("Process triangle %u\n", polygon.id);
     for (DepthSortEngine::PolygonInfoIteratorList::iterator it = begin; it != polygonstotest.end(); ) {
         PolygonInfo& current = *(*it);
         uint32_t itid = current.id;
@@ -507,41 +932,30 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
             std::vector<Point3ArrayPtr> intersection2; 
             std::vector<Point3ArrayPtr> rest1;
             std::vector<Point3ArrayPtr> rest2;
-            printf("Test intersection\n");
             if (!intersect(polygon.points, current.points, intersection1, intersection2, rest1, rest2)) { 
-                printf("No intersection\n");
                 ++it; continue; 
             }
             bool isbegin = (it == begin);
-            printf("intersect\n");
-            printf("%lu %lu %lu %lu\n", intersection1.size(), intersection2.size(), rest1.size(), rest2.size());
 
             PolygonInfoList mrest2 = _toPolygonInfo(rest2, itid);
             PolygonInfoList mrest1 = _toPolygonInfo(rest1, polygon.id);
             
             // We should process depth comparison
             PolygonInfoList mintersection1 = _toPolygonInfo(intersection1, polygon.id);
-            printf("mintersection1 : %lu\n", mintersection1.size());
             std::pair<real_t, real_t> zbounds1 = polygonzbounds(mintersection1);
             real_t zmin1 = zbounds1.first; real_t zmax1 = zbounds1.second;
 
             PolygonInfoList mintersection2 = _toPolygonInfo(intersection2, itid);
-            printf("mintersection2 : %lu\n", mintersection2.size());
             std::pair<real_t, real_t> zbounds2 = polygonzbounds(mintersection2);
             real_t zmin2 = zbounds2.first; real_t zmax2 = zbounds2.second;
 
-            printf("i1: %f %f\n", zmin1, zmax1);
-            printf("i2: %f %f\n", zmin2, zmax2);
             if (zmax1 <= zmin2) {
                 // new polygon hide the previous one.
                 // we remove the previous one and replace it by its non overlaping part.
-                printf("new polygon hide the previous one\n");
                 removePolygon(*it);
-                printf("remove polygon \n");
                 it = polygonstotest.erase(it);
 
                 if (mrest2.size() > 0) {
-                    printf("rest2 : %lu\n", mrest2.size());
                     DepthSortEngine::PolygonInfoIteratorList newPol = appendPolygons(mrest2.begin(), mrest2.end());
                     polygonstotest.insert(it, newPol.begin(), newPol.end());
                     if (isbegin) { 
@@ -564,7 +978,6 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                  // new polygon is hidden by the previous one.
                  // we keep the previous one.
                  // and test for the non overlapping area of the new one.
-                printf("new polygon is hidden the previous one\n");
                 ++it;
                 if (!mrest1.empty()){
                     if(mrest1.size() == 1) {
@@ -588,9 +1001,7 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
 
                 for (PolygonInfoList::const_iterator itI2 = mintersection2.begin(); itI2 != mintersection2.end() ; ++itI2) {
                     Point3ArrayPtr points = plane_triangle_clip(plane, itI2->points->getAt(0), itI2->points->getAt(1), itI2->points->getAt(2));
-                    printf("Clip triangle intersection2\n");
                     if (is_null_ptr(points) || points->size() < 3) continue;
-                    printf("intersection2 %u\n", points->size());
                     if (points->size() == 3) {
                         appendPolygon(_toPolygonInfo(points, itI2->id));
                     }
@@ -612,15 +1023,11 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                 Plane3 planeb (-cross(p1b-p0b,p2b-p0b), p0b);
                 for (PolygonInfoList::const_iterator itI1 = mintersection1.begin(); itI1 != mintersection1.end() ; ++itI1) {
                     Point3ArrayPtr points = plane_triangle_clip(planeb, itI1->points->getAt(0), itI1->points->getAt(1), itI1->points->getAt(2));
-                    printf("Clip triangle intersection1\n");
                     if (is_null_ptr(points) || points->size() < 3) continue;
-                    printf("intersection1 %u\n", points->size());
                     if (points->size() == 3) {
-                        printf("result in triangle\n");
                         appendPolygon(_toPolygonInfo(points, itI1->id));
                     }
                     else {
-                        printf("result in polygon\n");
                         Vector3& first = points->getAt(0);
                         for(Point3Array::const_iterator itP = points->begin()+1; itP != points->end()-1; ++itP){
                             Point3ArrayPtr lpoints(new Point3Array());
@@ -636,7 +1043,6 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                 it = polygonstotest.erase(it);
 
                 if (mrest2.size() > 0) {
-                    printf("rest2 : %lu\n", mrest2.size());
                     DepthSortEngine::PolygonInfoIteratorList newPol = appendPolygons(mrest2.begin(), mrest2.end());
                     polygonstotest.insert(it, newPol.begin(), newPol.end());
                     if (isbegin) {
@@ -648,8 +1054,8 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                         isbegin = false;
                     }
                 }
+                else if (isbegin) { begin = it; }
 
-                printf("rest1 : %lu\n", mrest1.size());
                 if (!mrest1.empty()) {
                     if(mrest1.size() == 1) {
                         polygon = mrest1.front();
@@ -669,14 +1075,14 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
         } 
     }
     if (!processed) {
-        printf("add to list\n");
         appendPolygon(polygon);
     }
     return begin;
 }
 
-ScenePtr DepthSortEngine::getResult(Color4::eColor4Format format, bool cameraCoordinates) const
+ScenePtr DepthSortEngine::getResult(Color4::eColor4Format format, bool cameraCoordinates)
 {
+    flush();
     ScenePtr scene(new Scene());
     for(PolygonInfoList::const_iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it){
         Color4 col = Color4::fromUint(it->id, format);
@@ -695,8 +1101,9 @@ ScenePtr DepthSortEngine::getResult(Color4::eColor4Format format, bool cameraCoo
     return scene;
 }
 
-ScenePtr DepthSortEngine::getProjectionResult(Color4::eColor4Format format, bool cameraCoordinates) const
+ScenePtr DepthSortEngine::getProjectionResult(Color4::eColor4Format format, bool cameraCoordinates)
 {
+    flush();
     ScenePtr scene(new Scene());
     for(PolygonInfoList::const_iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it){
         Color4 col = Color4::fromUint(it->id, format);
@@ -718,5 +1125,3 @@ ScenePtr DepthSortEngine::getProjectionResult(Color4::eColor4Format format, bool
     }
     return scene;
 }
-
-#endif
@@ -57,9 +57,11 @@
 #include <plantgl/tool/util_array2.h>
 #include <plantgl/tool/util_cache.h>
 #include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_hashmap.h>
 #include <plantgl/scenegraph/scene/scene.h>
 #include "projectionengine.h"
 #include <list>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -84,22 +86,45 @@ public :
 
     void processTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, uint32_t id);
 
-    ScenePtr getResult(Color4::eColor4Format format = Color4::eARGB, bool cameraCoordinates = true) const;
-    ScenePtr getProjectionResult(Color4::eColor4Format format = Color4::eARGB, bool cameraCoordinates = true) const;
+    /// The sorted polygons. Stored triangles are processed first (see flush).
+    ScenePtr getResult(Color4::eColor4Format format = Color4::eARGB, bool cameraCoordinates = true);
+    ScenePtr getProjectionResult(Color4::eColor4Format format = Color4::eARGB, bool cameraCoordinates = true);
 
     virtual void iprocess(TriangleSetPtr triangles, AppearancePtr appearance, uint32_t id, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
     virtual void iprocess(PolylinePtr polyline, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
     virtual void iprocess(PointSetPtr pointset, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
 
+    virtual void endProcess();
+
+    /** In multithreaded mode, triangles are stored until flush is called (or endProcess, getResult).
+        The polygons are then split into groups whose bounding boxes do not overlap, processed in parallel.
+        The result is the same as in serial mode. Overlapping polygons all belong to one group. */
+    bool isMultiThreaded() const { return __multithreaded; }
+    void setMultiThreaded(bool value) { __multithreaded = value; }
+
+    /// Process the stored triangles in parallel (see setMultiThreaded).
+    void flush();
+
+    /// Number of triangles stored and not yet processed.
+    size_t getPendingTriangleCount() const { return __pendinglist.size(); }
+
+    /** Size of the cells of the spatial hash used to find overlapping polygons.
+        If not set (or set to 0), it is estimated from the mean size of the first polygons. */
+    real_t getCellSize() const { return __cellsize; }
+    void setCellSize(real_t value);
+
     struct PolygonInfo {
         Point3ArrayPtr points;
         Vector3 pmin, pmax;
         uint32_t id;
+        /// Rank of insertion of the polygon in the list.
+        uint64_t order;
     };
 
     typedef std::list<PolygonInfo> PolygonInfoList;
     typedef std::list<PolygonInfo> PolygonInfoSet;
     typedef std::list<PolygonInfoSet::iterator> PolygonInfoIteratorList;
+    typedef std::vector<PolygonInfoSet::iterator> PolygonInfoIteratorVector;
 
 protected:
 
@@ -108,6 +133,12 @@ protected:
     DepthSortEngine::PolygonInfoIteratorList appendPolygons(DepthSortEngine::PolygonInfoList::iterator begin, DepthSortEngine::PolygonInfoList::iterator end);
     DepthSortEngine::PolygonInfoIteratorList getIntersectingPolygons(const PolygonInfo& polygon);
 
+    /// Insert a triangle given in camera coordinates and clip it against the overlapping polygons.
+    void _insertTriangle(const PolygonInfo& polygon);
+
+    /** Append the \e settled polygons and insert the \e pending triangles. Used to process a group of polygons.
+        Returns for each pending triangle the order of the first polygon appended while inserting it. */
+    std::vector<uint64_t> insertPolygons(const PolygonInfoList& settled, const PolygonInfoList& pending);
 
     PolygonInfo _toPolygonInfo(const Point3ArrayPtr& points, uint32_t id) const;
     DepthSortEngine::PolygonInfoList _toPolygonInfo(const std::vector<Point3ArrayPtr>& polygons, uint32_t id) const;
@@ -116,7 +147,26 @@ protected:
                                                                          DepthSortEngine::PolygonInfoIteratorList& polygonstotest, 
                                                                          DepthSortEngine::PolygonInfoIteratorList::iterator begin);
 
+    /// @name Spatial hash of the polygons
+    //@{
+    bool _cellRange(const PolygonInfo& polygon, int32_t& ixmin, int32_t& ixmax, int32_t& iymin, int32_t& iymax) const;
+    void _hashPolygon(PolygonInfoSet::iterator it);
+    void _unhashPolygon(PolygonInfoSet::iterator it);
+    void _rehash();
+    //@}
+
     PolygonInfoList __polygonlist; 
+
+    uint64_t __nextorder;
+
+    real_t __cellsize;
+    bool __autocellsize;
+    pgl_hash_map<uint64_t, PolygonInfoIteratorVector> __cells;
+    /// Polygons covering too many cells.
+    PolygonInfoIteratorVector __largepolygons;
+
+    bool __multithreaded;
+    PolygonInfoList __pendinglist;
 };
 
 /* ----------------------------------------------------------------------- */
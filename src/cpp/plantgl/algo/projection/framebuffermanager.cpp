@@ -43,11 +43,24 @@
 /* ----------------------------------------------------------------------- */
 
 #include "framebuffermanager.h"
+#include <algorithm>
 /* ----------------------------------------------------------------------- */
 
 PGL_USING_NAMESPACE
 
 
+void FrameBufferManager::setPixelSpan(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color3 * colors)
+{
+    for (uint_t i = 0; i < count; ++i)
+        if (mask & (1u << i)) setPixelAt(x + i, y, colors[i]);
+}
+
+void FrameBufferManager::fillPixel4Span(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color4& color)
+{
+    for (uint_t i = 0; i < count; ++i)
+        if (mask & (1u << i)) setPixel4At(x + i, y, color);
+}
+
 PglFrameBufferManager::PglFrameBufferManager(uint16_t imageWidth, uint16_t imageHeight, uint8_t nbChannels, const Color3& backGroundColor) :
      FrameBufferManager(imageWidth, imageHeight, nbChannels, backGroundColor), 
      __image(new Image(imageWidth, imageHeight, nbChannels, backGroundColor)) 
@@ -80,6 +93,28 @@ Color4 PglFrameBufferManager::getPixel4At(uint_t x, uint_t y) const
     return __image->getPixelAt(x,y); 
 }
 
+void PglFrameBufferManager::setPixelSpan(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color3 * colors)
+{
+    uint_t nbchannels = __image->nbChannels();
+    uchar_t * data = __image->getPixelDataAt(x, y);
+    for (uint_t i = 0; i < count; ++i, data += nbchannels) {
+        if (!(mask & (1u << i))) continue;
+        if (nbchannels > 0) data[0] = colors[i].getRed();
+        if (nbchannels > 1) data[1] = colors[i].getGreen();
+        if (nbchannels > 2) data[2] = colors[i].getBlue();
+        if (nbchannels > 3) data[3] = 0;
+    }
+}
+
+void PglFrameBufferManager::fillPixel4Span(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color4& color)
+{
+    uint_t nbchannels = __image->nbChannels();
+    uchar_t pixel[4] = { color.getRed(), color.getGreen(), color.getBlue(), color.getAlpha() };
+    uchar_t * data = __image->getPixelDataAt(x, y);
+    for (uint_t i = 0; i < count; ++i, data += nbchannels)
+        if (mask & (1u << i)) std::copy(pixel, pixel + std::min<uint_t>(nbchannels, 4), data);
+}
+
 uint16_t PglFrameBufferManager::width() const { return __image->width(); }
 uint16_t PglFrameBufferManager::height() const { return __image->height(); }
 
@@ -90,3 +125,60 @@ FrameBufferManagerPtr PglFrameBufferManager::deepcopy() const
     return FrameBufferManagerPtr(copy);
 }
 
+
+IdFrameBufferManager::IdFrameBufferManager(uint16_t imageWidth, uint16_t imageHeight, uint32_t defaultid, Color4::eColor4Format conversionformat) :
+     FrameBufferManager(imageWidth, imageHeight, 4, Color4::fromUint(defaultid, conversionformat)), 
+     __width(imageWidth),
+     __height(imageHeight),
+     __defaultid(defaultid),
+     __conversionformat(conversionformat),
+     __ids(new Uint32Array2(uint_t(imageWidth), uint_t(imageHeight), defaultid)),
+     __idData(&*__ids->begin())
+{}
+
+IdFrameBufferManager::~IdFrameBufferManager() {}
+
+void IdFrameBufferManager::setPixelAt(uint_t x, uint_t y, const Color3& color) 
+{ 
+    setIdAt(x, y, Color4(color, 0).toUint(__conversionformat)); 
+}
+
+Color3 IdFrameBufferManager::getPixelAt(uint_t x, uint_t y) const
+{ 
+    return Color3(getPixel4At(x, y)); 
+}
+
+void IdFrameBufferManager::setPixel4At(uint_t x, uint_t y, const Color4& color) 
+{ 
+    setIdAt(x, y, color.toUint(__conversionformat)); 
+}
+
+Color4 IdFrameBufferManager::getPixel4At(uint_t x, uint_t y) const
+{ 
+    return Color4::fromUint(getIdAt(x, y), __conversionformat); 
+}
+
+void IdFrameBufferManager::fillPixel4Span(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color4& color)
+{
+    fillIdSpan(x, y, count, mask, color.toUint(__conversionformat));
+}
+
+uint16_t IdFrameBufferManager::width() const { return __width; }
+uint16_t IdFrameBufferManager::height() const { return __height; }
+
+FrameBufferManagerPtr IdFrameBufferManager::deepcopy() const
+{ 
+    IdFrameBufferManager * copy = new IdFrameBufferManager(*this); 
+    copy->__ids = Uint32Array2Ptr(new Uint32Array2(*__ids));
+    copy->__idData = &*copy->__ids->begin();
+    return FrameBufferManagerPtr(copy);
+}
+
+ImagePtr IdFrameBufferManager::getImage() const
+{
+    ImagePtr image(new Image(__width, __height, 4));
+    for (uint_t y = 0; y < __height; ++y)
+        for (uint_t x = 0; x < __width; ++x)
+            image->setPixelAt(x, y, Color4::fromUint(getIdAt(x, y), __conversionformat));
+    return image;
+}
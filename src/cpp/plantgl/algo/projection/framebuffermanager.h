@@ -52,6 +52,7 @@
 
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/scenegraph/appearance/util_image.h>
+#include <plantgl/tool/util_array2.h>
 #include "../algo_config.h"
 
 /* ----------------------------------------------------------------------- */
@@ -83,6 +84,12 @@ public:
     virtual void setPixel4At(uint_t x, uint_t y, const Color4& color) = 0;
     virtual Color4 getPixel4At(uint_t x, uint_t y) const = 0;
 
+    /** Set the pixels of the span [x, x+count[ of the row y selected by \e mask to \e colors.
+        Bulk version of setPixelAt used by the shaders to avoid a virtual call per pixel. */
+    virtual void setPixelSpan(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color3 * colors);
+    /// Set the pixels of the span [x, x+count[ of the row y selected by \e mask to \e color.
+    virtual void fillPixel4Span(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color4& color);
+
     virtual uint16_t width() const = 0;
     virtual uint16_t height() const = 0;
     virtual FrameBufferManagerPtr deepcopy() const = 0;
@@ -101,6 +108,9 @@ public:
     
     virtual void setPixel4At(uint_t x, uint_t y, const Color4& color);
     virtual Color4 getPixel4At(uint_t x, uint_t y) const ;
+
+    virtual void setPixelSpan(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color3 * colors);
+    virtual void fillPixel4Span(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color4& color);
     
     virtual uint16_t width() const;
     virtual uint16_t height() const;
@@ -113,6 +123,58 @@ public:
 
 typedef RCPtr<PglFrameBufferManager> PglFrameBufferManagerPtr;
 
+
+/** 
+    \class IdFrameBufferManager
+    \brief A frame buffer storing the id of the shape of each pixel as uint32 values.
+    Ids are indexed by (x, y) as the depth buffer. Colors are converted to ids with the given format.
+*/
+class IdFrameBufferManager : public FrameBufferManager {
+public:
+    IdFrameBufferManager(uint16_t imageWidth, uint16_t imageHeight, uint32_t defaultid, Color4::eColor4Format conversionformat = Color4::eARGB);
+    virtual ~IdFrameBufferManager();
+
+    virtual void setPixelAt(uint_t x, uint_t y, const Color3& color);
+    virtual Color3 getPixelAt(uint_t x, uint_t y) const ;
+    
+    virtual void setPixel4At(uint_t x, uint_t y, const Color4& color);
+    virtual Color4 getPixel4At(uint_t x, uint_t y) const ;
+
+    virtual void fillPixel4Span(uint_t x, uint_t y, uint_t count, uint32_t mask, const Color4& color);
+
+    virtual uint16_t width() const;
+    virtual uint16_t height() const;
+    virtual FrameBufferManagerPtr deepcopy() const;
+
+    inline uint32_t getIdAt(uint_t x, uint_t y) const { return __idData[size_t(x) * __height + y]; }
+    inline void setIdAt(uint_t x, uint_t y, uint32_t id) { __idData[size_t(x) * __height + y] = id; }
+
+    inline void fillIdSpan(uint_t x, uint_t y, uint_t count, uint32_t mask, uint32_t id) {
+        uint32_t * data = __idData + size_t(x) * __height + y;
+        for (uint_t i = 0; i < count; ++i, data += __height)
+            if (mask & (1u << i)) *data = id;
+    }
+
+    uint32_t getDefaultId() const { return __defaultid; }
+    Color4::eColor4Format getConversionFormat() const { return __conversionformat; }
+
+    Uint32Array2Ptr getIds() const { return __ids; }
+
+    /// Return the ids converted in colors.
+    ImagePtr getImage() const;
+
+protected:
+    uint16_t __width;
+    uint16_t __height;
+    uint32_t __defaultid;
+    Color4::eColor4Format __conversionformat;
+    Uint32Array2Ptr __ids;
+    /// Pointer to the data of __ids.
+    uint32_t * __idData;
+};
+
+typedef RCPtr<IdFrameBufferManager> IdFrameBufferManagerPtr;
+
 /* ----------------------------------------------------------------------- */
 
 PGL_END_NAMESPACE
@@ -0,0 +1,77 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+#include "layerbuffer.h"
+#include <algorithm>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const float LayerBuffer::EMPTY_DEPTH = std::numeric_limits<float>::infinity();
+
+LayerBuffer::LayerBuffer(uint16_t width, uint16_t height, uint32_t nbLayers, uint32_t defaultid):
+    RefCountObject(),
+    __width(width),
+    __height(height),
+    __nbLayers(pglMax<uint32_t>(1, nbLayers)),
+    __defaultid(defaultid),
+    __layers(size_t(width) * height * __nbLayers)
+{
+    clear();
+}
+
+LayerBuffer::~LayerBuffer() {}
+
+void LayerBuffer::clear()
+{
+    Layer empty;
+    empty.depth = EMPTY_DEPTH;
+    empty.id = __defaultid;
+    std::fill(__layers.begin(), __layers.end(), empty);
+}
+
+LayerBufferPtr LayerBuffer::deepcopy() const
+{
+    return LayerBufferPtr(new LayerBuffer(*this));
+}
+
+/* ----------------------------------------------------------------------- */
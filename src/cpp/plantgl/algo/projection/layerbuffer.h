@@ -0,0 +1,157 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file layerbuffer.h
+    \brief Nearest layers of fragments of each pixel of ZBufferEngine.
+*/
+
+
+
+#ifndef __LayerBuffer_h__
+#define __LayerBuffer_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/math/util_math.h>
+#include <limits>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/** 
+    \class LayerBuffer
+    \brief The nearest \e k (depth, id) fragments of each pixel, sorted by increasing depth.
+
+    The layers of a pixel are stored contiguously and pixels are indexed by (x, y) with x major order,
+    as the depth buffer. Empty layers have an infinite depth and the default id.
+    Fragments of the same id at the same depth as a stored layer, given by the triangles of a shape
+    sharing an edge, are recorded once.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class LayerBuffer;
+typedef RCPtr<LayerBuffer> LayerBufferPtr;
+
+class ALGO_API LayerBuffer : public RefCountObject {
+public:
+
+    struct Layer {
+        float depth;
+        uint32_t id;
+    };
+
+    LayerBuffer(uint16_t width, uint16_t height, uint32_t nbLayers, uint32_t defaultid);
+    virtual ~LayerBuffer();
+
+    inline uint16_t width() const { return __width; }
+    inline uint16_t height() const { return __height; }
+    inline uint32_t getNbLayers() const { return __nbLayers; }
+    inline uint32_t getDefaultId() const { return __defaultid; }
+
+    /// Set all the layers to empty.
+    void clear();
+
+    /// The layers of the pixel (x, y).
+    inline const Layer * getLayersAt(uint_t x, uint_t y) const 
+    { return &__layers[(size_t(x) * __height + y) * __nbLayers]; }
+
+    /// Number of non empty layers of the pixel (x, y).
+    inline uint32_t getNbLayersAt(uint_t x, uint_t y) const {
+        const Layer * layers = getLayersAt(x, y);
+        uint32_t nb = 0;
+        while (nb < __nbLayers && layers[nb].depth != EMPTY_DEPTH) ++nb;
+        return nb;
+    }
+
+    inline uint32_t getIdAt(uint_t x, uint_t y, uint32_t layer) const { return getLayersAt(x, y)[layer].id; }
+    inline real_t getDepthAt(uint_t x, uint_t y, uint32_t layer) const { 
+        float depth = getLayersAt(x, y)[layer].depth;
+        return depth == EMPTY_DEPTH ? REAL_MAX : depth; 
+    }
+
+    /// Whether a fragment at depth \e z is closer than the farthest layer of the pixel (x, y).
+    inline bool accepts(uint_t x, uint_t y, real_t z) const 
+    { return float(z) < getLayersAt(x, y)[__nbLayers - 1].depth; }
+
+    /// Insert the fragment (z, id) in the layers of the pixel (x, y). Return whether it was inserted.
+    inline bool insert(uint_t x, uint_t y, real_t z, uint32_t id) {
+        Layer * layers = &__layers[(size_t(x) * __height + y) * __nbLayers];
+        float fz = float(z);
+        float tolerance = 1e-5f * std::fabs(fz) + float(GEOM_EPSILON);
+        uint32_t pos = 0;
+        for (; pos < __nbLayers && layers[pos].depth <= fz; ++pos)
+            if (layers[pos].id == id && fz - layers[pos].depth <= tolerance) return false;
+        if (pos == __nbLayers) return false;
+        if (layers[pos].id == id && layers[pos].depth - fz <= tolerance) return false;
+        for (uint32_t i = __nbLayers - 1; i > pos; --i) layers[i] = layers[i - 1];
+        layers[pos].depth = fz;
+        layers[pos].id = id;
+        return true;
+    }
+
+    /// Pointer to the layers.
+    inline const Layer * data() const { return __layers.data(); }
+
+    LayerBufferPtr deepcopy() const;
+
+protected:
+
+    static const float EMPTY_DEPTH;
+
+    uint16_t __width;
+    uint16_t __height;
+    uint32_t __nbLayers;
+    uint32_t __defaultid;
+    std::vector<Layer> __layers;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
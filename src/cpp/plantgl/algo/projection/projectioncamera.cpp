@@ -112,12 +112,14 @@ Vector3 ProjectionCamera::cameraToNDC(const Vector3& vertexCamera) const {
 }
 
 Vector3 ProjectionCamera::ndcToCamera(const Vector3& vertexNDC) const {
-    if (type == eOrthographic)
-        return NDC2screen(vertexNDC.x(), vertexNDC.y(), vertexNDC.z());
-    else {
-        real_t z = -vertexNDC.z();
-        return NDC2screen(vertexNDC.x() * z, vertexNDC.y() * z, vertexNDC.z());
+    Vector3 vertexCamera = NDC2screen(vertexNDC.x(), vertexNDC.y(), vertexNDC.z());
+    if (type == ePerspective) {
+        // invert the perspective division of cameraToNDC
+        real_t z = -vertexCamera.z();
+        vertexCamera.x() *= z / near;
+        vertexCamera.y() *= z / near;
     }
+    return vertexCamera;
 }
 
 
@@ -152,7 +154,7 @@ Vector3 ProjectionCamera::cameraToWorld(const Vector3& vertexCamera) const
 Vector3 ProjectionCamera::rasterToWorld(const Vector3& raster, const uint16_t imageWidth, const uint16_t imageHeight) const
 {
     Vector3 vertexNDC = rasterToNDC(raster, imageWidth, imageHeight);
-    return cameraToWorld(NDC2screen(vertexNDC.x(), vertexNDC.y(), vertexNDC.z()));
+    return cameraToWorld(ndcToCamera(vertexNDC));
 
 }
 
@@ -161,6 +163,22 @@ BoundingBoxPtr ProjectionCamera::getBoundingBoxView() const
     return BoundingBoxPtr(new BoundingBox(Vector3(left,bottom,near),Vector3(right,top,far)));    
 }
 
+real_t ProjectionCamera::getPixelScale(const Vector3& vertexModel, const uint16_t imageWidth, const uint16_t imageHeight, real_t radius) const
+{
+    // largest factor applied to lengths by the model transformation
+    real_t modelScale = 0;
+    for (uchar_t i = 0; i < 3; ++i) {
+        Vector4 column = __currentModelMatrix.getColumn(i);
+        modelScale = std::max(modelScale, norm(Vector3(column.x(), column.y(), column.z())));
+    }
+    real_t scale = std::max(imageWidth / (right - left), imageHeight / (top - bottom));
+    if (type == ePerspective) {
+        real_t z = -worldToCamera(vertexModel).z() - radius * modelScale;
+        if (z > near) scale *= near / z;
+    }
+    return scale * modelScale;
+}
+
 
 bool ProjectionCamera::isInZRange(real_t z) const {
     return (z >= near && z <= far);
@@ -100,6 +100,11 @@ public:
 
    BoundingBoxPtr getBoundingBoxView() const;
 
+   /** Returns the length in pixels of a unit of the model space at \e vertexModel once projected
+       on an image of size \e imageWidth x \e imageHeight. With a \e radius, the scale is the largest one
+       of the sphere of center \e vertexModel, i.e. the one of its nearest point to the camera. */
+   real_t getPixelScale(const Vector3& vertexModel, const uint16_t imageWidth, const uint16_t imageHeight, real_t radius = 0) const;
+
    Matrix4 getWorldToCameraMatrix() const { return __worldToCamera; }
    Matrix4 getCameraToWorldMatrix() const { return __cameraToWorld; }
 
@@ -171,7 +176,7 @@ inline Vector3 rasterToNDC(const Vector3& raster, const uint16_t imageWidth, con
 {
     // convert raster to NDC space
     Vector3 vertexNDC(  (raster.x()*2/imageWidth) - 1,
-                        1 - (raster.y()*2/imageWidth),
+                        1 - (raster.y()*2/imageHeight),
                         raster.z());
     return vertexNDC;
 }
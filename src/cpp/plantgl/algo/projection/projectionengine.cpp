@@ -54,7 +54,8 @@ PGL_USING_NAMESPACE
 
 
 ProjectionEngine::ProjectionEngine():
-    __camera(0)
+    __camera(0),
+    __lodTolerance(0)
 {
     setOrthographicCamera(-1, 1, -1, 1, 0, 2);
     lookAt(Vector3(0,1,0),Vector3(0,0,0),Vector3(0,0,1));
@@ -115,6 +115,20 @@ public :
       BoundingBoxPtr getBoundingBoxView() const
       {  return __camera->getBoundingBoxView();  }
 
+      /** Sets the maximal distance in pixels between the primitives and their tessellation.
+          If strictly positive, the resolution of each primitive is chosen from its projected size.
+          A tolerance of 0 (default) keeps the resolution of the primitives. */
+      inline void setLodTolerance(real_t pixels)
+      {  __lodTolerance = pixels;  }
+
+      inline real_t getLodTolerance() const
+      {  return __lodTolerance;  }
+
+      /** Returns the length in pixels of a unit of the model space at \e vertexModel (0 if not defined).
+          With a \e radius, the largest one on the sphere of center \e vertexModel. */
+      virtual real_t getPixelScale(const ProjectionCameraPtr& camera, const Vector3& vertexModel, real_t radius = 0) const
+      {  return 0;  }
+
       virtual void process(ScenePtr scene);
 
       void process(TriangleSetPtr triangles, AppearancePtr appearance, uint32_t id) { iprocess(triangles, appearance,id,__camera); }
@@ -130,6 +144,7 @@ public :
 
 protected:
     ProjectionCameraPtr __camera;
+    real_t __lodTolerance;
 
 
 };
@@ -146,6 +161,9 @@ public :
       virtual uint16_t getImageWidth() const { return __imageWidth; }
       virtual uint32_t getImageHeight() const { return __imageHeight; }
 
+      virtual real_t getPixelScale(const ProjectionCameraPtr& camera, const Vector3& vertexModel, real_t radius = 0) const
+      { return camera->getPixelScale(vertexModel, __imageWidth, __imageHeight, radius); }
+
 
 protected:
    uint16_t __imageWidth;
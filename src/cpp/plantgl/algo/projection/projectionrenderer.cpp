@@ -60,6 +60,25 @@ PGL_USING_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
 
+void ProjectionRenderer::setLevelOfDetail(Discretizer& discretizer, Geometry * geom)
+{
+  real_t tolerance = __engine.getLodTolerance();
+  if (tolerance > 0) {
+    // resolution chosen from the projected size of the bounding sphere of the primitive
+    Vector3 center = Vector3::ORIGIN;
+    real_t radius = 0;
+    // only the distance of the nearest point of the primitive changes the scale in perspective
+    if (__camera->type == ProjectionCamera::ePerspective && geom->apply(__bboxComputer)) {
+      BoundingBoxPtr bbox = __bboxComputer.getBoundingBox();
+      center = bbox->getCenter();
+      radius = norm(bbox->getSize());
+    }
+    discretizer.setLodTolerance(tolerance);
+    discretizer.setLodScale(__engine.getPixelScale(__camera, center, radius));
+  }
+  else discretizer.setLodScale(0);
+}
+
 template<class T>
 bool ProjectionRenderer::discretize_and_process(T *geom) 
 {
@@ -67,6 +86,7 @@ bool ProjectionRenderer::discretize_and_process(T *geom)
   if (__appearance && __appearance->isTexture())
     __discretizer.computeTexCoord(true);
   else __discretizer.computeTexCoord(false);
+  setLevelOfDetail(__discretizer, geom);
   bool b = geom->apply(__discretizer);
   if (b && (b = (__discretizer.getDiscretization()))) {
     b = __discretizer.getDiscretization()->apply(*this);
@@ -81,6 +101,7 @@ bool ProjectionRenderer::tesselate_and_process(T *geom)
   if (__appearance && __appearance->isTexture())
     __tesselator.computeTexCoord(true);
   else __tesselator.computeTexCoord(false);
+  setLevelOfDetail(__tesselator, geom);
   bool b = geom->apply(__tesselator);
   if (b && (b = (__tesselator.getDiscretization()))) {
     b = __tesselator.getDiscretization()->apply(*this);
@@ -111,6 +132,7 @@ ProjectionRenderer::ProjectionRenderer(ProjectionEngine& engine, Tesselator& tes
         __camera(engine.camera()),
         __tesselator(tesselator),
         __discretizer(discretizer),
+        __bboxComputer(discretizer),
         __appearance(),
         __id(Shape::NOID),
         __threadid(threadid)
@@ -125,6 +147,7 @@ ProjectionRenderer::ProjectionRenderer(ProjectionEngine& engine, ProjectionCamer
         __camera(camera),
         __tesselator(tesselator),
         __discretizer(discretizer),
+        __bboxComputer(discretizer),
         __appearance(),
         __id(Shape::NOID),
         __threadid(threadid)
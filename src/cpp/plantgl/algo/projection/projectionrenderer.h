@@ -56,6 +56,7 @@
 
 #include <plantgl/scenegraph/core/action.h>
 #include <plantgl/algo/base/tesselator.h>
+#include <plantgl/algo/base/bboxcomputer.h>
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/tool/util_cache.h>
 
@@ -218,6 +219,9 @@ protected:
 
   Discretizer& __discretizer;
 
+  /// Computes the bounding boxes of the primitives to choose their level of detail.
+  BBoxComputer __bboxComputer;
+
   // The engine used to render
   ProjectionEngine& __engine;
 
@@ -234,6 +238,9 @@ protected:
   uint32_t __threadid;
   
 private:
+  /// Sets the level of detail of \e discretizer from the projected size of the bounding sphere of \e geom.
+  void setLevelOfDetail(Discretizer& discretizer, Geometry * geom);
+
   template<class T> 
   bool discretize_and_process(T * geom);
 
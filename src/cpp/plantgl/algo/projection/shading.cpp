@@ -94,12 +94,18 @@ const Color3& Shader::lightSpecular() const { return __engine->__lightSpecular;
 TriangleShader::TriangleShader(ZBufferEngine * engine) : Shader(engine) {}
 TriangleShader::~TriangleShader() {}
 
+void TriangleShader::processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                                  const real_t * z, const float * w0, const float * w1, const float * w2)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        if (mask & (1u << i)) process(x + i, y, z[i], w0[i], w1[i], w2[i]);
+}
+
 
 IdBasedShader::IdBasedShader(ZBufferEngine * engine, uint32_t _defaultid, Color4::eColor4Format _conversionformat) : 
-    TriangleShader(engine), defaultid(_defaultid), conversionformat(_conversionformat) 
+    TriangleShader(engine), defaultid(_defaultid), conversionformat(_conversionformat), idbuffer(NULL)
 {
-    Color4 defcol = Color4::fromUint(_defaultid, conversionformat);
-    engine->__frameBuffer = new PglFrameBufferManager(engine->__imageWidth, engine->__imageHeight, 4, defcol);
+    engine->__frameBuffer = new IdFrameBufferManager(engine->__imageWidth, engine->__imageHeight, _defaultid, conversionformat);
 
     // if(engine->getImage()->nbChannels() != 4){
     //     engine->getImage()->setNbChannels(4);
@@ -108,7 +114,10 @@ IdBasedShader::IdBasedShader(ZBufferEngine * engine, uint32_t _defaultid, Color4
 IdBasedShader::~IdBasedShader() {}
 
 void IdBasedShader::init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, uint32_t _shapeid, const ProjectionCameraPtr& camera) 
-{ shapeid = _shapeid;}
+{ 
+    shapeid = _shapeid;
+    idbuffer = dynamic_cast<IdFrameBufferManager *>(__engine->getFrameBuffer().get());
+}
 
 TriangleShader *  IdBasedShader::copy(bool deep) const
 {
@@ -118,7 +127,15 @@ TriangleShader *  IdBasedShader::copy(bool deep) const
 
 void IdBasedShader::process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) 
 {    
- __engine->getFrameBuffer()->setPixel4At(x,y,Color4::fromUint(shapeid, conversionformat));   
+    if (idbuffer) idbuffer->setIdAt(x, y, shapeid);
+    else __engine->getFrameBuffer()->setPixel4At(x,y,Color4::fromUint(shapeid, conversionformat));   
+}
+
+void IdBasedShader::processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                                 const real_t * z, const float * w0, const float * w1, const float * w2)
+{
+    if (idbuffer) idbuffer->fillIdSpan(x, y, count, mask, shapeid);
+    else __engine->getFrameBuffer()->fillPixel4Span(x, y, count, mask, Color4::fromUint(shapeid, conversionformat));
 }
 
 TextureShader::TextureShader(ZBufferEngine * engine) : TriangleShader(engine) {}
@@ -139,6 +156,32 @@ void TextureShader::init(AppearancePtr appearance, TriangleSetPtr triangles, uin
         }
         repeatu = texture->getImage()->getRepeatS();
         repeatv = texture->getImage()->getRepeatT();
+        mipmaping = texture->getImage()->getMipmaping();
+        if (!mipmaping) return;
+
+        uint16_t width = __engine->getImageWidth(), height = __engine->getImageHeight();
+        Vector3 p0 = camera->worldToRaster(triangles->getFacePointAt(trid, 0), width, height);
+        Vector3 p1 = camera->worldToRaster(triangles->getFacePointAt(trid, 1), width, height);
+        Vector3 p2 = camera->worldToRaster(triangles->getFacePointAt(trid, 2), width, height);
+        if (camera->type == ProjectionCamera::ePerspective) { z0 = p0.z(); z1 = p1.z(); z2 = p2.z(); }
+        else { z0 = 1; z1 = 1; z2 = 1; }
+
+        // derivatives of the linear barycentric coordinates in raster space
+        Vector3 e1 = p1 - p0, e2 = p2 - p0;
+        real_t det = e1.x() * e2.y() - e1.y() * e2.x();
+        if (fabs(det) > GEOM_EPSILON) {
+            real_t dl1dx = e2.y() / det, dl1dy = - e2.x() / det;
+            real_t dl2dx = - e1.y() / det, dl2dy = e1.x() / det;
+            real_t dl0dx = - dl1dx - dl2dx, dl0dy = - dl1dy - dl2dy;
+            duvzdx = uv0 * (dl0dx / z0) + uv1 * (dl1dx / z1) + uv2 * (dl2dx / z2);
+            duvzdy = uv0 * (dl0dy / z0) + uv1 * (dl1dy / z1) + uv2 * (dl2dy / z2);
+            dinvzdx = dl0dx / z0 + dl1dx / z1 + dl2dx / z2;
+            dinvzdy = dl0dy / z0 + dl1dy / z1 + dl2dy / z2;
+        }
+        else {
+            duvzdx = Vector2::ORIGIN; duvzdy = Vector2::ORIGIN;
+            dinvzdx = 0; dinvzdy = 0;
+        }
     }
 }
 
@@ -151,7 +194,14 @@ void TextureShader::process(int32_t x, int32_t y, int32_t z, float w0, float w1,
 {
     Vector2 uv = uv0 * w0 + uv1 * w1 + uv2 * w2;
     Color4 rasterColor;
-    if(is_valid_ptr(image))rasterColor = image->getPixelAtUV(uv.x(), uv.y(), repeatu, repeatv);
+    if(is_valid_ptr(image) && !mipmaping) rasterColor = image->getPixelAtUV(uv.x(), uv.y(), 0, repeatu, repeatv);
+    else if(is_valid_ptr(image)) {
+        // w are perspective correct weights. The depth of the fragment is thus linear in them.
+        real_t z = z0 * w0 + z1 * w1 + z2 * w2;
+        Vector2 duvdx = (duvzdx - uv * dinvzdx) * z;
+        Vector2 duvdy = (duvzdy - uv * dinvzdy) * z;
+        rasterColor = image->getPixelAtUV(uv.x(), uv.y(), image->getLevelOfDetail(duvdx, duvdy), repeatu, repeatv);
+    }
     __engine->setFrameBufferAt(x,y,rasterColor);    
 }
 
@@ -191,6 +241,15 @@ void ColorBasedShader::process(int32_t x, int32_t y, int32_t z, float w0, float
     __engine->setFrameBufferAt(x,y,rasterColor);    
 }
 
+void ColorBasedShader::processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                                    const real_t * z, const float * w0, const float * w1, const float * w2)
+{
+    Color4 rasterColors[PGL_RASTER_BLOCK_SIZE];
+    for (uint32_t i = 0; i < count; ++i)
+        if (mask & (1u << i)) rasterColors[i] = c0 * w0[i]  + c1 * w1[i]  + c2 * w2[i] ;
+    __engine->setFrameBufferSpan(x, y, count, mask, rasterColors);
+}
+
 
 GouraudInterpolation::GouraudInterpolation(ZBufferEngine * engine) : TriangleShader(engine) {}
 GouraudInterpolation::~GouraudInterpolation() {}
@@ -227,6 +286,15 @@ void GouraudInterpolation::process(int32_t x, int32_t y, int32_t z, float w0, fl
 
 }
 
+void GouraudInterpolation::processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                                        const real_t * z, const float * w0, const float * w1, const float * w2)
+{
+    Color4 rasterColors[PGL_RASTER_BLOCK_SIZE];
+    for (uint32_t i = 0; i < count; ++i)
+        if (mask & (1u << i)) rasterColors[i] = c0 * w0[i]  + c1 * w1[i]  + c2 * w2[i] ;
+    __engine->setFrameBufferSpan(x, y, count, mask, rasterColors);
+}
+
 
 PhongInterpolation::PhongInterpolation(ZBufferEngine * engine) : TriangleShader(engine) {}
 PhongInterpolation::~PhongInterpolation() {}
@@ -280,6 +348,12 @@ void TriangleShaderSelector::process(int32_t x, int32_t y, int32_t z, float w0,
     __current->process(x, y, z, w0, w1, w2);
 }
 
+void TriangleShaderSelector::processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                                          const real_t * z, const float * w0, const float * w1, const float * w2)
+{
+    __current->processBlock(x, y, count, mask, z, w0, w1, w2);
+}
+
 TriangleShader *  TriangleShaderSelector::copy(bool deep) const
 {
     if (deep) {
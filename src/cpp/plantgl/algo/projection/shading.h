@@ -60,6 +60,8 @@
 #include <plantgl/scenegraph/appearance/util_image.h>
 #include "../algo_config.h"
 #include "projectioncamera.h"
+#include "framebuffermanager.h"
+#include "texturecache.h"
 /* ----------------------------------------------------------------------- */
 
 PGL_BEGIN_NAMESPACE
@@ -104,6 +106,9 @@ typedef RCPtr<Shader> ShaderPtr;
 class TriangleShader;
 typedef RCPtr<TriangleShader> TriangleShaderPtr;
 
+/// Number of consecutive pixels of a row given to TriangleShader::processBlock.
+#define PGL_RASTER_BLOCK_SIZE 8
+
 class TriangleShader : public Shader {
 public:
     TriangleShader(ZBufferEngine * engine);
@@ -111,6 +116,13 @@ public:
 
     virtual void init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, uint32_t shapeid, const ProjectionCameraPtr& camera) = 0;
     virtual void process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) = 0;
+
+    /** Process the pixels (x+i, y) for i in [0, count[ whose bit i is set in mask.
+        Arrays give depth and barycentric weights of each pixel.
+        Default implementation calls process for each pixel of the mask. */
+    virtual void processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                              const real_t * z, const float * w0, const float * w1, const float * w2);
+
     virtual TriangleShader * copy(bool deep = false) const = 0;
 
 };
@@ -130,11 +142,15 @@ public:
 
     virtual void init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, uint32_t shapeid, const ProjectionCameraPtr& camera);
     virtual void process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) ;
+    virtual void processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                              const real_t * z, const float * w0, const float * w1, const float * w2);
     virtual TriangleShader * copy(bool deep = false) const;
 
     uint32_t shapeid;
     uint32_t defaultid;
     Color4::eColor4Format conversionformat;
+    /// The frame buffer of the engine if it stores the ids natively. Set by init.
+    IdFrameBufferManager * idbuffer;
 };
 
 class TextureShader : public TriangleShader {
@@ -146,12 +162,20 @@ public:
     virtual void process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) ;
     virtual TriangleShader * copy(bool deep = false) const;
 
-    ImagePtr image;
+    MipmappedTexturePtr image;
     Vector2 uv0;
     Vector2 uv1;
     Vector2 uv2;
     bool repeatu;
     bool repeatv;
+    bool mipmaping;
+
+    /** Depth of the vertices (1 with orthographic camera) and derivatives along raster x and y
+        of sum(l_i uv_i / z_i) and sum(l_i / z_i), where l_i are the linear barycentric coordinates.
+        They give the derivatives of uv at each fragment to select its mip level. */
+    real_t z0, z1, z2;
+    Vector2 duvzdx, duvzdy;
+    real_t dinvzdx, dinvzdy;
 };
 
 
@@ -162,6 +186,8 @@ public:
 
     virtual void init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, uint32_t shapeid, const ProjectionCameraPtr& camera);
     virtual void process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) ;
+    virtual void processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                              const real_t * z, const float * w0, const float * w1, const float * w2);
     virtual TriangleShader * copy(bool deep = false) const;
 
     void setColors(const Color4& _c0, const Color4& _c1, const Color4& _c2) { c0 = _c0; c1 = _c1; c2 = _c2; }
@@ -178,6 +204,8 @@ public:
 
     virtual void init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, uint32_t shapeid, const ProjectionCameraPtr& camera);
     virtual void process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) ;
+    virtual void processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                              const real_t * z, const float * w0, const float * w1, const float * w2);
     virtual TriangleShader * copy(bool deep = false) const;
 
     Color4 c0;
@@ -212,6 +240,8 @@ public:
 
     virtual void init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, uint32_t shapeid, const ProjectionCameraPtr& camera);
     virtual void process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) ;
+    virtual void processBlock(int32_t x, int32_t y, uint32_t count, uint32_t mask, 
+                              const real_t * z, const float * w0, const float * w1, const float * w2);
     virtual TriangleShader * copy(bool deep = false) const;
 
     pgl_hash_map<int32_t, TriangleShaderPtr> __shadermap;
@@ -0,0 +1,109 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+             
+
+#include "shadowmap.h"
+#include "zbufferengine.h"
+#include "../base/bboxcomputer.h"
+#include "../base/discretizer.h"
+#include <plantgl/scenegraph/geometry/boundingbox.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+ShadowMap::ShadowMap(const Vector3& direction, uint16_t width, uint16_t height):
+    RefCountObject(),
+    __direction(direction.normed()),
+    __width(width),
+    __height(height),
+    __bias(-1),
+    __texelSize(0),
+    __camera(),
+    __depthBuffer()
+{
+}
+
+ShadowMap::~ShadowMap() {}
+
+void ShadowMap::compute(ScenePtr scene)
+{
+    Discretizer d;
+    BBoxComputer bbc(d);
+    bbc.process(scene);
+    compute(scene, bbc.getBoundingBox());
+}
+
+void ShadowMap::compute(ScenePtr scene, const BoundingBoxPtr& bbox)
+{
+    if (is_null_ptr(bbox)) return;
+
+    Vector3 center = bbox->getCenter();
+    real_t radius = pglMax(norm(bbox->getSize()), real_t(GEOM_EPSILON));
+    real_t xextent = radius * pglMax(real_t(1), real_t(__width) / __height);
+    real_t yextent = radius * pglMax(real_t(1), real_t(__height) / __width);
+    __texelSize = 2 * radius / pglMin(__width, __height);
+
+    // Scene is between distance radius and 3 radius from the light camera
+    Vector3 up = (fabs(__direction.z()) < 0.9 ? Vector3::OZ : Vector3::OX);
+    ZBufferEngine engine(__width, __height, Color3(0,0,0), ZBufferEngine::eDepthOnly);
+    engine.setMultiThreaded(false);
+    engine.setOrthographicCamera(-xextent, xextent, -yextent, yextent, 0.5 * radius, 3.5 * radius);
+    engine.lookAt(center - __direction * (2 * radius), center, up);
+    engine.process(scene);
+
+    __camera = engine.camera();
+    __depthBuffer = engine.getDepthBuffer();
+}
+
+bool ShadowMap::isLit(const Vector3& position) const
+{
+    if (is_null_ptr(__depthBuffer)) return true;
+    Vector3 raster = __camera->worldToRaster(position, __width, __height);
+    int32_t x = int32_t(floor(raster.x()));
+    int32_t y = int32_t(floor(raster.y()));
+    if (x < 0 || y < 0 || x >= __width || y >= __height) return true;
+    real_t bias = (__bias < 0 ? 1.5 * __texelSize : __bias);
+    return raster.z() <= __depthBuffer->getAt(x, y) + bias;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,139 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+             
+
+/*! \file shadowmap.h
+    \brief Shadow maps of directional lights for ZBufferEngine.
+*/
+
+
+
+#ifndef __ShadowMap_h__
+#define __ShadowMap_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include "projectioncamera.h"
+#include <plantgl/tool/util_array2.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Maximum number of shadow lights of a ZBufferEngine (one bit per light in lighting buffer).
+#define PGL_MAX_SHADOW_LIGHTS 32
+
+/* ----------------------------------------------------------------------- */
+
+/** 
+    \class ShadowMap
+    \brief Depth map of a scene seen from a directional light.
+
+    The map is rendered with an orthographic ProjectionCamera looking along 
+    the light direction and fitted to the bounding box of the scene.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class ShadowMap;
+typedef RCPtr<ShadowMap> ShadowMapPtr;
+
+class ALGO_API ShadowMap : public RefCountObject {
+public:
+    /// Constructor. \e direction is the direction of propagation of the light.
+    ShadowMap(const Vector3& direction, uint16_t width = 1024, uint16_t height = 1024);
+    virtual ~ShadowMap();
+
+    /// Render the depth map of \e scene.
+    void compute(ScenePtr scene);
+
+    /// Render the depth map of \e scene with a camera fitted to \e bbox.
+    void compute(ScenePtr scene, const BoundingBoxPtr& bbox);
+
+    /// Tell whether \e position (in world coordinates) receives the light.
+    bool isLit(const Vector3& position) const;
+
+    bool isComputed() const { return is_valid_ptr(__depthBuffer); }
+
+    const Vector3& getDirection() const { return __direction; }
+    uint16_t getWidth() const { return __width; }
+    uint16_t getHeight() const { return __height; }
+
+    /// Depth tolerance used to compare depths. If negative, 1.5 texel size is used.
+    real_t getBias() const { return __bias; }
+    void setBias(real_t bias) { __bias = bias; }
+
+    const ProjectionCameraPtr& getCamera() const { return __camera; }
+    const RealArray2Ptr& getDepthBuffer() const { return __depthBuffer; }
+
+protected:
+    Vector3 __direction;
+    uint16_t __width;
+    uint16_t __height;
+    real_t __bias;
+    real_t __texelSize;
+    ProjectionCameraPtr __camera;
+    RealArray2Ptr __depthBuffer;
+};
+
+/// Lit statistics of a shape in a rendering with shadow lights.
+struct ALGO_API ShapeLighting {
+    ShapeLighting(uint32_t nblights = 0) : nbPixels(0), nbLitPixels(nblights, 0) {}
+
+    /// Number of visible pixels of the shape.
+    uint32_t nbPixels;
+    /// Number of visible pixels of the shape lit by each light.
+    std::vector<uint32_t> nbLitPixels;
+};
+
+typedef pgl_hash_map<uint32_t, ShapeLighting> ShapeLightingMap;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
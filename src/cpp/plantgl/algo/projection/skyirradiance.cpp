@@ -0,0 +1,347 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include "skyirradiance.h"
+#include "zbufferengine.h"
+#include "../base/tesselator.h"
+#include "../base/bboxcomputer.h"
+#include "../base/surfcomputer.h"
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/errormsg.h>
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+Vector3 LightDirection::getDirection(real_t north) const
+{
+    Vector3 direction(-Vector3(Vector3::Spherical(1, (north - azimuth) * GEOM_RAD, (90 - elevation) * GEOM_RAD)));
+    direction.normalize();
+    return direction;
+}
+
+/* ----------------------------------------------------------------------- */
+
+SkyIrradiance::SkyIrradiance(const ScenePtr& scene, real_t screenResolution, real_t north):
+    RefCountObject(),
+    __scene(new Scene()),
+    __bbox(),
+    __screenResolution(screenResolution),
+    __north(north),
+    __multithreaded(true)
+{
+    // The meshes are tessellated and their normals computed once, since the engines of
+    // the directions share them and would otherwise compute them concurrently.
+    Tesselator tesselator;
+    SurfComputer surfcomputer(tesselator);
+    for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it) {
+        ShapePtr shape = dynamic_pointer_cast<Shape>(*it);
+        if (is_null_ptr(shape)) continue;
+        if (shape->apply(surfcomputer)) __shapeAreas[shape->getId()] += surfcomputer.getSurface();
+        else __shapeAreas[shape->getId()] += 0;
+        if (shape->apply(tesselator)) {
+            TriangleSetPtr triangles = tesselator.getTriangulation();
+            triangles->checkNormalList();
+            __scene->add(ShapePtr(new Shape(GeometryPtr(triangles), shape->getAppearance(), shape->getId())));
+        }
+        else __scene->add(shape);
+    }
+    for (ShapeValueMap::const_iterator it = __shapeAreas.begin(); it != __shapeAreas.end(); ++it)
+        __shapeIds.push_back(it->first);
+    std::sort(__shapeIds.begin(), __shapeIds.end());
+
+    if (!__scene->empty()) {
+        Discretizer discretizer;
+        BBoxComputer bbc(discretizer);
+        bbc.process(__scene);
+        __bbox = bbc.getBoundingBox();
+    }
+}
+
+SkyIrradiance::~SkyIrradiance() {}
+
+SkyIrradiance::DirectionKey SkyIrradiance::directionKey(real_t azimuth, real_t elevation)
+{
+    int32_t az = int32_t(floor(azimuth * 100 + 0.5)) % 36000;
+    if (az < 0) az += 36000;
+    return DirectionKey(az, int32_t(floor(elevation * 100 + 0.5)));
+}
+
+ShapeValueMap SkyIrradiance::render(const Vector3& direction) const
+{
+    ShapeValueMap result;
+    if (is_null_ptr(__bbox)) return result;
+
+    Vector3 center = __bbox->getCenter();
+    Vector3 halfSize = __bbox->getSize();
+    real_t distance = 2 * pglMax(pglMax(pglMax(halfSize.x(), halfSize.y()), halfSize.z()), real_t(GEOM_EPSILON));
+
+    // Extent of the bounding box seen along direction
+    Vector3 up = direction.anOrthogonalVector();
+    Vector3 side = cross(up, direction);
+    side.normalize();
+    up = cross(direction, side);
+    up.normalize();
+    real_t width = 0, height = 0;
+    for (int i = 0; i < 8; ++i) {
+        Vector3 corner(i & 1 ? halfSize.x() : -halfSize.x(), i & 2 ? halfSize.y() : -halfSize.y(), i & 4 ? halfSize.z() : -halfSize.z());
+        width = pglMax(width, 2 * fabs(dot(side, corner)));
+        height = pglMax(height, 2 * fabs(dot(up, corner)));
+    }
+
+    // The images are limited to 65535 pixels along each axis
+    real_t resolution = pglMax(__screenResolution, pglMax(width, height) / (UINT16_MAX - 1));
+    uint16_t w = uint16_t(pglMax(2, int(ceil(width / resolution)) + 1));
+    uint16_t h = uint16_t(pglMax(2, int(ceil(height / resolution)) + 1));
+    width = w * resolution;
+    height = h * resolution;
+
+    ZBufferEngine engine(w, h, Shape::NOID, Color4::eARGB);
+    engine.setMultiThreaded(false);
+    engine.setDepthPrecision(DepthBuffer::eFloatDepth);
+    engine.setIdStatisticsEnabled(true);
+    engine.setOrthographicCamera(-width / 2, width / 2, -height / 2, height / 2, distance, 3 * distance);
+    engine.lookAt(center - direction * distance * 2, center, up);
+    engine.process(__scene);
+
+    const IdStatistics& statistics = engine.getIdStatistics();
+    for (size_t i = 0; i < statistics.size(); ++i)
+        result[statistics.ids[i]] = statistics.areas[i];
+    return result;
+}
+
+const ShapeValueMap& SkyIrradiance::getProjectedAreas(real_t azimuth, real_t elevation)
+{
+    DirectionKey key = directionKey(azimuth, elevation);
+    std::map<DirectionKey, ShapeValueMap>::iterator it = __projectedAreas.find(key);
+    if (it == __projectedAreas.end())
+        it = __projectedAreas.insert(std::make_pair(key, render(LightDirection(azimuth, elevation).getDirection(__north)))).first;
+    return it->second;
+}
+
+void SkyIrradiance::computeProjectedAreas(const LightDirectionList& directions)
+{
+    std::vector<DirectionKey> keys;
+    std::vector<Vector3> toRender;
+    for (LightDirectionList::const_iterator it = directions.begin(); it != directions.end(); ++it) {
+        DirectionKey key = directionKey(it->azimuth, it->elevation);
+        if (__projectedAreas.find(key) != __projectedAreas.end() || std::find(keys.begin(), keys.end(), key) != keys.end()) continue;
+        keys.push_back(key);
+        toRender.push_back(it->getDirection(__north));
+    }
+    // Each direction is rendered with its own single threaded engine
+    std::vector<ShapeValueMap> areas(toRender.size());
+    pgl_parallel_for(0, toRender.size(), [this, &areas, &toRender](size_t i) {
+        areas[i] = render(toRender[i]);
+    }, __multithreaded ? 0 : 1);
+    for (size_t i = 0; i < keys.size(); ++i) __projectedAreas[keys[i]].swap(areas[i]);
+}
+
+ShapeValueMap SkyIrradiance::interception(const LightDirectionList& directions, bool horizontal)
+{
+    computeProjectedAreas(directions);
+    ShapeValueMap result;
+    for (LightDirectionList::const_iterator it = directions.begin(); it != directions.end(); ++it) {
+        real_t weight = it->weight;
+        if (horizontal) {
+            real_t sinel = sin(it->elevation * GEOM_RAD);
+            if (sinel <= GEOM_EPSILON) continue;
+            weight /= sinel;
+        }
+        const ShapeValueMap& areas = getProjectedAreas(it->azimuth, it->elevation);
+        for (ShapeValueMap::const_iterator itarea = areas.begin(); itarea != areas.end(); ++itarea)
+            result[itarea->first] += itarea->second * weight;
+    }
+    return result;
+}
+
+ShapeValueMap SkyIrradiance::irradiance(const LightDirectionList& directions, bool horizontal)
+{
+    ShapeValueMap result = interception(directions, horizontal);
+    for (ShapeValueMap::iterator it = result.begin(); it != result.end(); ++it) {
+        ShapeValueMap::const_iterator itarea = __shapeAreas.find(it->first);
+        it->second = (itarea != __shapeAreas.end() && itarea->second > GEOM_EPSILON ? it->second / itarea->second : 0);
+    }
+    return result;
+}
+
+RealArray2Ptr SkyIrradiance::irradiances(const std::vector<LightDirectionList>& steps, bool horizontal)
+{
+    LightDirectionList all;
+    for (std::vector<LightDirectionList>::const_iterator it = steps.begin(); it != steps.end(); ++it)
+        all.insert(all.end(), it->begin(), it->end());
+    computeProjectedAreas(all);
+
+    pgl_hash_map<uint32_t, uint_t> rows;
+    for (uint_t i = 0; i < __shapeIds.size(); ++i) rows[__shapeIds[i]] = i;
+    RealArray2Ptr result(new RealArray2(uint_t(__shapeIds.size()), uint_t(steps.size()), 0));
+    for (uint_t step = 0; step < steps.size(); ++step) {
+        ShapeValueMap values = irradiance(steps[step], horizontal);
+        for (ShapeValueMap::const_iterator it = values.begin(); it != values.end(); ++it) {
+            pgl_hash_map<uint32_t, uint_t>::const_iterator itrow = rows.find(it->first);
+            if (itrow != rows.end()) result->setAt(itrow->second, step, it->second);
+        }
+    }
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+const LightDirectionList& SkyIrradiance::skyTurtle()
+{
+    static const real_t elevations[] = {
+        9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 10.81, 10.81, 10.81, 10.81, 10.81,
+        26.57, 26.57, 26.57, 26.57, 26.57, 31.08, 31.08, 31.08, 31.08, 31.08, 31.08, 31.08, 31.08, 31.08, 31.08,
+        47.41, 47.41, 47.41, 47.41, 47.41, 52.62, 52.62, 52.62, 52.62, 52.62, 69.16, 69.16, 69.16, 69.16, 69.16, 90 };
+    static const real_t azimuths[] = {
+        12.23, 59.77, 84.23, 131.77, 156.23, 203.77, 228.23, 275.77, 300.23, 347.77, 36, 108, 180, 252, 324,
+        0, 72, 144, 216, 288, 23.27, 48.73, 95.27, 120.73, 167.27, 192.73, 239.27, 264.73, 311.27, 336.73,
+        0, 72, 144, 216, 288, 36, 108, 180, 252, 324, 0, 72, 144, 216, 288, 180 };
+    static const real_t weights[] = {
+        0.026808309, 0.029325083, 0.031299545, 0.038160959, 0.045638829, 0.050212264, 0.052965108, 0.0481 };
+    // Index in weights of each elevation
+    static const int rings[] = { 0, 10, 15, 20, 30, 35, 40, 45, 46 };
+    static LightDirectionList directions;
+    static std::once_flag initialized;
+    std::call_once(initialized, []() {
+        for (int ring = 0; ring < 8; ++ring)
+            for (int i = rings[ring]; i < rings[ring + 1]; ++i)
+                directions.push_back(LightDirection(azimuths[i], elevations[i], weights[ring]));
+    });
+    return directions;
+}
+
+namespace {
+
+real_t declination(int day)
+{
+    real_t om = 0.017202 * (day - 3.244);
+    real_t teta = om + 0.03344 * sin(om) * (1 + 0.021 * cos(om)) - 1.3526;
+    return asin(0.3978 * sin(teta));
+}
+
+/// Hour angle (radians) of the minute \e m of the solar day.
+inline real_t hourAngle(real_t m) { return (m * 0.25 - 180) * GEOM_RAD; }
+
+/// The true solar time (minutes) of the local \e hour of \e day.
+int solarTime(int day, real_t hour, real_t decalSun, real_t decalGMT, real_t longitude)
+{
+    real_t om = 0.017202 * (day - 3.244);
+    real_t teta = om + 0.03344 * sin(om) * (1 + 0.021 * cos(om)) - 1.3526;
+    real_t dph1 = atan(0.91747 * sin(teta) / cos(teta)) - om + 1.3526;
+    real_t dphi = dph1;
+    if (dph1 <= -1) {
+        real_t n = dph1 + 1;
+        dphi = n - GEOM_PI * floor(n / GEOM_PI + 0.5) - 1;
+    }
+    real_t equationOfTime = -dphi * 229.2;
+    return int(floor((hour - decalSun - decalGMT + longitude / 15. + equationOfTime / 60.) * 60 + 0.5));
+}
+
+real_t sunAzimuth(real_t latitude, real_t declin, real_t angle, real_t height)
+{
+    real_t sinAz = cos(declin) * sin(angle) / cos(height);
+    real_t cosAz = (sin(latitude) * cos(declin) * cos(angle) - cos(latitude) * sin(declin)) / cos(height);
+    sinAz = pglMax(real_t(-1), pglMin(real_t(1), sinAz));
+    if (cosAz >= 0) return asin(sinAz);
+    else if (sinAz >= 0) return GEOM_PI - asin(sinAz);
+    else return -GEOM_PI - asin(sinAz);
+}
+
+inline real_t round2(real_t value) { return floor(value * 100 + 0.5) / 100; }
+
+}
+
+LightDirectionList SkyIrradiance::sunCourse(real_t latitude, real_t longitude, int day,
+                                            real_t startHour, real_t stopHour, int step,
+                                            real_t decalSun, real_t decalGMT)
+{
+    typedef std::tuple<real_t, real_t, int, real_t, real_t, int, real_t, real_t> CourseKey;
+    static std::map<CourseKey, LightDirectionList> courses;
+    static std::mutex coursesMutex;
+
+    CourseKey key(latitude, longitude, day, startHour, stopHour, step, decalSun, decalGMT);
+    {
+        std::lock_guard<std::mutex> lock(coursesMutex);
+        std::map<CourseKey, LightDirectionList>::const_iterator it = courses.find(key);
+        if (it != courses.end()) return it->second;
+    }
+
+    LightDirectionList result;
+    if (step > 0) {
+        real_t lat = latitude * GEOM_RAD;
+        real_t declin = declination(day);
+        int start = solarTime(day, startHour, decalSun, decalGMT, longitude);
+        int stop = solarTime(day, stopHour, decalSun, decalGMT, longitude);
+        // Polar days and nights have no sunrise and sunset
+        real_t halfDay = acos(pglMax(real_t(-1), pglMin(real_t(1), -tan(declin) * tan(lat)))) * GEOM_DEG / 360. * 24;
+        real_t sunrise = hourAngle(floor((12 - halfDay) * 60 + 0.5));
+        real_t sunset = hourAngle(floor((12 + halfDay) * 60 + 0.5));
+        real_t angularStep = step * 0.25 * GEOM_RAD;
+        real_t end = hourAngle(stop + 1);
+        for (real_t s = hourAngle(start); s < end; s += angularStep) {
+            if (s < sunrise || s > sunset) continue;
+            real_t height = asin(sin(lat) * sin(declin) + cos(lat) * cos(declin) * cos(s));
+            if (height <= 0) continue;
+            result.push_back(LightDirection(sunAzimuth(lat, declin, s, height) * GEOM_DEG, height * GEOM_DEG,
+                                            pow(0.7, 1 / sin(height)) * sin(height)));
+        }
+        real_t sum = 0;
+        for (LightDirectionList::const_iterator it = result.begin(); it != result.end(); ++it) sum += it->weight;
+        for (LightDirectionList::iterator it = result.begin(); it != result.end(); ++it) {
+            it->weight /= sum;
+            it->azimuth = round2(it->azimuth);
+            it->elevation = round2(it->elevation);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(coursesMutex);
+    courses[key] = result;
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
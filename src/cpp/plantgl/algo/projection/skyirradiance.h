@@ -0,0 +1,183 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file skyirradiance.h
+    \brief Irradiance of the shapes of a scene lit from the directions of the sun and the sky.
+*/
+
+#ifndef __SkyIrradiance_h__
+#define __SkyIrradiance_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/math/util_vector.h>
+#include <plantgl/tool/util_array2.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/geometry/boundingbox.h>
+#include <vector>
+#include <map>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/** A direction from which the light comes, given by its azimuth (degrees, clockwise from the North)
+    and its elevation (degrees), with the irradiance it brings. */
+struct ALGO_API LightDirection {
+    LightDirection(real_t _azimuth = 0, real_t _elevation = 90, real_t _weight = 1) :
+        azimuth(_azimuth), elevation(_elevation), weight(_weight) {}
+
+    /// Direction of propagation of the light in a scene whose x axis makes the angle \e north (degrees) with the North.
+    Vector3 getDirection(real_t north = 0) const;
+
+    real_t azimuth;
+    real_t elevation;
+    real_t weight;
+};
+
+typedef std::vector<LightDirection> LightDirectionList;
+
+/// A value for each shape id.
+typedef pgl_hash_map<uint32_t, real_t> ShapeValueMap;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+    \class SkyIrradiance
+    \brief Light intercepted by the shapes of a scene from a set of directions.
+
+    For each direction, the scene is rendered with an orthographic id based ZBufferEngine and
+    the visible area of each shape is its number of pixels times the area of a pixel.
+    The scene is tessellated once at construction and the directions are rendered in parallel.
+    The visible areas are kept for each direction (rounded to 0.01 degree) so that the
+    directions shared by several calls or time steps, such as the sky directions or
+    the sun positions of a day, are rendered only once.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class SkyIrradiance;
+typedef RCPtr<SkyIrradiance> SkyIrradiancePtr;
+
+class ALGO_API SkyIrradiance : public RefCountObject {
+public:
+    /** Constructor. \e screenResolution is the size of a pixel in the units of the scene and
+        \e north the angle (degrees, counter clockwise) between the x axis and the North. */
+    SkyIrradiance(const ScenePtr& scene, real_t screenResolution = 1, real_t north = 0);
+    virtual ~SkyIrradiance();
+
+    real_t getScreenResolution() const { return __screenResolution; }
+    real_t getNorth() const { return __north; }
+
+    bool isMultiThreaded() const { return __multithreaded; }
+    void setMultiThreaded(bool value) { __multithreaded = value; }
+
+    /// The sorted ids of the shapes of the scene.
+    const std::vector<uint32_t>& getShapeIds() const { return __shapeIds; }
+
+    /// The area of the surface of the shapes of each id.
+    const ShapeValueMap& getShapeAreas() const { return __shapeAreas; }
+
+    /// The area of the shapes of each id seen from the direction (\e azimuth, \e elevation).
+    const ShapeValueMap& getProjectedAreas(real_t azimuth, real_t elevation);
+
+    /// Render in parallel the directions of \e directions whose projected areas are not known.
+    void computeProjectedAreas(const LightDirectionList& directions);
+
+    /// Number of directions whose projected areas are kept.
+    size_t getNbCachedDirections() const { return __projectedAreas.size(); }
+    void clearCache() { __projectedAreas.clear(); }
+
+    /** The light intercepted by the shapes of each id: the sum over \e directions of their
+        projected area times the weight of the direction. If \e horizontal, the weights are
+        irradiances on an horizontal plane and are divided by the sine of the elevation. */
+    ShapeValueMap interception(const LightDirectionList& directions, bool horizontal = false);
+
+    /// The intercepted light divided by the area of the shapes of each lit id.
+    ShapeValueMap irradiance(const LightDirectionList& directions, bool horizontal = false);
+
+    /** The irradiance of the shapes of each id of getShapeIds() (rows) for each time step (columns),
+        a time step being a set of directions. All the directions are rendered in a single parallel pass. */
+    RealArray2Ptr irradiances(const std::vector<LightDirectionList>& steps, bool horizontal = false);
+
+    /// The 46 directions of the sky turtle with their weights for a standard overcast sky.
+    static const LightDirectionList& skyTurtle();
+
+    /** The positions of the sun every \e step minutes between \e startHour and \e stopHour
+        of the julian day \e day at \e latitude and \e longitude (degrees). \e decalSun and
+        \e decalGMT give the daylight saving time and the time zone (hours).
+        The weights follow the atmospheric transmission of the direct light and sum to 1.
+        The courses are kept for each site and time window. */
+    static LightDirectionList sunCourse(real_t latitude, real_t longitude, int day,
+                                        real_t startHour, real_t stopHour, int step = 30,
+                                        real_t decalSun = 1, real_t decalGMT = 0);
+
+protected:
+    typedef std::pair<int32_t, int32_t> DirectionKey;
+
+    static DirectionKey directionKey(real_t azimuth, real_t elevation);
+
+    /// Render the scene from \e direction (direction of propagation) and count the pixels of each id.
+    ShapeValueMap render(const Vector3& direction) const;
+
+    /// The tessellated scene.
+    ScenePtr __scene;
+    BoundingBoxPtr __bbox;
+    real_t __screenResolution;
+    real_t __north;
+    bool __multithreaded;
+
+    std::vector<uint32_t> __shapeIds;
+    ShapeValueMap __shapeAreas;
+
+    std::map<DirectionKey, ShapeValueMap> __projectedAreas;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
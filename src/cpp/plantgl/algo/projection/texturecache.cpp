@@ -0,0 +1,215 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+             
+
+#include "texturecache.h"
+#include <plantgl/math/util_math.h>
+#include <sys/stat.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+MipmappedTexture::MipmappedTexture(const ImagePtr& image):
+    RefCountObject(),
+    __levels(1, image),
+    __memorySize(image->width() * image->height() * image->nbChannels())
+{
+    if (!isValid()) return;
+    uint_t nbchannels = image->nbChannels();
+    std::vector<uint_t> sum(nbchannels);
+    std::vector<uchar_t> texel(nbchannels);
+    while (__levels.back()->width() > 1 || __levels.back()->height() > 1) {
+        const ImagePtr& level = __levels.back();
+        uint_t w = level->width(), h = level->height();
+        uint_t nw = std::max<uint_t>(1, w / 2), nh = std::max<uint_t>(1, h / 2);
+        ImagePtr next(new Image(nw, nh, nbchannels));
+        for (uint_t y = 0; y < nh; ++y) {
+            for (uint_t x = 0; x < nw; ++x) {
+                // average the 2x2 block of texels. For odd sizes, the last row and column are merged with the previous ones.
+                uint_t x0 = 2 * x, x1 = (x == nw - 1 ? w : 2 * x + 2);
+                uint_t y0 = 2 * y, y1 = (y == nh - 1 ? h : 2 * y + 2);
+                std::fill(sum.begin(), sum.end(), 0);
+                for (uint_t sy = y0; sy < y1; ++sy)
+                    for (uint_t sx = x0; sx < x1; ++sx) {
+                        const uchar_t * data = level->getPixelDataAt(sx, sy);
+                        for (uint_t c = 0; c < nbchannels; ++c) sum[c] += data[c];
+                    }
+                uint_t nb = (x1 - x0) * (y1 - y0);
+                for (uint_t c = 0; c < nbchannels; ++c) texel[c] = uchar_t((sum[c] + nb / 2) / nb);
+                next->setPixelAt(x, y, &texel[0]);
+            }
+        }
+        __levels.push_back(next);
+        __memorySize += nw * nh * nbchannels;
+    }
+}
+
+MipmappedTexture::~MipmappedTexture() {}
+
+real_t MipmappedTexture::getLevelOfDetail(const Vector2& duvdx, const Vector2& duvdy) const
+{
+    // Size of a pixel in texels.
+    real_t rhox = norm(Vector2(duvdx.x() * width(), duvdx.y() * height()));
+    real_t rhoy = norm(Vector2(duvdy.x() * width(), duvdy.y() * height()));
+    real_t rho = std::max(rhox, rhoy);
+    if (rho <= 0) return 0;
+    return log(rho) / log(2.);
+}
+
+Color4 MipmappedTexture::getPixelAtUV(real_t u, real_t v, real_t lod, bool repeatu, bool repeatv) const
+{
+    if (!isValid()) return Color4();
+    uint_t level = 0;
+    if (lod > 0.5) level = std::min<uint_t>(getLevelCount() - 1, uint_t(lod + 0.5));
+    return __levels[level]->getPixelAtUV(u, v, repeatu, repeatv);
+}
+
+/* ----------------------------------------------------------------------- */
+
+const size_t TextureCache::DEFAULT_MAX_MEMORY_SIZE = 256 * 1024 * 1024;
+
+TextureCache::TextureCache():
+    __textures(),
+    __lru(),
+    __maxMemorySize(DEFAULT_MAX_MEMORY_SIZE),
+    __statistics()
+{
+}
+
+TextureCache& TextureCache::get()
+{
+    static TextureCache CACHE;
+    return CACHE;
+}
+
+static time_t modificationTime(const std::string& filename)
+{
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return 0;
+    return st.st_mtime;
+}
+
+MipmappedTexturePtr TextureCache::getTexture(const std::string& filename)
+{
+    time_t mtime = modificationTime(filename);
+    {
+        std::lock_guard<std::mutex> guard(__mutex);
+        pgl_hash_map_string<Entry>::iterator it = __textures.find(filename);
+        if (it != __textures.end()) {
+            if (it->second.modificationTime == mtime) {
+                ++__statistics.hits;
+                __lru.splice(__lru.begin(), __lru, it->second.lru);
+                return it->second.texture;
+            }
+            ++__statistics.reloads;
+        }
+    }
+
+    // Decode the file without locking the cache, so that other textures can be accessed meanwhile.
+    MipmappedTexturePtr texture(new MipmappedTexture(ImagePtr(new Image(filename))));
+
+    std::lock_guard<std::mutex> guard(__mutex);
+    ++__statistics.misses;
+    pgl_hash_map_string<Entry>::iterator it = __textures.find(filename);
+    if (it != __textures.end()) {
+        // Loaded by another thread meanwhile.
+        if (it->second.modificationTime == mtime) {
+            __lru.splice(__lru.begin(), __lru, it->second.lru);
+            return it->second.texture;
+        }
+        __statistics.memorySize -= it->second.texture->getMemorySize();
+        __lru.erase(it->second.lru);
+        __textures.erase(it);
+    }
+    __lru.push_front(filename);
+    Entry& entry = __textures[filename];
+    entry.texture = texture;
+    entry.modificationTime = mtime;
+    entry.lru = __lru.begin();
+    __statistics.memorySize += texture->getMemorySize();
+    evict();
+    return texture;
+}
+
+void TextureCache::evict()
+{
+    // The most recently used texture is always kept.
+    while (__statistics.memorySize > __maxMemorySize && __lru.size() > 1) {
+        pgl_hash_map_string<Entry>::iterator it = __textures.find(__lru.back());
+        __statistics.memorySize -= it->second.texture->getMemorySize();
+        __textures.erase(it);
+        __lru.pop_back();
+        ++__statistics.evictions;
+    }
+}
+
+void TextureCache::setMaxMemorySize(size_t size)
+{
+    std::lock_guard<std::mutex> guard(__mutex);
+    __maxMemorySize = size;
+    evict();
+}
+
+void TextureCache::clear()
+{
+    std::lock_guard<std::mutex> guard(__mutex);
+    __textures.clear();
+    __lru.clear();
+    __statistics.memorySize = 0;
+}
+
+TextureCache::Statistics TextureCache::getStatistics() const
+{
+    std::lock_guard<std::mutex> guard(__mutex);
+    Statistics result = __statistics;
+    result.nbTextures = __textures.size();
+    return result;
+}
+
+void TextureCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> guard(__mutex);
+    size_t memorySize = __statistics.memorySize;
+    __statistics = Statistics();
+    __statistics.memorySize = memorySize;
+}
@@ -0,0 +1,188 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file texturecache.h
+    \brief Process wide cache of the decoded textures of ZBufferEngine.
+*/
+
+
+
+#ifndef __TextureCache_h__
+#define __TextureCache_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/scenegraph/appearance/util_image.h>
+#include <plantgl/math/util_vector.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/** 
+    \class MipmappedTexture
+    \brief An image with its pyramid of mip levels.
+
+    Each level is half the size of the previous one, each texel averaging a 2x2 block of texels,
+    down to a 1x1 level. Minified textures are sampled in the level whose texels best match the pixels.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class MipmappedTexture;
+typedef RCPtr<MipmappedTexture> MipmappedTexturePtr;
+
+class ALGO_API MipmappedTexture : public RefCountObject {
+public:
+    /// Constructor. Build the mip levels of \e image.
+    MipmappedTexture(const ImagePtr& image);
+    virtual ~MipmappedTexture();
+
+    uint_t width() const { return __levels[0]->width(); }
+    uint_t height() const { return __levels[0]->height(); }
+    bool isValid() const { return width() > 0 && height() > 0; }
+
+    uint_t getLevelCount() const { return __levels.size(); }
+    const ImagePtr& getLevel(uint_t level) const { return __levels[level]; }
+
+    /// Number of bytes of the texels of all the levels.
+    size_t getMemorySize() const { return __memorySize; }
+
+    /** Level of detail of a fragment whose uv coordinates vary of \e duvdx and \e duvdy 
+        between neighbor pixels along x and y. Negative when the texture is magnified. */
+    real_t getLevelOfDetail(const Vector2& duvdx, const Vector2& duvdy) const;
+
+    /// Color of the texel at (\e u, \e v) in the level the closest to \e lod.
+    Color4 getPixelAtUV(real_t u, real_t v, real_t lod = 0, bool repeatu = true, bool repeatv = true) const;
+
+protected:
+    std::vector<ImagePtr> __levels;
+    size_t __memorySize;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/** 
+    \class TextureCache
+    \brief Thread safe cache of the textures decoded from files, shared by all the engines.
+
+    Textures are identified by their file name and reloaded when the modification time of the file changes.
+    When the memory used by the textures exceeds the maximum size, the least recently used textures are removed.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class ALGO_API TextureCache {
+public:
+    /// Statistics of the use of the cache.
+    struct Statistics {
+        Statistics() : hits(0), misses(0), reloads(0), evictions(0), nbTextures(0), memorySize(0) {}
+
+        /// Number of textures found in the cache.
+        size_t hits;
+        /// Number of textures loaded from their file (first use or reload).
+        size_t misses;
+        /// Number of textures reloaded because their file was modified.
+        size_t reloads;
+        /// Number of textures removed to respect the maximum memory size.
+        size_t evictions;
+        /// Number of textures in the cache.
+        size_t nbTextures;
+        /// Number of bytes of the textures in the cache.
+        size_t memorySize;
+    };
+
+    /// Default maximum number of bytes of the textures (256 Mb).
+    static const size_t DEFAULT_MAX_MEMORY_SIZE;
+
+    /// Singleton access.
+    static TextureCache& get();
+
+    /// Return the texture of the file \e filename, loading it if needed.
+    MipmappedTexturePtr getTexture(const std::string& filename);
+
+    /// Maximum number of bytes of the textures. The last used texture is always kept.
+    size_t getMaxMemorySize() const { return __maxMemorySize; }
+    void setMaxMemorySize(size_t size);
+
+    /// Remove all the textures.
+    void clear();
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+protected:
+    TextureCache();
+
+    struct Entry {
+        MipmappedTexturePtr texture;
+        time_t modificationTime;
+        std::list<std::string>::iterator lru;
+    };
+
+    /// Remove least recently used textures until the memory size is below the maximum. Mutex should be locked.
+    void evict();
+
+    pgl_hash_map_string<Entry> __textures;
+
+    /// File names of the textures from the most to the least recently used.
+    std::list<std::string> __lru;
+
+    size_t __maxMemorySize;
+    Statistics __statistics;
+
+    mutable std::mutex __mutex;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
@@ -48,7 +48,12 @@
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
+#include "../base/bboxcomputer.h"
+#include "../base/discretizer.h"
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/errormsg.h>
 #include <queue>
+#include <algorithm>
 #include <chrono>
 /* ----------------------------------------------------------------------- */
 
@@ -63,12 +68,16 @@ ZBufferEngine::ZBufferEngine(uint16_t imageWidth, uint16_t imageHeight, const Co
     __lightDiffuse(255,255,255),
     __lightSpecular(255,255,255),
     __alphathreshold(0.99),
-    __depthBuffer(new RealArray2(uint_t(imageWidth), uint_t(imageHeight), REAL_MAX)),
+    __depthBuffer(new DepthBuffer(imageWidth, imageHeight)),
     __frameBuffer(style != eDepthOnly ? new PglFrameBufferManager(imageWidth, imageHeight, style == eIdBased ? 4 : 3, backGroundColor) : NULL),
     __imageMutex(),
     __triangleshader(NULL),
     __triangleshaderset(NULL),
-    __multithreaded(DEFAULT_MULTITHREAD)
+    __multithreaded(DEFAULT_MULTITHREAD),
+    __shadowIntensity(0.5),
+    __idStatisticsEnabled(false),
+    __period(0,0),
+    __periodicWrapping(false)
 {
     if (style != eDepthOnly) {
         if (style == eIdBased) __triangleshader = TriangleShaderPtr(new IdBasedShader(this));
@@ -84,12 +93,16 @@ ZBufferEngine::ZBufferEngine(uint16_t imageWidth, uint16_t imageHeight, const Co
     __lightDiffuse(255,255,255),
     __lightSpecular(255,255,255),
     __alphathreshold(0.99),
-    __depthBuffer(new RealArray2(uint_t(imageWidth), uint_t(imageHeight), REAL_MAX)),
+    __depthBuffer(new DepthBuffer(imageWidth, imageHeight)),
     __frameBuffer(style == eColorBased ? new PglFrameBufferManager(imageWidth, imageHeight, 3, backGroundColor) : NULL),
     __imageMutex(),
     __triangleshader(NULL),
     __triangleshaderset(NULL),
-    __multithreaded(DEFAULT_MULTITHREAD)
+    __multithreaded(DEFAULT_MULTITHREAD),
+    __shadowIntensity(0.5),
+    __idStatisticsEnabled(false),
+    __period(0,0),
+    __periodicWrapping(false)
 {
     if (style != eDepthOnly) {
         if (style == eIdBased) __triangleshader = TriangleShaderPtr(new IdBasedShader(this, backGroundColor.toUint()));
@@ -104,12 +117,16 @@ ZBufferEngine::ZBufferEngine(uint16_t imageWidth, uint16_t imageHeight,uint32_t
     __lightDiffuse(255,255,255),
     __lightSpecular(255,255,255),
     __alphathreshold(0.99),
-    __depthBuffer(new RealArray2(uint_t(imageWidth), uint_t(imageHeight), REAL_MAX)),
+    __depthBuffer(new DepthBuffer(imageWidth, imageHeight)),
     __frameBuffer(), // will be initialized into IdBasedShader constructor
     __imageMutex(),
     __triangleshader(new IdBasedShader(this, defaultid, conversionformat)),
     __triangleshaderset(NULL),
-    __multithreaded(DEFAULT_MULTITHREAD)
+    __multithreaded(DEFAULT_MULTITHREAD),
+    __shadowIntensity(0.5),
+    __idStatisticsEnabled(false),
+    __period(0,0),
+    __periodicWrapping(false)
 {
 }    
 
@@ -120,9 +137,13 @@ ZBufferEngine::ZBufferEngine(uint16_t imageWidth, uint16_t imageHeight) :
 	__lightDiffuse(255, 255, 255),
 	__lightSpecular(255, 255, 255),
 	__alphathreshold(0.99),
-	__depthBuffer(new RealArray2(uint_t(imageWidth), uint_t(imageHeight), REAL_MAX)),
+	__depthBuffer(new DepthBuffer(imageWidth, imageHeight)),
 	__frameBuffer(),
-	__triangleshader(NULL)
+	__triangleshader(NULL),
+	__shadowIntensity(0.5),
+	__idStatisticsEnabled(false),
+	__period(0, 0),
+	__periodicWrapping(false)
 {}  
     
 ZBufferEngine::~ZBufferEngine()
@@ -152,6 +173,8 @@ void ZBufferEngine::beginProcess()
         // printf("begin rendering : create thread pool\n");
         __imageMutex = getImageMutex(__imageWidth, __imageHeight);
     }
+    if (is_valid_ptr(__camera)) __depthBuffer->setRange(__camera->near, __camera->far);
+    computePeriodicShifts();
 
 }
 
@@ -164,6 +187,7 @@ void ZBufferEngine::endProcess()
         // printf("end rendering : %u\n", uint32_t(__nb_tasks));
         //printf("end rendering done\n");
     }
+    if (__idStatisticsEnabled) computeIdStatistics();
 }
 
 
@@ -171,9 +195,31 @@ ImagePtr ZBufferEngine::getImage() const
 {
     PglFrameBufferManagerPtr fb = dynamic_pointer_cast<PglFrameBufferManager>(__frameBuffer);
     if (is_valid_ptr(fb)) { return fb->getImage(); }
+    IdFrameBufferManagerPtr idfb = dynamic_pointer_cast<IdFrameBufferManager>(__frameBuffer);
+    if (is_valid_ptr(idfb)) { return idfb->getImage(); }
     return ImagePtr();
 }
 
+Uint32Array2Ptr ZBufferEngine::getIdBuffer() const
+{
+    IdFrameBufferManagerPtr idfb = dynamic_pointer_cast<IdFrameBufferManager>(__frameBuffer);
+    if (is_valid_ptr(idfb)) { return idfb->getIds(); }
+    return Uint32Array2Ptr();
+}
+
+void ZBufferEngine::setDepthPrecision(DepthBuffer::ePrecision precision)
+{
+    __depthBuffer = DepthBufferPtr(new DepthBuffer(__imageWidth, __imageHeight, precision));
+}
+
+void ZBufferEngine::setLayerCount(uint32_t nbLayers)
+{
+    if (nbLayers <= 1) { __layerBuffer = LayerBufferPtr(); return; }
+    IdFrameBufferManagerPtr idfb = dynamic_pointer_cast<IdFrameBufferManager>(__frameBuffer);
+    uint32_t defaultid = (is_valid_ptr(idfb) ? idfb->getDefaultId() : Shape::NOID);
+    __layerBuffer = LayerBufferPtr(new LayerBuffer(__imageWidth, __imageHeight, nbLayers, defaultid));
+}
+
 
 bool ZBufferEngine::isTotallyTransparent(const real_t alpha) const
 {
@@ -204,10 +250,22 @@ void ZBufferEngine::setFrameBufferAt(uint32_t x, uint32_t y, const Color4& raste
     }
 }
 
+void ZBufferEngine::setFrameBufferSpan(uint32_t x, uint32_t y, uint32_t count, uint32_t mask, const Color4 * rasterColors)
+{
+    if (!__frameBuffer) return;
+    Color3 colors[PGL_RASTER_BLOCK_SIZE];
+    uint32_t opaque = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!(mask & (1u << i))) continue;
+        if (rasterColors[i].getAlpha() < GEOM_EPSILON ) { colors[i] = Color3(rasterColors[i]); opaque |= (1u << i); }
+        else setFrameBufferAt(x + i, y, rasterColors[i]);
+    }
+    if (opaque != 0) __frameBuffer->setPixelSpan(x, y, count, opaque, colors);
+}
+
 bool ZBufferEngine::isVisible(int32_t x, int32_t y, real_t z) const
 {
-    real_t cz = __depthBuffer->getAt(x, y);
-    return (z < cz && (cz-z) > GEOM_EPSILON); 
+    return __depthBuffer->isCloser(x, y, z);
 }
 
 bool ZBufferEngine::isVisible(const Vector3& pos) const
@@ -261,7 +319,7 @@ void ZBufferEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance,
 
     bool ccw = triangles->getCCW();
 
-    triangles->checkNormalList();
+    if(is_valid_ptr(__triangleshader)) triangles->checkNormalList();
 
     size_t nbfaces = triangles->getIndexListSize();
     bool hasColor = triangles->hasColorList();
@@ -286,9 +344,9 @@ void ZBufferEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance,
 
         if(is_valid_ptr(shader)){
             shader->init(appearance, triangles, itidx, id, _camera);
+            shader->initEnv(_camera);
         }
       
-        shader->initEnv(_camera);
         renderShadedTriangle(v0, v1, v2, ccw, shader, _camera);
 
     }
@@ -308,12 +366,59 @@ void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(V
     Vector3 v1Raster = camera->cameraToRaster(v1Cam,__imageWidth, __imageHeight);
     Vector3 v2Raster = camera->cameraToRaster(v2Cam,__imageWidth, __imageHeight);
 
-    v0Raster.x() = std::round(v0Raster.x());
-    v0Raster.y() = std::round(v0Raster.y());
-    v1Raster.x() = std::round(v1Raster.x());
-    v1Raster.y() = std::round(v1Raster.y());
-    v2Raster.x() = std::round(v2Raster.x());
-    v2Raster.y() = std::round(v2Raster.y());
+    if (!__periodicWrapping) {
+        renderRasterTriangle(v0Raster, v1Raster, v2Raster, ccw, shader, camera);
+        return;
+    }
+
+    real_t xmin = min3(v0Raster.x(), v1Raster.x(), v2Raster.x());
+    real_t ymin = min3(v0Raster.y(), v1Raster.y(), v2Raster.y());
+    real_t xmax = max3(v0Raster.x(), v1Raster.x(), v2Raster.x());
+    real_t ymax = max3(v0Raster.y(), v1Raster.y(), v2Raster.y());
+
+    // The translations i * shift0 + j * shift1 bringing the triangle on the image are those
+    // in the box [-xmax, width - xmin] x [-ymax, height - ymin]. Find the range of i and j
+    // from the lattice coordinates of its corners.
+    const Vector3& shift0 = __periodicShifts[0];
+    const Vector3& shift1 = __periodicShifts[1];
+    real_t cornersx[2] = { -xmax, __imageWidth - xmin };
+    real_t cornersy[2] = { -ymax, __imageHeight - ymin };
+    real_t imin = REAL_MAX, imax = -REAL_MAX, jmin = REAL_MAX, jmax = -REAL_MAX;
+    real_t det = shift0.x() * shift1.y() - shift0.y() * shift1.x();
+    for (int cx = 0; cx < 2; ++cx) {
+        for (int cy = 0; cy < 2; ++cy) {
+            real_t i, j = 0;
+            if (fabs(det) > GEOM_EPSILON) {
+                i = (shift1.y() * cornersx[cx] - shift1.x() * cornersy[cy]) / det;
+                j = (shift0.x() * cornersy[cy] - shift0.y() * cornersx[cx]) / det;
+            }
+            else {
+                // Only one periodic axis: project the corner on its shift.
+                const Vector3& shift = (shift0.x() != 0 || shift0.y() != 0 ? shift0 : shift1);
+                real_t t = (shift.x() * cornersx[cx] + shift.y() * cornersy[cy]) / (shift.x() * shift.x() + shift.y() * shift.y());
+                if (&shift == &shift0) i = t; else { i = 0; j = t; }
+            }
+            imin = pglMin(imin, i); imax = pglMax(imax, i);
+            jmin = pglMin(jmin, j); jmax = pglMax(jmax, j);
+        }
+    }
+
+    for (int32_t i = int32_t(std::floor(imin)); i <= int32_t(std::ceil(imax)); ++i) {
+        for (int32_t j = int32_t(std::floor(jmin)); j <= int32_t(std::ceil(jmax)); ++j) {
+            Vector3 shift = shift0 * i + shift1 * j;
+            if (xmin + shift.x() >= __imageWidth || xmax + shift.x() < 0 ||
+                ymin + shift.y() >= __imageHeight || ymax + shift.y() < 0) continue;
+            renderRasterTriangle(v0Raster + shift, v1Raster + shift, v2Raster + shift, ccw, shader, camera);
+        }
+    }
+}
+
+void ZBufferEngine::renderRasterTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw,
+                                         const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera)
+{
+    Vector3 v0Raster(std::round(v0.x()), std::round(v0.y()), v0.z());
+    Vector3 v1Raster(std::round(v1.x()), std::round(v1.y()), v1.z());
+    Vector3 v2Raster(std::round(v2.x()), std::round(v2.y()), v2.z());
 
     // Prepare vertex attributes. Divde them by their vertex z-coordinate
     // (though we use a multiplication here because v.z = 1 / v.z)
@@ -347,7 +452,7 @@ void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(V
     int32_t y1 = pglMin(int32_t(__imageHeight) - 1, (int32_t)(std::floor(ymax)));
 
     if (__multithreaded && (x1-x0+1)*(y1-y0+1) > 20) {
-        ThreadManager::get().new_task(boost::bind(&ZBufferEngine::rasterizeMT, this, Index4(x0,x1,y0,y1), v0Raster, v1Raster, v2Raster, ccw, TriangleShaderPtr(shader->copy()), ProjectionCameraPtr(camera->copy())));
+        ThreadManager::get().new_task(boost::bind(&ZBufferEngine::rasterizeMT, this, Index4(x0,x1,y0,y1), v0Raster, v1Raster, v2Raster, ccw, TriangleShaderPtr(is_valid_ptr(shader) ? shader->copy() : NULL), ProjectionCameraPtr(camera->copy())));
     }
     else {
         rasterize(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,ccw,shader,camera);
@@ -373,10 +478,9 @@ void ZBufferEngine::rasterizeMT(const Index4& rect,
 
 #define PROCESS_FRAGMENT(x,y,z,w0,w1,w2) \
         if (camera->isInZRange(z)){ \
-            if (isVisible(x, y, z)) { \
+            if (acceptFragment(x, y, z)) { \
                 if(tryLock(x,y)){ \
-                    if (isVisible(x, y, z)) { \
-                        __depthBuffer->setAt(x, y, z); \
+                    if (acceptFragment(x, y, z) && storeFragment(x, y, z, layerid)) { \
                         if(is_valid_ptr(shader))shader->process(x, y, z, w0, w1, w2); \
                     } \
                     unlock(x,y); \
@@ -406,13 +510,26 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
     real_t z1 = v1Raster.z();
     real_t z2 = v2Raster.z();
 
+    // Depth is linear in raster space with orthographic projection.
+    // Perspective correct interpolation is only required with perspective projection.
+    bool perspective = (camera->type == ProjectionCamera::ePerspective);
+
     // Precompute reciprocal of vertex z-coordinate
-    v0Raster.z() = 1. / v0Raster.z();
-    v1Raster.z() = 1. / v1Raster.z();
-    v2Raster.z() = 1. / v2Raster.z();
+    if (perspective) {
+        v0Raster.z() = 1. / v0Raster.z();
+        v1Raster.z() = 1. / v1Raster.z();
+        v2Raster.z() = 1. / v2Raster.z();
+    }
 
     real_t area = edgeFunction(v0Raster, v1Raster, v2Raster, ccw);
 
+    // Id of the fragments recorded in the layers
+    uint32_t layerid = Shape::NOID;
+    if (is_valid_ptr(__layerBuffer)) {
+        IdBasedShader * idshader = dynamic_cast<IdBasedShader *>(shader.get());
+        layerid = (idshader ? idshader->shapeid : __layerBuffer->getDefaultId());
+    }
+
     std::queue<Fragment> fragqueue;
 
     // Inner loop
@@ -515,6 +632,107 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
         }
 
     }*/
+    else if (fabs(area) > 3 * GEOM_EPSILON) {
+        // Pixels are processed by blocks of consecutive pixels of a row given together to the shader.
+        // There is no SIMD kernel: each pixel of a block is evaluated as in the per-pixel loop below,
+        // with edgeFunction and a division by area, so both paths give the same fragments.
+
+        // The sum of the 3 edge functions is the area. Thus only one side of the edges can contain pixels.
+        bool positive = (area > 0);
+        const Vector3 * edges[3][2] = { { &v1Raster, &v2Raster }, { &v2Raster, &v0Raster }, { &v0Raster, &v1Raster } };
+
+        // Edge functions are affine in the pixel position : e(x, y) = ex * x + ey * y + ec.
+        // This form is only used to skip the pixels of a row that are far outside of the triangle.
+        real_t ex[3], ey[3], ec[3];
+        for (int e = 0; e < 3; ++e) {
+            const Vector3& a = *edges[e][0];
+            const Vector3& b = *edges[e][1];
+            ex[e] = b.y() - a.y();
+            ey[e] = a.x() - b.x();
+            ec[e] = - a.x() * ex[e] - a.y() * ey[e];
+        }
+
+        real_t w0[PGL_RASTER_BLOCK_SIZE], w1[PGL_RASTER_BLOCK_SIZE], w2[PGL_RASTER_BLOCK_SIZE];
+        real_t zs[PGL_RASTER_BLOCK_SIZE];
+        float sw0[PGL_RASTER_BLOCK_SIZE], sw1[PGL_RASTER_BLOCK_SIZE], sw2[PGL_RASTER_BLOCK_SIZE];
+
+        for (int32_t y = y0; y <= y1; ++y) {
+            real_t py = y + 0.5;
+            real_t row[3];
+            for (int e = 0; e < 3; ++e) row[e] = ey[e] * py + ec[e];
+
+            // Conservative span of the row in which the edge functions can be of the right sign.
+            // Its tolerance and its margin of one pixel cover the rounding differences with edgeFunction.
+            real_t cxmin = x0, cxmax = x1 + 1;
+            bool empty = false;
+            for (int e = 0; e < 3 && !empty; ++e) {
+                real_t slope = (positive ? 1 : -1) * ex[e];
+                real_t bound = -2 * GEOM_EPSILON - (positive ? 1 : -1) * row[e];
+                if (slope > 0) cxmin = std::max(cxmin, bound / slope);
+                else if (slope < 0) cxmax = std::min(cxmax, bound / slope);
+                else if (bound >= 0) empty = true;
+            }
+            if (empty || cxmin > cxmax + 2) continue;
+            cxmin = std::min<real_t>(cxmin, x1 + 2);
+            cxmax = std::max<real_t>(cxmax, x0 - 2);
+            int32_t xl = std::max<int32_t>(x0, int32_t(floor(cxmin - 0.5)) - 1);
+            int32_t xr = std::min<int32_t>(x1, int32_t(ceil(cxmax - 0.5)) + 1);
+
+            for (int32_t bx = xl; bx <= xr; bx += PGL_RASTER_BLOCK_SIZE) {
+                uint32_t count = std::min<int32_t>(PGL_RASTER_BLOCK_SIZE, xr - bx + 1);
+
+                uint32_t mask = 0;
+                for (uint32_t i = 0; i < count; ++i) {
+                    Vector2 pixelSample(bx + i + 0.5, py);
+
+                    // find weight of pixel
+                    w0[i] = edgeFunction(v1Raster, v2Raster, pixelSample, ccw);
+                    w1[i] = edgeFunction(v2Raster, v0Raster, pixelSample, ccw);
+                    w2[i] = edgeFunction(v0Raster, v1Raster, pixelSample, ccw);
+
+                    if (!((w0[i] > -GEOM_EPSILON && w1[i] > -GEOM_EPSILON && w2[i] > -GEOM_EPSILON) || 
+                          (w0[i] < GEOM_EPSILON && w1[i] < GEOM_EPSILON && w2[i] < GEOM_EPSILON))) continue;
+
+                    w0[i] /= area;
+                    w1[i] /= area;
+                    w2[i] /= area;
+
+                    real_t z = v0Raster.z() * w0[i] + v1Raster.z() * w1[i] + v2Raster.z() * w2[i];
+                    if (perspective) { 
+                        z = 1. / z;
+                        w0[i] *= z / z0;
+                        w1[i] *= z / z1;
+                        w2[i] *= z / z2;
+                    }
+
+                    // Depth-buffer test
+                    if (camera->isInZRange(z) && acceptFragment(bx + i, y, z)) {
+                        zs[i] = z;
+                        sw0[i] = w0[i]; sw1[i] = w1[i]; sw2[i] = w2[i];
+                        mask |= (1u << i);
+                    }
+                }
+                if (mask == 0) continue;
+
+                uint32_t locked = 0;
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!(mask & (1u << i))) continue;
+                    int32_t x = bx + i;
+                    if(tryLock(x,y)){
+                        locked |= (1u << i);
+                        if (!(acceptFragment(x, y, zs[i]) && storeFragment(x, y, zs[i], layerid))) mask &= ~(1u << i);
+                    }
+                    else {
+                        mask &= ~(1u << i);
+                        fragqueue.push(Fragment(x, y, zs[i], sw0[i], sw1[i], sw2[i]));
+                    }
+                }
+                if (mask != 0 && is_valid_ptr(shader)) shader->processBlock(bx, y, count, mask, zs, sw0, sw1, sw2);
+                for (uint32_t i = 0; i < count; ++i)
+                    if (locked & (1u << i)) unlock(bx + i, y);
+            }
+        }
+    }
     else {
         for (int32_t y = y0; y <= y1; ++y) {
             for (int32_t x = x0; x <= x1; ++x) {
@@ -533,24 +751,28 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
                     w1 /= area;
                     w2 /= area;
 
-                    real_t oneOverZ = v0Raster.z() * w0 + v1Raster.z() * w1 + v2Raster.z() * w2;
-                    real_t z = 1. / oneOverZ;
+                    real_t z = v0Raster.z() * w0 + v1Raster.z() * w1 + v2Raster.z() * w2;
+                    if (perspective) { 
+                        z = 1. / z;
+                        w0 *= z / z0;
+                        w1 *= z / z1;
+                        w2 *= z / z2;
+                    }
 
                     // Depth-buffer test
                     if (camera->isInZRange(z)){
 
                         // Vec2f st = st0 * w0 + st1 * w1 + st2 * w2;                        
                         // st *= z;
-                        if (isVisible(x, y, z)) {
+                        if (acceptFragment(x, y, z)) {
                             if(tryLock(x,y)){
-                                if (isVisible(x, y, z)) {
-                                    __depthBuffer->setAt(x, y, z);
-                                    if(is_valid_ptr(shader))shader->process(x, y, z, (w0 * z / z0), (w1 * z / z1), (w2 * z / z2));
+                                if (acceptFragment(x, y, z) && storeFragment(x, y, z, layerid)) {
+                                    if(is_valid_ptr(shader))shader->process(x, y, z, w0, w1, w2);
                                 }
                                 unlock(x,y);
                             }
                             else {
-                                fragqueue.push(Fragment(x,y,z,(w0 * z / z0), (w1 * z / z1), (w2 * z / z2)));
+                                fragqueue.push(Fragment(x,y,z,w0, w1, w2));
 
                             }
                         }                   
@@ -563,8 +785,7 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
         Fragment f = fragqueue.front();
         fragqueue.pop();
         if(tryLock(f.x,f.y)){
-            if (isVisible(f.x, f.y, f.z)) {
-                __depthBuffer->setAt(f.x, f.y, f.z);
+            if (acceptFragment(f.x, f.y, f.z) && storeFragment(f.x, f.y, f.z, layerid)) {
                 if(is_valid_ptr(shader))shader->process(f.x, f.y, f.z, f.w0, f.w1, f.w2);
             }
             unlock(f.x,f.y);
@@ -652,14 +873,15 @@ void ZBufferEngine::iprocess(PointSetPtr pointset, MaterialPtr material, uint32_
     }
 }
 
-ImagePtr ZBufferEngine::getTexture(const ImageTexturePtr imgdef)
+MipmappedTexturePtr ZBufferEngine::getTexture(const ImageTexturePtr imgdef)
 {
-    Cache<ImagePtr>::const_Iterator it = __cachetexture.find(imgdef->getObjectId());
+    std::lock_guard<std::mutex> guard(__cachetextureMutex);
+    Cache<MipmappedTexturePtr>::const_Iterator it = __cachetexture.find(imgdef->getObjectId());
     if (it != __cachetexture.end()){
         return it->second;
     }
     else {
-        ImagePtr img(new Image(imgdef->getFilename()));
+        MipmappedTexturePtr img = TextureCache::get().getTexture(imgdef->getFilename());
         __cachetexture.insert(imgdef->getObjectId(),img);
         return img;
     }
@@ -668,6 +890,7 @@ ImagePtr ZBufferEngine::getTexture(const ImageTexturePtr imgdef)
 
 void ZBufferEngine::process(ScenePtr scene)
 {
+    if (!__shadowMaps.empty()) computeShadowMaps(scene);
     beginProcess();
     size_t msize = scene->size();
     if(__multithreaded && msize > 100){
@@ -697,6 +920,199 @@ void ZBufferEngine::process(ScenePtr scene)
         processScene(scene->begin(), scene->end(), __camera);
     }
     endProcess();
+    if (!__shadowMaps.empty()) computeLighting();
+}
+
+uint32_t ZBufferEngine::addShadowLight(const Vector3& direction, uint16_t mapWidth, uint16_t mapHeight)
+{
+    if (__shadowMaps.size() >= PGL_MAX_SHADOW_LIGHTS) {
+        pglWarning("ZBufferEngine : Maximum number of shadow lights (%i) reached.", PGL_MAX_SHADOW_LIGHTS);
+        return UINT32_MAX;
+    }
+    __shadowMaps.push_back(ShadowMapPtr(new ShadowMap(direction, mapWidth, mapHeight)));
+    return __shadowMaps.size() - 1;
+}
+
+void ZBufferEngine::clearShadowLights()
+{
+    __shadowMaps.clear();
+    __lightingBuffer = Uint32Array2Ptr();
+    __shapeLighting.clear();
+}
+
+void ZBufferEngine::computeShadowMaps(ScenePtr scene)
+{
+    Discretizer d;
+    BBoxComputer bbc(d);
+    bbc.process(scene);
+    BoundingBoxPtr bbox = bbc.getBoundingBox();
+    // Each light renders with its own single threaded engine
+    pgl_parallel_for(0, __shadowMaps.size(), [this, &scene, &bbox](size_t lightid) {
+        __shadowMaps[lightid]->compute(scene, bbox);
+    });
+}
+
+void ZBufferEngine::computeLighting()
+{
+    __shapeLighting.clear();
+    uint32_t nblights = __shadowMaps.size();
+    if (nblights == 0) { __lightingBuffer = Uint32Array2Ptr(); return; }
+    __lightingBuffer = Uint32Array2Ptr(new Uint32Array2(uint_t(__imageWidth), uint_t(__imageHeight), 0));
+
+    IdBasedShader * idshader = dynamic_cast<IdBasedShader *>(__triangleshader.get());
+    bool darken = is_valid_ptr(__frameBuffer) && idshader == NULL && __shadowIntensity > 0;
+
+    pgl_parallel_for(0, __imageHeight, [this, nblights, darken](size_t y) {
+        for (uint32_t x = 0; x < __imageWidth; ++x) {
+            real_t z = __depthBuffer->getAt(x, y);
+            if (!__camera->isInZRange(z)) continue;
+            Vector3 position = __camera->rasterToWorld(Vector3(x + 0.5, y + 0.5, z), __imageWidth, __imageHeight);
+            uint32_t mask = 0;
+            uint32_t nblit = 0;
+            for (uint32_t lightid = 0; lightid < nblights; ++lightid) {
+                if (__shadowMaps[lightid]->isLit(position)) { mask |= (1u << lightid); ++nblit; }
+            }
+            __lightingBuffer->setAt(x, y, mask);
+            if (darken && nblit < nblights) {
+                real_t attenuation = 1 - __shadowIntensity * real_t(nblights - nblit) / nblights;
+                __frameBuffer->setPixelAt(x, y, __frameBuffer->getPixelAt(x, y) * pglMax(real_t(0), attenuation));
+            }
+        }
+    }, 0, 16);
+
+    if (idshader != NULL && is_valid_ptr(__frameBuffer)) {
+        Uint32Array2Ptr ids = getIdBuffer();
+        for (uint32_t y = 0; y < __imageHeight; ++y) {
+            for (uint32_t x = 0; x < __imageWidth; ++x) {
+                if (!__camera->isInZRange(__depthBuffer->getAt(x, y))) continue;
+                uint32_t id = (is_valid_ptr(ids) ? ids->getAt(x, y) : __frameBuffer->getPixel4At(x, y).toUint(idshader->conversionformat));
+                ShapeLightingMap::iterator it = __shapeLighting.find(id);
+                if (it == __shapeLighting.end()) it = __shapeLighting.insert(ShapeLightingMap::value_type(id, ShapeLighting(nblights))).first;
+                ++it->second.nbPixels;
+                uint32_t mask = __lightingBuffer->getAt(x, y);
+                for (uint32_t lightid = 0; lightid < nblights; ++lightid)
+                    if (mask & (1u << lightid)) ++it->second.nbLitPixels[lightid];
+            }
+        }
+    }
+}
+
+void IdStatistics::clear()
+{
+    ids.clear(); nbPixels.clear(); areas.clear(); meanDepths.clear(); flags.clear();
+    nbLayers = 1; layerPixels.clear(); layerAreas.clear();
+}
+
+size_t IdStatistics::find(uint32_t id) const
+{
+    std::vector<uint32_t>::const_iterator it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id) return ids.size();
+    return it - ids.begin();
+}
+
+/// Pixel statistics of a shape accumulated by a thread.
+struct IdAccumulator {
+    IdAccumulator(uint32_t nbLayers = 1) : nbPixels(0), area(0), depth(0), flags(0), layerPixels(nbLayers, 0), layerAreas(nbLayers, 0) {}
+    uint32_t nbPixels;
+    real_t area;
+    real_t depth;
+    uchar_t flags;
+    std::vector<uint32_t> layerPixels;
+    std::vector<real_t> layerAreas;
+};
+
+typedef pgl_hash_map<uint32_t, IdAccumulator> IdAccumulatorMap;
+
+void ZBufferEngine::computeIdStatistics()
+{
+    __idStatistics.clear();
+    IdFrameBufferManagerPtr idbuffer = dynamic_pointer_cast<IdFrameBufferManager>(__frameBuffer);
+    if (is_null_ptr(idbuffer)) return;
+
+    uint32_t defaultid = idbuffer->getDefaultId();
+    uint32_t nbLayers = getLayerCount();
+    bool perspective = (__camera->type == ProjectionCamera::ePerspective);
+    // Area of a pixel on the image plane (the near plane with perspective)
+    real_t pixelArea = fabs((__camera->right - __camera->left) * (__camera->top - __camera->bottom)) / (real_t(__imageWidth) * __imageHeight);
+    real_t nearz = __camera->near;
+
+    size_t nbchunks = pglMin<size_t>(__imageWidth, 4 * pgl_thread_count());
+    std::vector<IdAccumulatorMap> histograms(nbchunks);
+    pgl_parallel_for(0, nbchunks, [&](size_t chunk) {
+        IdAccumulatorMap& histogram = histograms[chunk];
+        IdAccumulatorMap::iterator current = histogram.end();
+        // Consecutive pixels mostly belong to the same shape
+        auto accumulator = [&](uint32_t id) -> IdAccumulator& {
+            if (current == histogram.end() || current->first != id)
+                current = histogram.insert(IdAccumulatorMap::value_type(id, IdAccumulator(nbLayers))).first;
+            return current->second;
+        };
+        uint32_t xbegin = chunk * __imageWidth / nbchunks;
+        uint32_t xend = (chunk + 1) * __imageWidth / nbchunks;
+        // Ids and depths are stored by column
+        for (uint32_t x = xbegin; x < xend; ++x) {
+            for (uint32_t y = 0; y < __imageHeight; ++y) {
+                uint32_t id = idbuffer->getIdAt(x, y);
+                if (id != defaultid) {
+                    real_t z = __depthBuffer->getAt(x, y);
+                    real_t area = (perspective ? pixelArea * (z / nearz) * (z / nearz) : pixelArea);
+                    IdAccumulator& acc = accumulator(id);
+                    ++acc.nbPixels;
+                    acc.depth += z;
+                    acc.area += area;
+                    acc.flags |= IdStatistics::eFirstHit;
+                    if (nbLayers == 1) {
+                        // With a single depth layer, the visible surface is also the last recorded hit.
+                        acc.flags |= IdStatistics::eLastHit;
+                        ++acc.layerPixels[0];
+                        acc.layerAreas[0] += area;
+                    }
+                }
+                if (nbLayers > 1) {
+                    const LayerBuffer::Layer * layers = __layerBuffer->getLayersAt(x, y);
+                    uint32_t nb = __layerBuffer->getNbLayersAt(x, y);
+                    for (uint32_t layer = 0; layer < nb; ++layer) {
+                        if (layers[layer].id == defaultid) continue;
+                        real_t z = layers[layer].depth;
+                        IdAccumulator& acc = accumulator(layers[layer].id);
+                        ++acc.layerPixels[layer];
+                        acc.layerAreas[layer] += (perspective ? pixelArea * (z / nearz) * (z / nearz) : pixelArea);
+                        if (layer == nb - 1) acc.flags |= IdStatistics::eLastHit;
+                    }
+                }
+            }
+        }
+    }, (__multithreaded ? 0 : 1));
+
+    IdAccumulatorMap& total = histograms[0];
+    for (size_t chunk = 1; chunk < nbchunks; ++chunk) {
+        for (IdAccumulatorMap::const_iterator it = histograms[chunk].begin(); it != histograms[chunk].end(); ++it) {
+            IdAccumulatorMap::iterator itacc = total.find(it->first);
+            if (itacc == total.end()) { total.insert(*it); continue; }
+            IdAccumulator& acc = itacc->second;
+            acc.nbPixels += it->second.nbPixels;
+            acc.area += it->second.area;
+            acc.depth += it->second.depth;
+            acc.flags |= it->second.flags;
+            for (uint32_t layer = 0; layer < nbLayers; ++layer) {
+                acc.layerPixels[layer] += it->second.layerPixels[layer];
+                acc.layerAreas[layer] += it->second.layerAreas[layer];
+            }
+        }
+    }
+
+    __idStatistics.nbLayers = nbLayers;
+    for (IdAccumulatorMap::const_iterator it = total.begin(); it != total.end(); ++it) __idStatistics.ids.push_back(it->first);
+    std::sort(__idStatistics.ids.begin(), __idStatistics.ids.end());
+    for (std::vector<uint32_t>::const_iterator it = __idStatistics.ids.begin(); it != __idStatistics.ids.end(); ++it) {
+        const IdAccumulator& acc = total[*it];
+        __idStatistics.nbPixels.push_back(acc.nbPixels);
+        __idStatistics.areas.push_back(acc.area);
+        __idStatistics.meanDepths.push_back(acc.nbPixels > 0 ? acc.depth / acc.nbPixels : 0);
+        __idStatistics.flags.push_back(acc.flags);
+        __idStatistics.layerPixels.insert(__idStatistics.layerPixels.end(), acc.layerPixels.begin(), acc.layerPixels.end());
+        __idStatistics.layerAreas.insert(__idStatistics.layerAreas.end(), acc.layerAreas.begin(), acc.layerAreas.end());
+    }
 }
 
 void ZBufferEngine::processScene(Scene::const_iterator scene_begin, Scene::const_iterator scene_end, ProjectionCameraPtr camera, uint32_t threadid)
@@ -748,7 +1164,7 @@ void ZBufferEngine::duplicateBuffer(int32_t xDiff, int32_t yDiff, real_t zDiff,
         yEnd += yDiff;
     }
 
-    RealArray2Ptr depthBuffer(new RealArray2(*__depthBuffer));
+    DepthBufferPtr depthBuffer(__depthBuffer->deepcopy());
     FrameBufferManagerPtr framebuffer = (is_valid_ptr(__frameBuffer) ? __frameBuffer->deepcopy() : NULL);
 
     for (uint32_t i = xStart ; i < xEnd ; ++i) {
@@ -761,6 +1177,49 @@ void ZBufferEngine::duplicateBuffer(int32_t xDiff, int32_t yDiff, real_t zDiff,
 
 }
 
+void ZBufferEngine::setPeriodicDomain(const Vector2& lowerCorner, const Vector2& upperCorner)
+{
+    __period = upperCorner - lowerCorner;
+    if (__period.x() < 0) __period.x() = 0;
+    if (__period.y() < 0) __period.y() = 0;
+}
+
+void ZBufferEngine::computePeriodicShifts()
+{
+    __periodicWrapping = false;
+    __periodicShifts[0] = Vector3::ORIGIN;
+    __periodicShifts[1] = Vector3::ORIGIN;
+    if (!isPeriodic() || is_null_ptr(__camera)) return;
+
+    if (__camera->type == ProjectionCamera::ePerspective) {
+        pglWarning("ZBufferEngine : Periodic domain is only supported with an orthographic camera.");
+        return;
+    }
+
+    // With an orthographic camera, translating a triangle by a period translates its raster coordinates by a constant vector.
+    Vector3 origin = worldToRaster(Vector3::ORIGIN);
+    for (int k = 0; k < 2; ++k) {
+        if (__period[k] <= 0) continue;
+        Vector3 shift = worldToRaster(k == 0 ? Vector3(__period.x(), 0, 0) : Vector3(0, __period.y(), 0)) - origin;
+        if (norm(Vector2(shift.x(), shift.y())) < 1) {
+            pglWarning("ZBufferEngine : Period along %s is smaller than a pixel in the image. It is ignored.", (k == 0 ? "x" : "y"));
+            continue;
+        }
+        __periodicShifts[k] = shift;
+    }
+
+    // Both periods are seen aligned in the image (side view of the domain): the copies along y overlap those along x.
+    const Vector3& shift0 = __periodicShifts[0];
+    const Vector3& shift1 = __periodicShifts[1];
+    real_t det = shift0.x() * shift1.y() - shift0.y() * shift1.x();
+    if (shift0 != Vector3::ORIGIN && shift1 != Vector3::ORIGIN && fabs(det) < 1) {
+        pglWarning("ZBufferEngine : Periods along x and y are aligned in the image. Periodicity along y is ignored.");
+        __periodicShifts[1] = Vector3::ORIGIN;
+    }
+
+    __periodicWrapping = (__periodicShifts[0] != Vector3::ORIGIN || __periodicShifts[1] != Vector3::ORIGIN);
+}
+
 void ZBufferEngine::periodizeBuffer(const Vector3& from, const Vector3& to, bool useDefaultColor, const Color3& defaultcolor)
 {
     Vector3 vRasterFrom = __camera->worldToRaster(from,__imageWidth, __imageHeight);
@@ -852,8 +1311,11 @@ void ThreadManager::new_task(std::function<void()> task){
     //boost::asio::post(*__pool, task);    
 }
 
+bool ThreadManager::is_worker_thread() { return pgl_is_worker_thread(); }
+
 void ThreadManager::process_task(std::function<void()> task)
 {
+    pgl_set_worker_thread(true);
     task();
     __threadend_mutex.lock();
     --__nb_tasks;
@@ -870,6 +1332,37 @@ void ThreadManager::join()
 }
 
 
+void ThreadManager::run_tasks(size_t nbtasks, std::function<void(size_t)> task)
+{
+    if (nbtasks <= 1 || pgl_is_worker_thread()) {
+        for (size_t i = 0; i < nbtasks; ++i) task(i);
+        return;
+    }
+    std::mutex donemutex;
+    std::condition_variable done;
+    size_t remaining = nbtasks - 1;
+    std::exception_ptr error;
+    for (size_t i = 1; i < nbtasks; ++i) {
+        boost::asio::post(*getPool(), [&, i]() {
+            pgl_set_worker_thread(true);
+            std::exception_ptr taskerror;
+            try { task(i); }
+            catch (...) { taskerror = std::current_exception(); }
+            std::lock_guard<std::mutex> guard(donemutex);
+            if (taskerror && !error) error = taskerror;
+            if (--remaining == 0) done.notify_one();
+        });
+    }
+    // The calling thread runs the first task
+    std::exception_ptr firsterror;
+    try { task(0); }
+    catch (...) { firsterror = std::current_exception(); }
+    std::unique_lock<std::mutex> lock(donemutex);
+    done.wait(lock, [&remaining]() { return remaining == 0; });
+    if (firsterror) std::rethrow_exception(firsterror);
+    if (error) std::rethrow_exception(error);
+}
+
 bool ThreadManager::hasCompletedTasks() const { 
     // printf("rendering nb task : %u\n", uint32_t(__nb_tasks));
     return __nb_tasks == 0; 
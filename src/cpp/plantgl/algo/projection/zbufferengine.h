@@ -59,7 +59,10 @@
 #include "shading.h"
 #include "projectionengine.h"
 #include "framebuffermanager.h"
+#include "depthbuffer.h"
+#include "layerbuffer.h"
 #include "imagemutex.h"
+#include "shadowmap.h"
 #include <condition_variable>
 // #include <boost/fiber/mutex.hpp>
 #include <atomic>
@@ -82,6 +85,13 @@ public:
     void join();
     size_t nb_threads() { return __nb_threads; }
 
+    /** Run \e task(i) for i in [0, nbtasks[ on the pool and wait for these tasks only, not for the other tasks of the pool.
+        From a thread of the pool, the tasks are run serially in the calling thread. The first exception raised is given back. */
+    void run_tasks(size_t nbtasks, std::function<void(size_t)> task);
+
+    /// Whether the current thread is a thread of the pool or of a parallel loop (see pgl_is_worker_thread).
+    static bool is_worker_thread();
+
     // Singleton access
     static ThreadManager& get();
 protected:
@@ -110,6 +120,45 @@ protected:
 
 
 
+/* ----------------------------------------------------------------------- */
+
+/** 
+    \struct IdStatistics
+    \brief Pixel statistics of the shapes of an id rendering, as arrays sorted by shape id.
+    With a multi layer rendering, shapes recorded only in the hidden layers have no visible pixel.
+*/
+struct ALGO_API IdStatistics {
+    IdStatistics() : nbLayers(1) {}
+
+    enum eHitFlag {
+        /// The shape is the first surface hit by the ray of at least one pixel.
+        eFirstHit = 1,
+        /// The shape is the last surface recorded for at least one pixel.
+        eLastHit = 2
+    };
+
+    std::vector<uint32_t> ids;
+    /// Number of pixels of each shape.
+    std::vector<uint32_t> nbPixels;
+    /// Area of the pixels of each shape in world units, on planes orthogonal to the view direction.
+    std::vector<real_t> areas;
+    /// Mean depth of the pixels of each shape.
+    std::vector<real_t> meanDepths;
+    /// Combination of eHitFlag for each shape.
+    std::vector<uchar_t> flags;
+    /// Number of depth layers of the rendering.
+    uint32_t nbLayers;
+    /// Number of pixels of each shape in each layer, indexed by id index * nbLayers + layer.
+    std::vector<uint32_t> layerPixels;
+    /// Area of the pixels of each shape in each layer, indexed as layerPixels.
+    std::vector<real_t> layerAreas;
+
+    size_t size() const { return ids.size(); }
+    void clear();
+    /// Return the index of \e id in the arrays, or size() if it is absent.
+    size_t find(uint32_t id) const;
+};
+
 /* ----------------------------------------------------------------------- */
 
 /** 
@@ -191,8 +240,31 @@ public :
    void setFrameBufferAt(uint32_t x, uint32_t y, const Color4& rasterColor);
    Color3 getFrameBufferAt(uint32_t x, uint32_t y);
 
+   /** Set the pixels of the span [x, x+count[ of the row y selected by \e mask to \e rasterColors.
+       Opaque colors are written with a single call to the frame buffer. */
+   void setFrameBufferSpan(uint32_t x, uint32_t y, uint32_t count, uint32_t mask, const Color4 * rasterColors);
+
+   /// The rendered image. With id rendering, the ids are converted in colors.
    ImagePtr getImage() const;
-   RealArray2Ptr getDepthBuffer() const { return __depthBuffer; }
+   /// The ids of the shapes of each pixel with id rendering, indexed by (x, y). Null otherwise.
+   Uint32Array2Ptr getIdBuffer() const;
+
+   /// The depths of each pixel. Converted from the stored precision if it is not eRealDepth.
+   RealArray2Ptr getDepthBuffer() const { return __depthBuffer->getRealDepths(); }
+   const DepthBufferPtr& getDepthStorage() const { return __depthBuffer; }
+
+   /** Set the precision of the depth buffer. Float and 24 bits fixed point depths use 4 and 3 bytes per pixel.
+       Fixed point depths cover linearly the z range of the camera. The depth buffer is cleared. */
+   void setDepthPrecision(DepthBuffer::ePrecision precision);
+   DepthBuffer::ePrecision getDepthPrecision() const { return __depthBuffer->getPrecision(); }
+
+   /** Record the nearest \e nbLayers fragments of each pixel of the triangles, with their shape id if id rendering is used.
+       The layers are filled in the same pass as the depth buffer, whose pixels keep the nearest fragment.
+       A count of 1 disables the layers. The layers are cleared. */
+   void setLayerCount(uint32_t nbLayers);
+   uint32_t getLayerCount() const { return is_valid_ptr(__layerBuffer) ? __layerBuffer->getNbLayers() : 1; }
+   /// The layers of the pixels. Null if a single layer is rendered.
+   const LayerBufferPtr& getLayerBuffer() const { return __layerBuffer; }
 
    inline bool isTotallyTransparent(const Color4& c) const { return isTotallyTransparent(c.getAlpha()); }
    bool isTotallyTransparent(const real_t alpha) const ;
@@ -204,7 +276,8 @@ public :
 
   void render(ScenePtr scene);
 
-  ImagePtr getTexture(const ImageTexturePtr imgdef);
+  /// Return the texture of \e imgdef from the shared TextureCache.
+  MipmappedTexturePtr getTexture(const ImageTexturePtr imgdef);
 
   void renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw = true, const TriangleShaderPtr& shader = TriangleShaderPtr(), const ProjectionCameraPtr& camera = ProjectionCameraPtr());
   void renderShadedTriangleMT(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw = true, const TriangleShaderPtr& shader = TriangleShaderPtr(), const ProjectionCameraPtr& camera = ProjectionCameraPtr());
@@ -219,6 +292,15 @@ public :
   void periodizeBuffer(const Vector3& from, const Vector3& to, bool useDefaultColor = true, const Color3& defaultcolor = Color3(0,0,0));
   void periodizeBuffer(int32_t xDiff, int32_t yDiff, real_t zDiff, bool useDefaultColor = true, const Color3& defaultcolor = Color3(0,0,0));
 
+  /** Declare the scene periodic along x and y, with the domain [lowerCorner, upperCorner] as period.
+      A null extent along an axis disables the periodicity along it. When rendering a scene,
+      each triangle is also rendered translated by all the periods that bring it into the image,
+      so that an infinite canopy is obtained in a single pass. It requires an orthographic camera. */
+  void setPeriodicDomain(const Vector2& lowerCorner, const Vector2& upperCorner);
+  void clearPeriodicDomain() { __period = Vector2(0,0); }
+  bool isPeriodic() const { return __period.x() > 0 || __period.y() > 0; }
+  const Vector2& getPeriod() const { return __period; }
+
   void setFrameBuffer(FrameBufferManagerPtr fb) { __frameBuffer = fb; }
   FrameBufferManagerPtr getFrameBuffer() const { return __frameBuffer; }
 
@@ -227,10 +309,50 @@ public :
 
   virtual void process(ScenePtr scene);
 
+  /** Add a directional light casting shadows. \e direction is the direction of propagation of the light.
+      Its shadow map is rendered at the beginning of process(ScenePtr). Return the index of the light. */
+  uint32_t addShadowLight(const Vector3& direction, uint16_t mapWidth = 1024, uint16_t mapHeight = 1024);
+  void clearShadowLights();
+  uint32_t getShadowLightCount() const { return __shadowMaps.size(); }
+  ShadowMapPtr getShadowMap(uint32_t lightid) const { return __shadowMaps[lightid]; }
+
+  /// Render the shadow maps of all shadow lights for \e scene, in parallel over lights.
+  void computeShadowMaps(ScenePtr scene);
+
+  /** Sample the shadow maps for each pixel of the depth buffer. Fill the lighting buffer,
+      the lighting statistics of shapes if id rendering is used, or darken the frame buffer otherwise. */
+  void computeLighting();
+
+  /// Bitmask of the shadow lights reaching each pixel.
+  Uint32Array2Ptr getLightingBuffer() const { return __lightingBuffer; }
+  /// Number of visible and lit pixels of each shape id. Only filled with id rendering.
+  const ShapeLightingMap& getShapeLighting() const { return __shapeLighting; }
+
+  /** Enable the computation of the pixel statistics of each shape id at the end of the rendering.
+      Only available with id rendering. */
+  void setIdStatisticsEnabled(bool enabled) { __idStatisticsEnabled = enabled; }
+  bool isIdStatisticsEnabled() const { return __idStatisticsEnabled; }
+
+  /** Compute the pixel statistics of each shape id from the id and depth buffers, and from the layers if any.
+      Image columns are processed in parallel with their own histograms, merged at the end. */
+  void computeIdStatistics();
+  const IdStatistics& getIdStatistics() const { return __idStatistics; }
+
+  /// Attenuation of the color of a pixel shadowed from all lights.
+  real_t getShadowIntensity() const { return __shadowIntensity; }
+  void setShadowIntensity(real_t value) { __shadowIntensity = value; }
+
 protected :
 
   void _bufferPeriodizationStep(int32_t xDiff, int32_t yDiff, real_t zDiff, bool useDefaultColor = true, const Color3& defaultcolor = Color3(0,0,0));
 
+  /// Compute the translations in raster space of the periods of the domain for the current camera.
+  void computePeriodicShifts();
+
+  /// Clip the triangle given in raster space to the image and rasterize it.
+  void renderRasterTriangle(const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const TOOLS(Vector3)& v2Raster, bool ccw,
+                            const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera);
+
   void rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
                  TOOLS(Vector3) v0Raster, TOOLS(Vector3) v1Raster, TOOLS(Vector3) v2Raster, bool ccw, 
                  const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera);
@@ -245,18 +367,37 @@ protected :
   void unlock(uint_t x, uint_t y);
   bool tryLock(uint_t x, uint_t y);
 
+  /// Whether a fragment at depth \e z of the pixel (x, y) is kept, in the depth buffer or in the layers.
+  inline bool acceptFragment(int32_t x, int32_t y, real_t z) const {
+      if (is_valid_ptr(__layerBuffer)) return __layerBuffer->accepts(x, y, z);
+      return __depthBuffer->isCloser(x, y, z);
+  }
+
+  /// Record an accepted fragment of the shape \e id. Return whether it is the nearest fragment of the pixel and has to be shaded.
+  inline bool storeFragment(int32_t x, int32_t y, real_t z, uint32_t id) {
+      if (is_valid_ptr(__layerBuffer)) {
+          __layerBuffer->insert(x, y, z, id);
+          if (!__depthBuffer->isCloser(x, y, z)) return false;
+      }
+      __depthBuffer->setAt(x, y, z);
+      return true;
+  }
+
   bool __lightEnabled;
   Vector3 __lightPosition;
   Color3 __lightAmbient;
   Color3 __lightDiffuse;
   Color3 __lightSpecular;
 
-  RealArray2Ptr __depthBuffer;
+  DepthBufferPtr __depthBuffer;
+  LayerBufferPtr __layerBuffer;
   FrameBufferManagerPtr __frameBuffer;
 
   real_t __alphathreshold;
 
-  Cache<ImagePtr> __cachetexture;
+  /// Textures of the engine, identified by the id of their ImageTexture, to avoid checking the shared cache for each triangle.
+  Cache<MipmappedTexturePtr> __cachetexture;
+  std::mutex __cachetextureMutex;
 
   TriangleShaderPtr __triangleshader;
   TriangleShaderPtr * __triangleshaderset;
@@ -264,6 +405,20 @@ protected :
   bool __multithreaded;
   ImageMutexPtr __imageMutex;
 
+  std::vector<ShadowMapPtr> __shadowMaps;
+  real_t __shadowIntensity;
+  Uint32Array2Ptr __lightingBuffer;
+  ShapeLightingMap __shapeLighting;
+
+  bool __idStatisticsEnabled;
+  IdStatistics __idStatistics;
+
+  Vector2 __period;
+  /// Translations in raster space of the periods along x and y. Null for non periodic axes.
+  Vector3 __periodicShifts[2];
+  /// Whether the triangles are wrapped with the periodic shifts in the current rendering.
+  bool __periodicWrapping;
+
 
   static ImageMutexPtr getImageMutex(uint16_t imageWidth, uint16_t imageHeight);
 
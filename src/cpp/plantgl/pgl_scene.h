@@ -51,6 +51,7 @@
 #include "plantgl/scenegraph/scene/scene.h"
 #include "plantgl/scenegraph/scene/shape.h"
 #include "plantgl/scenegraph/scene/inline.h"
+#include "plantgl/scenegraph/scene/flatscene.h"
 
 // __scene_h__
 #endif
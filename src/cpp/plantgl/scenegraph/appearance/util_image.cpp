@@ -148,6 +148,11 @@ const uchar_t * Image::getPixelDataAt(uint_t x, uint_t y) const {
     return &(*itCol);
 }
 
+uchar_t * Image::getPixelDataAt(uint_t x, uint_t y) {
+    GEOM_ASSERT(x < __width && y < __height);
+    return &__data[__nbchannels*(y * __width + x)];
+}
+
 void Image::fill(const Color4 & color)
 {
     uint8_t i = 0;
@@ -86,6 +86,7 @@ public:
 
     Color4 getPixelAt(uint_t x, uint_t y) const;
     const uchar_t * getPixelDataAt(uint_t x, uint_t y) const;
+    uchar_t * getPixelDataAt(uint_t x, uint_t y);
 
     Color4 getPixelAtUV(real_t u, real_t v, bool repeatu = true, bool repeatv = true) const;
 
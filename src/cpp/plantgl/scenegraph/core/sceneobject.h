@@ -52,6 +52,7 @@
 
 #include <plantgl/scenegraph/core/action.h>
 #include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_objectpool.h>
 #include <plantgl/tool/util_hashmap.h>
 #include "deepcopier.h"
 #include "pgl_messages.h"
@@ -82,7 +83,7 @@ class DeepCopier;
 
 /* ----------------------------------------------------------------------- */
 
-class SG_API SceneObject : public virtual RefCountObject
+class SG_API SceneObject : public virtual RefCountObject, public PoolAllocated
 {
 
 public:
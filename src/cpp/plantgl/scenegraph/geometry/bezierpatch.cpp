@@ -315,6 +315,137 @@ Vector3 BezierPatch::getPointAt(real_t u, real_t v) const{
     }
 }
 
+/* ----------------------------------------------------------------------- */
+
+/*
+  Fill B with the n+1 nth-degree Bernstein polynomials for a fixed u and,
+  if dB is not null, with their derivatives. (see the Nurbs Book p21-22)
+*/
+static void bernsteinBasis( uint_t n, real_t u, real_t * B, real_t * dB ) {
+  B[0]=1.0;
+  real_t u1=1.0-u;
+  real_t saved, temp;
+  for(uint_t j=1; j<=n; j++){
+      if (dB && j == n) {
+          // derivatives from the degree n-1 polynomials
+          dB[0] = -B[0] * n;
+          for(uint_t k=1; k<n; k++) dB[k] = (B[k-1] - B[k]) * n;
+          dB[n] = B[n-1] * n;
+      }
+      saved =0.0;
+      for(uint_t k=0; k<j; k++){
+          temp = B[k];
+          B[k] = saved+u1*temp;
+          saved = u*temp;
+      }
+      B[j] = saved;
+  }
+  if (dB && n == 0) dB[0] = 0;
+}
+
+Point3ArrayPtr BezierPatch::evaluateGrid(const RealArrayPtr& uvalues, const RealArrayPtr& vvalues,
+                                         Point3ArrayPtr * normals,
+                                         Point3ArrayPtr * utangents,
+                                         Point3ArrayPtr * vtangents) const
+{
+    bool derivatives = normals || utangents || vtangents;
+    BasisMatrix basis[2];
+    const RealArrayPtr * values[2] = { &uvalues, &vvalues };
+    for (uint_t d = 0; d < 2; ++d){
+        BasisMatrix& b = basis[d];
+        b.degree = (d == 0 ? getUDegree() : getVDegree());
+        uint_t nbvalues = (*values[d])->size();
+        uint_t stride = b.degree + 1;
+        b.first.assign(nbvalues,0);
+        b.values.resize(nbvalues * stride);
+        if (derivatives) b.derivatives.resize(nbvalues * stride);
+        for (uint_t i = 0; i < nbvalues; ++i){
+            real_t t = (*values[d])->getAt(i);
+            GEOM_ASSERT( t >= 0.0 && t <= 1.0 );
+            bernsteinBasis(b.degree, t, &b.values[i*stride], derivatives ? &b.derivatives[i*stride] : NULL);
+        }
+    }
+    // control points are stored with v along the rows and u along the columns
+    return evaluateGrid(*__ctrlPointMatrix, basis[0], basis[1], false, normals, utangents, vtangents);
+}
+
+Point3ArrayPtr BezierPatch::evaluateGrid(const Point4Matrix& ctrl,
+                                         const BasisMatrix& ubasis, const BasisMatrix& vbasis, bool urows,
+                                         Point3ArrayPtr * normals,
+                                         Point3ArrayPtr * utangents,
+                                         Point3ArrayPtr * vtangents)
+{
+    uint_t nu = ubasis.first.size();
+    uint_t nv = vbasis.first.size();
+    uint_t ustride = ubasis.degree + 1;
+    uint_t vstride = vbasis.degree + 1;
+    uint_t nbvctrl = (urows ? ctrl.getRowSize() : ctrl.getColumnSize());
+    bool derivatives = normals || utangents || vtangents;
+    GEOM_ASSERT(!derivatives || (ubasis.derivatives.size() == ubasis.values.size() && vbasis.derivatives.size() == vbasis.values.size()));
+
+    Point3ArrayPtr points(new Point3Array(nu*nv));
+    if (normals) *normals = Point3ArrayPtr(new Point3Array(nu*nv));
+    if (utangents) *utangents = Point3ArrayPtr(new Point3Array(nu*nv));
+    if (vtangents) *vtangents = Point3ArrayPtr(new Point3Array(nu*nv));
+
+    // curve of control points for the current u value and its derivative along u
+    vector<Vector4> upoints(nbvctrl);
+    vector<Vector4> uderivatives(derivatives ? nbvctrl : 0);
+
+    Point3Array::iterator itPoint = points->begin();
+    for (uint_t i = 0; i < nu; ++i){
+        uint_t ufirst = ubasis.first[i];
+        const real_t * Nu = &ubasis.values[i*ustride];
+        const real_t * dNu = (derivatives ? &ubasis.derivatives[i*ustride] : NULL);
+        for (uint_t l = 0; l < nbvctrl; ++l){
+            Vector4 temp(0,0,0,0);
+            Vector4 dtemp(0,0,0,0);
+            for (uint_t k = 0; k < ustride; ++k){
+                const Vector4& c = (urows ? ctrl.getAt(ufirst+k,l) : ctrl.getAt(l,ufirst+k));
+                temp += c * Nu[k];
+                if (derivatives) dtemp += c * dNu[k];
+            }
+            upoints[l] = temp;
+            if (derivatives) uderivatives[l] = dtemp;
+        }
+
+        for (uint_t j = 0; j < nv; ++j, ++itPoint){
+            uint_t vfirst = vbasis.first[j];
+            const real_t * Nv = &vbasis.values[j*vstride];
+            Vector4 Sw(0,0,0,0);
+            for (uint_t l = 0; l < vstride; ++l)
+                Sw += upoints[vfirst+l] * Nv[l];
+            bool rational = fabs(Sw.w()) >= GEOM_TOLERANCE;
+            Vector3 pt = (rational ? Sw.project() : Vector3(Sw.x(),Sw.y(),Sw.z()));
+            *itPoint = pt;
+
+            if (derivatives){
+                const real_t * dNv = &vbasis.derivatives[j*vstride];
+                Vector4 Su(0,0,0,0), Sv(0,0,0,0);
+                for (uint_t l = 0; l < vstride; ++l){
+                    Su += uderivatives[vfirst+l] * Nv[l];
+                    Sv += upoints[vfirst+l] * dNv[l];
+                }
+                Vector3 tu(Su.x(),Su.y(),Su.z());
+                Vector3 tv(Sv.x(),Sv.y(),Sv.z());
+                if (rational){
+                    tu = (tu - pt * Su.w()) / Sw.w();
+                    tv = (tv - pt * Sv.w()) / Sw.w();
+                }
+                uint_t index = i*nv+j;
+                if (utangents) (*utangents)->setAt(index,tu);
+                if (vtangents) (*vtangents)->setAt(index,tv);
+                if (normals){
+                    tu.normalize(); tv.normalize();
+                    (*normals)->setAt(index,cross(tu,tv));
+                }
+            }
+        }
+    }
+    return points;
+}
+
+/* ----------------------------------------------------------------------- */
 
 LineicModelPtr BezierPatch::getIsoUSectionAt(real_t u) const
 {
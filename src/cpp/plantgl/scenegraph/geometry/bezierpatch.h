@@ -51,6 +51,7 @@
 
 #include "patch.h"
 #include <plantgl/math/util_vector.h>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -64,6 +65,10 @@ class Point3Matrix;
 typedef RCPtr<Point3Matrix> Point3MatrixPtr;
 class LineicModel;
 typedef RCPtr<LineicModel> LineicModelPtr;
+class Point3Array;
+typedef RCPtr<Point3Array> Point3ArrayPtr;
+class RealArray;
+typedef RCPtr<RealArray> RealArrayPtr;
 
 /* ----------------------------------------------------------------------- */
 
@@ -176,6 +181,18 @@ public:
       - \e v must be in [0,1];*/
   virtual Vector3 getPointAt(real_t u,real_t v) const;
 
+  /*! Returns the points of the patch on the grid \e uvalues x \e vvalues.
+      Point (i,j) is at index i * vvalues->size() + j.
+      If given, \e normals, \e utangents and \e vtangents are filled in the same order.
+      Basis functions are computed once per u and v value and the points are
+      obtained by products of the basis matrices with the control points.
+     \pre
+      - \e uvalues and \e vvalues must be in [0,1];*/
+  virtual Point3ArrayPtr evaluateGrid(const RealArrayPtr& uvalues, const RealArrayPtr& vvalues,
+                                      Point3ArrayPtr * normals = NULL,
+                                      Point3ArrayPtr * utangents = NULL,
+                                      Point3ArrayPtr * vtangents = NULL) const;
+
   /* Returns the \e Point for u = \e u.
       using classical algorithm (see the Nurbs book p.22)
      \pre
@@ -202,6 +219,27 @@ public:
 
 protected:
 
+  /// Basis functions (and their first derivatives) evaluated on a set of parameter values.
+  struct BasisMatrix {
+      /// Degree of the basis functions
+      uint_t degree;
+      /// Index of the first control point affected by each parameter value
+      std::vector<uint_t> first;
+      /// degree+1 basis function values per parameter value
+      std::vector<real_t> values;
+      /// degree+1 basis function derivatives per parameter value (empty if not needed)
+      std::vector<real_t> derivatives;
+  };
+
+  /*! Returns the grid of points defined by the products of the basis matrices \e ubasis and \e vbasis
+      with the control points \e ctrl. Control point (k,l) along u and v is read at (k,l) in \e ctrl
+      if \e urows is true and at (l,k) otherwise. Derivatives of the basis must be present if normals or tangents are requested. */
+  static Point3ArrayPtr evaluateGrid(const Point4Matrix& ctrl,
+                                     const BasisMatrix& ubasis, const BasisMatrix& vbasis, bool urows,
+                                     Point3ArrayPtr * normals,
+                                     Point3ArrayPtr * utangents,
+                                     Point3ArrayPtr * vtangents);
+
   /// The \b CtrlPointMatrix field.
   Point4MatrixPtr __ctrlPointMatrix;
 
@@ -48,6 +48,7 @@
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/colorarray.h>
 #include <plantgl/tool/util_string.h>
+#include <plantgl/tool/util_parallel.h>
 
 PGL_USING_NAMESPACE
 
@@ -110,13 +111,9 @@ bool
 Mesh::Builder::MeshValid( ) const{
   if(!EMValid())return false;
 
+  // The number of normals depends on the normal indices and is checked by the builders of the meshes.
   if(NormalList){
     uint_t _normalListSize = (*NormalList)->size();
-    if(NormalPerVertex && *NormalPerVertex &&_normalListSize != (*PointList)->size()){
-    pglErrorEx(PGLWARNINGMSG(INVALID_FIELD_VALUE_sss),"Mesh","Normals","Number of normals must be compatible to PointList.");
-    return false;
-    }
-
     for (uint_t _i = 0; _i < _normalListSize; _i++){
       if (!(*NormalList)->getAt(_i).isValid()) {
     pglErrorEx
@@ -315,12 +312,14 @@ Mesh::isNormalListToDefault() const {
 }
 
 void
-Mesh::computeNormalList(bool pervertex){
-    __normalPerVertex = pervertex;
+Mesh::computeNormalList(bool pervertex, NormalWeighting weighting){
+  __normalPerVertex = pervertex;
+  // the current list is reused if nobody else refers to it
+  if (!__normalList || !__normalList->unique()) __normalList = Point3ArrayPtr(new Point3Array());
   if(pervertex)
-    __normalList = computeNormalPerVertex();
+    computeNormalPerVertex(*__normalList, weighting);
   else
-    __normalList = computeNormalPerFace();
+    computeNormalPerFace(*__normalList);
 }
 
 bool
@@ -340,51 +339,138 @@ Mesh::getFaceCenter( uint_t i ) const
 }
 
 
+/// Below this number of faces, normals are computed sequentially.
+static const size_t NORMAL_GRAIN = 4096;
+
+/// Non normalized normal of the face \e j, computed on its first 3 points.
+inline Vector3 faceCross(const Mesh& mesh, uint_t j) {
+  const Vector3& _p0 = mesh.getFacePointAt(j,0);
+  return cross(mesh.getFacePointAt(j,mesh.getCCW() ? 1 : 2) - _p0,
+               mesh.getFacePointAt(j,mesh.getCCW() ? 2 : 1) - _p0);
+}
+
+/// Angle of the face \e j at its corner \e i.
+inline real_t cornerAngle(const Mesh& mesh, uint_t j, uint_t i) {
+  uint_t _nb = mesh.getFaceSize(j);
+  const Vector3& _p = mesh.getFacePointAt(j,i);
+  return angle(mesh.getFacePointAt(j,(i + 1) % _nb) - _p, mesh.getFacePointAt(j,(i + _nb - 1) % _nb) - _p);
+}
+
+inline void normalizeNormal(Vector3& normal) {
+  normal.normalize();
+  if (fabs(norm(normal) - 1.0) > GEOM_EPSILON) normal = Mesh::DEFAULT_NORMAL_VALUE;
+}
+
 Point3ArrayPtr
-Mesh::computeNormalPerVertex() const {
-    std::vector<bool> hasNormal(__pointList->size(),false);
-    Point3ArrayPtr normalList(new Point3Array(__pointList->size()));
-    uint_t i = 0;
-    uint_t j = 0;
-    for(j=0; j < getIndexListSize(); j++){
-        Vector3 _norm = cross(getFacePointAt(j,__ccw ? 1 : 2) - getFacePointAt(j,0),
-                              getFacePointAt(j,__ccw ? 2 : 1) - getFacePointAt(j,0));
-        for(i = 0; i < getFaceSize(j); i++){
+Mesh::computeNormalPerVertex(NormalWeighting weighting) const {
+    Point3ArrayPtr normalList(new Point3Array());
+    computeNormalPerVertex(*normalList, weighting);
+    return normalList;
+}
+
+void
+Mesh::computeNormalPerVertex(Point3Array& normals, NormalWeighting weighting) const {
+    uint_t _nbPoints = __pointList->size();
+    uint_t _nbFaces = getIndexListSize();
+    if (_nbFaces >= NORMAL_GRAIN && pgl_thread_count() > 1 && !pgl_is_worker_thread()) {
+        NormalWorkspace _workspace;
+        computeNormalPerVertex(normals, weighting, _workspace);
+        return;
+    }
+
+    // sequential accumulation on the vertices of the normals of the faces,
+    // weighted by their area or of unit length
+    normals.resize(_nbPoints);
+    std::fill(normals.begin(), normals.end(), Vector3::ORIGIN);
+    std::vector<bool> hasNormal(_nbPoints,false);
+    for(uint_t j = 0; j < _nbFaces; j++){
+        Vector3 _faceNormal = faceCross(*this,j);
+        if (weighting != eAreaWeighting) _faceNormal.normalize();
+        for(uint_t i = 0; i < getFaceSize(j); i++){
             uint_t _index = getFacePointIndexAt(j,i);
-            normalList->getAt(_index)+=_norm;
+            if (weighting == eAngleWeighting) normals[_index] += _faceNormal * cornerAngle(*this,j,i);
+            else normals[_index] += _faceNormal;
             hasNormal[_index] = true;
         }
     }
-    for(i=0; i < __pointList->size(); i++) {
-        if(!hasNormal[i] )
-            normalList->setAt(i,Vector3( 1,0,0 ) );
+    for(uint_t i = 0; i < _nbPoints; i++) {
+        if(!hasNormal[i]) normals[i] = Vector3(1,0,0);
+        normalizeNormal(normals[i]);
     }
-    for(Point3Array::iterator _it=normalList->begin();_it!=normalList->end();_it++)
-    {
-        _it->normalize();
-        if (fabs(norm(*_it) - 1.0) > GEOM_EPSILON) *_it = DEFAULT_NORMAL_VALUE;
+}
+
+Mesh::NormalWorkspace::NormalWorkspace() : __nbPoints(0), __nbFaces(0) {}
+
+void Mesh::NormalWorkspace::clear() {
+    __offsets.clear();
+    __corners.clear();
+    __nbPoints = 0;
+    __nbFaces = 0;
+}
+
+void
+Mesh::computeNormalPerVertex(Point3Array& normals, NormalWeighting weighting, NormalWorkspace& workspace) const {
+    uint_t _nbPoints = __pointList->size();
+    uint_t _nbFaces = getIndexListSize();
+    normals.resize(_nbPoints);
+
+    // normals of the faces, weighted by their area or of unit length
+    std::vector<Vector3>& _faceNormals = workspace.__faceNormals;
+    _faceNormals.resize(_nbFaces);
+    pgl_parallel_for(0, _nbFaces, [this, weighting, &_faceNormals](size_t j){
+        _faceNormals[j] = faceCross(*this,j);
+        if (weighting != eAreaWeighting) _faceNormals[j].normalize();
+    }, 0, NORMAL_GRAIN);
+
+    // map from the vertices to their face corners, in the order of the faces
+    std::vector<uint_t>& _offsets = workspace.__offsets;
+    std::vector<std::pair<uint_t,uint_t> >& _corners = workspace.__corners;
+    if (_offsets.empty() || workspace.__nbPoints != _nbPoints || workspace.__nbFaces != _nbFaces) {
+        _offsets.assign(_nbPoints + 1, 0);
+        for(uint_t j = 0; j < _nbFaces; j++)
+            for(uint_t i = 0; i < getFaceSize(j); i++)
+                ++_offsets[getFacePointIndexAt(j,i) + 1];
+        for(uint_t i = 0; i < _nbPoints; i++) _offsets[i + 1] += _offsets[i];
+        _corners.resize(_offsets[_nbPoints]);
+        std::vector<uint_t> _cursors(_offsets.begin(), _offsets.end() - 1);
+        for(uint_t j = 0; j < _nbFaces; j++)
+            for(uint_t i = 0; i < getFaceSize(j); i++)
+                _corners[_cursors[getFacePointIndexAt(j,i)]++] = std::pair<uint_t,uint_t>(j,i);
+        workspace.__nbPoints = _nbPoints;
+        workspace.__nbFaces = _nbFaces;
     }
 
-    return normalList;
+    // each vertex sums the normals of its faces
+    pgl_parallel_for(0, _nbPoints, [this, weighting, &normals, &_faceNormals, &_offsets, &_corners](size_t v){
+        Vector3 _normal;
+        if (_offsets[v] == _offsets[v + 1]) _normal = Vector3(1,0,0);
+        for(uint_t k = _offsets[v]; k < _offsets[v + 1]; ++k) {
+            const std::pair<uint_t,uint_t>& _corner = _corners[k];
+            if (weighting == eAngleWeighting) _normal += _faceNormals[_corner.first] * cornerAngle(*this,_corner.first,_corner.second);
+            else _normal += _faceNormals[_corner.first];
+        }
+        normalizeNormal(_normal);
+        normals[v] = _normal;
+    }, 0, NORMAL_GRAIN);
 }
 
 Point3ArrayPtr
 Mesh::computeNormalPerFace() const {
-    Point3ArrayPtr normalList(new Point3Array(getIndexListSize()));
-    for(uint_t j=0; j < getIndexListSize(); j++){
-        normalList->setAt(j,cross(getFacePointAt(j,__ccw ? 1 : 2) - getFacePointAt(j,0),
-                  getFacePointAt(j,__ccw ? 2 : 1) - getFacePointAt(j,0)));
-    }
-    bool hasinvalid = false;
-    for(Point3Array::iterator _it=normalList->begin();_it!=normalList->end();_it++)
-    {
-        _it->normalize();
-        if (fabs(norm(*_it) - 1.0) > GEOM_EPSILON) *_it = DEFAULT_NORMAL_VALUE;
-    }
-
+    Point3ArrayPtr normalList(new Point3Array());
+    computeNormalPerFace(*normalList);
     return normalList;
 }
 
+void
+Mesh::computeNormalPerFace(Point3Array& normals) const {
+    normals.resize(getIndexListSize());
+    pgl_parallel_for(0, getIndexListSize(), [this, &normals](size_t j){
+        Vector3 _normal = faceCross(*this,j);
+        normalizeNormal(_normal);
+        normals[j] = _normal;
+    }, 0, NORMAL_GRAIN);
+}
+
 
 /* ----------------------------------------------------------------------- */
 
@@ -51,6 +51,7 @@
 
 #include "explicitmodel.h"
 #include "polyline.h"
+#include <vector>
 /* ----------------------------------------------------------------------- */
 
 PGL_BEGIN_NAMESPACE
@@ -362,10 +363,61 @@ public:
   { return getFaceColorAt(i,j); }
 #endif
 
-  void computeNormalList(bool pervertex);
-  Point3ArrayPtr computeNormalPerVertex() const;
+  /// Weighting of the normals of the faces around a vertex when computing normals per vertex.
+  enum NormalWeighting {
+    /// Weighted by the area of the faces (computed on their first 3 points).
+    eAreaWeighting,
+    /// Weighted by the angle of the faces at the vertex.
+    eAngleWeighting,
+    /// Unit normals of the faces summed.
+    eUniformWeighting
+  };
+
+  /** Computes the normals of \e self per vertex or per face.
+      The current normal list is filled in place if it is not shared. */
+  void computeNormalList(bool pervertex, NormalWeighting weighting = eAreaWeighting);
+
+  Point3ArrayPtr computeNormalPerVertex(NormalWeighting weighting = eAreaWeighting) const;
   Point3ArrayPtr computeNormalPerFace() const;
 
+  /** Buffers of the computation of the normals per vertex: normals of the faces and
+      map from the vertices to their faces. Given to successive calls on meshes of same
+      topology, for instance when only the points move, the map is built once and
+      the buffers are not allocated again. clear() must be called when the indices change. */
+  class SG_API NormalWorkspace {
+  public:
+    NormalWorkspace();
+
+    /// Forgets the map from the vertices to the faces.
+    void clear();
+
+  protected:
+    friend class Mesh;
+
+    /// Normals of the faces.
+    std::vector<Vector3> __faceNormals;
+    /// Range of the corners of each vertex in __corners.
+    std::vector<uint_t> __offsets;
+    /// Face and corner index of the corners of the vertices, in the order of the faces.
+    std::vector<std::pair<uint_t,uint_t> > __corners;
+    /// Number of points and faces of the mesh of the map.
+    uint_t __nbPoints;
+    uint_t __nbFaces;
+  };
+
+  /** Computes the normals per vertex into \e normals, resized to the number of points.
+      Small meshes are computed sequentially. Otherwise, normals of the faces are computed
+      in parallel and summed on each vertex in parallel using a map from vertices to faces. */
+  void computeNormalPerVertex(Point3Array& normals, NormalWeighting weighting = eAreaWeighting) const;
+
+  /** Computes the normals per vertex into \e normals with the buffers and the map of \e workspace,
+      built on first use. Loops are parallel for large meshes, except when called from
+      a parallel loop or a thread pool. */
+  void computeNormalPerVertex(Point3Array& normals, NormalWeighting weighting, NormalWorkspace& workspace) const;
+
+  /// Computes in parallel the normals per face into \e normals, resized to the number of faces.
+  void computeNormalPerFace(Point3Array& normals) const;
+
   inline bool hasNormalList() const { return is_valid_ptr(__normalList); }
   inline void checkNormalList() { if(!hasNormalList())computeNormalList(); }
   inline void computeNormalList() { computeNormalList(__normalPerVertex); };
@@ -442,7 +442,8 @@ Vector3 NurbsCurve::getPointAt(real_t u) const{
     GEOM_ASSERT( (getFirstKnot() -u ) < GEOM_EPSILON &&  !((u - getLastKnot()) > GEOM_EPSILON));
 
     uint_t span = findSpan(u);
-    RealArrayPtr _basisFunctions = computeBasisFunctions(span,u);
+    real_t * _basisFunctions = (real_t*)alloca((__degree+1)*sizeof(real_t));
+    basisFunctions(span,u,__degree,__knotList,_basisFunctions);
     Vector4 Cw(0.0,0.0,0.0,0.0);
     for (uint_t j = 0; j <= __degree; j++) {
         Vector4 Pj = __ctrlPointList->getAt( span - __degree + j );
@@ -450,7 +451,7 @@ Vector3 NurbsCurve::getPointAt(real_t u) const{
         Pj.y() *= Pj.w();
         Pj.z() *= Pj.w();
 
-        Cw += Pj * _basisFunctions->getAt(j);
+        Cw += Pj * _basisFunctions[j];
     }
 
     if (fabs(Cw.w()) < GEOM_TOLERANCE)
@@ -580,10 +581,17 @@ PGL(findSpan)(real_t u,
 RealArrayPtr
 PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _knotList) {
   RealArrayPtr BasisFunctions(new RealArray(_degree + 1));
+  basisFunctions(span, u, _degree, _knotList, BasisFunctions->data());
+  return BasisFunctions;
+}
+
+void
+PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _knotList, real_t * BasisFunctions) {
   if( span >= _knotList->size()-_degree - 1){ // for clamped vector only
+    BasisFunctions[0] = 0.0;
     for(uint_t _i = 0 ; _i <_degree ; _i ++)
-      BasisFunctions->setAt(_degree - _i ,1.0);
-    return BasisFunctions;
+      BasisFunctions[_degree - _i] = 1.0;
+    return;
   }
 
   /// memory set with alloca is automatically freed at the end of the function
@@ -591,7 +599,7 @@ PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _
   real_t * right= &left[ _degree+1 ];
   real_t saved;
 
-  BasisFunctions->setAt(0,1.0);
+  BasisFunctions[0] = 1.0;
 
   for( uint_t j = 1 ; j <= _degree ; j++ ){
     left[j] = u - _knotList->getAt(span + 1 -j) ;
@@ -604,28 +612,47 @@ PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _
                  << j << '-' << r << "] = " << left[j-r] << endl;
         }
         assert(right[r+1] + left[j-r] != 0);
-        real_t temp = BasisFunctions->getAt(r) / ( right[r+1] + left[j-r] );
-        BasisFunctions->setAt(r, saved + ( right[r+1] * temp ));
+        real_t temp = BasisFunctions[r] / ( right[r+1] + left[j-r] );
+        BasisFunctions[r] = saved + ( right[r+1] * temp );
         saved = left[j-r] * temp;
     }
-    BasisFunctions->setAt(j,saved);
+    BasisFunctions[j] = saved;
   }
-  return BasisFunctions;
 }
 
 /* Algo A2.3 p72 Nurbs Book */
 RealArray2Ptr
 PGL(derivatesBasisFunctions)(int n,real_t u, int span,  uint_t _degree, const RealArrayPtr& _knotList ){
-  real_t * left = (real_t *) alloca(2*(_degree+1)*sizeof(real_t)) ;
-  real_t * right = &left[_degree+1] ;
+  RealArray2Ptr ders(new RealArray2(n+1,_degree+1));
+  /// memory set with alloca is automatically freed at the end of the function
+  real_t * workspace = (real_t *) alloca(derivatesBasisFunctionsWorkspaceSize(_degree)*sizeof(real_t)) ;
+  derivatesBasisFunctions(n, u, span, _degree, _knotList, &ders->getAt(0,0), workspace);
+  return ders;
+}
+
+uint_t
+PGL(derivatesBasisFunctionsWorkspaceSize)(uint_t _degree){
+  // ndu matrix, two rows of a and the left and right arrays
+  return (_degree+1)*(_degree+1) + 4*(_degree+1);
+}
+
+void
+PGL(derivatesBasisFunctions)(int n,real_t u, int span,  uint_t _degree, const RealArrayPtr& _knotList,
+                             real_t * ders, real_t * workspace ){
+  const int stride = _degree+1;
+  real_t * ndu = workspace ;
+  real_t * a = &ndu[stride*stride] ;
+  real_t * left = &a[2*stride] ;
+  real_t * right = &left[stride] ;
+
+#define NDU(i,j) ndu[(i)*stride+(j)]
+#define AR(i,j) a[(i)*stride+(j)]
+#define DERS(i,j) ders[(i)*stride+(j)]
 
-  RealArray2 ndu(_degree+1,_degree+1) ;
   real_t saved,temp ;
   int r, j;
 
-  RealArray2Ptr ders(new RealArray2(n+1,_degree+1));
-
-  ndu.setAt(0,0,1.0) ;
+  NDU(0,0) = 1.0 ;
 
   for(j=1; j <= (int)_degree ;j++){
       left[j] = u-_knotList->getAt(span+1-j) ;
@@ -634,25 +661,24 @@ PGL(derivatesBasisFunctions)(int n,real_t u, int span,  uint_t _degree, const Re
 
       for(r=0;r<j ; r++){
           // Lower triangle
-          ndu.setAt(j,r,right[r+1]+left[j-r]) ;
-          temp = ndu.getAt(r,j-1)/ndu.getAt(j,r) ;
+          NDU(j,r) = right[r+1]+left[j-r] ;
+          temp = NDU(r,j-1)/NDU(j,r) ;
           // Upper triangle
-          ndu.setAt(r,j,saved+right[r+1] * temp) ;
+          NDU(r,j) = saved+right[r+1] * temp ;
           saved = left[j-r] * temp ;
       }
 
-      ndu.setAt(j,j,saved) ;
+      NDU(j,j) = saved ;
   }
 
   for(j=_degree;j>=0;--j)
-      ders->setAt(0,j,ndu.getAt(j,_degree)) ;
+      DERS(0,j) = NDU(j,_degree) ;
 
   // Compute the derivatives
-  RealArray2 a(_degree+1,_degree+1) ;
   for(r=0;r<=(int)_degree;r++){
       int s1,s2 ;
       s1 = 0 ; s2 = 1 ; // alternate rows in array a
-      a.setAt(0,0,1.0) ;
+      AR(0,0) = 1.0 ;
       // Compute the kth derivative
       for(int k=1;k<=n;k++){
           real_t d ;
@@ -661,8 +687,8 @@ PGL(derivatesBasisFunctions)(int n,real_t u, int span,  uint_t _degree, const Re
           rk = r-k ; pk = _degree-k ;
 
           if(r>=k){
-              a.setAt(s2,0,(a.getAt(s1,0)/ndu.getAt(pk+1,rk))) ;
-              d = a.getAt(s2,0)*ndu.getAt(rk,pk) ;
+              AR(s2,0) = AR(s1,0)/NDU(pk+1,rk) ;
+              d = AR(s2,0)*NDU(rk,pk) ;
           }
 
           if(rk>=-1){
@@ -680,15 +706,15 @@ PGL(derivatesBasisFunctions)(int n,real_t u, int span,  uint_t _degree, const Re
           }
 
           for(j=j1;j<=j2;j++){
-              a.setAt(s2,j,((a.getAt(s1,j)-a.getAt(s1,j-1))/ndu.getAt(pk+1,rk+j))) ;
-              d += a.getAt(s2,j)*ndu.getAt(rk+j,pk) ;
+              AR(s2,j) = (AR(s1,j)-AR(s1,j-1))/NDU(pk+1,rk+j) ;
+              d += AR(s2,j)*NDU(rk+j,pk) ;
           }
 
       if(r<=pk){
-        a.setAt(s2,k,-(a.getAt(s1,k-1))/ndu.getAt(pk+1,r)) ;
-        d += a.getAt(s2,k)*ndu.getAt(r,pk) ;
+        AR(s2,k) = -AR(s1,k-1)/NDU(pk+1,r) ;
+        d += AR(s2,k)*NDU(r,pk) ;
       }
-      ders->setAt(k,r, d) ;
+      DERS(k,r) = d ;
       j = s1 ; s1 = s2 ; s2 = j ; // Switch rows
     }
   }
@@ -697,11 +723,13 @@ PGL(derivatesBasisFunctions)(int n,real_t u, int span,  uint_t _degree, const Re
   r = _degree ;
   for(int k=1;k<=n;k++){
       for(j=_degree;j>=0;--j)
-          ders->setAt(k,j,ders->getAt(k,j)*r) ;
+          DERS(k,j) *= r ;
       r *= _degree-k ;
   }
-  return ders;
 
+#undef NDU
+#undef AR
+#undef DERS
 }
 
 /* ----------------------------------------------------------------------- */
@@ -957,14 +985,15 @@ Vector2 NurbsCurve2D::getPointAt(real_t u) const{
   GEOM_ASSERT( (getFirstKnot() -u ) < GEOM_EPSILON &&  !((u - getLastKnot()) > GEOM_EPSILON));
 
   uint_t span = findSpan(u);
-  RealArrayPtr _basisFunctions = basisFunctions(span,u,__degree,__knotList);
+  real_t * _basisFunctions = (real_t*)alloca((__degree+1)*sizeof(real_t));
+  basisFunctions(span,u,__degree,__knotList,_basisFunctions);
   Vector3 Cw(0.0,0.0,0.0);
   for (uint_t j = 0; j <= __degree; j++) {
       Vector3 Pj = __ctrlPointList->getAt( span - __degree + j );
       Pj.x() *= Pj.z();
       Pj.y() *= Pj.z();
 
-      Cw += Pj * _basisFunctions->getAt(j);
+      Cw += Pj * _basisFunctions[j];
   }
 
   if (fabs(Cw.z()) < GEOM_TOLERANCE)
@@ -445,6 +445,14 @@ RealArrayPtr SG_API basisFunctions(uint_t span, real_t u,
                    uint_t _degree,
                    const RealArrayPtr& _knotList );
 
+/*! \brief Compute the Basis Functions Values in \e result, an array of \e _degree + 1 values.
+  Same as previous function without allocation.
+*/
+void SG_API basisFunctions(uint_t span, real_t u,
+                   uint_t _degree,
+                   const RealArrayPtr& _knotList,
+                   real_t * result );
+
 /*!
   \brief Compute the Derivates Basis Functions Values
   Algo A2.3 p72 Nurbs Book
@@ -455,6 +463,19 @@ RealArray2Ptr SG_API derivatesBasisFunctions(int n, real_t u,
                       uint_t _degree,
                       const RealArrayPtr& _knotList );
 
+/*! \brief Compute the Derivates Basis Functions Values in \e result, an array of (\e n + 1) x (\e _degree + 1) values stored by rows.
+  Same as previous function without allocation. \e workspace is an array of derivatesBasisFunctionsWorkspaceSize(\e _degree) values.
+*/
+void SG_API derivatesBasisFunctions(int n, real_t u,
+                      int span,
+                      uint_t _degree,
+                      const RealArrayPtr& _knotList,
+                      real_t * result,
+                      real_t * workspace );
+
+/// Number of values of the workspace of derivatesBasisFunctions.
+uint_t SG_API derivatesBasisFunctionsWorkspaceSize(uint_t _degree);
+
 /* ----------------------------------------------------------------------- */
 
 PGL_END_NAMESPACE
@@ -51,6 +51,11 @@
 #include <plantgl/tool/util_array.h>
 #include <plantgl/scenegraph/container/pointmatrix.h>
 #include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/tool/util_array2.h>
+#ifdef _WIN32
+#include <malloc.h>
+#define alloca _alloca
+#endif
 //#include <iostream>
 
 PGL_USING_NAMESPACE
@@ -318,6 +323,7 @@ NurbsPatch::~NurbsPatch( ) {
 
 SceneObjectPtr NurbsPatch::copy(DeepCopier& copier) const {
   NurbsPatch * ptr = new NurbsPatch(*this);
+  ptr->clearBezierCache();
   copier.copy_attribute(ptr->getCtrlPointMatrix( ));
   copier.copy_attribute(ptr->getUKnotList( ));
   copier.copy_attribute(ptr->getVKnotList( ));
@@ -431,6 +437,7 @@ Point4MatrixPtr  NurbsPatch::deriveAtH(real_t u, real_t v, int d, int uspan, int
 
     for(int k=0;k<=du;++k){
         for(int s=0;s<=__vdegree;++s){
+            temp[s] = Vector4::ORIGIN;
             for(int r=0;r<=__udegree;++r){
                 temp[s] +=  UderF->getAt(k,r)*__ctrlPointMatrix->getAt(uspan-__udegree+r,vspan-__vdegree+s) ;
             }
@@ -447,9 +454,12 @@ Point4MatrixPtr  NurbsPatch::deriveAtH(real_t u, real_t v, int d, int uspan, int
 }
 
 
-Point4MatrixPtr NurbsPatch::deriveAt(real_t  u, real_t  v, int d, int uspan, int vspan ) const{
+/*
+  Compute the derivatives of the rational patch from the homogeneous derivatives dersW.
+  (see the Nurbs Book A4.4 p.137)
+*/
+static Point4MatrixPtr rationalDerivatives(const Point4MatrixPtr& dersW, int d){
     Point4MatrixPtr patchders(new Point4Matrix(d+1,d+1));
-    Point4MatrixPtr dersW = deriveAtH(u,v,d,uspan,vspan) ;
 
     Vector4 vec;
 
@@ -489,10 +499,15 @@ Point4MatrixPtr NurbsPatch::deriveAt(real_t  u, real_t  v, int d, int uspan, int
     return patchders;
 }
 
+Point4MatrixPtr NurbsPatch::deriveAt(real_t  u, real_t  v, int d, int uspan, int vspan ) const{
+    return rationalDerivatives(deriveAtH(u,v,d,uspan,vspan),d);
+}
+
 
 Vector4 NurbsPatch::getDerivativeAt(real_t u, real_t v, int du, int dv) const {
     int d = max(du,dv) ;
     if (d > min(__udegree,__vdegree)) return Vector4(0,0,0,0);
+    if (hasBezierCache()) return rationalDerivatives(bezierDeriveAtH(u,v,d),d)->getAt(du,dv);
     int uspan = findSpan(u,__udegree,__uKnotList) ;
     int vspan = findSpan(v,__vdegree,__vKnotList) ;
     Point4MatrixPtr ders = deriveAt(u,v,d,uspan,vspan) ;
@@ -501,27 +516,250 @@ Vector4 NurbsPatch::getDerivativeAt(real_t u, real_t v, int du, int dv) const {
 
 
 Point4MatrixPtr NurbsPatch::getDerivativesAt(real_t u,real_t v) const {
+    int degree = min(__udegree,__vdegree) ;
+    if (hasBezierCache()) return rationalDerivatives(bezierDeriveAtH(u,v,degree),degree);
     int uspan = findSpan(u,__udegree,__uKnotList) ;
     int vspan = findSpan(v,__vdegree,__vKnotList) ;
-    int degree = min(__udegree,__vdegree) ;
     return deriveAt(u,v,degree,uspan,vspan) ;
 }
 
 
 
+/* ----------------------------------------------------------------------- */
+
+/*
+  Compute the Bernstein polynomials of degree p at t and their derivatives up to order n.
+  ders[k*(p+1)+i] is the k-th derivative of B(i,p) multiplied by scale^k.
+  (see the Nurbs Book p.21-22)
+*/
+static void bernsteinDerivatives(uint_t p, uint_t n, real_t t, real_t scale, real_t * ders){
+    GEOM_ASSERT(n <= p);
+    uint_t stride = p+1;
+    real_t * B = (real_t*)alloca(stride*sizeof(real_t));
+    real_t t1 = 1.0-t;
+    real_t saved, temp;
+    B[0] = 1.0;
+    for(uint_t j = 0; j <= p; ++j){
+        if (j > 0) {
+            saved = 0.0;
+            for(uint_t k = 0; k < j; ++k){
+                temp = B[k];
+                B[k] = saved+t1*temp;
+                saved = t*temp;
+            }
+            B[j] = saved;
+        }
+        if (j + n < p) continue;
+        if (j == p && n == 0) {
+            std::copy(B, B+stride, ders);
+            break;
+        }
+        // B holds the polynomials of degree p-k
+        uint_t k = p - j;
+        real_t coef = 1.0;
+        for(uint_t r = 0; r < k; ++r) coef *= (p-r)*scale;
+        for(uint_t i = 0; i <= p; ++i){
+            real_t sum = 0.0;
+            real_t binom = 1.0;
+            for(uint_t r = 0; r <= k; ++r){
+                if (r <= i && i-r <= j) sum += ((k-r) % 2 ? -binom : binom) * B[i-r];
+                binom = binom * (k-r) / (r+1);
+            }
+            ders[k*stride+i] = coef * sum;
+        }
+    }
+}
+
+/*
+  Returns the index of the Bezier segment delimited by breaks that contains t.
+  Set local to the parameter of t on this segment and scale to the inverse of its length.
+*/
+static inline uint_t findBezierSegment(const std::vector<real_t>& breaks, real_t t, real_t& local, real_t& scale){
+    uint_t s = std::upper_bound(breaks.begin()+1, breaks.end()-1, t) - (breaks.begin()+1);
+    scale = 1.0 / (breaks[s+1]-breaks[s]);
+    local = (t - breaks[s]) * scale;
+    return s;
+}
+
+/*
+  Decompose into Bezier segments the control points along one parametric direction (see the Nurbs Book A5.6 p.173).
+  Control point i is the block of width points starting at ctrl[i*width].
+  The degree+1 blocks of each segment are stored in result and the parameter bounds of the segments in breaks.
+  Returns false if a knot has a multiplicity greater than the degree.
+*/
+static bool decomposeBezier(const std::vector<Vector4>& ctrl, uint_t width, uint_t p, const RealArrayPtr& U,
+                            std::vector<Vector4>& result, std::vector<real_t>& breaks){
+    int m = U->size()-1;
+    int a = p;
+    int b = p+1;
+    uint_t nb = 0;
+    uint_t segsize = (p+1)*width;
+    real_t * alphas = (real_t*)alloca((p+1)*sizeof(real_t));
+    result.assign(ctrl.begin(), ctrl.begin()+segsize);
+    breaks.assign(1,U->getAt(p));
+#define Q(seg,k) (&result[(seg)*segsize+(k)*width])
+    while (b < m) {
+        int i = b;
+        while (b < m && U->getAt(b+1) == U->getAt(b)) b++;
+        int mult = b-i+1;
+        if (b < m) {
+            if (mult > (int)p) return false;
+            result.resize((nb+2)*segsize);
+        }
+        if (mult < (int)p) {
+            real_t numer = U->getAt(b)-U->getAt(a);
+            for (int j = p; j > mult; j--)
+                alphas[j-mult-1] = numer/(U->getAt(a+j)-U->getAt(a));
+            int r = p-mult;
+            for (int j = 1; j <= r; j++) {
+                int save = r-j;
+                int s = mult+j;
+                for (int k = p; k >= s; k--) {
+                    real_t alpha = alphas[k-s];
+                    Vector4 * qk = Q(nb,k);
+                    const Vector4 * qk1 = Q(nb,k-1);
+                    for (uint_t w = 0; w < width; ++w)
+                        qk[w] = qk[w] * alpha + qk1[w] * (1.0-alpha);
+                }
+                if (b < m) std::copy(Q(nb,p), Q(nb,p)+width, Q(nb+1,save));
+            }
+        }
+        breaks.push_back(U->getAt(b));
+        nb++;
+        if (b < m) {
+            for (int k = p-mult; k <= (int)p; k++)
+                std::copy(&ctrl[(b-p+k)*width], &ctrl[(b-p+k+1)*width], Q(nb,k));
+            a = b;
+            b++;
+        }
+    }
+#undef Q
+    result.resize(nb*segsize);
+    return true;
+}
+
+static bool isClampedKnotList(const RealArrayPtr& knots, uint_t degree){
+    uint_t last = knots->size()-1;
+    for (uint_t i = 1; i <= degree; ++i)
+        if (knots->getAt(i) != knots->getAt(0) || knots->getAt(last-i) != knots->getAt(last)) return false;
+    return true;
+}
+
+bool NurbsPatch::buildBezierCache(){
+    clearBezierCache();
+    if (!isValid() || __udegree == 0 || __vdegree == 0) return false;
+    if (!isClampedKnotList(__uKnotList,__udegree) || !isClampedKnotList(__vKnotList,__vdegree)) return false;
+
+    // along u, control point i is the row i of the matrix
+    uint_t nv = __ctrlPointMatrix->getColumnNb();
+    std::vector<Vector4> ctrl(__ctrlPointMatrix->begin(), __ctrlPointMatrix->end());
+    std::vector<Vector4> usegments, vsegments;
+    std::vector<real_t> ubreaks, vbreaks;
+    if (!decomposeBezier(ctrl, nv, __udegree, __uKnotList, usegments, ubreaks)) return false;
+
+    // along v, control point j is the column j of the u decomposition
+    uint_t nbrows = usegments.size() / nv;
+    ctrl.resize(usegments.size());
+    for (uint_t r = 0; r < nbrows; ++r)
+        for (uint_t j = 0; j < nv; ++j)
+            ctrl[j*nbrows+r] = usegments[r*nv+j];
+    if (!decomposeBezier(ctrl, nbrows, __vdegree, __vKnotList, vsegments, vbreaks)) return false;
+
+    uint_t nbcols = vsegments.size() / nbrows;
+    Point4MatrixPtr bezierPoints(new Point4Matrix(nbrows,nbcols));
+    for (uint_t c = 0; c < nbcols; ++c)
+        for (uint_t r = 0; r < nbrows; ++r)
+            bezierPoints->setAt(r,c,vsegments[c*nbrows+r]);
+
+    __bezierCache.ctrlPointMatrix = bezierPoints;
+    __bezierCache.ubreaks.swap(ubreaks);
+    __bezierCache.vbreaks.swap(vbreaks);
+    __bezierCache.source = __ctrlPointMatrix;
+    __bezierCache.uknots = __uKnotList;
+    __bezierCache.vknots = __vKnotList;
+    __bezierCache.sourceStamp = __ctrlPointMatrix->getModificationStamp();
+    __bezierCache.uknotsStamp = __uKnotList->getModificationStamp();
+    __bezierCache.vknotsStamp = __vKnotList->getModificationStamp();
+    __bezierCache.udegree = __udegree;
+    __bezierCache.vdegree = __vdegree;
+    return true;
+}
+
+void NurbsPatch::clearBezierCache(){
+    __bezierCache = BezierCache();
+}
+
+bool NurbsPatch::hasBezierCache() const{
+    return is_valid_ptr(__bezierCache.ctrlPointMatrix) &&
+           __bezierCache.source == __ctrlPointMatrix &&
+           __bezierCache.uknots == __uKnotList &&
+           __bezierCache.vknots == __vKnotList &&
+           __bezierCache.sourceStamp == __ctrlPointMatrix->getModificationStamp() &&
+           __bezierCache.uknotsStamp == __uKnotList->getModificationStamp() &&
+           __bezierCache.vknotsStamp == __vKnotList->getModificationStamp() &&
+           __bezierCache.udegree == __udegree &&
+           __bezierCache.vdegree == __vdegree;
+}
+
+Point4MatrixPtr NurbsPatch::bezierDeriveAtH(real_t u, real_t v, int d) const {
+    int du = ( d < (int)__udegree ? d : __udegree);
+    int dv = ( d < (int)__vdegree ? d : __vdegree);
+    const Point4Matrix& ctrl = *__bezierCache.ctrlPointMatrix;
+
+    real_t su, sv, scale;
+    uint_t ufirst = findBezierSegment(__bezierCache.ubreaks, u, su, scale) * (__udegree+1);
+    real_t * UderF = (real_t*)alloca((du+1)*(__udegree+1)*sizeof(real_t));
+    bernsteinDerivatives(__udegree, du, su, scale, UderF);
+    uint_t vfirst = findBezierSegment(__bezierCache.vbreaks, v, sv, scale) * (__vdegree+1);
+    real_t * VderF = (real_t*)alloca((dv+1)*(__vdegree+1)*sizeof(real_t));
+    bernsteinDerivatives(__vdegree, dv, sv, scale, VderF);
+
+    Point4MatrixPtr patchders(new Point4Matrix(d+1,d+1, Vector4::ORIGIN));
+    Point4Array temp(__vdegree+1, Vector4::ORIGIN) ;
+    for(int k=0;k<=du;++k){
+        for(uint_t s=0;s<=__vdegree;++s){
+            temp[s] = Vector4::ORIGIN;
+            for(uint_t r=0;r<=__udegree;++r)
+                temp[s] += ctrl.getAt(ufirst+r,vfirst+s)*UderF[k*(__udegree+1)+r];
+        }
+        int dd = ( (d-k) < dv ? (d-k) : dv);
+        for(int r=0;r<=dd;++r){
+            for(uint_t s=0;s<=__vdegree;++s){
+                patchders->getAt(k,r) += temp[s]*VderF[r*(__vdegree+1)+s];
+            }
+        }
+    }
+    return patchders;
+}
+
 Vector3 NurbsPatch::getPointAt(real_t u, real_t v) const{
   GEOM_ASSERT( u >= getFirstUKnot() && u <= getLastUKnot() && v>= getFirstVKnot() && v<= getLastVKnot());
 
-  uint_t uspan = findSpan(u,__udegree,__uKnotList);
-  RealArrayPtr Nu = basisFunctions(uspan, u, __udegree, __uKnotList);
-  uint_t vspan = findSpan(v,__vdegree,__vKnotList);
-  RealArrayPtr Nv = basisFunctions(vspan, v, __vdegree, __vKnotList);
+  real_t * Nu = (real_t*)alloca((__udegree+1)*sizeof(real_t));
+  real_t * Nv = (real_t*)alloca((__vdegree+1)*sizeof(real_t));
+  uint_t uind, vfirst;
+  bool cached = hasBezierCache();
+  const Point4MatrixPtr& ctrlPointMatrix = (cached ? __bezierCache.ctrlPointMatrix : __ctrlPointMatrix);
+  if (cached) {
+      real_t su, sv, scale;
+      uind = findBezierSegment(__bezierCache.ubreaks, u, su, scale) * (__udegree+1);
+      bernsteinDerivatives(__udegree, 0, su, scale, Nu);
+      vfirst = findBezierSegment(__bezierCache.vbreaks, v, sv, scale) * (__vdegree+1);
+      bernsteinDerivatives(__vdegree, 0, sv, scale, Nv);
+  }
+  else {
+      uint_t uspan = findSpan(u,__udegree,__uKnotList);
+      basisFunctions(uspan, u, __udegree, __uKnotList, Nu);
+      uint_t vspan = findSpan(v,__vdegree,__vKnotList);
+      basisFunctions(vspan, v, __vdegree, __vKnotList, Nv);
+      uind = uspan - __udegree;
+      vfirst = vspan - __vdegree;
+  }
   Vector4 Sw( 0 , 0 , 0 ,0 );
 
-  uint_t uind = uspan - __udegree;
   for (uint_t l = 0 ; l <= __vdegree ; l++ ){
       Vector4 temp( 0 , 0 , 0 ,0 );
-      uint_t vind = vspan - __vdegree +l;
+      uint_t vind = vfirst +l;
       for (uint_t k = 0 ; k <= __udegree ; k++ ) {
            /*
              Note that ctrlPointMatrix access is inverted:
@@ -530,9 +768,9 @@ Vector3 NurbsPatch::getPointAt(real_t u, real_t v) const{
              Indices are similar between ctrlPointMatrix.getAt and
              NurbsPatch.getPointAt which is  coherent.
            */
-          temp += (__ctrlPointMatrix->getAt(uind+k,vind) *  (Nu->getAt(k))) ;
+          temp += (ctrlPointMatrix->getAt(uind+k,vind) *  (Nu[k])) ;
       }
-      Sw += temp * Nv->getAt(l);
+      Sw += temp * Nv[l];
   }
 
 
@@ -542,6 +780,71 @@ Vector3 NurbsPatch::getPointAt(real_t u, real_t v) const{
 
   return Sw.project();
 }
+
+Point3ArrayPtr NurbsPatch::evaluateGrid(const RealArrayPtr& uvalues, const RealArrayPtr& vvalues,
+                                        Point3ArrayPtr * normals,
+                                        Point3ArrayPtr * utangents,
+                                        Point3ArrayPtr * vtangents) const
+{
+    bool derivatives = normals || utangents || vtangents;
+    BasisMatrix basis[2];
+    const RealArrayPtr * values[2] = { &uvalues, &vvalues };
+    if (hasBezierCache()){
+        const std::vector<real_t> * breaks[2] = { &__bezierCache.ubreaks, &__bezierCache.vbreaks };
+        real_t * ders = (real_t*)alloca(2*(max(__udegree,__vdegree)+1)*sizeof(real_t));
+        for (uint_t d = 0; d < 2; ++d){
+            BasisMatrix& b = basis[d];
+            b.degree = (d == 0 ? __udegree : __vdegree);
+            uint_t nbvalues = (*values[d])->size();
+            uint_t stride = b.degree + 1;
+            b.first.resize(nbvalues);
+            b.values.resize(nbvalues * stride);
+            if (derivatives) b.derivatives.resize(nbvalues * stride);
+            for (uint_t i = 0; i < nbvalues; ++i){
+                real_t t, scale;
+                b.first[i] = findBezierSegment(*breaks[d], (*values[d])->getAt(i), t, scale) * stride;
+                bernsteinDerivatives(b.degree, derivatives ? 1 : 0, t, scale, ders);
+                std::copy(ders, ders + stride, b.values.begin() + i*stride);
+                if (derivatives) std::copy(ders + stride, ders + 2*stride, b.derivatives.begin() + i*stride);
+            }
+        }
+        return BezierPatch::evaluateGrid(*__bezierCache.ctrlPointMatrix, basis[0], basis[1], true, normals, utangents, vtangents);
+    }
+    const RealArrayPtr * knots[2] = { &__uKnotList, &__vKnotList };
+    for (uint_t d = 0; d < 2; ++d){
+        BasisMatrix& b = basis[d];
+        const RealArrayPtr& knotList = *knots[d];
+        b.degree = (d == 0 ? __udegree : __vdegree);
+        uint_t nbvalues = (*values[d])->size();
+        uint_t stride = b.degree + 1;
+        b.first.resize(nbvalues);
+        b.values.resize(nbvalues * stride);
+        // workspaces of the derivatives of the basis functions, shared by all the values
+        std::vector<real_t> ders, workspace;
+        if (derivatives) {
+            b.derivatives.resize(nbvalues * stride);
+            ders.resize(2 * stride);
+            workspace.resize(derivatesBasisFunctionsWorkspaceSize(b.degree));
+        }
+        for (uint_t i = 0; i < nbvalues; ++i){
+            real_t t = (*values[d])->getAt(i);
+            GEOM_ASSERT( t >= knotList->getAt(0) && t <= knotList->getAt(knotList->size()-1) );
+            uint_t span = findSpan(t,b.degree,knotList);
+            b.first[i] = span - b.degree;
+            basisFunctions(span, t, b.degree, knotList, &b.values[i*stride]);
+            if (derivatives) {
+                if (b.degree == 0) b.derivatives[i] = 0;
+                else {
+                    derivatesBasisFunctions(1, t, span, b.degree, knotList, &ders[0], &workspace[0]);
+                    std::copy(ders.begin() + stride, ders.end(), b.derivatives.begin() + i*stride);
+                }
+            }
+        }
+    }
+    // control points are stored with u along the rows and v along the columns
+    return BezierPatch::evaluateGrid(*__ctrlPointMatrix, basis[0], basis[1], true, normals, utangents, vtangents);
+}
+
 /*
 Point4MatrixPtr NurbsPatch::getMetric(real_t u, real_t v) const{
     GEOM_ASSERT( u >= 0.0 && u <= 1.0 && v>= 0.0 && v<=1.0);
@@ -622,9 +925,20 @@ Vector3 NurbsPatch::getVTangentAt(real_t u, real_t v) const {
 
 Vector3 NurbsPatch::getNormalAt(real_t u, real_t v) const{
     GEOM_ASSERT( u >= 0.0 && u <= 1.0 && v>= 0.0 && v<=1.0);
-    Vector3 _utangent = getUTangentAt(u,v);
+    Vector3 _utangent, _vtangent;
+    if (hasBezierCache()) {
+        // both tangents from a single evaluation of the Bezier patch
+        Point4MatrixPtr ders = rationalDerivatives(bezierDeriveAtH(u,v,1),1);
+        const Vector4& du = ders->getAt(1,0);
+        const Vector4& dv = ders->getAt(0,1);
+        _utangent = Vector3(du.x(),du.y(),du.z());
+        _vtangent = Vector3(dv.x(),dv.y(),dv.z());
+    }
+    else {
+        _utangent = getUTangentAt(u,v);
+        _vtangent = getVTangentAt(u,v);
+    }
     _utangent.normalize();
-    Vector3 _vtangent = getVTangentAt(u,v);
     _vtangent.normalize();
     return cross(_utangent,_vtangent);
 }
@@ -220,6 +220,17 @@ public:
       - \e v must be in [0,1];*/
   virtual Vector3 getPointAt(real_t u,real_t v) const;
 
+  /*! Returns the points of the patch on the grid \e uvalues x \e vvalues.
+      Point (i,j) is at index i * vvalues->size() + j.
+      Knot spans and basis functions are computed once per u and v value.
+     \pre
+      - \e uvalues must be in [getFirstUKnot(),getLastUKnot()];
+      - \e vvalues must be in [getFirstVKnot(),getLastVKnot()];*/
+  virtual Point3ArrayPtr evaluateGrid(const RealArrayPtr& uvalues, const RealArrayPtr& vvalues,
+                                      Point3ArrayPtr * normals = NULL,
+                                      Point3ArrayPtr * utangents = NULL,
+                                      Point3ArrayPtr * vtangents = NULL) const;
+
   /* Returns the \e Metric for  u = \e u and v = \e v.
       (see Differential Geometry, Kreyszig p. 82)
      \author Michael Walker
@@ -293,6 +304,21 @@ public:
      - \e u, \e v must be in [0,1];*/
   virtual Point4MatrixPtr getDerivativesAt(real_t u, real_t v) const;
 
+  /*! Extracts the Bezier patches of \e self by knot insertion and keeps them in a cache.
+      getPointAt, getDerivativeAt, getNormalAt and evaluateGrid then evaluate the polynomial
+      of the segment containing the parameters instead of the de Boor path.
+      The cache is no longer used once the control point matrix, the knot lists or the degrees are
+      replaced or modified (see the modification stamp of the arrays). Writes through references to
+      their elements should be followed by a call to touch on the array, or to clearBezierCache.
+      Returns false if the knot lists are not clamped. */
+  bool buildBezierCache();
+
+  /// Removes the Bezier extraction cache.
+  void clearBezierCache();
+
+  /// Returns whether a Bezier extraction cache corresponding to the current patch is available.
+  bool hasBezierCache() const;
+
 
 
 
@@ -322,6 +348,32 @@ protected:
   /// The \b vdegree field.
   uint_t __vdegree;
 
+  /// Bezier patches extracted from the patch.
+  struct BezierCache {
+      /// Control points of all the Bezier patches. Patch (i,j) starts at row i*(udegree+1) and column j*(vdegree+1).
+      Point4MatrixPtr ctrlPointMatrix;
+      /// Parameter values delimiting the Bezier patches along u.
+      std::vector<real_t> ubreaks;
+      /// Parameter values delimiting the Bezier patches along v.
+      std::vector<real_t> vbreaks;
+      /// Fields of the patch used for the extraction.
+      Point4MatrixPtr source;
+      RealArrayPtr uknots;
+      RealArrayPtr vknots;
+      /// Modification stamps of the fields used for the extraction.
+      size_t sourceStamp;
+      size_t uknotsStamp;
+      size_t vknotsStamp;
+      uint_t udegree;
+      uint_t vdegree;
+  };
+
+  /// The Bezier extraction cache.
+  BezierCache __bezierCache;
+
+  /// Computes the homogeneous derivatives up to degree \e d from the Bezier extraction cache.
+  Point4MatrixPtr bezierDeriveAtH(real_t u, real_t v, int d) const;
+
 }; // NurbsPatch
 
 /// NurbsPatch Pointer
@@ -0,0 +1,327 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "flatscene.h"
+#include <plantgl/pgl_scene.h>
+#include <plantgl/pgl_geometry.h>
+#include <plantgl/pgl_appearance.h>
+#include <plantgl/pgl_transformation.h>
+#include <plantgl/scenegraph/geometry/text.h>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const uint_t FlatScene::NO_INDEX = uint_t(-1);
+
+/* ----------------------------------------------------------------------- */
+
+// Action that records the nodes of a scene in depth first order.
+class FlatScene::Compiler : public Action {
+public:
+    Compiler(FlatScene& flat) : __flat(flat), __parent(NO_INDEX), __matrix(0) { }
+
+    virtual ~Compiler() { }
+
+    void compile(const Scene& scene) {
+        for (Scene::const_iterator it = scene.begin(); it != scene.end(); ++it)
+            visit(*it);
+    }
+
+    bool process( Shape * shape ) {
+        uint_t id = open(shape, shape, eShape);
+        if (__parent == NO_INDEX) __flat.__shapes.push_back(id);
+        uint_t parent = enter(id);
+        visit(shape->getGeometry());
+        visit(shape->getAppearance());
+        close(id, parent);
+        return true;
+    }
+
+    bool process( Inline * geomInline ) {
+        uint_t id = open(geomInline, geomInline, eInline);
+        if (__parent == NO_INDEX) __flat.__shapes.push_back(id);
+        uint_t parent = enter(id);
+        uint_t matrix = __matrix;
+        if (__matrix != NO_INDEX)
+            pushMatrix(Matrix4::translation(geomInline->getTranslation()) * Matrix4(Matrix3::scaling(geomInline->getScale())));
+        if (geomInline->getScene()) compile(*geomInline->getScene());
+        __matrix = matrix;
+        close(id, parent);
+        return true;
+    }
+
+#define PGL_FLATSCENE_LEAF(T) \
+    bool process( T * obj ) { close(open(obj, obj, e##T), __parent); return true; }
+
+    PGL_FLATSCENE_LEAF(Material)
+    PGL_FLATSCENE_LEAF(MonoSpectral)
+    PGL_FLATSCENE_LEAF(MultiSpectral)
+    PGL_FLATSCENE_LEAF(ImageTexture)
+    PGL_FLATSCENE_LEAF(Texture2DTransformation)
+    PGL_FLATSCENE_LEAF(AmapSymbol)
+    PGL_FLATSCENE_LEAF(AsymmetricHull)
+    PGL_FLATSCENE_LEAF(BezierCurve)
+    PGL_FLATSCENE_LEAF(BezierPatch)
+    PGL_FLATSCENE_LEAF(Box)
+    PGL_FLATSCENE_LEAF(Cone)
+    PGL_FLATSCENE_LEAF(Cylinder)
+    PGL_FLATSCENE_LEAF(ElevationGrid)
+    PGL_FLATSCENE_LEAF(FaceSet)
+    PGL_FLATSCENE_LEAF(Frustum)
+    PGL_FLATSCENE_LEAF(NurbsCurve)
+    PGL_FLATSCENE_LEAF(NurbsPatch)
+    PGL_FLATSCENE_LEAF(Paraboloid)
+    PGL_FLATSCENE_LEAF(PointSet)
+    PGL_FLATSCENE_LEAF(Polyline)
+    PGL_FLATSCENE_LEAF(QuadSet)
+    PGL_FLATSCENE_LEAF(Sphere)
+    PGL_FLATSCENE_LEAF(TriangleSet)
+    PGL_FLATSCENE_LEAF(BezierCurve2D)
+    PGL_FLATSCENE_LEAF(Disc)
+    PGL_FLATSCENE_LEAF(NurbsCurve2D)
+    PGL_FLATSCENE_LEAF(PointSet2D)
+    PGL_FLATSCENE_LEAF(Polyline2D)
+    PGL_FLATSCENE_LEAF(Font)
+
+#undef PGL_FLATSCENE_LEAF
+
+    bool process( Texture2D * texture ) {
+        uint_t id = open(texture, texture, eTexture2D);
+        uint_t parent = enter(id);
+        visit(texture->getImage());
+        visit(texture->getTransformation());
+        close(id, parent);
+        return true;
+    }
+
+    bool process( ExtrudedHull * extrudedHull ) {
+        uint_t id = open(extrudedHull, extrudedHull, eExtrudedHull);
+        uint_t parent = enter(id);
+        visit(extrudedHull->getVertical());
+        visit(extrudedHull->getHorizontal());
+        close(id, parent);
+        return true;
+    }
+
+    bool process( Extrusion * extrusion ) {
+        uint_t id = open(extrusion, extrusion, eExtrusion);
+        uint_t parent = enter(id);
+        visit(extrusion->getAxis());
+        visit(extrusion->getCrossSection());
+        close(id, parent);
+        return true;
+    }
+
+    bool process( Group * group ) {
+        uint_t id = open(group, group, eGroup);
+        uint_t parent = enter(id);
+        const GeometryArrayPtr& geometries = group->getGeometryList();
+        if (geometries)
+            for (GeometryArray::const_iterator it = geometries->begin(); it != geometries->end(); ++it)
+                visit(*it);
+        close(id, parent);
+        return true;
+    }
+
+    bool process( Revolution * revolution ) {
+        uint_t id = open(revolution, revolution, eRevolution);
+        uint_t parent = enter(id);
+        visit(revolution->getProfile());
+        close(id, parent);
+        return true;
+    }
+
+    bool process( Swung * swung ) {
+        uint_t id = open(swung, swung, eSwung);
+        uint_t parent = enter(id);
+        const Curve2DArrayPtr& profiles = swung->getProfileList();
+        if (profiles)
+            for (Curve2DArray::const_iterator it = profiles->begin(); it != profiles->end(); ++it)
+                visit(*it);
+        close(id, parent);
+        return true;
+    }
+
+    bool process( Text * text ) {
+        uint_t id = open(text, text, eText);
+        uint_t parent = enter(id);
+        visit(text->getFontStyle());
+        close(id, parent);
+        return true;
+    }
+
+    bool process( AxisRotated * axisRotated ) { return matrixTransformed(axisRotated, eAxisRotated); }
+    bool process( EulerRotated * eulerRotated ) { return matrixTransformed(eulerRotated, eEulerRotated); }
+    bool process( Oriented * oriented ) { return matrixTransformed(oriented, eOriented); }
+    bool process( Scaled * scaled ) { return matrixTransformed(scaled, eScaled); }
+    bool process( Translated * translated ) { return matrixTransformed(translated, eTranslated); }
+
+    bool process( IFS * ifs ) { return nonLinearTransformed(ifs, eIFS); }
+    bool process( ScreenProjected * scp ) { return nonLinearTransformed(scp, eScreenProjected); }
+    bool process( Tapered * tapered ) { return nonLinearTransformed(tapered, eTapered); }
+
+protected:
+
+    template<class T>
+    inline void visit(const RCPtr<T>& obj) { if (obj) obj->apply(*this); }
+
+    uint_t open(void * obj, SceneObject * sobj, Tag tag) {
+        Node node;
+        node.object = obj;
+        node.sceneObject = sobj;
+        node.tag = uchar_t(tag);
+        node.parent = __parent;
+        node.subtreeSize = 1;
+        node.matrix = __matrix;
+        __flat.__nodes.push_back(node);
+        return uint_t(__flat.__nodes.size() - 1);
+    }
+
+    inline uint_t enter(uint_t id) { uint_t parent = __parent; __parent = id; return parent; }
+
+    inline void close(uint_t id, uint_t parent) {
+        __flat.__nodes[id].subtreeSize = uint_t(__flat.__nodes.size()) - id;
+        __parent = parent;
+    }
+
+    void pushMatrix(const Matrix4& transformation) {
+        Matrix4 matrix = __flat.__matrices[__matrix] * transformation;
+        __flat.__matrices.push_back(matrix);
+        __matrix = uint_t(__flat.__matrices.size() - 1);
+    }
+
+    template<class T>
+    bool matrixTransformed(T * obj, Tag tag) {
+        uint_t id = open(obj, obj, tag);
+        uint_t parent = enter(id);
+        uint_t matrix = __matrix;
+        if (__matrix != NO_INDEX) {
+            Matrix4TransformationPtr transformation = dynamic_pointer_cast<Matrix4Transformation>(obj->getTransformation());
+            if (transformation) pushMatrix(transformation->getMatrix());
+            else __matrix = NO_INDEX;
+        }
+        visit(obj->getGeometry());
+        __matrix = matrix;
+        close(id, parent);
+        return true;
+    }
+
+    template<class T>
+    bool nonLinearTransformed(T * obj, Tag tag) {
+        uint_t id = open(obj, obj, tag);
+        uint_t parent = enter(id);
+        uint_t matrix = __matrix;
+        __matrix = NO_INDEX;
+        visit(obj->getGeometry());
+        __matrix = matrix;
+        close(id, parent);
+        return true;
+    }
+
+    FlatScene& __flat;
+    uint_t __parent;
+    uint_t __matrix;
+};
+
+/* ----------------------------------------------------------------------- */
+
+FlatScene::FlatScene( const ScenePtr& scene ) :
+    RefCountObject(),
+    __scene(scene)
+{
+    __matrices.push_back(Matrix4::IDENTITY);
+    if (__scene) {
+        __scene->lock();
+        Compiler compiler(*this);
+        compiler.compile(*__scene);
+        __scene->unlock();
+    }
+}
+
+FlatScene::~FlatScene( )
+{
+}
+
+const char * FlatScene::getTagName( uchar_t tag )
+{
+#define PGL_FLATSCENE_TAGNAME(T) #T,
+    static const char * TAGNAMES[] = { PGL_FLATSCENE_TYPES(PGL_FLATSCENE_TAGNAME) "Unknown" };
+#undef PGL_FLATSCENE_TAGNAME
+    return TAGNAMES[tag < eNbTags ? tag : eNbTags];
+}
+
+bool FlatScene::apply( Action& action ) const
+{
+    bool result;
+    if ( ! (result = action.beginProcess()) ) return false;
+    for (std::vector<uint_t>::const_iterator it = __shapes.begin(); it != __shapes.end(); ++it)
+        if (! dispatch(*it, action)) result = false;
+    action.endProcess();
+    return result;
+}
+
+bool FlatScene::applyGeometryOnly( Action& action ) const
+{
+    bool result;
+    if ( ! (result = action.beginProcess()) ) return false;
+    for (std::vector<uint_t>::const_iterator it = __shapes.begin(); it != __shapes.end(); ++it) {
+        const Node& node = __nodes[*it];
+        if (node.tag == eShape) {
+            if (static_cast<Shape *>(node.object)->getGeometry()) {
+                if (! dispatch(*it + 1, action)) result = false;
+            }
+            else result = false;
+        }
+        else if (! static_cast<Inline *>(node.object)->applyGeometryOnly(action)) result = false;
+    }
+    action.endProcess();
+    return result;
+}
+
+std::vector<uint_t> FlatScene::getTagCount( ) const
+{
+    std::vector<uint_t> result(eNbTags, 0);
+    for (std::vector<Node>::const_iterator it = __nodes.begin(); it != __nodes.end(); ++it)
+        ++result[it->tag];
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
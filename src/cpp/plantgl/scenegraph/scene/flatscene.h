@@ -0,0 +1,228 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file flatscene.h
+    \brief Definition of the FlatScene class.
+*/
+
+#ifndef __flatscene_h__
+#define __flatscene_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "scene.h"
+#include "../core/action.h"
+#include <plantgl/math/util_matrix.h>
+#include <plantgl/tool/util_parallel.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// List of the types of objects that can be processed by an Action.
+#define PGL_FLATSCENE_TYPES(X) \
+    X(Shape) X(Inline) \
+    X(Material) X(MonoSpectral) X(MultiSpectral) X(Texture2D) X(ImageTexture) X(Texture2DTransformation) \
+    X(AmapSymbol) X(AsymmetricHull) X(AxisRotated) X(BezierCurve) X(BezierPatch) X(Box) X(Cone) \
+    X(Cylinder) X(ElevationGrid) X(EulerRotated) X(ExtrudedHull) X(FaceSet) X(Frustum) X(Extrusion) \
+    X(Group) X(IFS) X(NurbsCurve) X(NurbsPatch) X(Oriented) X(Paraboloid) X(PointSet) X(Polyline) \
+    X(QuadSet) X(Revolution) X(Swung) X(Scaled) X(ScreenProjected) X(Sphere) X(Tapered) X(Translated) \
+    X(TriangleSet) X(BezierCurve2D) X(Disc) X(NurbsCurve2D) X(PointSet2D) X(Polyline2D) \
+    X(Text) X(Font)
+
+/**
+   \class FlatScene
+   \brief A Scene compiled into a flat list of nodes.
+
+   Nodes are stored in depth first order with a type tag. The children of a
+   node \e i are stored in [\e i+1, \e i+getSubtreeSize(i)[. For each node,
+   the matrix of the transformations of its ancestors is precomputed when
+   these transformations are all linear.
+
+   The flat list can be traversed with a switch on the type tags instead of
+   virtual calls and reference counting. A visitor is any object with a
+   \c process(T*) function for each type T (an Action for instance).
+   The objects are kept alive by the FlatScene but it should be rebuilt if the
+   scene is modified.
+*/
+
+class SG_API FlatScene : public RefCountObject
+{
+
+public:
+
+#define PGL_FLATSCENE_TAG(T) e##T,
+  /// Type tags of the nodes.
+  enum Tag { PGL_FLATSCENE_TYPES(PGL_FLATSCENE_TAG) eNbTags };
+#undef PGL_FLATSCENE_TAG
+
+  /// Index used for nodes without parent or without linear transformation.
+  static const uint_t NO_INDEX;
+
+  /// A node of the flat list.
+  struct Node {
+    /// Pointer on the object, of the type given by tag.
+    void * object;
+    /// The object as a SceneObject.
+    SceneObject * sceneObject;
+    /// The type tag.
+    uchar_t tag;
+    /// Index of the parent node.
+    uint_t parent;
+    /// Number of nodes of the subtree of this node, including itself.
+    uint_t subtreeSize;
+    /// Index of the matrix of the transformations of the ancestors.
+    uint_t matrix;
+  };
+
+  /// Compiles the scene \e scene.
+  FlatScene( const ScenePtr& scene );
+
+  /// Destructor.
+  virtual ~FlatScene( );
+
+  /// Returns the compiled scene.
+  inline const ScenePtr& getScene( ) const { return __scene; }
+
+  /// Returns the number of nodes.
+  inline uint_t size( ) const { return uint_t(__nodes.size()); }
+
+  /// Returns the \e i-th node.
+  inline const Node& getNode( uint_t i ) const { return __nodes[i]; }
+
+  /// Returns the nodes.
+  inline const std::vector<Node>& getNodes( ) const { return __nodes; }
+
+  /// Returns the indices of the nodes of the shapes of the scene.
+  inline const std::vector<uint_t>& getShapeNodes( ) const { return __shapes; }
+
+  /// Returns the index of the next sibling of node \e i (or of an ancestor).
+  inline uint_t getNextNode( uint_t i ) const { return i + __nodes[i].subtreeSize; }
+
+  /// Returns whether the transformations of the ancestors of node \e i are linear.
+  inline bool hasWorldMatrix( uint_t i ) const { return __nodes[i].matrix != NO_INDEX; }
+
+  /** Returns the matrix of the transformations of the ancestors of node \e i.
+      \pre hasWorldMatrix(i) */
+  inline const Matrix4& getWorldMatrix( uint_t i ) const { return __matrices[__nodes[i].matrix]; }
+
+  /// Returns the name of the type \e tag.
+  static const char * getTagName( uchar_t tag );
+
+  /** Calls \e visitor.process on the object of node \e i with its actual type.
+      Returns the result of the process function. */
+  template<class Visitor>
+  inline bool dispatch( uint_t i, Visitor& visitor ) const {
+    const Node& node = __nodes[i];
+    switch(node.tag) {
+#define PGL_FLATSCENE_DISPATCH(T) case e##T : return visitor.process(static_cast<T *>(node.object));
+      PGL_FLATSCENE_TYPES(PGL_FLATSCENE_DISPATCH)
+#undef PGL_FLATSCENE_DISPATCH
+      default : return false;
+    }
+  }
+
+  /** Visits the nodes of [\e begin, \e end[ in depth first order.
+      When the process function of the visitor returns false, the children
+      of the node are skipped. The visitor should not recurse on the children
+      itself, contrary to Action. */
+  template<class Visitor>
+  void traverse( Visitor& visitor, uint_t begin, uint_t end ) const {
+    for (uint_t i = begin; i < end; ) {
+      if (dispatch(i, visitor)) ++i;
+      else i = getNextNode(i);
+    }
+  }
+
+  /// Visits all the nodes in depth first order.
+  template<class Visitor>
+  inline void traverse( Visitor& visitor ) const { traverse(visitor, 0, size()); }
+
+  /** Calls \e func(shapeid, nodeid) for each shape of the scene.
+      If \e parallel, shapes are distributed on several threads and \e func must be thread safe. */
+  template<class Function>
+  void forEachShape( Function func, bool parallel = false ) const {
+    if (parallel) pgl_parallel_for(0, __shapes.size(), [this,&func](size_t s) { func(uint_t(s), __shapes[s]); });
+    else for (uint_t s = 0; s < __shapes.size(); ++s) func(s, __shapes[s]);
+  }
+
+  /** Applies \e action on each shape as Scene::apply but with
+      dispatch on type tags. \e action recurses on the shapes itself. */
+  bool apply( Action& action ) const;
+
+  /** Applies \e action on the geometry of each shape as Scene::applyGeometryOnly. */
+  bool applyGeometryOnly( Action& action ) const;
+
+  /// Returns the number of nodes of each type.
+  std::vector<uint_t> getTagCount( ) const;
+
+protected:
+
+  class Compiler;
+  friend class Compiler;
+
+  /// The compiled scene.
+  ScenePtr __scene;
+
+  /// The nodes in depth first order.
+  std::vector<Node> __nodes;
+
+  /// The nodes of the shapes.
+  std::vector<uint_t> __shapes;
+
+  /// The matrices of the nodes.
+  std::vector<Matrix4> __matrices;
+
+};
+
+/// FlatScene Pointer
+typedef RCPtr<FlatScene> FlatScenePtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __flatscene_h__
+#endif
@@ -74,7 +74,8 @@ using namespace std;
 
 Scene::Scene(unsigned int size ) :
   RefCountObject(),
-  __shapeList(size,Shape3DPtr())
+  __shapeList(size,Shape3DPtr()),
+  __objectPoolTeardown(false)
   {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
@@ -86,7 +87,8 @@ Scene::Scene(unsigned int size ) :
 }
 
 Scene::Scene(const Scene& scene) :
-  RefCountObject()
+  RefCountObject(),
+  __objectPoolTeardown(false)
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
@@ -101,7 +103,8 @@ Scene::Scene(const Scene& scene) :
 }
 
 Scene::Scene(const Scene::const_iterator begin, const Scene::const_iterator end) :
-  RefCountObject()
+  RefCountObject(),
+  __objectPoolTeardown(false)
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
@@ -125,7 +128,8 @@ Scene& Scene::operator=( const Scene& scene){
 
 Scene::Scene(const string& filename, const std::string& format, ostream& errlog, int max_error ) :
   RefCountObject(),
-  __shapeList()
+  __shapeList(),
+  __objectPoolTeardown(false)
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
@@ -139,7 +143,8 @@ Scene::Scene(const string& filename, const std::string& format, ostream& errlog,
 
 Scene::Scene(const SceneObjectSymbolTable& table) :
   RefCountObject(),
-  __shapeList()
+  __shapeList(),
+  __objectPoolTeardown(false)
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
@@ -202,6 +207,12 @@ Scene::~Scene( ){
 #ifdef WITH_POOL
       POOL.unregisterScene(this);
 #endif
+  if (__objectPool && __objectPoolTeardown) {
+    // The objects of the scene are deleted and the memory of the pool is freed at once.
+    __objectPool->beginTeardown();
+    __shapeList.clear();
+    __objectPool->releaseAll();
+  }
 #ifdef PGL_THREAD_SUPPORT
     if (__mutex)delete __mutex;
 #endif
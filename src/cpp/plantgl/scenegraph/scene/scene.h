@@ -51,6 +51,7 @@
 
 #include <vector>
 #include <plantgl/tool/util_hashmap.h>
+#include <plantgl/tool/util_objectpool.h>
 #include "plantgl/scenegraph/core/sceneobject.h"
 #include "shape.h"
 
@@ -230,6 +231,19 @@ public:
   void lock() const ;
   void unlock() const;
 
+  /** The pool in which the objects of \e self have been allocated.
+      It is kept alive with \e self and its memory is freed once all its objects are deleted. */
+  inline const ObjectPoolPtr& getObjectPool() const { return __objectPool; }
+
+  /** Set the pool of \e self. If \e teardown, the memory of all the objects of the pool is
+      freed at once when \e self is deleted (see ObjectPool::releaseAll). The objects of the pool
+      should then be referenced only by \e self. */
+  inline void setObjectPool(const ObjectPoolPtr& pool, bool teardown = false)
+  { __objectPool = pool; __objectPoolTeardown = teardown; }
+
+  /// Whether the memory of the pool of \e self is freed at once when \e self is deleted.
+  inline bool isObjectPoolTeardown() const { return __objectPoolTeardown; }
+
   void sort();
 
 #ifndef PGL_NO_DEPRECATED
@@ -259,6 +273,10 @@ protected:
 
   PglMutex* __mutex;
 
+  ObjectPoolPtr __objectPool;
+
+  bool __objectPoolTeardown;
+
 public:
 
     /// A Scene Pool class
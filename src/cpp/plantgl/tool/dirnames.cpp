@@ -122,9 +122,9 @@ string get_dirname(const string & filename) {
 #else
         size_t slashit = filename.rfind("/");
         size_t backslashit = filename.rfind("\\");
-        if (slashit == std::string::npos && backslashit == std::string::npos) return filename;
+        if (slashit == std::string::npos && backslashit == std::string::npos) return ".";
         size_t end = slashit;
-        if (slashit == std::string::npos || slashit <   backslashit)
+        if (slashit == std::string::npos || (backslashit != std::string::npos && slashit < backslashit))
                 end = backslashit;
         return std::string(filename.begin(), filename.begin()+end);
 
@@ -140,7 +140,7 @@ string get_filename(const string & filename) {
         size_t backslashit = filename.rfind("\\");
         if (slashit == std::string::npos && backslashit == std::string::npos) return filename;
         size_t begin = slashit;
-        if (slashit == std::string::npos || slashit <   backslashit)
+        if (slashit == std::string::npos || (backslashit != std::string::npos && slashit < backslashit))
                 begin = backslashit;
         return std::string(filename.begin()+begin+1, filename.end());
 
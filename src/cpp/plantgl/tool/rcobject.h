@@ -398,6 +398,15 @@ public:
 
 #endif
 
+/// Start of the address range reserved for the memory of the ObjectPool (see util_objectpool.h).
+extern TOOLS_API uintptr_t pgl_pool_region_begin;
+
+/// Size of the address range reserved for the memory of the ObjectPool. 0 until a pool is created.
+extern TOOLS_API size_t pgl_pool_region_size;
+
+/// Initial value of the reference counter of an object allocated in an ObjectPool.
+TOOLS_API size_t pgl_pooled_initial_count( const void * ptr );
+
 //template<class Policy>
 class TOOLS_API RefCountObject
 {
@@ -406,9 +415,13 @@ public:
   /// @name Constructors
   //@{
 
+  /** Flag of the reference counter for objects confined to one thread.
+      Their counter is modified without atomic operations. */
+  static const size_t LOCAL_COUNT_FLAG = size_t(1) << (sizeof(size_t) * 8 - 1);
+
   /// Default constructor.
   RefCountObject( ) :
-    _ref_count(0)
+    _ref_count(initialCount(this))
 #ifdef WITH_REFCOUNTLISTENER
   ,_ref_count_listener(0)
 #endif
@@ -417,7 +430,7 @@ public:
 
   /// Copy constructor.
   RefCountObject( const RefCountObject& ) :
-    _ref_count(0)
+    _ref_count(initialCount(this))
 #ifdef WITH_REFCOUNTLISTENER
   ,_ref_count_listener(0)
 #endif
@@ -459,7 +472,9 @@ public:
   /// Increments the reference counter.
   inline void addReference( )
   {
-    ++_ref_count;
+    size_t count = _ref_count.load(std::memory_order_relaxed);
+    if (count & LOCAL_COUNT_FLAG) _ref_count.store(count + 1, std::memory_order_relaxed);
+    else ++_ref_count;
 #ifdef RCOBJECT_DEBUG
     std::cerr << this << " ref++ => " << getReferenceCount();
     std::cerr << "\t(" << typeid(*this).name() << ")" << std::endl;
@@ -472,34 +487,53 @@ public:
   /// Returns the number of reference to \e self.
   inline size_t use_count( ) const
   {
-    return _ref_count;
+    return _ref_count & ~LOCAL_COUNT_FLAG;
   }
 
 
   /// Returns whether \e self is shared.
   inline bool unique( ) const
   {
-    return _ref_count == 1;
+    return use_count() == 1;
   }
 
 #ifndef PGL_NO_DEPRECATED
   /// Returns the number of reference to \e self.
   attribute_deprecated inline size_t getReferenceCount( ) const
   {
-    return _ref_count;
+    return use_count();
   }
 
   /// Returns whether \e self is shared.
   attribute_deprecated inline bool isShared( ) const
   {
-    return _ref_count > 1;
+    return use_count() > 1;
   }
 #endif
 
+  /// Returns whether the reference counter of \e self is modified without atomic operations.
+  inline bool hasLocalReferenceCount( ) const
+  {
+    return (_ref_count & LOCAL_COUNT_FLAG) != 0;
+  }
+
+  /** Set whether the reference counter of \e self is modified without atomic operations.
+      \warning \e self should then be referenced by one thread only. */
+  inline void setLocalReferenceCount( bool local )
+  {
+    if (local) _ref_count |= LOCAL_COUNT_FLAG;
+    else _ref_count &= ~LOCAL_COUNT_FLAG;
+  }
+
   /// Decrements the reference counter.
   inline void removeReference( )
   {
-    size_t refcount = --_ref_count;
+    size_t refcount = _ref_count.load(std::memory_order_relaxed);
+    if (refcount & LOCAL_COUNT_FLAG) {
+      _ref_count.store(--refcount, std::memory_order_relaxed);
+      refcount &= ~LOCAL_COUNT_FLAG;
+    }
+    else refcount = --_ref_count;
 #ifdef RCOBJECT_DEBUG
     std::cerr << this << " ref-- => " << getReferenceCount();
     std::cerr << "\t(" << typeid(*this).name() << ")" << std::endl;
@@ -526,6 +560,12 @@ public:
 
 private:
 
+  /// Objects of a thread confined ObjectPool start with a local reference counter.
+  static inline size_t initialCount( const void * ptr )
+  {
+    return uintptr_t(ptr) - pgl_pool_region_begin < pgl_pool_region_size ? pgl_pooled_initial_count(ptr) : 0;
+  }
+
   std::atomic<size_t> _ref_count;
 
 #ifdef WITH_REFCOUNTLISTENER
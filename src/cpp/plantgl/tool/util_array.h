@@ -56,6 +56,7 @@
 #include <iostream>
 
 #include "rcobject.h"
+#include "util_objectpool.h"
 #include "tools_config.h"
 #include "classinfo.h"
 #include "../math/util_math.h"
@@ -130,19 +131,35 @@ typedef typename std::vector<element_type>::iterator iterator;
 
 /// Constructs an Array1 of size \e size
 PglVector( size_t size = 0 ) :
-        __A(size) {
+        __A(size),
+        __stamp(0) {
 }
 
 /// Constructs an Array1 with \e size copies of \e t.
 PglVector( size_t size, const T& t ) :
-        __A(size,t) {
+        __A(size,t),
+        __stamp(0) {
 }
 
 
 /// Constructs an Array1 with the range [\e begin, \e end).
 template <class InIterator>
 PglVector( InIterator begin, InIterator end ) :
-        __A(begin,end) {
+        __A(begin,end),
+        __stamp(0) {
+}
+
+/// Copy constructor.
+PglVector( const PglVector& t ) :
+        __A(t.__A),
+        __stamp(0) {
+}
+
+/// Assignment operator.
+PglVector& operator=( const PglVector& t ) {
+        __A = t.__A;
+        touch();
+        return *this;
 }
 
 /// Destructor
@@ -225,10 +242,12 @@ inline uint_t size( ) const {
 /// Clear \e self.
 inline void clear( ) {
         __A.clear();
+        touch();
 }
 
 /// Inserts \e t into \e self before the position pointed by \e it.
 iterator insert( iterator it, const T& t ) {
+        touch();
         return __A.insert(it,t);
 }
 
@@ -237,11 +256,13 @@ iterator insert( iterator it, const T& t ) {
 template <class InputIterator>
 void insert(iterator pos, InputIterator f, InputIterator l){
         __A.insert(pos,f,l);
+        touch();
 }
 
 /// Inserts \e t into \e self before the position pointed by \e it.
 PglVector& operator+=( const PglVector& t ) {
         __A.insert(__A.end(),t.begin(),t.end());
+        this->touch();
         return *this;
 }
 
@@ -296,16 +317,19 @@ friend std::ostream& operator<<(std::ostream& stream, const PglVector<T>& a){
 void setAt( uint_t i, const T& t ) {
         GEOM_ASSERT(i < __A.size());
         __A[i] = t;
+        touch();
 }
 
 /** push back \e t to \e self. */
 void push_back( const T& t ) {
         __A.push_back(t);
+        touch();
 }
 
 template <class InputIterator>
 void push_back( InputIterator first, InputIterator last  ) {
         __A.push_back(first, last);
+        touch();
 }
 
 /** increase \e self capacity to size.
@@ -314,14 +338,23 @@ void reserve( uint_t size ) {
         __A.reserve(size);
 }
 
+/** change \e self size to size. New elements are default constructed.
+ */
+void resize( uint_t size ) {
+        __A.resize(size);
+        touch();
+}
+
 
 /** erase \e pos to \e self and return the next element. */
 iterator erase(iterator pos) {
+        touch();
         return __A.erase(pos);
 }
 
 /** erase elements range \e [first,last)  of \e self and return the next element. */
 iterator erase(iterator first,iterator last) {
+        touch();
         return __A.erase(first,last);
 }
 
@@ -335,6 +368,18 @@ T * data() const {
 }
 void reverse( ) {
         std::reverse(__A.begin(),__A.end());
+        touch();
+}
+
+/// Returns a stamp changed by each modification of \e self through its member functions.
+inline size_t getModificationStamp( ) const {
+        return __stamp;
+}
+
+/** Marks \e self as modified. To be called after writing elements through
+    the references or iterators given by the non const accessors. */
+inline void touch( ) {
+        ++__stamp;
 }
 
 #ifndef PGL_NO_DEPRECATED
@@ -386,12 +431,15 @@ protected:
 /// The elements contained by \e self.
 std::vector<T> __A;
 
+/// The modification stamp of \e self.
+size_t __stamp;
+
 };
 
 /* ----------------------------------------------------------------------- */
 
 template <class T>
-class Array1 : public RefCountObject, public PglVector<T>
+class Array1 : public RefCountObject, public PglVector<T>, public PoolAllocated
 {
 public:
 /// Constructs an Array1 of size \e size
@@ -417,6 +465,7 @@ Array1( InIterator begin, InIterator end ) :
 /// Inserts \e t into \e self before the position pointed by \e it.
 Array1& operator+=( const Array1& t ) {
         PglVector<T>::__A.insert(PglVector<T>::end(),t.begin(),t.end());
+        this->touch();
         return *this;
 }
 };
@@ -489,6 +538,7 @@ NumericArray1<T>& operator+=(const NumericArray1<T>&a){
                 *_i2 += *_i1;
                 _i1++;
         }
+        this->touch();
         return *this;
 }
 
@@ -507,6 +557,7 @@ NumericArray1<T>& operator-=(const NumericArray1<T>& a){
                 *_i2 -= *_i1;
                 _i1++;
         }
+        this->touch();
         return *this;
 }
 
@@ -522,6 +573,7 @@ NumericArray1<T>& operator+=(T val){
             _i2 != this->__A.end(); _i2++) {
                 *_i2 += val;
         }
+        this->touch();
         return *this;
 }
 
@@ -537,6 +589,7 @@ NumericArray1<T>& operator -= ( T val ){
             _i2 != this->__A.end(); _i2++) {
                 *_i2 -= val;
         }
+        this->touch();
         return *this;
 }
 
@@ -552,6 +605,7 @@ NumericArray1<T>& operator *= (T val){
             _i2 != this->__A.end(); _i2++) {
                 *_i2 *= val;
         }
+        this->touch();
         return *this;
 }
 
@@ -567,6 +621,7 @@ NumericArray1<T>& operator /= (T val){
             _i2 != this->__A.end(); _i2++) {
                 *_i2 /= val;
         }
+        this->touch();
         return *this;
 }
 
@@ -723,6 +778,7 @@ RealArray& operator+=(const RealArray&a){
                 *_i2 += *_i1;
                 _i1++;
         }
+        this->touch();
         return *this;
 }
 
@@ -741,6 +797,7 @@ RealArray& operator-=(const RealArray& a){
                 *_i2 -= *_i1;
                 _i1++;
         }
+        this->touch();
         return *this;
 }
 
@@ -755,6 +812,7 @@ RealArray& operator+=(real_t val){
         for(iterator _i2 = __A.begin(); _i2 != __A.end(); _i2++) {
                 *_i2 += val;
         }
+        this->touch();
         return *this;
 }
 
@@ -769,6 +827,7 @@ RealArray& operator -= (real_t val ){
         for(iterator _i2 = __A.begin(); _i2 != __A.end(); _i2++) {
                 *_i2 -= val;
         }
+        this->touch();
         return *this;
 }
 
@@ -783,6 +842,7 @@ RealArray& operator *= (real_t val){
         for(iterator _i2 = __A.begin(); _i2 != __A.end(); _i2++) {
                 *_i2 *= val;
         }
+        this->touch();
         return *this;
 }
 
@@ -797,6 +857,7 @@ RealArray& operator /= (real_t val){
         for(iterator _i2 =__A.begin(); _i2 != __A.end(); _i2++) {
                 *_i2 /= val;
         }
+        this->touch();
         return *this;
 }
 
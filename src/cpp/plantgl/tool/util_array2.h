@@ -52,6 +52,7 @@
 #include "tools_config.h"
 
 #include "rcobject.h"
+#include "util_objectpool.h"
 #include "classinfo.h"
 
 #include <vector>
@@ -71,7 +72,7 @@ PGL_BEGIN_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
 template <class T>
-class Array2 : public RefCountObject
+class Array2 : public RefCountObject, public PoolAllocated
 {
 
 public:
@@ -89,7 +90,8 @@ public:
   Array2( uint_t row = 0, uint_t col = 0 ) :
     RefCountObject(),
       __A(col*row),
-      __rowSize(col)
+      __rowSize(col),
+      __stamp(0)
       {
  }
 
@@ -97,7 +99,8 @@ public:
   Array2( uint_t row, uint_t col, const T& t ) :
     RefCountObject(),
       __A((unsigned int)(col*row),t),
-      __rowSize(col)
+      __rowSize(col),
+      __stamp(0)
       {
   }
 
@@ -106,7 +109,8 @@ public:
   Array2( InIterator begin, InIterator end, uint_t rowsSize ) :
     RefCountObject(),
       __A(begin,end),
-      __rowSize(rowsSize)
+      __rowSize(rowsSize),
+      __stamp(0)
       {
   }
 
@@ -118,6 +122,7 @@ public:
   Array2<T>& operator=(const Array2<T>& m){
     __A = std::vector<T>(m.__A);
     __rowSize = m.getRowSize();
+    touch();
     return *this;
   }
 
@@ -125,12 +130,14 @@ public:
   virtual void resize(const uint_t nr, const uint_t nc){
       __A = std::vector<T> (nr * nc);
       __rowSize = nc;
+      touch();
   }
 
   /// Changes the matrix dimensions.
   virtual void reshape(const uint_t nr, const uint_t nc){
       assert(__A.size() == nr*nc);
       __rowSize = nc;
+      touch();
   }
 
   /// Returns whether \e self contain \e t.
@@ -188,7 +195,7 @@ public:
   inline bool empty( ) const { return __A.empty(); }
 
   /// Clear \e self.
-  inline void clear( ) { __A.clear(); __rowSize = 0; }
+  inline void clear( ) { __A.clear(); __rowSize = 0; touch(); }
 
   /// data
   inline const T * data( ) const { return __A.data(); }
@@ -260,6 +267,7 @@ public:
       if(!__rowSize) { _pos = __A.begin(); __rowSize = nrsize; }
       else _pos = beginRow(j);
       __A.insert(_pos, begin,end);
+      touch();
   }
 
   /// Insert \e t into \e self before the position pointed by \e i.
@@ -283,6 +291,7 @@ public:
                _pos = __A.insert(_pos,*_k);
           };
       }
+      touch();
   }
 
   /// Inserts a row \e t at the end.
@@ -291,6 +300,7 @@ public:
     GEOM_ASSERT( __rowSize == 0 || distance(begin,end) == getRowSize() );
     __A.insert(__A.end(),begin,end);
     if (__rowSize == 0) __rowSize = __A.size();
+    touch();
    }
 
   /// Inserts a row \e t at the end.
@@ -327,8 +337,16 @@ public:
   void setAt( uint_t r, uint_t c, const T& t ) {
       GEOM_ASSERT(r < getRowNb() && c < getColumnNb() );
       __A[((r*getRowSize())+c)] = t;
+      touch();
   }
 
+  /// Returns a stamp changed by each modification of \e self through its member functions.
+  inline size_t getModificationStamp( ) const { return __stamp; }
+
+  /** Marks \e self as modified. To be called after writing elements through
+      the references or iterators given by the non const accessors. */
+  inline void touch( ) { ++__stamp; }
+
   /** returns the matrix of size \e (nr,nc) starting at \e (rw,cl).
       \params
       - rw the index of the row
@@ -426,6 +444,9 @@ protected:
 
   /// The number of row of \e self.
   uint_t __rowSize;
+
+  /// The modification stamp of \e self.
+  size_t __stamp;
 };
 
 
@@ -550,6 +571,7 @@ public:
           *_i2 += *_i1;
           _i1++;
       }
+      this->touch();
       return *this;
   }
 
@@ -568,6 +590,7 @@ public:
           *_i2 -= *_i1;
           _i1++;
       }
+      this->touch();
       return *this;
   }
 
@@ -584,6 +607,7 @@ public:
           _i2 != this->__A.end(); _i2++){
           *_i2 -= val;
       }
+      this->touch();
       return *this;
   }
 
@@ -601,6 +625,7 @@ public:
           _i2 != this->__A.end(); _i2++){
           *_i2 -= val;
       }
+      this->touch();
       return *this;
   }
 
@@ -616,6 +641,7 @@ public:
           _i2 != this->__A.end(); _i2++){
           *_i2 *= val;
       }
+      this->touch();
       return *this;
   }
 
@@ -631,6 +657,7 @@ public:
           _i2 != this->__A.end(); _i2++){
           *_i2 /= val;
       }
+      this->touch();
       return *this;
   }
 
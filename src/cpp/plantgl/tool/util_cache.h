@@ -64,12 +64,12 @@ PGL_BEGIN_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
 
-template <class T>
+template <class T, class Key = size_t>
 class Cache {
 
 public:
 
-  typedef typename pgl_hash_map<size_t,T> maptype;
+  typedef typename pgl_hash_map<Key,T> maptype;
 
   /// A const iterator used to iterate through the cache.
   typedef typename maptype::const_iterator const_Iterator;
@@ -113,17 +113,17 @@ public:
   }
 
   /// Returns an iterator to the object identified with \e id.
-  inline Iterator find( size_t id ) {
+  inline Iterator find( Key id ) {
     return __cache.find(id);
   }
 
   /** Inserts into \e self the element \e t associated to the object
       identified with \e id. */
-  inline Iterator insert( size_t id, const T& t ) {
-    return __cache.insert(std::pair<size_t,T>(id,t)).first;
+  inline Iterator insert( Key id, const T& t ) {
+    return __cache.insert(std::pair<Key,T>(id,t)).first;
   }
 
-  inline void remove( size_t id ) {
+  inline void remove( Key id ) {
     Iterator _it = find(id);
     if(_it != end()) __cache.erase(_it);
   }
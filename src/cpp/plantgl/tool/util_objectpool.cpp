@@ -0,0 +1,474 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "util_objectpool.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// Objects are allocated by size classes of POOL_GRANULARITY bytes.
+// Bigger objects are allocated on the heap.
+#define POOL_GRANULARITY 16
+#define POOL_NB_CLASSES 32
+#define POOL_MAX_OBJECT_SIZE (POOL_GRANULARITY * POOL_NB_CLASSES)
+
+// Chunks are made of slots of the reserved address range. The pool of an object is the one of its slot.
+#define POOL_SLOT_SIZE (size_t(1) << 20)
+
+const size_t ObjectPool::DEFAULT_CHUNK_SIZE = POOL_SLOT_SIZE;
+
+uintptr_t PGL::pgl_pool_region_begin = 0;
+size_t PGL::pgl_pool_region_size = 0;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/** The address range reserved for the chunks of all the pools.
+    Memory is committed when a chunk is allocated and decommitted when it is freed. */
+class ObjectPoolRegion {
+public:
+    /// Returns the region, reserved at the first call.
+    static ObjectPoolRegion& get();
+
+    /// Returns NULL if no memory is available in the region.
+    char * allocateChunk(size_t size, ObjectPoolStorage * storage);
+    void freeChunk(char * chunk, size_t size);
+
+    /// The storage of the slot containing \e ptr, which should be in the region.
+    inline ObjectPoolStorage * storage(const void * ptr) const
+    { return __slots[(uintptr_t(ptr) - pgl_pool_region_begin) / POOL_SLOT_SIZE].load(std::memory_order_acquire); }
+
+protected:
+    ObjectPoolRegion();
+
+    char * __begin;
+    size_t __size;
+    char * __next;
+    std::atomic<ObjectPoolStorage *> * __slots;
+    /// The free ranges of slots, with their size.
+    std::vector<std::pair<char *, size_t> > __free;
+    std::mutex __mutex;
+};
+
+static char * reserveMemory(size_t size)
+{
+#ifdef _WIN32
+    return static_cast<char *>(VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS));
+#else
+    void * result = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return result == MAP_FAILED ? NULL : static_cast<char *>(result);
+#endif
+}
+
+static bool commitMemory(char * ptr, size_t size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+    return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+static void decommitMemory(char * ptr, size_t size)
+{
+#ifdef _WIN32
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+    mmap(ptr, size, PROT_NONE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+#endif
+}
+
+ObjectPoolRegion::ObjectPoolRegion():
+    __begin(NULL), __size(0), __next(NULL), __slots(NULL)
+{
+    for (size_t size = (sizeof(void *) == 8 ? size_t(1) << 36 : size_t(1) << 28); size >= 64 * POOL_SLOT_SIZE; size /= 2) {
+        if ((__begin = reserveMemory(size))) {
+            __size = size;
+            break;
+        }
+    }
+    __next = __begin;
+    size_t nbslots = __size / POOL_SLOT_SIZE;
+    __slots = new std::atomic<ObjectPoolStorage *>[nbslots];
+    for (size_t i = 0; i < nbslots; ++i) __slots[i].store(NULL, std::memory_order_relaxed);
+    pgl_pool_region_begin = uintptr_t(__begin);
+    pgl_pool_region_size = __size;
+}
+
+ObjectPoolRegion& ObjectPoolRegion::get()
+{
+    // Never deleted: objects of the pools may be deleted at exit.
+    static ObjectPoolRegion * region = new ObjectPoolRegion();
+    return *region;
+}
+
+char * ObjectPoolRegion::allocateChunk(size_t size, ObjectPoolStorage * storage)
+{
+    std::lock_guard<std::mutex> lock(__mutex);
+    char * chunk = NULL;
+    for (std::vector<std::pair<char *, size_t> >::iterator it = __free.begin(); it != __free.end(); ++it) {
+        if (it->second < size) continue;
+        chunk = it->first;
+        if (it->second == size) __free.erase(it);
+        else { it->first += size; it->second -= size; }
+        break;
+    }
+    if (!chunk) {
+        if (size > __size - size_t(__next - __begin)) return NULL;
+        chunk = __next;
+        __next += size;
+    }
+    if (!commitMemory(chunk, size)) {
+        __free.push_back(std::make_pair(chunk, size));
+        return NULL;
+    }
+    for (size_t slot = (chunk - __begin) / POOL_SLOT_SIZE, last = slot + size / POOL_SLOT_SIZE; slot < last; ++slot)
+        __slots[slot].store(storage, std::memory_order_release);
+    return chunk;
+}
+
+void ObjectPoolRegion::freeChunk(char * chunk, size_t size)
+{
+    std::lock_guard<std::mutex> lock(__mutex);
+    for (size_t slot = (chunk - __begin) / POOL_SLOT_SIZE, last = slot + size / POOL_SLOT_SIZE; slot < last; ++slot)
+        __slots[slot].store(NULL, std::memory_order_release);
+    decommitMemory(chunk, size);
+    __free.push_back(std::make_pair(chunk, size));
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// An object deleted by another thread than the one of its thread confined pool.
+struct RemoteFree {
+    RemoteFree * next;
+    size_t sizeclass;
+};
+
+class ObjectPoolStorage {
+public:
+    ObjectPoolStorage(bool threadConfined, size_t chunkSize);
+    ~ObjectPoolStorage();
+
+    /// Returns NULL if \e size is too big for the pool or if the pool cannot be used by this thread.
+    void * allocate(size_t size);
+    void deallocate(void * ptr, size_t size);
+
+    /// The pool handle is deleted. Storage is freed when no more object is alive.
+    void release();
+
+    /// Free all the chunks at once if no object is alive.
+    bool clear();
+
+    /// Free all the chunks at once. Returns the number of objects alive.
+    size_t releaseAll();
+
+    inline size_t liveCount() const { return __count.load() - 1; }
+
+    inline bool isOwnerThread() const { return std::this_thread::get_id() == __owner; }
+
+    inline void lock() { if (!__threadConfined) __mutex.lock(); }
+    inline void unlock() { if (!__threadConfined) __mutex.unlock(); }
+
+    /// Deletes \e self once the pool handle is released and all objects are deleted.
+    inline void unref() { if (__count.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this; }
+
+    /// Gives back the objects deleted by other threads to the free lists.
+    void drainRemoteFrees();
+
+    bool newChunk();
+    void freeChunks();
+
+    bool __threadConfined;
+    std::thread::id __owner;
+    size_t __chunkSize;
+    std::vector<char *> __chunks;
+    char * __current;
+    char * __end;
+    void * __freelists[POOL_NB_CLASSES];
+    /// The number of live objects, plus one while the pool handle exists.
+    std::atomic<size_t> __count;
+    std::atomic<RemoteFree *> __remoteFrees;
+    std::atomic<bool> __tearingDown;
+    std::mutex __mutex;
+};
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// Pool activated on the current thread
+static thread_local ObjectPool * CURRENT_POOL = NULL;
+static thread_local ObjectPoolStorage * CURRENT_STORAGE = NULL;
+
+/* ----------------------------------------------------------------------- */
+
+ObjectPoolStorage::ObjectPoolStorage(bool threadConfined, size_t chunkSize):
+    __threadConfined(threadConfined),
+    __owner(std::this_thread::get_id()),
+    __chunkSize((std::max<size_t>(chunkSize, 1) + POOL_SLOT_SIZE - 1) / POOL_SLOT_SIZE * POOL_SLOT_SIZE),
+    __current(NULL),
+    __end(NULL),
+    __count(1),
+    __remoteFrees(NULL),
+    __tearingDown(false)
+{
+    for (size_t i = 0; i < POOL_NB_CLASSES; ++i) __freelists[i] = NULL;
+}
+
+ObjectPoolStorage::~ObjectPoolStorage()
+{
+    freeChunks();
+}
+
+bool ObjectPoolStorage::newChunk()
+{
+    char * chunk = ObjectPoolRegion::get().allocateChunk(__chunkSize, this);
+    if (!chunk) return false;
+    __chunks.push_back(chunk);
+    __current = chunk;
+    __end = chunk + __chunkSize;
+    return true;
+}
+
+void ObjectPoolStorage::freeChunks()
+{
+    for (std::vector<char *>::const_iterator it = __chunks.begin(); it != __chunks.end(); ++it)
+        ObjectPoolRegion::get().freeChunk(*it, __chunkSize);
+    __chunks.clear();
+    __current = __end = NULL;
+    for (size_t i = 0; i < POOL_NB_CLASSES; ++i) __freelists[i] = NULL;
+    __remoteFrees.store(NULL);
+}
+
+void ObjectPoolStorage::drainRemoteFrees()
+{
+    RemoteFree * node = __remoteFrees.exchange(NULL, std::memory_order_acquire);
+    while (node) {
+        RemoteFree * next = node->next;
+        size_t sizeclass = node->sizeclass;
+        *reinterpret_cast<void **>(node) = __freelists[sizeclass];
+        __freelists[sizeclass] = node;
+        node = next;
+    }
+}
+
+void * ObjectPoolStorage::allocate(size_t size)
+{
+    if (size == 0 || size > POOL_MAX_OBJECT_SIZE) return NULL;
+    if (__threadConfined && !isOwnerThread()) return NULL;
+    size_t sizeclass = (size - 1) / POOL_GRANULARITY;
+    size_t allocsize = (sizeclass + 1) * POOL_GRANULARITY;
+    lock();
+    if (__threadConfined && __remoteFrees.load(std::memory_order_relaxed)) drainRemoteFrees();
+    void * result = __freelists[sizeclass];
+    if (result) __freelists[sizeclass] = *static_cast<void **>(result);
+    else {
+        if (__current + allocsize > __end && !newChunk()) {
+            unlock();
+            return NULL;
+        }
+        result = __current;
+        __current += allocsize;
+    }
+    unlock();
+    __count.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+void ObjectPoolStorage::deallocate(void * ptr, size_t size)
+{
+    // During a teardown, memory is not reused before all the chunks are freed.
+    if (!__tearingDown.load(std::memory_order_relaxed)) {
+        size_t sizeclass = (size - 1) / POOL_GRANULARITY;
+        if (__threadConfined && !isOwnerThread()) {
+            RemoteFree * node = static_cast<RemoteFree *>(ptr);
+            node->sizeclass = sizeclass;
+            node->next = __remoteFrees.load(std::memory_order_relaxed);
+            while (!__remoteFrees.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+        }
+        else {
+            lock();
+            *static_cast<void **>(ptr) = __freelists[sizeclass];
+            __freelists[sizeclass] = ptr;
+            unlock();
+        }
+    }
+    unref();
+}
+
+void ObjectPoolStorage::release()
+{
+    unref();
+}
+
+bool ObjectPoolStorage::clear()
+{
+    lock();
+    bool empty = (liveCount() == 0);
+    if (empty) freeChunks();
+    unlock();
+    return empty;
+}
+
+size_t ObjectPoolStorage::releaseAll()
+{
+    lock();
+    size_t live = liveCount();
+    freeChunks();
+    __count.store(1);
+    __tearingDown.store(false);
+    unlock();
+    return live;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void * PGL::pgl_pool_allocate( size_t size )
+{
+    if (CURRENT_STORAGE) {
+        void * result = CURRENT_STORAGE->allocate(size);
+        if (result) return result;
+    }
+    return ::operator new(size);
+}
+
+void PGL::pgl_pool_deallocate( void * ptr, size_t size )
+{
+    if (!ptr) return;
+    if (uintptr_t(ptr) - pgl_pool_region_begin < pgl_pool_region_size) {
+        // The memory of objects of a released pool is already given back.
+        ObjectPoolStorage * storage = ObjectPoolRegion::get().storage(ptr);
+        if (storage) storage->deallocate(ptr, size);
+    }
+    else ::operator delete(ptr);
+}
+
+size_t PGL::pgl_pooled_initial_count( const void * ptr )
+{
+    ObjectPoolStorage * storage = ObjectPoolRegion::get().storage(ptr);
+    return storage && storage->__threadConfined ? RefCountObject::LOCAL_COUNT_FLAG : 0;
+}
+
+/* ----------------------------------------------------------------------- */
+
+ObjectPool::ObjectPool(bool threadConfined, size_t chunkSize):
+    RefCountObject(),
+    __storage(new ObjectPoolStorage(threadConfined, chunkSize))
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+    __storage->release();
+}
+
+bool ObjectPool::isThreadConfined() const
+{
+    return __storage->__threadConfined;
+}
+
+size_t ObjectPool::getLiveObjectCount() const
+{
+    return __storage->liveCount();
+}
+
+size_t ObjectPool::getChunkCount() const
+{
+    __storage->lock();
+    size_t result = __storage->__chunks.size();
+    __storage->unlock();
+    return result;
+}
+
+size_t ObjectPool::getAllocatedSize() const
+{
+    return getChunkCount() * __storage->__chunkSize;
+}
+
+bool ObjectPool::clear()
+{
+    return __storage->clear();
+}
+
+size_t ObjectPool::releaseAll()
+{
+    return __storage->releaseAll();
+}
+
+void ObjectPool::beginTeardown()
+{
+    __storage->__tearingDown.store(true);
+}
+
+ObjectPool * ObjectPool::current()
+{
+    return CURRENT_POOL;
+}
+
+/* ----------------------------------------------------------------------- */
+
+ObjectPoolScope::ObjectPoolScope(const ObjectPoolPtr& pool):
+    __pool(pool),
+    __previous(CURRENT_POOL)
+{
+    CURRENT_POOL = __pool.get();
+    CURRENT_STORAGE = __pool ? __pool->__storage : NULL;
+}
+
+ObjectPoolScope::~ObjectPoolScope()
+{
+    CURRENT_POOL = __previous;
+    CURRENT_STORAGE = __previous ? __previous->__storage : NULL;
+}
+
+/* ----------------------------------------------------------------------- */
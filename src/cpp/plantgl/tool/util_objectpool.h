@@ -0,0 +1,168 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file util_objectpool.h
+    \brief Pool allocation of scene objects and arrays.
+*/
+
+#ifndef __util_objectpool_h__
+#define __util_objectpool_h__
+
+#include "tools_config.h"
+#include "rcobject.h"
+
+PGL_BEGIN_NAMESPACE
+
+class ObjectPoolStorage;
+
+/* ----------------------------------------------------------------------- */
+
+/// Allocates \e size bytes in the ObjectPool activated on the current thread, or on the heap.
+TOOLS_API void * pgl_pool_allocate( size_t size );
+
+/// Gives back the memory of an object of \e size bytes allocated with pgl_pool_allocate.
+TOOLS_API void pgl_pool_deallocate( void * ptr, size_t size );
+
+/**
+   \class PoolAllocated
+   \brief Base of the classes whose objects can be allocated in an ObjectPool.
+
+   Only these classes (scene objects and arrays) look up the pool activated on
+   the current thread when they are allocated. The memory of the pools is taken
+   from a reserved address range, so that no header is needed to find the pool
+   of an object when it is deleted.
+*/
+class TOOLS_API PoolAllocated {
+public:
+    static void * operator new( size_t size ) { return pgl_pool_allocate(size); }
+    static void operator delete( void * ptr, size_t size ) { pgl_pool_deallocate(ptr, size); }
+
+    /// Placement new.
+    static void * operator new( size_t, void * place ) { return place; }
+    static void operator delete( void *, void * ) { }
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ObjectPool
+   \brief A pool of memory for scene objects and arrays.
+
+   When a pool is activated on a thread (see ObjectPoolScope), the PoolAllocated
+   objects created by this thread are allocated in large chunks of the pool, with
+   free lists per object size. By default, memory of the chunks is given back
+   when the pool is released and all its objects are deleted. releaseAll frees
+   all the chunks at once instead, as done by a Scene owning its pool.
+
+   A thread confined pool belongs to the thread that created it. It takes no
+   lock and its objects have a non atomic reference counter, so that they should
+   be referenced by this thread only. Objects deleted by another thread are
+   given back to the pool by its own thread, and other threads allocate on the heap.
+*/
+
+class TOOLS_API ObjectPool : public RefCountObject {
+public:
+    static const size_t DEFAULT_CHUNK_SIZE;
+
+    /// Constructs a pool.
+    ObjectPool(bool threadConfined = false, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    /// Destructor. Memory is freed when all objects of the pool are deleted.
+    virtual ~ObjectPool();
+
+    bool isThreadConfined() const;
+
+    /// Number of objects of the pool not yet deleted.
+    size_t getLiveObjectCount() const;
+
+    /// Number of chunks allocated.
+    size_t getChunkCount() const;
+
+    /// Size in bytes of the chunks allocated.
+    size_t getAllocatedSize() const;
+
+    /// Free all the chunks at once. Only done if no object of the pool is alive. Return whether it was done.
+    bool clear();
+
+    /** Free all the chunks at once, whatever the objects of the pool still alive.
+        Their destructors are not called and they should not be used anymore.
+        Returns the number of objects that were alive. */
+    size_t releaseAll();
+
+    /** Deletions of objects of the pool do not maintain its free lists until releaseAll is called.
+        Used to delete a whole scene before freeing its memory. */
+    void beginTeardown();
+
+    /// Returns the pool activated on the current thread, if any.
+    static ObjectPool * current();
+
+protected:
+    friend class ObjectPoolScope;
+
+    ObjectPoolStorage * __storage;
+};
+
+typedef RCPtr<ObjectPool> ObjectPoolPtr;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ObjectPoolScope
+   \brief Activate a pool on the current thread during the lifetime of the scope.
+*/
+
+class TOOLS_API ObjectPoolScope {
+public:
+    ObjectPoolScope(const ObjectPoolPtr& pool);
+
+    ~ObjectPoolScope();
+
+    inline const ObjectPoolPtr& getPool() const { return __pool; }
+
+protected:
+    ObjectPoolPtr __pool;
+    ObjectPool * __previous;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+#endif
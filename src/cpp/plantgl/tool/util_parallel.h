@@ -0,0 +1,113 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file util_parallel.h
+    \brief Simple parallel loops on a range of indices.
+*/
+
+#ifndef __util_parallel_h__
+#define __util_parallel_h__
+
+#include "tools_config.h"
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Number of threads used by default by parallel loops.
+inline size_t pgl_thread_count()
+{
+    size_t nbthreads = std::thread::hardware_concurrency();
+    return nbthreads == 0 ? 1 : nbthreads;
+}
+
+/// Whether the calling thread already runs the tasks of a parallel loop or of a thread pool.
+TOOLS_API bool pgl_is_worker_thread();
+
+/// Declare the calling thread as a thread running the tasks of a parallel loop or of a thread pool.
+TOOLS_API void pgl_set_worker_thread(bool worker);
+
+/** Call \e func(i) for each i of [\e begin, \e end[ with \e nbthreads threads.
+    If \e nbthreads is 0, pgl_thread_count() threads are used. The range is split
+    in contiguous blocks of at least \e grain indices, one per thread.
+    The first exception raised by \e func is given back to the caller.
+    Loops nested in a parallel loop or in a task of a thread pool are run serially.
+    \warning \e func must be thread safe. */
+template<class Function>
+void pgl_parallel_for(size_t begin, size_t end, Function func, size_t nbthreads = 0, size_t grain = 1)
+{
+    if (end <= begin) return;
+    if (nbthreads == 0) nbthreads = pgl_thread_count();
+    size_t nbblocks = std::min(nbthreads, (end - begin + grain - 1) / std::max<size_t>(grain,1));
+    if (nbblocks <= 1 || pgl_is_worker_thread()) {
+        for (size_t i = begin; i < end; ++i) func(i);
+        return;
+    }
+    size_t blocksize = (end - begin + nbblocks - 1) / nbblocks;
+    std::vector<std::exception_ptr> errors(nbblocks);
+    std::vector<std::thread> threads;
+    threads.reserve(nbblocks - 1);
+    for (size_t b = 1; b < nbblocks; ++b) {
+        size_t bbeg = begin + b * blocksize;
+        size_t bend = std::min(end, bbeg + blocksize);
+        threads.push_back(std::thread([&func, &errors, b, bbeg, bend]() {
+            pgl_set_worker_thread(true);
+            try { for (size_t i = bbeg; i < bend; ++i) func(i); }
+            catch (...) { errors[b] = std::current_exception(); }
+        }));
+    }
+    pgl_set_worker_thread(true);
+    try { for (size_t i = begin, bend = std::min(end, begin + blocksize); i < bend; ++i) func(i); }
+    catch (...) { errors[0] = std::current_exception(); }
+    pgl_set_worker_thread(false);
+    for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it) it->join();
+    for (std::vector<std::exception_ptr>::const_iterator it = errors.begin(); it != errors.end(); ++it)
+        if (*it) std::rethrow_exception(*it);
+}
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+#endif
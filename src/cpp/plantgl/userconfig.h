@@ -0,0 +1,13 @@
+// User configuration of the PlantGL project.
+// This file is automatically generated. Do not edit it directly.
+// Generated on 2026-10-19T15:58:16.
+
+#define PGL_USE_DOUBLE 1
+
+#define PGL_WITHOUT_QT 1
+
+#define PGL_WITH_EIGEN 1
+
+#define PGL_WITH_BOOST 1
+
+#define PGL_WITH_BOOST_NUMPY 1
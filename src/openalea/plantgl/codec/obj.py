@@ -16,7 +16,8 @@
 This module provide a codec for OBJ file format.
 `OBJ`_ is a file format for 3D geometry defined by the Wavefront company.
 
-This codec allow to read and write `OBJ`_ file format. 
+This codec allow to write `OBJ`_ file format. 
+The files are read by the native 'OBJ' codec of PlantGL.
 
 .. _OBJ: http://en.wikipedia.org/wiki/Wavefront_.obj_file
 """
@@ -24,8 +25,6 @@ This codec allow to read and write `OBJ`_ file format.
 __license__ = "Cecill-C"
 
 import os
-import warnings
-from random import randint
 try:
     from itertools import zip_longest
 except ImportError:
@@ -36,10 +35,6 @@ import openalea.plantgl.scenegraph as sg
 import openalea.plantgl.algo as alg
 #from openalea.plantgl.ext import color
 
-def random_material(): 
-    r, g, b = randint(0,255), randint(0,255), randint(0,255)
-    return sg.Material(sg.Color3(r, g, b))
-
 def retrieveext(fname):
     return os.path.splitext(os.path.basename(fname))[1][1:]
 
@@ -72,91 +67,6 @@ def relocateimg(fname, outdir, basedir):
     return outfname
 
 
-class Group(object):
-    def __init__(self, name):
-        self.name = name
-        self.vindex = []
-        self.nindex = []
-        self.tindex = []
-        self.material = sg.Material()
-        self.lvindex = []
-        self.lnindex = []
-        self.pvindex = []
-
-    def add_face(self, vindex, nindex=None, tindex=None):
-        vi = self.vindex 
-        vi.append(vindex)
-            
-        if nindex:
-            ni = self.nindex 
-            ni.append(nindex)
-        if tindex:
-            ti = self.tindex 
-            ti.append(tindex)
-
-    def add_line(self,  vindex, nindex = None):
-        self.lvindex.append(vindex)
-        self.lnindex.append(nindex)
-
-    def add_pointset(self,  vindex):
-        self.pvindex.append(vindex)
-
-    def shape(self, vertices, normals, textures):
-        # Create tset, qset and FaceSet
-        # TODO: Add QuadSet
-        pointList = vertices
-        indexList = self.vindex
-        normalList = normals if normals else None
-        normalIndexList = self.nindex if self.nindex else None
-        textCoordList = sg.Point2Array(textures) if textures else None
-        textCoordIndexList = self.tindex if self.tindex else None
-
-        tset = None
-        #try:
-        if normalIndexList and textCoordIndexList:
-            tset = sg.FaceSet(pointList=pointList, indexList=indexList,
-            normalList=normalList, normalIndexList=normalIndexList,
-            texCoordList=textCoordList, texCoordIndexList=textCoordIndexList)
-        elif normalIndexList:
-            tset = sg.FaceSet(pointList=pointList, indexList=indexList,
-            normalList=normalList, normalIndexList=normalIndexList)
-        else:
-            tset = sg.FaceSet(pointList=pointList, indexList=indexList)
-        #except:
-        #    return 
-        
-        glines = sg.Group([])
-        if len(self.lvindex) > 0:
-            for line in self.lvindex:
-               glines.geometryList.append(sg.Polyline(pointList=[pointList[i] for i in line]))
-        
-        gpoints = sg.Group([])
-        if len(self.pvindex) > 0:
-            for points in self.pvindex:
-               gpoints.geometryList.append(sg.PointSet(pointList=[pointList[i] for i in points]))
-        
-        if len(glines) == 0:
-            if len(gpoints) == 0:
-                geom = tset
-            else:
-                geom = sg.Group([tset,gpoints])
-        elif len(gpoints) == 0:
-            if tset is None:
-                geom = glines
-            else:
-                geom = sg.Group([tset,glines]) 
-        elif tset is None:
-            geom = sg.Group([glines,gpoints])
-        else:
-            geom = sg.Group([tset,glines,gpoints])
-
-        _shape =  sg.Shape(geom, self.material)
-        _shape.name = self.name
-        return _shape
-
-    def __len__(self):
-        return len(self.vindex) 
-
 class Faces(object):
     def __init__(self, name, voffset, toffset, noffset, mesh, appearancename):
         """ Create a temporary object to ease the writing of OBJ files.
@@ -193,86 +103,6 @@ class Faces(object):
             output.write(line)
 
 
-class ObjMat:
-    def __init__(self, name = None):
-        self.name = name
-        self.Ka = [0.1, 0.1, 0.1]
-        self.Kd = [0.3, 0.3, 0.3]
-        self.Ks = [0.0, 0.0, 0.0]
-        self.Tr = 0
-    def topgl(self):
-        if not hasattr(self, 'map_Kd'):
-            diffuseCoef = sum(self.Kd)/sum(self.Ka)
-            ambient = sg.Color3(*[int(v*255) for v in self.Ka])
-            specular = sg.Color3(*[int(v*255) for v in self.Ks])
-            return sg.Material(self.name, ambient = ambient, diffuse = diffuseCoef, specular = specular, transparency = self.Tr)
-        else:
-            base = sg.Color4(*[int(v*255) for v in self.Ka+[self.Tr]])
-            fname = self.map_Kd
-            if retrieveext(fname) == 'tga':
-                fname = renameimg(fname, 'png')
-            texture = sg.Texture2D(sg.ImageTexture(fname))
-            texture.baseColor = base
-            return texture
-        
-def read_mtl(fname):
-    current = None
-    result = {}
-    cwd = os.path.dirname(fname)
-
-    def finalizemat():
-        nonlocal current, result
-        if current:
-            if current.name in result:
-                warnings.warn("Material "+current.name+" in file '"+fname+"' defined several times")
-            result[current.name] = current.topgl()
-        current = None
-
-    def newmat(name):
-        nonlocal current
-        finalizemat()
-        current = ObjMat(name[0])
-
-    def set_value(varname, value):
-        nonlocal current
-        setattr(current, varname, value)
-
-    def read_numvalue(varname, value):
-        set_value(varname, eval(value[0]))
-
-    def read_tuple_numvalue(varname, value):
-        set_value(varname, list(map(eval,value)))
-
-    def comment(value):
-        pass
-
-    parser = {}
-    parser['#'] = parser[''] = comment
-    parser['newmtl'] = newmat
-    parser['Ka'] = lambda v : read_tuple_numvalue('Ka', v)
-    parser['Kd'] = lambda v : read_tuple_numvalue('Kd', v)
-    parser['Ks'] = lambda v : read_tuple_numvalue('Ks', v)
-    parser['Tr'] = lambda v : read_numvalue('Tr', v)
-    parser['map_Kd'] = lambda v : set_value('map_Kd', os.path.join(cwd,v[0]))
-    parser['illum'] = lambda v : read_numvalue('illum', v)
-
-    with open(fname,"r") as f:
-        line = 1
-        for l in f:
-            l = l.strip()
-            fields = l.split()
-            if not fields or len(fields)<2:
-                continue
-            key = fields[0]
-            if key in parser:
-                parser[key](fields[1:])
-            else:
-                warnings.warn("Type "+key+" in file '"+fname+"' is not take into account")
-            line += 1
-    finalizemat()
-    return result
-
-
 class ObjCodec (sg.SceneCodec):
     """ OBJ File Format 
 
@@ -308,172 +138,14 @@ class ObjCodec (sg.SceneCodec):
         """
         Initialisation of the codec info
         """
-        sg.SceneCodec.__init__(self,"OBJ",sg.SceneCodec.Mode.ReadWrite)
+        # Obj files are read by the C++ codec registered as "OBJ".
+        sg.SceneCodec.__init__(self,"OBJ_WRITER",sg.SceneCodec.Mode.Write)
 
     def formats(self):
         """ return formats """
         return [ sg.SceneFormat("Obj Codec",["obj"],"The Obj file format") ]
 
 
-    def read(self,fname):
-        """ read an obj file """
-
-        parser = {}
-        parser['#'] = parser[''] = self._comment
-        parser['v'] = self._vertex
-        parser['vt'] = self._vertex_texture
-        parser['vn'] = self._vertex_normal
-        parser['f'] = self._face
-        parser['l'] = self._line
-        parser['p'] = self._pointset
-        parser['mtllib'] = self._material
-        parser['o'] = self._object_name
-        parser['g'] = self._group_name
-        parser['usemtl'] = self._material_name
-
-        # define data
-        self.vertices = []
-        self.normals = []
-        self.textures= []
-        self.groups = [Group('')]
-        self.current_group = self.groups[0]
-        self.current_material = random_material()
-        self.line = 0
-        self.materiallist = {}
-
-        self.cwd = os.path.dirname(fname)
-        if self.cwd == '':
-            self.cwd = os.path.getcwd()
-
-        # read the obj file
-        with open(fname,"r") as f:
-            for l in f:
-                l = l.strip()
-                fields = l.split()
-                if not fields or len(fields)<2:
-                    continue
-                key = fields[0]
-                if key in parser:
-                    parser[key](fields[1:])
-                else:
-                    warnings.warn("Type "+key+" in file '"+fname+"' is not take into account")
-                self.line += 1
-
-        # Build the scene
-        scene = sg.Scene()
-        for g in self.groups:
-            if g:
-                #print('NAME: ', g.name)
-                s = g.shape(self.vertices, self.normals, self.textures)
-                #print('Shape ', s)
-                if s and s.geometry: 
-                    scene.add(s)
-
-
-        #scene.add(sg.Shape(sg.PointSet(self.vertices)))
-
-        return scene
-
-    def read_material(self, fname):
-        """ Read mtl format, and convert it into PlantGL materials.
-
-        """
-        self.materiallist =read_mtl(os.path.join(self.cwd,fname))
-
-    # Parser functions
-    def _comment(self, args):
-        pass
-
-    def _vertex(self, args):
-        x, y, z = list(map(float, args))[:3]
-        self.vertices.append((x,y,z))
-
-    def _vertex_texture(self, args):
-        l = list(map(float,args))
-        self.textures.append(l[:2])
-
-    def _vertex_normal(self, args):
-        """ Parse a vertex normal."""
-        x, y, z = list(map(float, args))
-        self.normals.append((x,y,z))
-
-    def _face(self, args):
-        """ Parse a face set."""
-        arg = args[0]
-        indices = normals = texts = None
-        case = 'vertex' # f v1 v2 v3
-        if '//' in arg:
-            case ="vertex/normal"
-            l = [s.split('//') for s in args]
-            indices = tuple(int(v[0]) -1 for v in l)
-            normals = tuple(int(v[1])-1 for v in l)
-        elif arg.count('/') == 1:
-            case ="vertex/texture"
-            l = [s.split('/') for s in args]
-            indices = tuple(int(v[0]) -1 for v in l)
-            texts= tuple(int(v[1])-1 for v in l)
-        elif arg.count('/') == 2:
-            case ="vertex/texture/normal"
-            l = [s.split('/') for s in args]
-            indices = tuple(int(v[0]) -1 for v in l)
-            texts= tuple(int(v[1])-1 for v in l)
-            normals = tuple(int(v[2])-1 for v in l)
-        else:
-            case = "vertex"
-            indices = tuple(int(s)-1 for s in args)
-
-        self.current_group.add_face(vindex=indices, nindex=normals, tindex=texts)
-
-    def _line(self, args):
-        """ Parse a line."""
-        arg = args[0]
-        indices = normals = None
-        case = 'vertex' # l v1 v2 v3
-        if '//' in arg:
-            case ="vertex/normal"
-            l = [s.split('//') for s in args]
-            indices = tuple(int(v[0]) -1 for v in l)
-            normals = tuple(int(v[1])-1 for v in l)
-        else:
-            case = "vertex"
-            indices = tuple(int(s)-1 for s in args)
-
-        self.current_group.add_line(vindex=indices, nindex=normals)
-
-    def _pointset(self, args):
-        """ Parse a point set."""
-        arg = args[0]
-        indices = normals = None
-        indices = tuple(int(s)-1 for s in args)
-
-        self.current_group.add_pointset(vindex=indices)
-
-    def _material(self, args):
-        # modify the path for local file
-        self.read_material(args[0])
-
-    def _object_name(self, args):
-        name = args[0]
-        self.current_group = Group(name)
-        self.current_group.material = self.current_material
-        self.groups.append(self.current_group) 
-
-    def _group_name(self, args):
-        name = args[0]
-        self.current_group = Group(name)
-        self.current_group.material = self.current_material
-        self.groups.append(self.current_group) 
-
-    def _material_name(self, args):
-        name = args[0]
-        if name in self.materiallist:
-            self.current_material = self.materiallist[name]
-        else:   
-            self.current_material = random_material()
-            self.current_material.name = name
-        #self.current_group.material = self.current_material
-
-
     #############################################################################
     #############################################################################
     # PlantGL -> OBJ codec
@@ -0,0 +1,23 @@
+# User configuration of the PlantGL project.
+# This file is automatically generated. Do not edit it directly.
+# Generated on 2026-10-19T15:58:16.
+
+PGL_VERSION = 0x030700
+
+PGL_VERSION_STR = '3.7.0'
+
+PGL_USE_DOUBLE = True
+
+PGL_WITHOUT_QT = True
+
+PGL_QT_VERSION = 5
+
+PGL_WITH_ANN = False
+
+PGL_WITH_QHULL = False
+
+PGL_WITH_BOOST_NUMPY = 1
+
+PGL_WITH_BISONFLEX = False
+
+PGL_WITH_CGAL = False
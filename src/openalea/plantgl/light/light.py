@@ -8,12 +8,12 @@ def diffuseInterception(scene):
   return  directionalInterception(scene, directions = sd.skyTurtle())
 
 def directInterception(scene, lat=43.36, long=3.52, jj=221, start=7, stop=19, stp=30, dsun = 1, dGMT = 0):
-  direct = sd.getDirectLight( latitude=lat , longitude=int, jourJul=jj, startH=start, stopH=stop, step=stp, decalSun = dsun, decalGMT = dGMT)
+  direct = sd.getDirectLight( latitude=lat , longitude=long, jourJul=jj, startH=start, stopH=stop, step=stp, decalSun = dsun, decalGMT = dGMT)
   return  directionalInterception(scene, directions = direct)
 
 def totalInterception(scene, lat=43.36, long=3.52, jj=221, start=7, stop=19, stp=30, dsun = 1, dGMT = 0):
   diffu = sd.skyTurtle()
-  direct =  sd.getDirectLight( latitude=lat , longitude=int, jourJul=jj, startH=start, stopH=stop, step=stp, decalSun = dsun, decalGMT = dGMT)
+  direct =  sd.getDirectLight( latitude=lat , longitude=long, jourJul=jj, startH=start, stopH=stop, step=stp, decalSun = dsun, decalGMT = dGMT)
   all = direct + diffu
   return directionalInterception(scene, directions = all)
 
@@ -101,42 +101,13 @@ def projectedBBox(bbx, direction, up):
 
 
 def directionalInterception(scene, directions, north = 0, horizontal = False, screenresolution = 1, verbose = False, multithreaded = True):
-
-  bbox=pgl.BoundingBox( scene )
-  d_factor = max(bbox.getXRange() , bbox.getYRange() , bbox.getZRange())
-  shapeLight = {}
-  pixsize = screenresolution*screenresolution
-
-  for az, el, wg in directions:
-    if( az != None and el != None):
-        dir = azel2vect(az, el, north)
-        if horizontal :
-            wg /= sin(radians(el))
-
-    up = dir.anOrthogonalVector()
-    pjbbx = projectedBBox(bbox, dir, up)
-    worldWidth = pjbbx.getXRange()
-    worldheight = pjbbx.getYRange()
-    w, h = max(2,int(ceil(worldWidth/screenresolution))+1), max(2,int(ceil(worldheight/screenresolution))+1)
-    if verbose : 
-        print('direction :', dir)
-        print('image size :', w,'x',h)
-    worldWidth = w * screenresolution
-    worldheight = h * screenresolution
-    noid = pgl.Shape.NOID
-    z = pgl.ZBufferEngine(w,h,noid)
-    z.multithreaded = multithreaded
-    z.setOrthographicCamera(-worldWidth/2., worldWidth/2., -worldheight/2., worldheight/2., d_factor , 3*d_factor)
-    eyepos = bbox.getCenter() - dir* d_factor * 2
-    z.lookAt(eyepos, bbox.getCenter(), up) 
-    z.process(scene)
-    img = z.getImage()
-    values = img.histogram()
-    if not values is None:
-        for shid, val in values:
-            if shid != noid:
-                shapeLight[shid] = shapeLight.get(shid,0) + val*pixsize*wg
-  
+  """ Return a dict giving the light intercepted by the shapes of each id of the scene.
+      The projections of the scene are computed in parallel by pgl.SkyIrradiance. """
+  sky = pgl.SkyIrradiance(scene, screenresolution, north)
+  sky.multithreaded = multithreaded
+  shapeLight = sky.interception(directions, horizontal)
+  if verbose :
+      print('directions :', sky.getNbCachedDirections())
   return shapeLight
 
 
@@ -161,13 +132,13 @@ def scene_irradiance(scene, directions, north = 0, horizontal = False, scene_uni
     conv_unit2 = conv_unit**2
 
 
-    res = directionalInterception(scene = scene, directions = directions, north = north, horizontal = horizontal, screenresolution=screenresolution, verbose=verbose)
-    res = { sid : conv_unit2 * value for sid, value in res.items() }
-
-    surfaces = dict([(sid, conv_unit2*sum([pgl.surface(sh.geometry) for sh in shapes])) for sid, shapes in scene.todict().items()])
+    sky = pgl.SkyIrradiance(scene, screenresolution, north)
+    if verbose :
+        print('shapes :', len(sky.getShapeIds()))
 
+    surfaces = { sid : conv_unit2 * value for sid, value in sky.getShapeAreas().items() }
 
-    irradiance = { sid : value / surfaces[sid] for sid, value in res.items() }
+    irradiance = sky.irradiance(directions, horizontal)
 
     import pandas
     return pandas.DataFrame( {'area' : surfaces, 'irradiance' : irradiance} )
@@ -1,6 +1,5 @@
 import openalea.plantgl.all as pgl
 from math import radians, degrees, sin 
-from numpy import around
 from . import sunPositions as sp
 
 elevations = [9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 9.23, 10.81, 10.81, 10.81, 10.81, 10.81, 26.57, 26.57, 26.57, 26.57, 26.57, 31.08, 31.08, 31.08,31.08, 31.08, 31.08, 31.08, 31.08, 31.08, 31.08, 47.41, 47.41, 47.41, 47.41, 47.41, 52.62, 52.62, 52.62, 52.62, 52.62, 69.16, 69.16, 69.16, 69.16,69.16, 90]
@@ -44,20 +43,8 @@ def getDirectLight( latitude, longitude, jourJul, startH, stopH, step=30, decalS
   # startH and stopH represent starting and stoping hour for the light, given in hour
   # step are time step, given in minute
   # decalGMT give 'fuseau horaire' express in hour
-  seq = sp.Sequence()
-  hdeb = seq.heureTSV(jourJul, startH, decalSun, decalGMT, longitude)
-  hfin = seq.heureTSV(jourJul, stopH, decalSun, decalGMT, longitude)
-  az, el, time = seq.positionSoleil(step, radians(latitude), jourJul, hdeb, hfin)
-  sw = 0
-  for h in el :
-    sw += 0.7**( 1./sin(h) ) * sin(h) 
-  w = [ 0.7**( 1./sin(h) ) * sin(h) / sw for h in el ] 
-  tot = 0
-  for s in w:
-    tot+= s
-  if round(tot,1) != 1.0:
-    print("sum weight : ", tot) 
-  return [ ( around(degrees(az[i]),2), around(degrees(el[i]), 2), w[i] ) for i in range(len(az)) ]
+  # the positions are computed and cached by pgl.SkyIrradiance
+  return pgl.SkyIrradiance.sunCourse(latitude, longitude, jourJul, startH, stopH, step, decalSun, decalGMT)
 
 
 def plotDirect( latitude, longitude, jourJul, startH, stopH, step=30, decalSun = 1, decalGMT = 0):
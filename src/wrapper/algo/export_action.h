@@ -62,6 +62,7 @@ void export_MatrixComputer();
 // custom algo
 void export_Merge();
 void export_Fit();
+void export_BranchCompressor();
 
 /* ----------------------------------------------------------------------- */
 // abstract printer export
@@ -89,6 +90,7 @@ void export_GLCtrlPointRenderer();
 void export_ProjectionCamera();
 void export_ProjectionEngine();
 void export_ZBufferEngine();
+void export_SkyIrradiance();
 void export_DepthSortEngine();
 void export_ProjectionRenderer();
 
@@ -117,6 +119,7 @@ void export_PointGrid();
 void export_KDtree();
 void export_PyGrid();
 void export_PlaneClip();
+void export_SceneVoxelizer();
 
 /* ----------------------------------------------------------------------- */
 // CurveManipulation export
@@ -46,6 +46,7 @@
 #include <plantgl/algo/base/discretizer.h>
 #include <plantgl/scenegraph/geometry/boundingbox.h>
 #include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/flatscene.h>
 
 /* ----------------------------------------------------------------------- */
 
@@ -62,6 +63,10 @@ bool p_scene( BBoxComputer * b, ScenePtr s){
     return b->process(s);
 }
 
+bool p_flatscene( BBoxComputer * b, FlatScenePtr s){
+    return b->process(*s);
+}
+
 /* ----------------------------------------------------------------------- */
 
 void export_BBoxComputer()
@@ -70,6 +75,7 @@ void export_BBoxComputer()
     ("BBoxComputer", init<Discretizer&>("BBoxComputer() -> Compute the objects bounding box" ))
     .def("clear",&BBoxComputer::clear)
     .def("process",&p_scene)
+    .def("process",&p_flatscene)
     .add_property("boundingbox",d_getBBox,"Return the last computed Bounding Box.")
     .add_property("result",d_getBBox)
     ;
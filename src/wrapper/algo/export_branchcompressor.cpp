@@ -0,0 +1,101 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include <boost/python.hpp>
+
+#include <plantgl/algo/fitting/branchcompressor.h>
+#include <plantgl/python/extract_list.h>
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+using namespace std;
+#define bp boost::python
+
+/* ----------------------------------------------------------------------- */
+
+BranchInput * py_make_branchinput(const Point3ArrayPtr& points, const Point2ArrayPtr& radius,
+                                  const AppearancePtr& appearance, int id, int father)
+{
+  BranchInput * result = new BranchInput();
+  result->points = points;
+  result->radius = radius;
+  result->appearance = appearance;
+  result->id = id;
+  result->father = father;
+  return result;
+}
+
+void py_bc_setData(BranchCompressor * compressor, object branches, int sorttype)
+{ compressor->setData(extract_vec<BranchInput>(branches)(), sorttype); }
+
+object py_bc_compress(BranchCompressor * compressor, real_t rate, real_t errorbound, int degree, int option)
+{
+  real_t obtainedrate = 0, computationtime = 0, fittime = 0;
+  ScenePtr result = compressor->compress(rate, &obtainedrate, &computationtime, &fittime, errorbound, degree, option);
+  return bp::make_tuple(result, obtainedrate, computationtime, fittime);
+}
+
+void export_BranchCompressor()
+{
+  class_< BranchInput >
+    ("BranchInput", "A branch to compress: its points, radius, appearance, id and the id of its father (0 or less for a root).", no_init)
+    .def("__init__", make_constructor(&py_make_branchinput, default_call_policies(),
+         (bp::arg("points"), bp::arg("radius"), bp::arg("appearance") = AppearancePtr(), bp::arg("id") = 0, bp::arg("father") = 0)))
+    .def_readwrite("points", &BranchInput::points)
+    .def_readwrite("radius", &BranchInput::radius)
+    .def_readwrite("appearance", &BranchInput::appearance)
+    .def_readwrite("id", &BranchInput::id)
+    .def_readwrite("father", &BranchInput::father)
+    ;
+
+  class_< BranchCompressor, boost::noncopyable >
+    ("BranchCompressor", "Compress the geometry of a set of branches to a given rate of the input data.", init<>("BranchCompressor()"))
+    .def("setVerbose", &BranchCompressor::setVerbose)
+    .def("setMultiThreaded", &BranchCompressor::setMultiThreaded)
+    .def("isMultiThreaded", &BranchCompressor::isMultiThreaded)
+    .add_property("multithreaded", &BranchCompressor::isMultiThreaded, &BranchCompressor::setMultiThreaded)
+    .def("setData", &py_bc_setData, (bp::arg("branches"), bp::arg("sorttype") = 0))
+    .def("clear", &BranchCompressor::clear)
+    .def("inputScene", &BranchCompressor::inputScene)
+    .def("compress", &py_bc_compress,
+         (bp::arg("rate") = 50, bp::arg("errorbound") = 1.0, bp::arg("degree") = 3, bp::arg("option") = 0),
+         "compress(rate, errorbound, degree, option) -> (scene, obtained rate, computation time, fitting time)")
+    ;
+}
@@ -52,16 +52,16 @@ using namespace std;
 
 void export_DepthSortEngine()
 {
-#ifdef PGL_WITH_CGAL
-
   class_< DepthSortEngine, bases<ProjectionEngine>, boost::noncopyable >
       ("DepthSortEngine", init<>("Construct a DepthSortEngine.") )
       .def("processTriangle", &DepthSortEngine::processTriangle)
       .def("getResult", &DepthSortEngine::getResult, (bp::arg("format")=Color4::eARGB, bp::arg("cameraCoordinates")=true))
       .def("getProjectionResult", &DepthSortEngine::getProjectionResult, (bp::arg("format")=Color4::eARGB, bp::arg("cameraCoordinates")=true))
+      .def("flush", &DepthSortEngine::flush)
+      .def("getPendingTriangleCount", &DepthSortEngine::getPendingTriangleCount)
+      .add_property("multithreaded", &DepthSortEngine::isMultiThreaded, &DepthSortEngine::setMultiThreaded)
+      .add_property("cellSize", &DepthSortEngine::getCellSize, &DepthSortEngine::setCellSize)
       ;
-
-#endif
 }
 
 
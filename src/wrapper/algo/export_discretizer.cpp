@@ -57,7 +57,7 @@ using namespace std;
 /* ----------------------------------------------------------------------- */
 
 ExplicitModelPtr d_getDiscretization( Discretizer* d )
-{ return d->getDiscretization(); }
+{ return Discretizer::detachTessellationTables(d->getDiscretization()); }
 
 /* ----------------------------------------------------------------------- */
 
@@ -72,7 +72,7 @@ ExplicitModelPtr py_discretize( const GeometryPtr& obj) {
     if (!obj)throw PythonExc_ValueError("Cannot discretize empty object.");
     Discretizer d;
     if (!obj->apply(d))throw PythonExc_ValueError("Error in discretization.");
-    else return d.getDiscretization();
+    else return Discretizer::detachTessellationTables(d.getDiscretization());
 }
 
 /* ----------------------------------------------------------------------- */
@@ -85,6 +85,11 @@ void export_Discretizer()
     .add_property("discretization",d_getDiscretization, "Return the last computed discretization.")
     .add_property("texCoord",get_Dis_texCoord,set_Dis_texCoord)
     .add_property("result",d_getDiscretization)
+    .def("clearTessellationTables",&Discretizer::clearTessellationTables,"Remove the tables shared by all the discretizers to tessellate primitives.")
+    .staticmethod("clearTessellationTables")
+    .add_property("lodScale",&Discretizer::getLodScale,&Discretizer::setLodScale, "Length in pixels of a unit of the scene used to choose the resolution of the primitives. 0 disables the level of detail.")
+    .add_property("lodTolerance",&Discretizer::getLodTolerance,&Discretizer::setLodTolerance, "Maximal distance in pixels between the primitives and their tessellation.")
+    .def("lodResolution",&Discretizer::lodResolution,(bp::arg("resolution"),bp::arg("radius"),bp::arg("minimum")=3,bp::arg("angle")=GEOM_TWO_PI))
     ;
 
    def("discretize",&py_discretize);
@@ -93,20 +98,20 @@ void export_Discretizer()
 /* ----------------------------------------------------------------------- */
 
 TriangleSetPtr  t_getTriangulation ( Tesselator* t )
-{ return t->getTriangulation(); }
+{ return dynamic_pointer_cast<TriangleSet>(Discretizer::detachTessellationTables(t->getTriangulation())); }
 
 TriangleSetPtr py_tesselate( const GeometryPtr& obj) {
     if (!obj)throw PythonExc_ValueError("Cannot tesselate empty object.");
     Tesselator t;
     if (!obj->apply(t))throw PythonExc_ValueError("Error in tesselation.");
-    else return t.getTriangulation();
+    else return dynamic_pointer_cast<TriangleSet>(Discretizer::detachTessellationTables(t.getTriangulation()));
 }
 
 TriangleSetPtr py_triangulation( const GeometryPtr& obj) {
     if (!obj)throw PythonExc_ValueError("Cannot tesselate empty object.");
     Tesselator t;
     if (!obj->apply(t))throw PythonExc_ValueError("Error in tesselation.");
-    else return t.getTriangulation();
+    else return dynamic_pointer_cast<TriangleSet>(Discretizer::detachTessellationTables(t.getTriangulation()));
 }
 
 
@@ -42,6 +42,8 @@
 
 #include <plantgl/python/export_property.h>
 #include <plantgl/algo/fitting/fit.h>
+#include <plantgl/algo/fitting/eigenvector.h>
+#include <plantgl/algo/fitting/convexhull.h>
 #include <plantgl/algo/base/discretizer.h>
 #include <boost/python.hpp>
 
@@ -105,6 +107,58 @@ boost::python::object py_plane(Point3Array * points, const Index& subset = Index
     else return make_tuple(center,plane);
 }
 
+boost::python::object py_symmetricEigenDecomposition(boost::python::object matrices){
+    extract<Matrix3> single(matrices);
+    if (single.check()) {
+        Vector3 values;
+        Matrix3 vectors;
+        symmetricEigenDecomposition(single(),values,vectors);
+        return make_tuple(values,vectors);
+    }
+    std::vector<Matrix3> mats;
+    stl_input_iterator<Matrix3> it(matrices), end;
+    for( ; it != end; ++it) mats.push_back(*it);
+    std::vector<Vector3> values;
+    std::vector<Matrix3> vectors;
+    symmetricEigenDecomposition(mats,values,vectors);
+    boost::python::list res;
+    for(size_t i = 0; i < mats.size(); ++i) res.append(make_tuple(values[i],vectors[i]));
+    return res;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void ch2_insert_point(ConvexHull2D * hull, const Vector2& point) { hull->insert(point); }
+
+void export_ConvexHull()
+{
+  class_< ConvexHull2D > ("ConvexHull2D", "Convex hull of a growing set of 2D points.", init<optional<real_t> >("ConvexHull2D([tolerance])",args("tolerance")))
+    .def(init<Point2ArrayPtr, optional<Index, real_t> >("ConvexHull2D(points[, group, tolerance])",args("points","group","tolerance")))
+    .def("insert",&ch2_insert_point,args("point"))
+    .def("insert",(void(ConvexHull2D::*)(const Point2ArrayPtr&, const Index&))&ConvexHull2D::insert,(arg("points"),arg("group")=Index()))
+    .def("clear",&ConvexHull2D::clear)
+    .def("contains",&ConvexHull2D::contains,args("point"))
+    .def("getPointList",&ConvexHull2D::getPointList)
+    .def("getPolyline",&ConvexHull2D::getPolyline)
+    ;
+
+  class_< ConvexHull3D > ("ConvexHull3D", "Convex hull of a growing set of 3D points.", init<optional<real_t> >("ConvexHull3D([tolerance])",args("tolerance")))
+    .def(init<Point3ArrayPtr, optional<Index, real_t> >("ConvexHull3D(points[, group, tolerance])",args("points","group","tolerance")))
+    .def("insert",(bool(ConvexHull3D::*)(const Vector3&))&ConvexHull3D::insert,args("point"))
+    .def("insert",(void(ConvexHull3D::*)(const Point3ArrayPtr&, const Index&))&ConvexHull3D::insert,(arg("points"),arg("group")=Index()))
+    .def("clear",&ConvexHull3D::clear)
+    .def("isValid",&ConvexHull3D::isValid)
+    .def("getFaceNb",&ConvexHull3D::getFaceNb)
+    .def("contains",&ConvexHull3D::contains,args("point"))
+    .def("getMesh",&ConvexHull3D::getMesh)
+    ;
+
+  def("pointsets_convex_hulls",&pointsets_convex_hulls,args("points","groups"),
+      "pointsets_convex_hulls(points, groups) -> list of the convex hulls of the groups of points, computed in parallel.");
+  def("pointsets_convex_polylines",&pointsets_convex_polylines,args("points","groups"),
+      "pointsets_convex_polylines(points, groups) -> list of the convex contours of the groups of 2D points, computed in parallel.");
+}
+
 /* ----------------------------------------------------------------------- */
 
 void export_Fit()
@@ -158,10 +212,17 @@ void export_Fit()
     .staticmethod("fitShapeFactor")
     ;
 
+  def("symmetric_eigen_decomposition",&py_symmetricEigenDecomposition,args("matrices"),
+      "symmetric_eigen_decomposition(matrix) -> (values, vectors). "
+      "Eigen values in increasing order and the matrix of the corresponding unit eigen vectors as columns. "
+      "A list of matrices gives a list of decompositions computed in parallel.");
+
 
   def("fit",&fit,args("algo","src"));
   def("inertiaAxis",inertiaAxis,args("points"));
   def("inertiaAxis",inertiaAxis2d,args("points"));
+
+  export_ConvexHull();
 }
 
 /* ----------------------------------------------------------------------- */
@@ -50,15 +50,42 @@
 PGL_USING_NAMESPACE
 using namespace boost::python;
 using namespace std;
+#define bp boost::python
+
+object py_weld( MeshWelder * welder, object meshes )
+{
+  extract<ExplicitModelPtr> _mesh(meshes);
+  if (_mesh.check()) {
+    std::vector<uint_t> remap;
+    ExplicitModelPtr result = welder->weld(_mesh(), &remap);
+    bp::list pyremap;
+    for (std::vector<uint_t>::const_iterator it = remap.begin(); it != remap.end(); ++it) pyremap.append(*it);
+    return bp::make_tuple(result, pyremap);
+  }
+  std::vector<ExplicitModelPtr> models;
+  for (int i = 0, n = len(meshes); i < n; ++i) models.push_back(extract<ExplicitModelPtr>(meshes[i])());
+  std::vector<ExplicitModelPtr> results = welder->weld(models);
+  bp::list pyresults;
+  for (std::vector<ExplicitModelPtr>::const_iterator it = results.begin(); it != results.end(); ++it) pyresults.append(*it);
+  return pyresults;
+}
 
 void export_Merge()
 {
+  class_< MeshWelder, boost::noncopyable >
+    ("MeshWelder", init<optional<real_t,real_t> >("MeshWelder([tolerance, attributeTolerance]) : weld the vertices of meshes closer than tolerance.", (bp::arg("tolerance")=GEOM_EPSILON,bp::arg("attributeTolerance")=GEOM_TOLERANCE) ))
+    .add_property("tolerance",&MeshWelder::getTolerance,&MeshWelder::setTolerance)
+    .add_property("attributeTolerance",&MeshWelder::getAttributeTolerance,&MeshWelder::setAttributeTolerance)
+    .def("weld", &py_weld, bp::arg("meshes"), "weld(mesh) -> (welded mesh, new index of each vertex). weld(list of meshes) -> list of welded meshes, computed in parallel.")
+    ;
+
   class_< Merge, boost::noncopyable >
     ("Merge", init<Discretizer&,ExplicitModelPtr&>("Merge(Discretizer d, ExplicitModel e )" ))
     .DEC_PTR_PROPERTY_RO(model,Merge,Model,ExplicitModelPtr)
     .def("apply", ( bool(Merge::*)(GeometryPtr&)      ) &Merge::apply)
     .def("apply", ( bool(Merge::*)(ExplicitModelPtr&) ) &Merge::apply)
     .add_property("result",make_function(&Merge::getModel,return_internal_reference<1>()))
+    .add_property("weldTolerance",&Merge::getWeldTolerance,&Merge::setWeldTolerance, "Distance below which the merged vertices are welded. 0 disables welding.")
     ;
 }
 
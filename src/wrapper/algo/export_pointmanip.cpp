@@ -237,6 +237,10 @@ boost::python::object py_select_pole_from_point(const Point3ArrayPtr& points, co
 }
 
 #ifdef PGL_WITH_CGAL
+boost::python::object py_delaunay_point_connection_flat(const Point3ArrayPtr points, bool parallel) {
+  return make_pair_tuple(delaunay_point_connection_flat(points, parallel));
+}
+
 boost::python::object py_pointset_plane(const Point3ArrayPtr points, const Index &group) {
   return make_pair_tuple(pointset_plane(points, group));
 }
@@ -261,8 +265,9 @@ void export_PointManip() {
   def("select_pole_from_point", &py_select_pole_from_point, (bp::arg("points"), bp::arg("startPoint"), bp::arg("iterations"), bp::arg("maxAngle")));
 
 #ifdef PGL_WITH_CGAL
-  def("delaunay_point_connection", &delaunay_point_connection, args("points"));
-  def("delaunay_triangulation", &delaunay_triangulation, args("points"));
+  def("delaunay_point_connection", &delaunay_point_connection, (bp::arg("points"), bp::arg("parallel") = false));
+  def("delaunay_point_connection_flat", &py_delaunay_point_connection_flat, (bp::arg("points"), bp::arg("parallel") = true));
+  def("delaunay_triangulation", &delaunay_triangulation, (bp::arg("points"), bp::arg("parallel") = false));
   def("k_closest_points_from_delaunay", &k_closest_points_from_delaunay, args("points", "k"));
 #endif
 #ifdef PGL_WITH_ANN
@@ -297,16 +302,20 @@ void export_PointManip() {
   def("pointset_max_radial_distance", &pointset_max_radial_distance, args("center", "direction", "points", "group"));
 
   def("pointset_covariance", &pointset_covariance, (arg("points"), arg("group") = Index()));
+  def("pointset_centered_covariance", &pointset_centered_covariance, (arg("points"), arg("group") = Index()));
 
   def("density_from_k_neighborhood", &density_from_k_neighborhood, (bp::arg("pid"), bp::arg("points"), bp::arg("adjacencies"), bp::arg("k") = 0), "Compute density of a point according to its k neighboordhood. If k is 0, its value is deduced from adjacencies.");
   def("densities_from_k_neighborhood", &densities_from_k_neighborhood, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("k") = 0), "Compute local densities of a set of points according to their k neighboordhood. If k is 0, its value is deduced from adjacencies.");
 
-#ifdef PGL_WITH_CGAL
-  def("pointset_plane", &py_pointset_plane, args("points", "group"));
   def("pointset_orientation", &pointset_orientation, args("points", "group"));
   def("pointsets_orientations", &pointsets_orientations, args("points", "groups"));
   def("pointset_normal", &pointset_normal, (bp::arg("points"), bp::arg("groups")));
   def("pointsets_normals", &pointsets_normals, (bp::arg("points"), bp::arg("groups")));
+  def("pointsets_principal_axes", &pointsets_principal_axes, (bp::arg("points"), bp::arg("groups"), bp::arg("axis"), bp::arg("progressmessage") = std::string("principal axes computed for %.2f%% of groups.")),
+      "Eigen vector of rank axis (0 for the smallest eigen value) of the centered covariance of each group.");
+
+#ifdef PGL_WITH_CGAL
+  def("pointset_plane", &py_pointset_plane, args("points", "group"));
   def("triangleset_orientation", &triangleset_orientation, args("points", "triangles"));
 
 #ifdef CGAL_AND_SVD_SOLVER_ENABLED
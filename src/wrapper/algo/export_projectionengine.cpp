@@ -59,6 +59,7 @@ void export_ProjectionCamera()
       .def("cameraToRaster", &ProjectionCamera::cameraToRaster)
       .def("worldToRaster", &ProjectionCamera::worldToRaster)
       .def("getBoundingBoxView", &ProjectionCamera::getBoundingBoxView)
+      .def("getPixelScale", &ProjectionCamera::getPixelScale, (bp::arg("vertexModel"),bp::arg("imageWidth"),bp::arg("imageHeight"),bp::arg("radius")=0))
       .def("getWorldToCameraMatrix", &ProjectionCamera::getWorldToCameraMatrix)
       .def("getCameraToWorldMatrix", &ProjectionCamera::getCameraToWorldMatrix)
       .def("getModelTransformationMatrix", &ProjectionCamera::getModelTransformationMatrix)
@@ -83,6 +84,7 @@ void export_ProjectionEngine()
       .def("setOrthographicCamera", &ProjectionEngine::setOrthographicCamera, bp::args("left","right","bottom", "top", "near", "far"))
       .def("lookAt", &ProjectionEngine::lookAt, bp::args("eye_position","target","up"))
       .def("getBoundingBoxView", &ProjectionEngine::getBoundingBoxView)
+      .add_property("lodTolerance", &ProjectionEngine::getLodTolerance, &ProjectionEngine::setLodTolerance, "Maximal distance in pixels between the primitives and their tessellation. 0 keeps the resolution of the primitives.")
       .def("camera", &get_camera)
       
       .def("process", (void(ProjectionEngine::*)(TriangleSetPtr, AppearancePtr, uint32_t))&ProjectionEngine::process, (bp::arg("triangleset"),bp::arg("appearance"),bp::arg("id")))
@@ -0,0 +1,142 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include <plantgl/algo/projection/skyirradiance.h>
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/boost_python.h>
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+using namespace std;
+#define bp boost::python
+
+/* ----------------------------------------------------------------------- */
+
+/// Convert a list of (azimuth, elevation, weight) tuples.
+LightDirectionList extract_directions(bp::object directions)
+{
+    LightDirectionList result;
+    for (stl_input_iterator<bp::object> it(directions), end; it != end; ++it) {
+        bp::object direction = *it;
+        result.push_back(LightDirection(bp::extract<real_t>(direction[0])(), bp::extract<real_t>(direction[1])(),
+                                        bp::extract<real_t>(direction[2])()));
+    }
+    return result;
+}
+
+bp::list make_directions(const LightDirectionList& directions)
+{
+    bp::list result;
+    for (LightDirectionList::const_iterator it = directions.begin(); it != directions.end(); ++it)
+        result.append(bp::make_tuple(it->azimuth, it->elevation, it->weight));
+    return result;
+}
+
+bp::dict make_shapevalues(const ShapeValueMap& values)
+{
+    bp::dict result;
+    for (ShapeValueMap::const_iterator it = values.begin(); it != values.end(); ++it)
+        result[it->first] = it->second;
+    return result;
+}
+
+bp::dict si_getShapeAreas(SkyIrradiance * sky)
+{ return make_shapevalues(sky->getShapeAreas()); }
+
+bp::list si_getShapeIds(SkyIrradiance * sky)
+{
+    bp::list result;
+    for (std::vector<uint32_t>::const_iterator it = sky->getShapeIds().begin(); it != sky->getShapeIds().end(); ++it)
+        result.append(*it);
+    return result;
+}
+
+bp::dict si_getProjectedAreas(SkyIrradiance * sky, real_t azimuth, real_t elevation)
+{ return make_shapevalues(sky->getProjectedAreas(azimuth, elevation)); }
+
+void si_computeProjectedAreas(SkyIrradiance * sky, bp::object directions)
+{ sky->computeProjectedAreas(extract_directions(directions)); }
+
+bp::dict si_interception(SkyIrradiance * sky, bp::object directions, bool horizontal)
+{ return make_shapevalues(sky->interception(extract_directions(directions), horizontal)); }
+
+bp::dict si_irradiance(SkyIrradiance * sky, bp::object directions, bool horizontal)
+{ return make_shapevalues(sky->irradiance(extract_directions(directions), horizontal)); }
+
+RealArray2Ptr si_irradiances(SkyIrradiance * sky, bp::object steps, bool horizontal)
+{
+    std::vector<LightDirectionList> csteps;
+    for (stl_input_iterator<bp::object> it(steps), end; it != end; ++it)
+        csteps.push_back(extract_directions(*it));
+    return sky->irradiances(csteps, horizontal);
+}
+
+bp::list si_skyTurtle()
+{ return make_directions(SkyIrradiance::skyTurtle()); }
+
+bp::list si_sunCourse(real_t latitude, real_t longitude, int day, real_t startHour, real_t stopHour, int step, real_t decalSun, real_t decalGMT)
+{ return make_directions(SkyIrradiance::sunCourse(latitude, longitude, day, startHour, stopHour, step, decalSun, decalGMT)); }
+
+/* ----------------------------------------------------------------------- */
+
+void export_SkyIrradiance()
+{
+  class_< SkyIrradiance, SkyIrradiancePtr, bases<RefCountObject>, boost::noncopyable >
+      ("SkyIrradiance", "Light intercepted by the shapes of a scene from a set of (azimuth, elevation, weight) directions. "
+       "The projected areas of the shapes are computed in parallel and kept for each direction.",
+       init<const ScenePtr&, real_t, real_t>("SkyIrradiance(scene, screenresolution, north)",
+                                             (bp::arg("scene"), bp::arg("screenresolution")=1, bp::arg("north")=0)) )
+      .add_property("multithreaded", &SkyIrradiance::isMultiThreaded, &SkyIrradiance::setMultiThreaded)
+      .def("getScreenResolution", &SkyIrradiance::getScreenResolution)
+      .def("getNorth", &SkyIrradiance::getNorth)
+      .def("getShapeIds", &si_getShapeIds)
+      .def("getShapeAreas", &si_getShapeAreas, "Return a dict giving the area of the shapes of each id.")
+      .def("getProjectedAreas", &si_getProjectedAreas, (bp::arg("azimuth"), bp::arg("elevation")),
+           "Return a dict giving the area of the shapes of each id seen from the direction.")
+      .def("computeProjectedAreas", &si_computeProjectedAreas, (bp::arg("directions")))
+      .def("getNbCachedDirections", &SkyIrradiance::getNbCachedDirections)
+      .def("clearCache", &SkyIrradiance::clearCache)
+      .def("interception", &si_interception, (bp::arg("directions"), bp::arg("horizontal")=false),
+           "Return a dict giving the light intercepted by the shapes of each id.")
+      .def("irradiance", &si_irradiance, (bp::arg("directions"), bp::arg("horizontal")=false),
+           "Return a dict giving the intercepted light per unit of area of the shapes of each id.")
+      .def("irradiances", &si_irradiances, (bp::arg("steps"), bp::arg("horizontal")=false),
+           "Return the irradiance of the shapes of each id of getShapeIds() (rows) for each list of directions of steps (columns).")
+      .def("skyTurtle", &si_skyTurtle, "Return the (azimuth, elevation, weight) directions of the sky turtle.")
+      .staticmethod("skyTurtle")
+      .def("sunCourse", &si_sunCourse, (bp::arg("latitude"), bp::arg("longitude"), bp::arg("day"), bp::arg("startHour"),
+                                        bp::arg("stopHour"), bp::arg("step")=30, bp::arg("decalSun")=1, bp::arg("decalGMT")=0),
+           "Return the (azimuth, elevation, weight) positions of the sun during a day.")
+      .staticmethod("sunCourse")
+      ;
+}
+
+/* ----------------------------------------------------------------------- */
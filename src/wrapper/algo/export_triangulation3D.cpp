@@ -54,7 +54,7 @@ using namespace boost::python;
 
 void export_Triangulation3D()
 {
-  def("delaunay_triangulation3D",&delaunay_triangulation3D,args("points"));
+  def("delaunay_triangulation3D",&delaunay_triangulation3D,(arg("points"),arg("parallel")=false));
 
 }
 
@@ -81,6 +81,32 @@ void py_register_pushpop(Turtle * t, boost::python::object push, boost::python::
     t->registerPushPopHandler(PushPopHandlerPtr(new PyPushPopHandler(push, pop)));
 }
 
+class PyGCRingConsumer : public GCRingConsumer {
+public:
+    PyGCRingConsumer(boost::python::object _ring, boost::python::object _end) :
+        GCRingConsumer(),
+        ring(_ring), end(_end) { }
+
+    virtual ~PyGCRingConsumer() {}
+
+    virtual void ringEvent(uint_t ringid, const Vector3& center,
+                           const Vector3& normal, const Vector3& binormal,
+                           real_t radius, real_t v,
+                           Point3Array::const_iterator begin,
+                           Point3Array::const_iterator end)
+    { ring(ringid, Point3ArrayPtr(new Point3Array(begin, end)), center, normal, binormal, radius, v); }
+
+    virtual void endEvent(uint_t nbrings) { if (end != boost::python::object()) end(nbrings); }
+
+protected:
+    boost::python::object ring;
+    boost::python::object end;
+};
+
+void py_register_gcring(Turtle * t, boost::python::object ring, boost::python::object end) {
+    t->registerGCRingConsumer(GCRingConsumerPtr(new PyGCRingConsumer(ring, end)));
+}
+
 void export_Turtle()
 {
     Turtle::register_error_handler(&py_error_handler);
@@ -264,6 +290,10 @@ void export_Turtle()
 
     .def("_register_pushpop",&py_register_pushpop)
 
+    .def_readwrite("gc_meshing_enabled",&Turtle::gc_meshing_enabled)
+    .def("registerGCRingConsumer",&py_register_gcring, (bp::arg("ringfunc"),bp::arg("endfunc")=boost::python::object()),
+         "registerGCRingConsumer(ringfunc[, endfunc]) : ringfunc(ringid, points, center, normal, binormal, radius, v) is called for each ring of the generalized cylinders. Require gc_meshing_enabled.")
+
 /*    .def("_frustum",&Turtle::_frustum )
     .def("_cylinder",&Turtle::_cylinder )
 //    .def("_polygon",&Turtle::_polygon )
@@ -0,0 +1,139 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "export_grid.h"
+#include <plantgl/algo/grid/voxelizer.h>
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/exception.h>
+
+#if PGL_WITH_BOOST_NUMPY
+#include <boost/python/numpy.hpp>
+#define np boost::python::numpy
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+DEF_POINTEE(SceneVoxelizer)
+
+object py_getOccupiedVoxels(SceneVoxelizer * voxelizer)
+{ return make_list(voxelizer->getOccupiedVoxels())(); }
+
+object py_getShapeIds(SceneVoxelizer * voxelizer, SceneVoxelizer::CellId cid)
+{ return make_list(voxelizer->getShapeIds(cid))(); }
+
+object py_getInclinationDistribution(SceneVoxelizer * voxelizer, SceneVoxelizer::CellId cid)
+{
+    if (!voxelizer->isValidId(cid)) throw PythonExc_IndexError();
+    const real_t * values = voxelizer->getInclinationDistribution(cid);
+    return make_list(std::vector<real_t>(values, values + voxelizer->getNbInclinationClasses()))();
+}
+
+object py_clipPolygon(SceneVoxelizer * voxelizer, const Point3ArrayPtr& polygon)
+{
+    bp::list result;
+    std::vector<std::pair<SceneVoxelizer::CellId, Point3ArrayPtr> > pieces = voxelizer->clipPolygon(polygon);
+    for (std::vector<std::pair<SceneVoxelizer::CellId, Point3ArrayPtr> >::const_iterator it = pieces.begin(); it != pieces.end(); ++it)
+        result.append(bp::make_tuple(make_pgl_tuple(voxelizer->index(it->first))(), it->second));
+    return result;
+}
+
+#if PGL_WITH_BOOST_NUMPY
+/// Returns a numpy array of shape (dimensions, nbvalues) sharing \e values. It keeps \e owner alive.
+np::ndarray voxel_values_to_nparray(SceneVoxelizer * voxelizer, const real_t * values, size_t nbvalues, object owner)
+{
+    SceneVoxelizer::Index dims = voxelizer->dimensions();
+    size_t s = sizeof(real_t);
+    bp::list shape, strides;
+    shape.append(dims[0]); shape.append(dims[1]); shape.append(dims[2]);
+    strides.append(dims[1] * dims[2] * nbvalues * s); strides.append(dims[2] * nbvalues * s); strides.append(nbvalues * s);
+    if (nbvalues > 1) { shape.append(nbvalues); strides.append(s); }
+    return np::from_data(values, np::dtype::get_builtin<real_t>(), bp::tuple(shape), bp::tuple(strides), owner);
+}
+
+np::ndarray py_areas(object self)
+{
+    SceneVoxelizer * voxelizer = extract<SceneVoxelizer *>(self)();
+    return voxel_values_to_nparray(voxelizer, &voxelizer->getAt(SceneVoxelizer::CellId(0)), 1, self);
+}
+
+np::ndarray py_inclinations(object self)
+{
+    SceneVoxelizer * voxelizer = extract<SceneVoxelizer *>(self)();
+    return voxel_values_to_nparray(voxelizer, voxelizer->getInclinationDistribution(0),
+                                   voxelizer->getNbInclinationClasses(), self);
+}
+#endif
+
+void export_SceneVoxelizer()
+{
+  class_< SceneVoxelizer, SceneVoxelizerPtr, boost::noncopyable > ("SceneVoxelizer",
+      "Area of the surfaces of a scene in the voxels of a regular grid. "
+      "Triangles are clipped exactly against the voxels and shapes are processed in parallel.",
+      init<Vector3, Vector3, Vector3, optional<uint_t> >
+      ("SceneVoxelizer(voxelsize, minpoint, maxpoint[, nbinclinationclasses])",
+       args("voxelsize","minpoint","maxpoint","nbinclinationclasses")))
+    .def(init<ScenePtr, Vector3, optional<uint_t> >
+      ("SceneVoxelizer(scene, voxelsize[, nbinclinationclasses])",
+       args("scene","voxelsize","nbinclinationclasses")))
+    .def(spatialarray_func<SceneVoxelizer>())
+    .def("setMultiThreaded",&SceneVoxelizer::setMultiThreaded)
+    .def("isMultiThreaded",&SceneVoxelizer::isMultiThreaded)
+    .def("getNbInclinationClasses",&SceneVoxelizer::getNbInclinationClasses)
+    .def("reset",&SceneVoxelizer::reset)
+    .def("process",&SceneVoxelizer::process,args("scene"))
+    .def("addTriangle",&SceneVoxelizer::addTriangle,args("a","b","c","shapeid"))
+    .def("getTotalArea",&SceneVoxelizer::getTotalArea)
+    .def("getArea",(const real_t&(SceneVoxelizer::*)(const SceneVoxelizer::CellId&)const)&SceneVoxelizer::getAt,
+         return_value_policy<return_by_value>(),args("cellid"))
+    .def("getAreaDensities",&SceneVoxelizer::getAreaDensities)
+    .def("getInclinationDistributions",&SceneVoxelizer::getInclinationDistributions)
+    .def("getInclinationDistribution",&py_getInclinationDistribution,args("cellid"))
+    .def("getOccupiedVoxels",&py_getOccupiedVoxels)
+    .def("getShapeIds",&py_getShapeIds,args("cellid"))
+    .def("clipPolygon",&py_clipPolygon,args("polygon"),
+         "clipPolygon(polygon) -> list of (cellindex, points) of the pieces of the polygon in the voxels of the grid.")
+#if PGL_WITH_BOOST_NUMPY
+    .def("areas",&py_areas,"Returns a numpy view of the area of the voxels.")
+    .def("inclinations",&py_inclinations,"Returns a numpy view of the area of the voxels in each class of inclination.")
+#endif
+    ;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -32,6 +32,12 @@
 #include <plantgl/algo/projection/zbufferengine.h>
 #include <plantgl/python/export_refcountptr.h>
 #include <plantgl/python/boost_python.h>
+#include <plantgl/python/export_list.h>
+
+#if PGL_WITH_BOOST_NUMPY
+#include <boost/python/numpy.hpp>
+#define np boost::python::numpy
+#endif
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -39,9 +45,215 @@ using namespace boost::python;
 using namespace std;
 #define bp boost::python
 
+#if PGL_WITH_BOOST_NUMPY
+/// Returns a numpy array of shape (width, height) sharing the depths of the buffer. It keeps the buffer alive.
+np::ndarray db_to_array(object self)
+{
+    DepthBuffer * buffer = extract<DepthBuffer *>(self)();
+    size_t s = buffer->getDepthSize();
+    bp::list shape, strides;
+    shape.append(buffer->width()); shape.append(buffer->height());
+    strides.append(buffer->height() * s); 
+    switch(buffer->getPrecision()){
+        case DepthBuffer::eRealDepth:
+            strides.append(s);
+            return np::from_data(buffer->data(), np::dtype::get_builtin<real_t>(), bp::tuple(shape), bp::tuple(strides), self);
+        case DepthBuffer::eFloatDepth:
+            strides.append(s);
+            return np::from_data(buffer->data(), np::dtype::get_builtin<float>(), bp::tuple(shape), bp::tuple(strides), self);
+        default:
+            // The 3 bytes of the fixed point depths, least significant first
+            shape.append(3); strides.append(s); strides.append(1);
+            return np::from_data(buffer->data(), np::dtype::get_builtin<uint8_t>(), bp::tuple(shape), bp::tuple(strides), self);
+    }
+}
+
+/// Returns a numpy array of shape (width, height) sharing the ids of the engine. It keeps the ids alive.
+object zbe_getIdArray(ZBufferEngine * engine)
+{
+    Uint32Array2Ptr ids = engine->getIdBuffer();
+    if (is_null_ptr(ids)) return object();
+    size_t s = sizeof(uint32_t);
+    return np::from_data(ids->data(), np::dtype::get_builtin<uint32_t>(),
+                         bp::make_tuple(ids->getColumnSize(), ids->getRowSize()),
+                         bp::make_tuple(ids->getRowSize() * s, s), object(ids));
+}
+
+object zbe_getDepthArray(ZBufferEngine * engine)
+{ return db_to_array(object(engine->getDepthStorage())); }
+
+/// Returns a numpy array of shape (width, height, nbLayers) sharing a field of the layers of the buffer. It keeps the buffer alive.
+template<class T>
+np::ndarray lb_field_to_array(object self, size_t offset)
+{
+    LayerBuffer * buffer = extract<LayerBuffer *>(self)();
+    size_t s = sizeof(LayerBuffer::Layer);
+    return np::from_data(reinterpret_cast<const char *>(buffer->data()) + offset, np::dtype::get_builtin<T>(),
+                         bp::make_tuple(buffer->width(), buffer->height(), buffer->getNbLayers()),
+                         bp::make_tuple(buffer->height() * buffer->getNbLayers() * s, buffer->getNbLayers() * s, s), self);
+}
+
+np::ndarray lb_ids_to_array(object self)
+{ return lb_field_to_array<uint32_t>(self, offsetof(LayerBuffer::Layer, id)); }
+
+np::ndarray lb_depths_to_array(object self)
+{ return lb_field_to_array<float>(self, offsetof(LayerBuffer::Layer, depth)); }
+
+template<class T>
+object values_to_python(const std::vector<T>& values)
+{
+    np::ndarray array = np::empty(bp::make_tuple(values.size()), np::dtype::get_builtin<T>());
+    if (!values.empty()) std::copy(values.begin(), values.end(), reinterpret_cast<T *>(array.get_data()));
+    return array;
+}
+
+/// Values of each shape in each layer as an array of shape (nbShapes, nbLayers).
+template<class T>
+object layer_values_to_python(const std::vector<T>& values, uint32_t nbLayers)
+{
+    np::ndarray array = np::empty(bp::make_tuple(values.size() / nbLayers, nbLayers), np::dtype::get_builtin<T>());
+    if (!values.empty()) std::copy(values.begin(), values.end(), reinterpret_cast<T *>(array.get_data()));
+    return array;
+}
+#else
+template<class T>
+object values_to_python(const std::vector<T>& values)
+{ return make_list(values)(); }
+
+template<class T>
+object layer_values_to_python(const std::vector<T>& values, uint32_t nbLayers)
+{ 
+    bp::list result;
+    for (typename std::vector<T>::const_iterator it = values.begin(); it != values.end(); it += nbLayers)
+        result.append(make_list(std::vector<T>(it, it + nbLayers))());
+    return result;
+}
+#endif
+
+boost::python::dict zbe_getIdStatistics(ZBufferEngine * engine)
+{
+    const IdStatistics& statistics = engine->getIdStatistics();
+    boost::python::dict result;
+    result["ids"] = values_to_python(statistics.ids);
+    result["nbPixels"] = values_to_python(statistics.nbPixels);
+    result["areas"] = values_to_python(statistics.areas);
+    result["meanDepths"] = values_to_python(statistics.meanDepths);
+    result["flags"] = values_to_python(statistics.flags);
+    result["layerPixels"] = layer_values_to_python(statistics.layerPixels, statistics.nbLayers);
+    result["layerAreas"] = layer_values_to_python(statistics.layerAreas, statistics.nbLayers);
+    return result;
+}
+
+void export_DepthBuffer()
+{
+  scope depthbuffer = class_< DepthBuffer, DepthBufferPtr, bases<RefCountObject>, boost::noncopyable > 
+      ("DepthBuffer", "Depth of the pixels of a ZBufferEngine stored with real, float or 24 bits fixed point values.", no_init)
+      .def("getPrecision", &DepthBuffer::getPrecision)
+      .def("width", &DepthBuffer::width)
+      .def("height", &DepthBuffer::height)
+      .def("getAt", &DepthBuffer::getAt, (bp::arg("x"), bp::arg("y")))
+      .def("getRealDepths", &DepthBuffer::getRealDepths, "Return the depths as a RealArray2.")
+#if PGL_WITH_BOOST_NUMPY
+      .def("to_array", &db_to_array, "Return a numpy view of the stored depths. Fixed point depths are given as 3 bytes.")
+#endif
+      ;
+
+   enum_<DepthBuffer::ePrecision>("ePrecision")
+    .value("eRealDepth",DepthBuffer::eRealDepth)
+    .value("eFloatDepth",DepthBuffer::eFloatDepth)
+    .value("eFixed24Depth",DepthBuffer::eFixed24Depth)
+      .export_values()
+      ;
+}
+
+void export_LayerBuffer()
+{
+  class_< LayerBuffer, LayerBufferPtr, bases<RefCountObject>, boost::noncopyable > 
+      ("LayerBuffer", "The nearest fragments of each pixel of a ZBufferEngine, as (depth, id) layers sorted by increasing depth.", no_init)
+      .def("getNbLayers", &LayerBuffer::getNbLayers)
+      .def("width", &LayerBuffer::width)
+      .def("height", &LayerBuffer::height)
+      .def("getNbLayersAt", &LayerBuffer::getNbLayersAt, (bp::arg("x"), bp::arg("y")), "Return the number of non empty layers of the pixel.")
+      .def("getIdAt", &LayerBuffer::getIdAt, (bp::arg("x"), bp::arg("y"), bp::arg("layer")))
+      .def("getDepthAt", &LayerBuffer::getDepthAt, (bp::arg("x"), bp::arg("y"), bp::arg("layer")))
+      .def("clear", &LayerBuffer::clear)
+#if PGL_WITH_BOOST_NUMPY
+      .def("ids_to_array", &lb_ids_to_array, "Return a numpy view of the ids of the layers, indexed by (x, y, layer).")
+      .def("depths_to_array", &lb_depths_to_array, "Return a numpy view of the float depths of the layers, indexed by (x, y, layer). Empty layers have an infinite depth.")
+#endif
+      ;
+}
+
+boost::python::dict zbe_getShapeLighting(ZBufferEngine * engine)
+{
+    boost::python::dict result;
+    const ShapeLightingMap& lighting = engine->getShapeLighting();
+    for (ShapeLightingMap::const_iterator it = lighting.begin(); it != lighting.end(); ++it) {
+        boost::python::list lit;
+        for (std::vector<uint32_t>::const_iterator itl = it->second.nbLitPixels.begin(); itl != it->second.nbLitPixels.end(); ++itl)
+            lit.append(*itl);
+        result[it->first] = boost::python::make_tuple(it->second.nbPixels, lit);
+    }
+    return result;
+}
+
+void export_ShadowMap()
+{
+  class_< ShadowMap, ShadowMapPtr, bases<RefCountObject>, boost::noncopyable > 
+      ("ShadowMap", "Depth map of a scene seen from a directional light.", init<const Vector3&, uint16_t, uint16_t>("Construct a ShadowMap.",(bp::arg("direction"), bp::arg("width")=1024, bp::arg("height")=1024)) )
+      .def("compute", (void(ShadowMap::*)(ScenePtr))&ShadowMap::compute, (bp::arg("scene")))
+      .def("isLit", &ShadowMap::isLit, (bp::arg("position")))
+      .def("isComputed", &ShadowMap::isComputed)
+      .def("getDirection", &ShadowMap::getDirection, return_value_policy<copy_const_reference>())
+      .def("getCamera", &ShadowMap::getCamera, return_value_policy<copy_const_reference>())
+      .def("getDepthBuffer", &ShadowMap::getDepthBuffer, return_value_policy<copy_const_reference>())
+      .add_property("bias", &ShadowMap::getBias, &ShadowMap::setBias)
+      ;
+
+  implicitly_convertible< ShadowMapPtr, RefCountObjectPtr >();
+}
+
+boost::python::dict tc_getStatistics()
+{
+    TextureCache::Statistics stats = TextureCache::get().getStatistics();
+    boost::python::dict result;
+    result["hits"] = stats.hits;
+    result["misses"] = stats.misses;
+    result["reloads"] = stats.reloads;
+    result["evictions"] = stats.evictions;
+    result["nbTextures"] = stats.nbTextures;
+    result["memorySize"] = stats.memorySize;
+    return result;
+}
+
+void tc_clear() { TextureCache::get().clear(); }
+void tc_resetStatistics() { TextureCache::get().resetStatistics(); }
+size_t tc_getMaxMemorySize() { return TextureCache::get().getMaxMemorySize(); }
+void tc_setMaxMemorySize(size_t size) { TextureCache::get().setMaxMemorySize(size); }
+
+void export_TextureCache()
+{
+  class_< TextureCache, boost::noncopyable > 
+      ("TextureCache", "Process wide cache of the mipmapped textures decoded by the ZBufferEngines.", no_init)
+      .def("getStatistics", &tc_getStatistics, "Return a dict with the number of hits, misses, reloads and evictions, the number of textures and their memory size in bytes.")
+      .staticmethod("getStatistics")
+      .def("resetStatistics", &tc_resetStatistics)
+      .staticmethod("resetStatistics")
+      .def("clear", &tc_clear)
+      .staticmethod("clear")
+      .def("getMaxMemorySize", &tc_getMaxMemorySize)
+      .staticmethod("getMaxMemorySize")
+      .def("setMaxMemorySize", &tc_setMaxMemorySize, (bp::arg("size")))
+      .staticmethod("setMaxMemorySize")
+      ;
+}
 
 void export_ZBufferEngine()
 {
+  export_TextureCache();
+  export_ShadowMap();
+  export_DepthBuffer();
+  export_LayerBuffer();
 
    enum_<ZBufferEngine::eRenderingStyle>("eRenderingStyle")
     .value("eColorBased",ZBufferEngine::eColorBased)
@@ -57,6 +269,15 @@ void export_ZBufferEngine()
       .def("setLight", (void(ZBufferEngine::*)(const Vector3&, const Color3&))&ZBufferEngine::setLight)
       .def("setLight", (void(ZBufferEngine::*)(const Vector3&, const Color3&, const Color3&, const Color3&))&ZBufferEngine::setLight)
       .def("getImage", &ZBufferEngine::getImage)
+      .def("getIdBuffer", &ZBufferEngine::getIdBuffer, "Return the ids of the shapes of each pixel with id rendering.")
+      .def("getDepthStorage", &ZBufferEngine::getDepthStorage, return_value_policy<copy_const_reference>())
+      .add_property("depthPrecision",&ZBufferEngine::getDepthPrecision, &ZBufferEngine::setDepthPrecision)
+      .add_property("layerCount",&ZBufferEngine::getLayerCount, &ZBufferEngine::setLayerCount)
+      .def("getLayerBuffer", &ZBufferEngine::getLayerBuffer, return_value_policy<copy_const_reference>(), "Return the layers of the pixels, or None if a single layer is rendered.")
+#if PGL_WITH_BOOST_NUMPY
+      .def("getIdArray", &zbe_getIdArray, "Return a numpy view of the ids of the shapes of each pixel, indexed by (x, y).")
+      .def("getDepthArray", &zbe_getDepthArray, "Return a numpy view of the stored depths, indexed by (x, y).")
+#endif
       .def("getDepthBuffer", &ZBufferEngine::getDepthBuffer)
       .add_property("multithreaded",&ZBufferEngine::isMultiThreaded, &ZBufferEngine::setMultiThreaded)
 
@@ -65,9 +286,28 @@ void export_ZBufferEngine()
       .def("duplicateBuffer", (void(ZBufferEngine::*)(int32_t, int32_t, real_t, bool, const Color3&))&ZBufferEngine::duplicateBuffer,(bp::arg("from"), bp::arg("to")=600, bp::arg("useDefaultColor")=true, bp::arg("defaultcolor")=Color3(0,0,0)))
       .def("periodizeBuffer", (void(ZBufferEngine::*)(const Vector3&, const Vector3&, bool, const Color3&))&ZBufferEngine::periodizeBuffer,(bp::arg("from"), bp::arg("to")=600, bp::arg("useDefaultColor")=true, bp::arg("defaultcolor")=Color3(0,0,0)))
       .def("periodizeBuffer", (void(ZBufferEngine::*)(int32_t, int32_t, real_t, bool, const Color3&))&ZBufferEngine::periodizeBuffer,(bp::arg("from"), bp::arg("to")=600, bp::arg("useDefaultColor")=true, bp::arg("defaultcolor")=Color3(0,0,0)))
+      .def("setPeriodicDomain", &ZBufferEngine::setPeriodicDomain, (bp::arg("lowerCorner"), bp::arg("upperCorner")), "Render the scene as periodic along x and y with the given domain as period. Requires an orthographic camera.")
+      .def("clearPeriodicDomain", &ZBufferEngine::clearPeriodicDomain)
+      .def("isPeriodic", &ZBufferEngine::isPeriodic)
+      .def("getPeriod", &ZBufferEngine::getPeriod, return_value_policy<copy_const_reference>())
       .def("setIdRendering", &ZBufferEngine::setIdRendering)
       .def("isVisible", (bool(ZBufferEngine::*)(int32_t, int32_t, real_t) const)&ZBufferEngine::isVisible,(bp::arg("x"), bp::arg("y"), bp::arg("z")))
       .def("isVisible", (bool(ZBufferEngine::*)(const Vector3&) const)&ZBufferEngine::isVisible,(bp::arg("position")))
+
+      .def("addShadowLight", &ZBufferEngine::addShadowLight, (bp::arg("direction"), bp::arg("mapWidth")=1024, bp::arg("mapHeight")=1024))
+      .def("clearShadowLights", &ZBufferEngine::clearShadowLights)
+      .def("getShadowLightCount", &ZBufferEngine::getShadowLightCount)
+      .def("getShadowMap", &ZBufferEngine::getShadowMap, (bp::arg("lightid")))
+      .def("computeShadowMaps", &ZBufferEngine::computeShadowMaps, (bp::arg("scene")))
+      .def("computeLighting", &ZBufferEngine::computeLighting)
+      .def("getLightingBuffer", &ZBufferEngine::getLightingBuffer)
+      .def("getShapeLighting", &zbe_getShapeLighting, "Return a dict giving for each shape id the number of visible pixels and the number of pixels lit by each shadow light.")
+      .add_property("shadowIntensity", &ZBufferEngine::getShadowIntensity, &ZBufferEngine::setShadowIntensity)
+      .add_property("idStatisticsEnabled", &ZBufferEngine::isIdStatisticsEnabled, &ZBufferEngine::setIdStatisticsEnabled)
+      .def("computeIdStatistics", &ZBufferEngine::computeIdStatistics)
+      .def("getIdStatistics", &zbe_getIdStatistics, "Return a dict of arrays sorted by shape id giving the ids, the number of pixels, "
+           "the area, the mean depth and the hit flags (1: first hit, 2: last hit) of the shapes, "
+           "and the number of pixels and the area of the shapes in each layer.")
       ;
 
 
@@ -43,11 +43,17 @@
 #include <boost/python.hpp>
 #include "export_action.h"
 #include <plantgl/python/exception_core.h>
+#if PGL_WITH_BOOST_NUMPY
+#include <boost/python/numpy.hpp>
+#endif
 
 /* ----------------------------------------------------------------------- */
 
 void module_algo()
 {
+#if PGL_WITH_BOOST_NUMPY
+    boost::python::numpy::initialize();
+#endif
   define_stl_exceptions();
 
     // util class export
@@ -68,6 +74,7 @@ void module_algo()
     // custom algo
     export_Merge();
     export_Fit();
+    export_BranchCompressor();
 
     // abstract printer export
     export_StrPrinter();
@@ -93,6 +100,7 @@ void module_algo()
     export_ProjectionCamera();
     export_ProjectionEngine();
     export_ZBufferEngine();
+    export_SkyIrradiance();
     export_DepthSortEngine();
     export_ProjectionRenderer();
 
@@ -117,6 +125,7 @@ void module_algo()
     export_KDtree();
     export_PyGrid();
     export_PlaneClip();
+    export_SceneVoxelizer();
 
     // CurveManipulation export
     export_CurveManipulation();
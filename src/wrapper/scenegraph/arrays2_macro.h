@@ -147,8 +147,11 @@ typename T::element_type& array2_ct_getitem( T * array, boost::python::tuple ind
 {
   size_t i = boost::python::extract<size_t>(indices[0])();
   size_t j = boost::python::extract<size_t>(indices[1])();
-  if( i < array->getRowNb() && j < array->getColumnNb() )
+  if( i < array->getRowNb() && j < array->getColumnNb() ) {
+    // the returned element can be modified in place from python
+    array->touch();
     return array->getAt( i, j );
+  }
   else {
       std::stringstream ss;
       ss << (int)i << "," << (int)j << " should be in [0," << array->getRowNb() << "]x[0," << array->getColumnNb() << "]";
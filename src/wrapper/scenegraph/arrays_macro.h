@@ -138,6 +138,8 @@ template<class T>
 typename T::element_type& array_ct_getitem( T * a, int pos )
 {
   size_t len = a->size();
+  // the returned element can be modified in place from python
+  a->touch();
   if( pos < 0 && pos >= -(int)len ) return a->getAt( len + pos );
   else if( pos < len ) return a->getAt( pos );
   else throw PythonExc_IndexError();
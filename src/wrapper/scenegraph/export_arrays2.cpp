@@ -66,6 +66,7 @@ EXPORT_FUNCTION( p2m, Point2Matrix )
 EXPORT_FUNCTION( p3m, Point3Matrix )
 EXPORT_FUNCTION( p4m, Point4Matrix )
 EXPORT_FUNCTION( ra,  RealArray2 )
+EXPORT_FUNCTION( ua,  Uint32Array2 )
 
 #if PGL_WITH_BOOST_NUMPY
 np::ndarray array_to_nparray(RealArray2 * data)
@@ -113,6 +114,9 @@ void export_arrays2()
    .def("threshold_min_values",&threshold_min_values);
 
   EXPORT_CONVERTER(RealArray2);
+
+  EXPORT_ARRAY_BT( ua, Uint32Array2 );
+  EXPORT_CONVERTER(Uint32Array2);
 }
 
 
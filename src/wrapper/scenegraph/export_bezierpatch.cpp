@@ -44,6 +44,7 @@
 #include <plantgl/scenegraph/geometry/bezierpatch.h>
 #include <plantgl/scenegraph/container/pointmatrix.h>
 #include <plantgl/scenegraph/geometry/lineicmodel.h>
+#include <plantgl/scenegraph/container/pointarray.h>
 
 
 #include <plantgl/python/export_refcountptr.h>
@@ -59,6 +60,14 @@ using namespace std;
 
 DEF_POINTEE(BezierPatch)
 
+object bzp_evaluateGrid(BezierPatch * patch, const RealArrayPtr& uvalues, const RealArrayPtr& vvalues, bool withnormals)
+{
+  if (!withnormals) return object(patch->evaluateGrid(uvalues,vvalues));
+  Point3ArrayPtr normals;
+  Point3ArrayPtr points = patch->evaluateGrid(uvalues,vvalues,&normals);
+  return bp::make_tuple(points,normals);
+}
+
 
 void export_BezierPatch()
 {
@@ -82,6 +91,9 @@ void export_BezierPatch()
     .add_static_property("DEFAULT_STRIDE",make_getter(&BezierPatch::DEFAULT_STRIDE))
     .DEC_PTR_PROPERTY(ctrlPointMatrix,BezierPatch,CtrlPointMatrix,Point4MatrixPtr)
     .def("getPointAt",&BezierPatch::getPointAt)
+    .def("evaluateGrid",&bzp_evaluateGrid,(bp::arg("uvalues"),bp::arg("vvalues"),bp::arg("normals")=false),
+         "Compute the points of the patch on the grid uvalues x vvalues. Point (i,j) is at index i*len(vvalues)+j. "
+         "If normals is True, return a tuple (points, normals).")
     .def("getIsoUSectionAt",&BezierPatch::getIsoUSectionAt,args("u"),"Compute a section line of the patch corresponding to a constant u value.")
     .def("getIsoVSectionAt",&BezierPatch::getIsoVSectionAt,args("v"),"Compute a section line of the patch corresponding to a constant v value.")
     ;
@@ -53,9 +53,18 @@ PGL_USING_NAMESPACE
 
 DEF_POINTEE( Mesh )
 
+void mesh_computeNormalList(Mesh * mesh, bool pervertex, Mesh::NormalWeighting weighting)
+{ mesh->computeNormalList(pervertex, weighting); }
+
+Point3ArrayPtr mesh_computeNormalPerVertex(Mesh * mesh, Mesh::NormalWeighting weighting)
+{ return mesh->computeNormalPerVertex(weighting); }
+
+Point3ArrayPtr mesh_computeNormalPerFace(Mesh * mesh)
+{ return mesh->computeNormalPerFace(); }
+
 void export_Mesh()
 {
-  class_<Mesh, MeshPtr, bases<ExplicitModel>, boost::noncopyable>( "Mesh", "Abstract base class for objects of type of mesh.", no_init )
+  scope mesh_scope = class_<Mesh, MeshPtr, bases<ExplicitModel>, boost::noncopyable>( "Mesh", "Abstract base class for objects of type of mesh.", no_init )
       .def("indexListSize",&Mesh::getIndexListSize)
       .DEC_BT_NR_PROPERTY_WDV(solid,            Mesh, Solid,           bool,  DEFAULT_SOLID)
       .DEC_BT_NR_PROPERTY_WDV(ccw,              Mesh, CCW,             bool,  DEFAULT_CCW)
@@ -65,14 +74,23 @@ void export_Mesh()
       .DEC_PTR_PROPERTY_WD(normalList,      Mesh, NormalList,      Point3ArrayPtr)
       .DEC_PTR_PROPERTY_WD(texCoordList,    Mesh, TexCoordList,    Point2ArrayPtr)
       .def("computeNormalList",  (void (Mesh::*)())&Mesh::computeNormalList)
-      .def("estimateNormalPerVertex",  (void (Mesh::*)())&Mesh::computeNormalPerVertex)
-      .def("estimateNormalPerFace",  (void (Mesh::*)())&Mesh::computeNormalPerFace)
+      .def("computeNormalList",  &mesh_computeNormalList, (arg("pervertex"),arg("weighting")=Mesh::eAreaWeighting))
+      .def("estimateNormalPerVertex",  &mesh_computeNormalPerVertex, (arg("weighting")=Mesh::eAreaWeighting), "Return the normals per vertex of the mesh.")
+      .def("estimateNormalPerFace",  &mesh_computeNormalPerFace, "Return the normals per face of the mesh.")
       .def( "pointAt",    (const Vector3& (Mesh::*)(uint_t) const)&Mesh::getPointAt,    return_value_policy<copy_const_reference>() )
       .def( "pointAt",    (const Vector3& (Mesh::*)(uint_t,uint_t) const)&Mesh::getFacePointAt,    return_value_policy<copy_const_reference>() )
       .def( "faceCenter",    &Mesh::getFaceCenter )
       .def( "faceSize",    &Mesh::getFaceSize )
 
       ;
+
+  enum_<Mesh::NormalWeighting>("NormalWeighting")
+    .value("eAreaWeighting",Mesh::eAreaWeighting)
+    .value("eAngleWeighting",Mesh::eAngleWeighting)
+    .value("eUniformWeighting",Mesh::eUniformWeighting)
+    .export_values()
+    ;
+
   implicitly_convertible<MeshPtr, ExplicitModelPtr>();
 
 }
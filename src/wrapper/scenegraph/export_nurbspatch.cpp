@@ -121,6 +121,9 @@ void export_NurbsPatch()
     .def("deriveAt",&NurbsPatch::deriveAt,bp::args("u","v","d","uspan","vspan"))
     .def("getDerivativeAt",&NurbsPatch::getDerivativeAt,bp::args("u","v","du","dv"),"Return the derivative at u and v. du and dv specify how many time you want to derive with respect to u and v.")
     .def("getDerivativesAt",&NurbsPatch::getDerivativesAt,bp::args("u","v"))
+    .def("buildBezierCache",&NurbsPatch::buildBezierCache,"Extract the Bezier patches of the patch to speed up its evaluation. Return False if the knot lists are not clamped.")
+    .def("clearBezierCache",&NurbsPatch::clearBezierCache,"Remove the Bezier extraction cache. The cache is also dropped when the control points or the knot lists are modified.")
+    .def("hasBezierCache",&NurbsPatch::hasBezierCache)
     ;
 
   implicitly_convertible< NurbsPatchPtr,BezierPatchPtr >();
@@ -42,6 +42,7 @@
 
 #include <plantgl/scenegraph/scene/scene.h>
 #include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/scenegraph/scene/flatscene.h>
 #include <plantgl/scenegraph/geometry/geometry.h>
 #include <plantgl/scenegraph/appearance/appearance.h>
 #include <plantgl/scenegraph/core/action.h>
@@ -210,6 +211,50 @@ bool scene_is_valid(Scene * sc){
 
 
 
+void sc_setObjectPool(Scene * sc, const ObjectPoolPtr& pool) { sc->setObjectPool(pool); }
+void sc_setObjectPool2(Scene * sc, const ObjectPoolPtr& pool, bool teardown) { sc->setObjectPool(pool, teardown); }
+
+class PyObjectPoolScope {
+public:
+    PyObjectPoolScope(ObjectPoolPtr pool) : __pool(pool), __scope(NULL) { }
+    ~PyObjectPoolScope() { if (__scope) delete __scope; }
+
+    ObjectPoolPtr enter() { if (!__scope) __scope = new ObjectPoolScope(__pool); return __pool; }
+    void exit(object, object, object) { if (__scope) { delete __scope; __scope = NULL; } }
+
+protected:
+    ObjectPoolPtr __pool;
+    ObjectPoolScope * __scope;
+};
+
+object fsc_getShapeNodes(FlatScene * fsc) { return make_list(fsc->getShapeNodes())(); }
+
+void fsc_check_index(FlatScene * fsc, uint_t i) {
+  if (i >= fsc->size()) throw PythonExc_IndexError();
+}
+
+SceneObjectPtr fsc_getObject(FlatScene * fsc, uint_t i) { fsc_check_index(fsc,i); return SceneObjectPtr(fsc->getNode(i).sceneObject); }
+std::string fsc_getTagName(FlatScene * fsc, uint_t i) { fsc_check_index(fsc,i); return FlatScene::getTagName(fsc->getNode(i).tag); }
+object fsc_getParent(FlatScene * fsc, uint_t i) {
+  fsc_check_index(fsc,i);
+  uint_t parent = fsc->getNode(i).parent;
+  if (parent == FlatScene::NO_INDEX) return object();
+  return object(parent);
+}
+uint_t fsc_getNextNode(FlatScene * fsc, uint_t i) { fsc_check_index(fsc,i); return fsc->getNextNode(i); }
+object fsc_getWorldMatrix(FlatScene * fsc, uint_t i) {
+  fsc_check_index(fsc,i);
+  if (!fsc->hasWorldMatrix(i)) return object();
+  return object(fsc->getWorldMatrix(i));
+}
+dict fsc_getTagCount(FlatScene * fsc) {
+  std::vector<uint_t> count = fsc->getTagCount();
+  dict result;
+  for (uint_t t = 0; t < count.size(); ++t)
+    if (count[t] > 0) result[FlatScene::getTagName(t)] = count[t];
+  return result;
+}
+
 void export_Scene()
 {
   class_<Scene,ScenePtr, bases<RefCountObject>, boost::noncopyable> sc("Scene",
@@ -269,9 +314,51 @@ void export_Scene()
     sc.def("sort", &Scene::sort);
     sc.def("getId",&RefCountObject::uid);
     sc.def("getPglReferenceCount",&RefCountObject::use_count);
+    sc.add_property("objectPool",make_function(&Scene::getObjectPool,return_value_policy<copy_const_reference>()),&sc_setObjectPool);
+    sc.def("setObjectPool", &sc_setObjectPool2, (boost::python::arg("pool"), boost::python::arg("teardown")=false),
+           "Set the pool of the scene. If teardown, the memory of all the objects of the pool is freed at once when the scene is deleted. "
+           "The objects of the pool should then be referenced only by the scene.");
+    sc.def("isObjectPoolTeardown", &Scene::isObjectPoolTeardown);
     sc.enable_pickling();
   ;
 
+  class_<FlatScene, FlatScenePtr, bases<RefCountObject>, boost::noncopyable>("FlatScene",
+      "A Scene compiled into a flat list of nodes in depth first order with type tags. "
+      "Actions applied on it are dispatched without virtual calls on the shapes.",
+      init<ScenePtr>(args("scene")))
+      .def("__len__", &FlatScene::size)
+      .def("size", &FlatScene::size)
+      .def("getScene", &FlatScene::getScene, return_value_policy<copy_const_reference>())
+      .def("getShapeNodes", &fsc_getShapeNodes)
+      .def("getObject", &fsc_getObject, args("nodeid"))
+      .def("getTagName", &fsc_getTagName, args("nodeid"))
+      .def("getParent", &fsc_getParent, args("nodeid"))
+      .def("getNextNode", &fsc_getNextNode, args("nodeid"))
+      .def("getWorldMatrix", &fsc_getWorldMatrix, args("nodeid"), "Matrix of the transformations of the ancestors of the node. None if they are not all linear.")
+      .def("getTagCount", &fsc_getTagCount)
+      .def("apply", &FlatScene::apply)
+      .def("applyGeometryOnly", &FlatScene::applyGeometryOnly)
+      ;
+
+  class_<ObjectPool, ObjectPoolPtr, bases<RefCountObject>, boost::noncopyable>("ObjectPool",
+      "A pool of memory for the objects created while it is activated with an ObjectPoolScope. "
+      "A thread confined pool takes no lock and its objects have a non atomic reference counter: they should be referenced by one thread only.",
+      init<optional<bool,size_t> >(args("threadConfined","chunkSize")))
+      .def("isThreadConfined", &ObjectPool::isThreadConfined)
+      .def("getLiveObjectCount", &ObjectPool::getLiveObjectCount)
+      .def("getChunkCount", &ObjectPool::getChunkCount)
+      .def("getAllocatedSize", &ObjectPool::getAllocatedSize)
+      .def("clear", &ObjectPool::clear, "Free all the memory of the pool at once. Only done if no object of the pool is alive.")
+      .def("releaseAll", &ObjectPool::releaseAll, "Free all the memory of the pool at once, whatever the objects still alive, which should not be used anymore. Return their number.")
+      ;
+
+  class_<PyObjectPoolScope, boost::noncopyable>("ObjectPoolScope",
+      "Context manager that activates an ObjectPool on the current thread. with ObjectPoolScope(pool): ...",
+      init<ObjectPoolPtr>(args("pool")))
+      .def("__enter__", &PyObjectPoolScope::enter)
+      .def("__exit__", &PyObjectPoolScope::exit)
+      ;
+
   class_<Scene::Pool, boost::noncopyable>("Pool","The scene pool. Allow you to access all scene in memory using their id.",no_init)
       .def("get", &Scene::Pool::get, "get scene from id.")
       .def("__getitem__", &Scene::Pool::get, "get scene from id.")
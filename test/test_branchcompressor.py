@@ -0,0 +1,47 @@
+from openalea.plantgl.all import *
+from math import cos, sin
+
+
+def branches():
+    """ A trunk carrying lateral branches, which carry secondary branches. """
+    result = []
+    def branch(id, father, origin, direction, nbpoints):
+        points = Point3Array([origin + direction * i + Vector3(0.1 * sin(i), 0.1 * cos(i), 0) for i in range(nbpoints)])
+        radius = Point2Array([Vector2(0.05 * (nbpoints - i) + 0.01, 0.05 * (nbpoints - i) + 0.01) for i in range(nbpoints)])
+        result.append(BranchInput(points, radius, Material.DEFAULT_MATERIAL, id, father))
+        return points
+    trunk = branch(1, 0, Vector3(0, 0, 0), Vector3(0, 0, 1), 30)
+    id = 2
+    for i in range(3, 30, 3):
+        lateral = branch(id, 1, trunk[i], Vector3(cos(i), sin(i), 0.5), 15)
+        father, id = id, id + 1
+        for j in range(4, 15, 5):
+            branch(id, father, lateral[j], Vector3(-sin(i), cos(i), 0.3), 6)
+            id += 1
+    return result
+
+
+def compressed(multithreaded, rate, option):
+    compressor = BranchCompressor()
+    compressor.setVerbose(False)
+    compressor.setMultiThreaded(multithreaded)
+    assert compressor.isMultiThreaded() == multithreaded
+    compressor.setData(branches())
+    scene = compressor.compress(rate, option=option)[0]
+    t = Tesselator()
+    result = []
+    for sh in scene:
+        sh.apply(t)
+        result.append((sh.id, [tuple(p) for p in t.result.pointList]))
+    return result
+
+
+def test_multithreaded_compression():
+    # the parallel fitting of the branches does not change the compressed geometry
+    for rate in [30, 85]:
+        for option in range(3):
+            assert compressed(True, rate, option) == compressed(False, rate, option)
+
+
+if __name__ == '__main__':
+    test_multithreaded_compression()
@@ -35,7 +35,30 @@ def test_read_obj():
     assert s.isValid()
     s.read(get_filename('trumpet.obj'))
     assert s.isValid()
-    
+
+def test_read_obj_groups():
+    import os, tempfile
+    tmpdir = tempfile.mkdtemp()
+    with open(os.path.join(tmpdir, 'groups.mtl'), 'w') as stream:
+        stream.write('newmtl red\nKa 0 0 0\nKd 1 0 0\nd 0.5\n')
+    with open(os.path.join(tmpdir, 'groups.obj'), 'w') as stream:
+        stream.write('mtllib groups.mtl\n'
+                     'v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 2\n'
+                     'g first\nusemtl red\nf 1//1 2//1 3//1\nf -4//-1 -2//-1 -1//-1\n'
+                     'g second\nf 1 2 3 4\nl 1 2 3\n')
+    s = Scene()
+    s.read(os.path.join(tmpdir, 'groups.obj'))
+    assert len(s) == 2, len(s)
+    assert s.isValid()
+    assert s[0].name == 'first' and s[1].name == 'second'
+    assert s[0].appearance.name == 'red' and s[1].appearance.name == 'red'
+    assert abs(s[0].appearance.transparency - 0.5) < 1e-5
+    assert type(s[0].geometry) == TriangleSet
+    assert len(s[0].geometry.pointList) == 4 and len(s[0].geometry.indexList) == 2
+    assert s[0].geometry.normalList[0] == Vector3(0,0,1)
+    assert type(s[1].geometry) == Group
+    assert type(s[1].geometry.geometryList[0]) == QuadSet
+
 def test_write_obj():
     s = Scene()
     s.read(get_filename('icosahedron.obj'))
@@ -56,3 +79,58 @@ def test_write_obj():
     s.clear()
     s.read(get_filename('test_trumpet.obj'))
     assert s.isValid()
+
+def test_read_obj_native():
+    # the python codec only writes obj files and does not shadow the native reader
+    assert 'read' not in obj.ObjCodec.__dict__
+    assert obj.codec.name != 'OBJ'
+    import os, tempfile
+    fname = os.path.join(tempfile.mkdtemp(), 'native.obj')
+    with open(fname, 'w') as stream:
+        stream.write('v 0 0 0\nv 1 0 0\nv 1 1 0\nusemtl undefined\nf -3 -2 -1\n')
+    for s in [Scene(fname), Scene()]:
+        if len(s) == 0: s.read(fname, 'OBJ')
+        assert len(s) == 1, len(s)
+        # relative indices and undefined materials are only supported by the native reader
+        assert type(s[0].geometry) == TriangleSet
+        assert list(s[0].geometry.indexList[0]) == [0, 1, 2]
+        assert s[0].appearance.name == 'undefined'
+        assert s[0].appearance.ambient == Material.DEFAULT_MATERIAL.ambient
+
+def read_glb(fname):
+    import json, struct
+    with open(fname, 'rb') as stream:
+        data = stream.read()
+    magic, version, length = struct.unpack('<III', data[:12])
+    assert magic == 0x46546C67 and version == 2 and length == len(data)
+    jsonlength, jsontype = struct.unpack('<II', data[12:20])
+    return json.loads(data[20:20+jsonlength].decode())
+
+def test_write_glb_index_type():
+    # indices use the smallest type that does not contain its primitive restart value (255 or 65535)
+    for nbvertices, componenttype in [(255, 5121), (256, 5123), (65535, 5123), (65536, 5125)]:
+        points = Point3Array([(i % 256, i // 256, (i % 7) * 0.1) for i in range(nbvertices)])
+        indices = Index3Array([(i, i+1, i+2) for i in range(nbvertices-2)])
+        Scene([Shape(TriangleSet(points, indices), Material((0,200,0)))]).save(get_filename('test_index_type.glb'))
+        gltf = read_glb(get_filename('test_index_type.glb'))
+        accessor = gltf['accessors'][gltf['meshes'][0]['primitives'][0]['indices']]
+        assert accessor['componentType'] == componenttype, (nbvertices, accessor['componentType'])
+        assert accessor['count'] == 3 * (nbvertices-2)
+
+def test_write_glb():
+    sphere = Sphere(1, 8, 8)
+    s = Scene([Shape(Translated((3*i,0,0),sphere), Material((0,200,0)), i+1) for i in range(3)])
+    s.add(Shape(Box((1,2,3)), Material((200,0,0), transparency=0.5), 10))
+    s.save(get_filename('test_scene.glb'))
+    gltf = read_glb(get_filename('test_scene.glb'))
+    # the sphere is written once and instanced by the nodes of its shapes
+    assert len(gltf['meshes']) == 2
+    assert len(gltf['nodes']) == 5
+    assert len(gltf['materials']) == 2
+    assert [n['extras']['id'] for n in gltf['nodes'][1:]] == [1, 2, 3, 10]
+    assert gltf['nodes'][2]['matrix'][12:15] == [3, 0, 0]
+
+    s.save(get_filename('test_scene_quantized.glb'), 'GLTF_QUANTIZED')
+    gltf = read_glb(get_filename('test_scene_quantized.glb'))
+    assert 'KHR_mesh_quantization' in gltf['extensionsRequired']
+    assert len(gltf['meshes']) == 2
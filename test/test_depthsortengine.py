@@ -0,0 +1,87 @@
+from openalea.plantgl.all import *
+from random import random, seed
+
+def square(xmin, ymin, size, z):
+    return QuadSet([(xmin,ymin,z),(xmin+size,ymin,z),(xmin+size,ymin+size,z),(xmin,ymin+size,z)],[(0,1,2,3)])
+
+def build_scene():
+    return Scene([Shape(square(0,0,2,0),id=1),
+                  Shape(square(1,0,2,-1),id=2),
+                  Shape(square(1.5,1.5,1,-2),id=3)])
+
+def engine(multithreaded):
+    e = DepthSortEngine()
+    e.setOrthographicCamera(-5,5,-5,5,1,100)
+    e.lookAt((0,0,10),(0,0,0),(0,1,0))
+    e.multithreaded = multithreaded
+    return e
+
+def visible_areas(e):
+    areas = {}
+    for sh in e.getProjectionResult():
+        p = sh.geometry.pointList
+        a = abs(cross(Vector2(p[1].x-p[0].x,p[1].y-p[0].y), Vector2(p[2].x-p[0].x,p[2].y-p[0].y)))/2
+        areas[sh.id] = areas.get(sh.id, 0) + a
+    return areas
+
+def check_areas(areas):
+    # the sorted pieces do not overlap: each id keeps its visible area only
+    expected = {1 : 4, 2 : 2, 3 : 0.5}
+    assert sorted(areas.keys()) == [1, 2, 3]
+    for sid, area in expected.items():
+        assert abs(areas[sid] - area) < 1e-5, (sid, areas[sid])
+
+def test_depthsort():
+    e = engine(False)
+    e.process(build_scene())
+    check_areas(visible_areas(e))
+
+def test_depthsort_multithreaded():
+    e = engine(True)
+    e.process(build_scene())
+    assert e.getPendingTriangleCount() == 0
+    check_areas(visible_areas(e))
+
+def test_depthsort_flush():
+    e = engine(True)
+    t = Tesselator()
+    for sh in build_scene():
+        sh.geometry.apply(t)
+        pts = t.result.pointList
+        for i,j,k in t.result.indexList:
+            e.processTriangle(pts[i], pts[j], pts[k], sh.id)
+    assert e.getPendingTriangleCount() == 6
+    e.flush()
+    assert e.getPendingTriangleCount() == 0
+    check_areas(visible_areas(e))
+
+def test_depthsort_lazy_flush():
+    e = engine(True)
+    for sh in build_scene():
+        t = Tesselator()
+        sh.geometry.apply(t)
+        pts = t.result.pointList
+        for i,j,k in t.result.indexList:
+            e.processTriangle(pts[i], pts[j], pts[k], sh.id)
+    # the stored triangles are processed when the result is asked
+    check_areas(visible_areas(e))
+    assert e.getPendingTriangleCount() == 0
+
+def clusters_scene():
+    seed(0)
+    shapes = []
+    for i in range(60):
+        cx, cy = (i % 5) * 3 - 6, ((i // 5) % 3) * 3 - 3
+        pts = [(cx + 1.5 * random(), cy + 1.5 * random(), 2 * random() - 1) for k in range(3)]
+        shapes.append(Shape(TriangleSet(pts, [(0,1,2)]), id = i+1))
+    return Scene(shapes)
+
+def test_depthsort_multithreaded_equivalence():
+    # groups of overlapping triangles are sorted in parallel with the same result as in serial
+    results = []
+    for multithreaded in [False, True]:
+        e = engine(multithreaded)
+        e.process(clusters_scene())
+        results.append([(sh.id, [tuple(p) for p in sh.geometry.pointList]) for sh in e.getResult()])
+    assert len(results[0]) > 60
+    assert results[0] == results[1]
@@ -5,6 +5,93 @@ from random import uniform, randint
 pointrange = (0,10)
 def random_point2(pointrange = pointrange) : return Vector2(uniform(*pointrange),uniform(*pointrange))
 
+def test_symmetric_eigen_decomposition():
+    m = Matrix3(2, 1, 0, 1, 2, 0, 0, 0, 3)
+    values, vectors = symmetric_eigen_decomposition(m)
+    assert abs(values[0] - 1) < 1e-8 and abs(values[1] - 3) < 1e-8 and abs(values[2] - 3) < 1e-8
+    for i in range(3):
+        v = vectors.getColumn(i)
+        assert norm(m * v - v * values[i]) < 1e-8
+    assert abs(vectors.det() - 1) < 1e-8
+    # repeated and null eigen values
+    for mat in [Matrix3(0,0,0,0,0,0,0,0,0), Matrix3(), Matrix3(1,1,1,1,1,1,1,1,1)]:
+        values, vectors = symmetric_eigen_decomposition(mat)
+        for i in range(3):
+            v = vectors.getColumn(i)
+            assert norm(mat * v - v * values[i]) < 1e-8
+    results = symmetric_eigen_decomposition([m, Matrix3()])
+    assert len(results) == 2
+
+def test_pointsets_normals():
+    points = Point3Array([(uniform(0,1), uniform(0,1), 0) for i in range(50)])
+    normals = pointsets_normals(points, [list(range(50))])
+    assert abs(abs(normals[0][2]) - 1) < 1e-8
+    orientations = pointsets_orientations(Point3Array([(i, 0, 0) for i in range(5)]), [list(range(5))])
+    assert abs(abs(orientations[0][0]) - 1) < 1e-8
+
+def test_pointsets_principal_axes_equivalence():
+    # the batch functions give the fits of the single group functions, up to the sign
+    points = Point3Array()
+    groups = []
+    for g in range(100):
+        center = Vector3(uniform(-10,10), uniform(-10,10), uniform(-10,10))
+        axes = [Vector3(uniform(-1,1), uniform(-1,1), uniform(-1,1)) for i in range(3)]
+        u = direction(axes[0])
+        v = direction(cross(u, axes[1]))
+        w = cross(u, v)
+        groups.append(list(range(len(points), len(points) + 30)))
+        for i in range(30):
+            points.append(center + u * uniform(-5,5) + v * uniform(-1,1) + w * uniform(-0.1,0.1))
+    normals = pointsets_normals(points, groups)
+    orientations = pointsets_orientations(points, groups)
+    for i, group in enumerate(groups):
+        assert abs(abs(dot(normals[i], pointset_normal(points, group))) - 1) < 1e-6
+        assert abs(abs(dot(orientations[i], pointset_orientation(points, group))) - 1) < 1e-6
+
+def test_pointsets_empty_group():
+    # an empty group stands for all the points, for single and batch versions alike
+    points = Point3Array([(uniform(0,1), uniform(0,1), 0) for i in range(50)])
+    assert abs(abs(pointset_normal(points, [])[2]) - 1) < 1e-8
+    assert abs(abs(pointsets_normals(points, [[]])[0][2]) - 1) < 1e-8
+    line = Point3Array([(0, i, 0) for i in range(5)])
+    assert abs(abs(pointset_orientation(line, [])[1]) - 1) < 1e-8
+    assert abs(abs(pointsets_orientations(line, [[]])[0][1]) - 1) < 1e-8
+
+def test_convex_hulls():
+    corners = [(x, y, z) for x in (0, 1) for y in (0, 1) for z in (0, 1)]
+    points = Point3Array(corners + [(uniform(0.1,0.9), uniform(0.1,0.9), uniform(0.1,0.9)) for i in range(50)])
+    hull = ConvexHull3D(points)
+    assert hull.isValid()
+    mesh = hull.getMesh()
+    assert len(mesh.pointList) == 8 and len(mesh.indexList) == 12
+    incremental = ConvexHull3D()
+    for p in points:
+        incremental.insert(p)
+    assert incremental.getFaceNb() == 12
+    assert incremental.contains(Vector3(0.5, 0.5, 0.5)) and not incremental.contains(Vector3(2, 0, 0))
+    hulls = pointsets_convex_hulls(points, [list(range(8)), list(range(8, len(points))), []])
+    assert len(hulls[0].pointList) == 8 and hulls[1] is not None and hulls[2] is None
+    square = Point2Array([(0, 0), (1, 0), (0.5, 0.5), (1, 1), (0, 1)])
+    assert len(ConvexHull2D(square).getPointList()) == 4
+    assert len(pointsets_convex_polylines(square, [list(range(5))])[0].ctrlPointList) == 4
+
+def test_convex_hull_tolerance():
+    # the tolerance is relative to the extent of the points, not to their distance to the origin
+    offset = Vector3(1e4, 1e4, 1e4)
+    corners = [Vector3(x, y, z) + offset for x in (0, 1) for y in (0, 1) for z in (0, 1)]
+    hull = ConvexHull3D(Point3Array(corners + [Vector3(1.05, 0.5, 0.5) + offset]))
+    assert len(hull.getMesh().pointList) == 9
+    square = ConvexHull2D(Point2Array([(0, 0), (1e-3, 0), (1e-3, 1e-3), (0, 1e-3)]))
+    assert square.contains(Vector2(1e-3, 5e-4)) and not square.contains(Vector2(1.005e-3, 5e-4))
+    # coplanar points inserted one by one, then a point giving a volume
+    incremental = ConvexHull3D()
+    for i in range(200):
+        assert incremental.insert(Vector3(uniform(0, 1), uniform(0, 1), 0))
+        assert not incremental.isValid()
+    incremental.insert(Vector3(0.5, 0.5, 1))
+    assert incremental.isValid()
+    assert incremental.contains(Vector3(0.5, 0.5, 0.5))
+
 if not pgl_support_extension('CGAL'):
     import warnings
     warnings.warn("Not supported CGAL extension. Skip overlay tests.")
@@ -0,0 +1,47 @@
+from openalea.plantgl.all import *
+
+def build_scene():
+    sc = Scene()
+    for i in range(10):
+        g = Sphere(1)
+        for j in range(3):
+            g = Translated(Vector3(i,j,1),g)
+        sc += Shape(Scaled(Vector3(2,2,2),g))
+    return sc
+
+def test_flatscene_structure():
+    sc = build_scene()
+    fsc = FlatScene(sc)
+    assert len(fsc.getShapeNodes()) == len(sc)
+    count = fsc.getTagCount()
+    assert count['Shape'] == 10
+    assert count['Translated'] == 30
+    assert count['Sphere'] == 10
+    for shapeid in fsc.getShapeNodes():
+        assert fsc.getTagName(shapeid) == 'Shape'
+        assert fsc.getParent(shapeid) is None
+        assert fsc.getNextNode(shapeid) - shapeid == 7
+
+def test_flatscene_bbox():
+    sc = build_scene()
+    fsc = FlatScene(sc)
+    bbc = BBoxComputer(Discretizer())
+    bbc.process(sc)
+    bbox = bbc.result
+    bbc.process(fsc)
+    assert norm(bbc.result.getLowerLeftCorner() - bbox.getLowerLeftCorner()) < 1e-5
+    assert norm(bbc.result.getUpperRightCorner() - bbox.getUpperRightCorner()) < 1e-5
+
+def test_flatscene_bbox_transformations():
+    sphere = Sphere(1)
+    sc = Scene([Shape(Translated((5,0,0),Group([AxisRotated((0,0,1),0.5,Box((1,2,3))), Scaled((1,1,3),sphere)]))),
+                Shape(Translated((0,4,0),Tapered(1,0.5,Cylinder(1,2)))),
+                Shape(Scaled((2,2,2),Translated((0,0,-3),sphere)))])
+    fsc = FlatScene(sc)
+    bbc = BBoxComputer(Discretizer())
+    bbc.process(sc)
+    bbox = bbc.result
+    bbc.clear()
+    bbc.process(fsc)
+    assert norm(bbc.result.getLowerLeftCorner() - bbox.getLowerLeftCorner()) < 1e-5
+    assert norm(bbc.result.getUpperRightCorner() - bbox.getUpperRightCorner()) < 1e-5
@@ -12,6 +12,27 @@ def test_triangle():
     print(res)
 
 
+def test_sky_irradiance():
+    from openalea.plantgl.all import QuadSet, Scene, Shape, SkyIrradiance
+    square = Scene([Shape(QuadSet([(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0)], [list(range(4))]), id=3)])
+    sky = SkyIrradiance(square, 0.01)
+    assert abs(sky.getShapeAreas()[3] - 1) < 1e-5
+    res = sky.interception([(0, 90, 1)])
+    assert abs(res[3] - 1) < 0.05, res
+    res = sky.irradiance([(0, 30, 1)], horizontal = True)
+    assert abs(res[3] - 1) < 0.05, res
+    assert sky.getNbCachedDirections() == 2
+    sky.interception([(0, 90, 1), (180, 30, 1)])
+    assert sky.getNbCachedDirections() == 3
+
+def test_sun_course():
+    from openalea.plantgl.light.sunDome import getDirectLight
+    sun = getDirectLight(latitude=43.36, longitude=3.52, jourJul=221, startH=7, stopH=19)
+    assert len(sun) > 0
+    assert abs(sum([w for az, el, w in sun]) - 1) < 1e-5
+    assert all([el > 0 for az, el, w in sun])
+
+
 if __name__ == '__main__':
     test_triangle()
 
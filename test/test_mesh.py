@@ -13,3 +13,80 @@ def test_triangleset():
     assert ts.isValid()
 
 
+
+def test_shared_primitive_topology():
+    """ Discretized primitives of same resolution share their index list """
+    d = Discretizer()
+    c1 = Cylinder(1, 2, True, 12)
+    c2 = Cylinder(3, 5, True, 12)
+    c1.apply(d)
+    m1 = d.discretization
+    c2.apply(d)
+    m2 = d.discretization
+    assert m1.indexList == m2.indexList
+    assert m1.pointList[1] != m2.pointList[1]
+    nbfaces = len(m2.indexList)
+    merge = Merge(d, m1)
+    assert merge.apply(Sphere())
+    assert len(m2.indexList) == nbfaces
+
+def test_lod_tessellation():
+    """ The resolution of primitives decreases with their projected size """
+    d = Discretizer()
+    s = Sphere(1, 32, 32)
+    s.apply(d)
+    full = len(d.discretization.pointList)
+    d.lodScale = 1000
+    s.apply(d)
+    assert len(d.discretization.pointList) == full
+    d.lodScale = 10
+    s.apply(d)
+    reduced = len(d.discretization.pointList)
+    assert reduced < full
+    # the scale of transformations is taken into account
+    d.lodScale = 1
+    Scaled((10, 10, 10), s).apply(d)
+    assert len(d.discretization.pointList) == reduced
+    d.lodScale = 0
+    s.apply(d)
+    assert len(d.discretization.pointList) == full
+
+def test_normal_weighting():
+    """ Normals per vertex with the different weightings of the faces """
+    pts = [(0,0,0), (1,0,0), (1,1,0), (0,1,0), (0.5,0.5,1)]
+    ts = TriangleSet(pts, [(0,1,4), (1,2,4), (2,3,4), (3,0,4)])
+    for weighting in [Mesh.eAreaWeighting, Mesh.eAngleWeighting, Mesh.eUniformWeighting]:
+        normals = ts.estimateNormalPerVertex(weighting)
+        assert len(normals) == len(pts)
+        assert abs(normals[4][2] - 1) < 1e-5
+    assert len(ts.estimateNormalPerFace()) == 4
+    ts.computeNormalList(True, Mesh.eAngleWeighting)
+    assert ts.isValid()
+
+def test_mesh_welding():
+    """ Coincident vertices are welded when merging meshes """
+    q1 = QuadSet([(0,0,0), (1,0,0), (1,1,0), (0,1,0)], [(0,1,2,3)])
+    q2 = QuadSet([(1,0,0), (2,0,0), (2,1,0), (1,1,0)], [(0,1,2,3)])
+    d = Discretizer()
+    merge = Merge(d, QuadSet(q1.pointList, q1.indexList))
+    merge.weldTolerance = 1e-5
+    assert merge.apply(q2)
+    result = merge.result
+    assert len(result.pointList) == 6
+    assert len(result.indexList) == 2
+    assert result.isValid()
+    ts = TriangleSet([(0,0,0), (1,0,0), (0,1,0), (1,0,0), (1,1,0), (0,1,0)], [(0,1,2), (3,4,5)])
+    welded, remap = MeshWelder(1e-5).weld(ts)
+    assert len(welded.pointList) == 4
+    assert list(remap) == [0, 1, 2, 1, 3, 2]
+
+def test_shared_primitive_topology_copy():
+    """ Modifying a discretization does not change the shared tables """
+    d = Discretizer()
+    Sphere(1, 10, 10).apply(d)
+    m1 = d.discretization
+    first = list(m1.indexList[0])
+    m1.indexList[0] = Index3(0, 0, 0)
+    Sphere(2, 10, 10).apply(d)
+    m2 = d.discretization
+    assert list(m2.indexList[0]) == first
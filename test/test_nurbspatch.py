@@ -28,5 +28,51 @@ def test_tangents():
     assert (norm(patch3.getUTangentAt(0,0) - Vector3(0,0,1)) < 1e-5)
     assert (norm(patch3.getVTangentAt(0,0) - Vector3(0,1,0)) < 1e-5)
 
+def test_evaluate_grid():
+    patch = NurbsPatch(Point4Matrix([[(0, j/3., i/3., 1) for j in range(4)] for i in range(4)]), udegree = 2, vdegree = 3)
+    uvalues = RealArray([i/4. for i in range(5)])
+    vvalues = RealArray([j/5. for j in range(6)])
+    points, normals = patch.evaluateGrid(uvalues, vvalues, normals = True)
+    assert len(points) == len(uvalues) * len(vvalues)
+    for i, u in enumerate(uvalues):
+        for j, v in enumerate(vvalues):
+            assert norm(points[i*len(vvalues)+j] - patch.getPointAt(u, v)) < 1e-5
+            assert norm(normals[i*len(vvalues)+j] - patch.getNormalAt(u, v)) < 1e-5
+
+def test_bezier_cache():
+    ctrl = [[(i, j, ((i*7+j*3)%5)/4., 1+((i+j)%3)/2.) for j in range(5)] for i in range(6)]
+    patch = NurbsPatch(Point4Matrix(ctrl), udegree = 3, vdegree = 2, uknotList = RealArray([0,0,0,0,0.3,0.6,1,1,1,1]), vknotList = RealArray([0,0,0,0.5,0.5,1,1,1]))
+    params = [(i/6., j/7.) for i in range(7) for j in range(8)]
+    points = [patch.getPointAt(u,v) for u,v in params]
+    derivatives = [patch.getDerivativeAt(u,v,1,0) for u,v in params]
+    assert patch.buildBezierCache()
+    assert patch.hasBezierCache()
+    for (u,v), p, d in zip(params, points, derivatives):
+        assert norm(patch.getPointAt(u,v) - p) < 1e-5
+        assert norm(patch.getDerivativeAt(u,v,1,0) - d) < 1e-5
+    patch.ctrlPointMatrix = Point4Matrix(ctrl)
+    assert not patch.hasBezierCache()
+
+def test_bezier_cache_in_place_edit():
+    ctrl = [[(i, j, ((i*7+j*3)%5)/4., 1) for j in range(4)] for i in range(4)]
+    patch = NurbsPatch(Point4Matrix(ctrl), udegree = 3, vdegree = 3)
+    assert patch.buildBezierCache()
+    before = patch.getPointAt(0.5, 0.5)
+    # a control point edited in place invalidates the cache
+    patch.ctrlPointMatrix[1,2] = Vector4(1, 2, 5, 1)
+    assert not patch.hasBezierCache()
+    after = patch.getPointAt(0.5, 0.5)
+    assert norm(after - before) > 1e-3
+    assert patch.buildBezierCache()
+    assert norm(patch.getPointAt(0.5, 0.5) - after) < 1e-5
+    # as well as an element modified through its reference
+    patch.ctrlPointMatrix[1,2].z = 0
+    assert not patch.hasBezierCache()
+    assert patch.buildBezierCache()
+    patch.uknotList[0] = 0
+    assert not patch.hasBezierCache()
+
 if __name__ == '__main__':
-    test_tangents()
\ No newline at end of file
+    test_tangents()
+    test_evaluate_grid()
+    test_bezier_cache()
\ No newline at end of file
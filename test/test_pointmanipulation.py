@@ -37,6 +37,22 @@ def test_median_point():
        raise ValueError(k,j,dist_to_points(p3list[i],p3list),dist_to_points(p3list[j],p3list),p3list[i],p3list[j])
 
 
+def test_delaunay_flat_connections():
+   if not pgl_support_extension('CGAL'):
+       return
+   seed(1)
+   nbpoint = 200
+   p3list = Point3Array([random_point() for i in range(nbpoint)])
+   connections = delaunay_point_connection(p3list)
+   for parallel in [False, True]:
+       offsets, neighbors = delaunay_point_connection_flat(p3list, parallel)
+       offsets, neighbors = list(offsets), list(neighbors)
+       assert len(offsets) == nbpoint + 1
+       assert offsets[nbpoint] == len(neighbors)
+       for i in range(nbpoint):
+           assert sorted(neighbors[offsets[i]:offsets[i+1]]) == sorted(connections[i])
+   assert len(delaunay_triangulation(p3list, True)) == len(delaunay_triangulation(p3list))
+
 
 if __name__ == '__main__':
     for i in range(50):
@@ -51,4 +51,37 @@ def test_scene3():
     scene.add(shape)
     assert scene.isValid()
 
-    
\ No newline at end of file
+    
+def test_object_pool():
+    pool = ObjectPool(True)
+    with ObjectPoolScope(pool):
+        sc = Scene([Shape(Sphere(1+i*0.01)) for i in range(100)])
+    assert pool.isThreadConfined()
+    assert pool.getLiveObjectCount() > 200
+    sc.objectPool = pool
+    del pool
+    assert sc.objectPool.getChunkCount() == 1
+    assert len(sc) == 100
+
+def test_object_pool_clear():
+    pool = ObjectPool()
+    with ObjectPoolScope(pool):
+        sc = Scene([Shape(Sphere(1+i*0.01)) for i in range(100)])
+    assert pool.getChunkCount() == 1
+    # memory is only given back once all the objects are deleted
+    assert not pool.clear()
+    del sc
+    assert pool.getLiveObjectCount() == 0
+    assert pool.clear()
+    assert pool.getChunkCount() == 0
+
+def test_object_pool_teardown():
+    pool = ObjectPool(True)
+    with ObjectPoolScope(pool):
+        sc = Scene([Shape(Sphere(1+i*0.01)) for i in range(100)])
+    # the scene gives all the chunks of its pool back when it is deleted
+    sc.setObjectPool(pool, True)
+    assert sc.isObjectPoolTeardown()
+    del sc
+    assert pool.getLiveObjectCount() == 0
+    assert pool.getChunkCount() == 0
@@ -15,5 +15,28 @@ def test_turtle_gc_gen():
     p.stopGC()
     assert len(p.getScene()) == 2
 
+def test_turtle_gc_meshing():
+    p = PglTurtle()
+    p.gc_meshing_enabled = True
+    rings = []
+    p.registerGCRingConsumer(lambda ringid, points, center, normal, binormal, radius, v : rings.append(ringid))
+    p.startGC()
+    p.F(10)
+    p.F(10)
+    p.push()
+    p.left(10)
+    p.F(10)
+    p.pop()
+    p.F(10)
+    p.stopGC()
+    sc = p.getScene()
+    assert len(sc) == 2
+    for sh in sc:
+        assert isinstance(sh.geometry, QuadSet)
+    # straight rings of the main axis are shared
+    assert len(sc[1].geometry.indexList) == p.sectionResolution
+    assert len(rings) == 4
+
 if __name__ == '__main__':
     test_turtle_gc_gen()
+    test_turtle_gc_meshing()
@@ -0,0 +1,48 @@
+from openalea.plantgl.all import *
+from random import uniform
+
+
+def triangle_area(a, b, c):
+    return norm(cross(b - a, c - a)) / 2
+
+def random_point():
+    return Vector3(uniform(0, 1), uniform(0, 1), uniform(0, 1))
+
+def test_voxelizer_triangle_pieces():
+    voxelizer = SceneVoxelizer((0.25, 0.25, 0.25), (0, 0, 0), (1, 1, 1))
+    for i in range(20):
+        a, b, c = random_point(), random_point(), random_point()
+        area = 0
+        for index, piece in voxelizer.clipPolygon(Point3Array([a, b, c])):
+            lower, upper = voxelizer.getVoxelLowerPoint(index), voxelizer.getVoxelUpperPoint(index)
+            for p in piece:
+                for k in range(3):
+                    assert lower[k] - 1e-9 <= p[k] <= upper[k] + 1e-9
+            area += sum(triangle_area(piece[0], piece[j], piece[j + 1]) for j in range(1, len(piece) - 1))
+        assert abs(area - triangle_area(a, b, c)) < 1e-8
+
+def test_voxelizer_scene():
+    points = Point3Array([(0, 0, 0.5), (1, 0, 0.5), (0, 1, 0.5), (1, 1, 0.5)])
+    scene = Scene([Shape(TriangleSet(points, [(0, 1, 3), (0, 3, 2)]), Material(), 7)])
+    voxelizer = SceneVoxelizer((0.25, 0.25, 0.25), (0, 0, 0), (1, 1, 1))
+    voxelizer.process(scene)
+    assert abs(voxelizer.getTotalArea() - 1) < 1e-8
+    occupied = voxelizer.getOccupiedVoxels()
+    assert len(occupied) == 16
+    for cid in occupied:
+        assert voxelizer.getShapeIds(cid) == [7]
+        assert abs(voxelizer.getArea(cid) - 0.0625) < 1e-8
+        # horizontal triangles are in the first inclination class
+        assert abs(voxelizer.getInclinationDistribution(cid)[0] - 0.0625) < 1e-8
+    densities = voxelizer.getAreaDensities()
+    assert abs(densities[occupied[0]] - 0.0625 / 0.25**3) < 1e-6
+
+def test_voxelizer_multithreaded():
+    scene = Scene([Shape(Translated(random_point() * 4, Sphere(uniform(0.2, 0.6))), Material(), i) for i in range(20)])
+    serial = SceneVoxelizer(scene, (0.2, 0.2, 0.2))
+    serial.setMultiThreaded(False)
+    serial.process(scene)
+    parallel = SceneVoxelizer(scene, (0.2, 0.2, 0.2))
+    parallel.process(scene)
+    assert abs(serial.getTotalArea() - parallel.getTotalArea()) < 1e-6
+    assert serial.getOccupiedVoxels() == parallel.getOccupiedVoxels()
@@ -131,6 +131,140 @@ def test_projected_sphere(view = False):
         plt.imshow(i.to_array())
         plt.show()
 
+def test_shadow():
+    s = Scene([Shape(Box((5,5,0.1)),Material((200,200,200)),1),
+               Shape(Translated((0,0,3),Sphere(1,32,32)),Material((200,0,0)),2)])
+    z = ZBufferEngine(200,200, 0xffffffff, eARGB)
+    z.setOrthographicCamera(-5,5,-5,5,1,100)
+    z.lookAt((0,0,20),(0,0,0),(0,1,0))
+    z.multithreaded = MT
+    assert z.addShadowLight((0,0,-1), 512, 512) == 0
+    assert z.addShadowLight((1,0,-1), 512, 512) == 1
+    z.process(s)
+    lighting = z.getShapeLighting()
+    nbpixels, (lit0, lit1) = lighting[1]
+    # ground is seen totally from top light and partially shaded by the sphere from the oblique light
+    assert lit0 == nbpixels
+    assert 0 < lit1 < nbpixels
+    buffer = z.getLightingBuffer()
+    # ground point on the light 1 side of the sphere: only lit by light 0
+    assert buffer[160,100] == 1
+    assert buffer[20,100] == 3
+
+
+def test_periodic_domain():
+    s = Scene([Shape(Box((0.5,0.5,0.1)),Material((200,200,200)),1)])
+    z = ZBufferEngine(200,200, 0xffffffff, eARGB)
+    z.setOrthographicCamera(-5,5,-5,5,1,100)
+    z.lookAt((0,0,20),(0,0,0),(0,1,0))
+    z.multithreaded = MT
+    z.setPeriodicDomain((-2,-2),(2,2))
+    assert z.isPeriodic()
+    z.process(s)
+    depth = z.getDepthBuffer()
+    # the square is rendered at its position and translated by the periods of the domain
+    covered = lambda x, y : depth[int(100+20*y),int(100+20*x)] < 1e10
+    assert covered(0,0)
+    assert covered(4,0) and covered(-4,0) and covered(0,4) and covered(-4,-4)
+    assert not covered(2,0) and not covered(0,-2)
+    z.clearPeriodicDomain()
+    assert not z.isPeriodic()
+
+
+def test_texture_cache():
+    texture = abspath(join(dirname(__file__),'../share/plantgl/pixmap/geomviewer.png'))
+    s = Scene([Shape(QuadSet([(-1,-1,0),(1,-1,0),(1,1,0),(-1,1,0)],[(0,1,2,3)],texCoordList=[(0,0),(1,0),(1,1),(0,1)],texCoordIndexList=[(0,1,2,3)]),
+                     Texture2D(ImageTexture(texture)),1)])
+    t = Tesselator()
+    s[0].geometry.apply(t)
+    s = Scene([Shape(t.result, s[0].appearance, 1)])
+    TextureCache.clear()
+    TextureCache.resetStatistics()
+    # the texture is decoded once and shared by the engines
+    for i in range(2):
+        z = ZBufferEngine(50,50)
+        z.setOrthographicCamera(-5,5,-5,5,1,100)
+        z.lookAt((0,0,20),(0,0,0),(0,1,0))
+        z.process(s)
+    stats = TextureCache.getStatistics()
+    assert stats['misses'] == 1
+    assert stats['hits'] == 1
+    assert stats['nbTextures'] == 1
+    assert stats['memorySize'] > 0
+
+
+def test_depth_precision():
+    s = Scene([Shape(Translated((i,0,0.1*i),Sphere(0.6,16,16)),Material((200,0,0)),i+1) for i in range(-2,3)])
+    ids = []
+    for precision in [DepthBuffer.eRealDepth, DepthBuffer.eFloatDepth, DepthBuffer.eFixed24Depth]:
+        z = ZBufferEngine(100,100, 0xffffffff, eARGB)
+        z.depthPrecision = precision
+        z.setOrthographicCamera(-5,5,-5,5,1,100)
+        z.lookAt((0,0,20),(0,0,0),(0,1,0))
+        z.multithreaded = False
+        z.process(s)
+        assert z.getDepthStorage().getPrecision() == precision
+        ids.append(z.getIdArray().copy())
+        depth = z.getDepthBuffer()
+        assert abs(depth[50,50] - (20 - 0.6)) < 0.05
+        assert depth[0,0] > 1e10
+    # the ids do not depend on the precision of the depths
+    assert (ids[0] == ids[1]).all() and (ids[0] == ids[2]).all()
+    histogram = dict(z.getImage().histogram())
+    assert histogram[3] == (ids[2] == 3).sum()
+
+
+def test_id_statistics():
+    s = Scene([Shape(QuadSet([(0,0,0),(1,0,0),(1,1,0),(0,1,0)],[(0,1,2,3)]),Material((200,0,0)),5),
+               Shape(Translated((2,0,-5),QuadSet([(0,0,0),(1,0,0),(1,1,0),(0,1,0)],[(0,1,2,3)])),Material((200,0,0)),7)])
+    z = ZBufferEngine(400,300, 0xffffffff, eARGB)
+    z.setOrthographicCamera(-4,4,-3,3,1,100)
+    z.lookAt((1.5,0.5,10),(1.5,0.5,0),(0,1,0))
+    z.multithreaded = MT
+    z.idStatisticsEnabled = True
+    z.process(s)
+    stats = z.getIdStatistics()
+    assert list(stats['ids']) == [5, 7]
+    assert list(stats['nbPixels']) == [2500, 2500]
+    assert abs(stats['areas'][0] - 1) < 1e-5 and abs(stats['areas'][1] - 1) < 1e-5
+    assert abs(stats['meanDepths'][0] - 10) < 1e-5 and abs(stats['meanDepths'][1] - 15) < 1e-5
+    assert list(stats['flags']) == [3, 3]
+
+def test_layers():
+    quad = QuadSet([(0,0,0),(1,0,0),(1,1,0),(0,1,0)],[(0,1,2,3)])
+    s = Scene([Shape(quad,Material((200,0,0)),5),
+               Shape(Translated((0.5,0,-2),quad),Material((200,0,0)),6),
+               Shape(Translated((0,0,-4),quad),Material((200,0,0)),7)])
+    z = ZBufferEngine(400,300, 0xffffffff, eARGB)
+    z.setOrthographicCamera(-4,4,-3,3,1,100)
+    z.lookAt((1.5,0.5,10),(1.5,0.5,0),(0,1,0))
+    z.multithreaded = MT
+    z.idStatisticsEnabled = True
+    z.layerCount = 2
+    z.process(s)
+    layers = z.getLayerBuffer()
+    assert layers.getNbLayers() == 2
+    r = z.worldToRaster((0.75,0.5,0))
+    x, y = int(r.x), int(r.y)
+    assert layers.getNbLayersAt(x, y) == 2
+    assert [layers.getIdAt(x, y, l) for l in range(2)] == [5, 6]
+    assert abs(layers.getDepthAt(x, y, 1) - 12) < 1e-3
+    stats = z.getIdStatistics()
+    # the third quad is hidden by the first one and is recorded in the second layer
+    assert list(stats['ids']) == [5, 6, 7]
+    assert list(stats['nbPixels']) == [2500, 1250, 0]
+    assert [list(l) for l in stats['layerPixels']] == [[2500, 0], [1250, 1250], [0, 1250]]
+    assert list(stats['flags']) == [1, 3, 2]
+
+
+def test_pixel_scale():
+    z = ZBufferEngine(100,100)
+    z.setPerspectiveCamera(60,1,0.1,1000)
+    z.lookAt((10,0,0),(0,0,0),(0,0,1))
+    s0 = z.camera().getPixelScale((0,0,0),100,100)
+    # the scale of a sphere is the one of its nearest point
+    s1 = z.camera().getPixelScale((0,0,0),100,100,radius=1)
+    assert abs(s1 / s0 - 10/9.) < 1e-5
 
 if __name__ == '__main__':
     test_projected_sphere(True)